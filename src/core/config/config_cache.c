@@ -0,0 +1,386 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * config_cache.c - Compiling, validating and reading configuration images.
+ *
+ * See config_cache.h for the image layout. The perfect hash index uses the
+ * configuration table's key hash: its high 32 bits pick a bucket, and the
+ * bucket's displacement, mixed into the full hash, picks the slot. Buckets
+ * are placed largest first, trying displacements 0, 1, 2, ... until every
+ * key of the bucket lands in a free slot. With a quarter of the slots kept
+ * spare and about four keys per bucket this takes a handful of tries per
+ * bucket.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "config_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Internal Helpers ---
+
+#define CONFIG_CACHE_MAGIC 0x43434850u // "PHCC" read as a little-endian word.
+#define CONFIG_CACHE_VERSION 3
+#define EMPTY_SLOT UINT32_MAX
+// Displacements tried per bucket before the build gives up.
+#define MAX_DISPLACEMENT (1u << 20)
+// Slot states while building.
+#define SLOT_FREE 0
+#define SLOT_TAKEN 1
+#define SLOT_TRYING 2
+
+static inline uint32_t bucket_of(uint64_t hash, uint32_t bucket_count) {
+    return (uint32_t)((hash >> 32) % bucket_count);
+}
+
+static inline uint32_t slot_of(uint64_t hash, uint32_t displacement, uint32_t slot_count) {
+    uint64_t x = hash ^ ((uint64_t)displacement * 0x9E3779B97F4A7C15ull);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return (uint32_t)(x % slot_count);
+}
+
+static inline uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+/**
+ * @brief Checks that `count` items of `size` bytes at `offset` lie within
+ * an image of `total` bytes, without overflowing.
+ */
+static int section_fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t total) {
+    return offset <= total && count <= (total - offset) / size;
+}
+
+/**
+ * @brief Checksums what a load trusts without further checks: the header,
+ * with the checksum of everything between it and the arena (buckets, slots
+ * and log list) in place of its own checksum field. The arena is left out,
+ * so the cost follows the number of keys, not the size of the strings;
+ * strings are bounds-checked as they are read (see config_cache_entry).
+ */
+static uint64_t image_checksum(const char* image, const ConfigCacheHeader* header) {
+    ConfigCacheHeader sealed = *header;
+    sealed.checksum = config_table_hash(image + sizeof(ConfigCacheHeader),
+                                        (size_t)(header->arena_offset - sizeof(ConfigCacheHeader)));
+    return config_table_hash((const char*)&sealed, sizeof(sealed));
+}
+
+/**
+ * @brief Places the keys in slots, given scratch space: `bucket_start`
+ * (bucket_count + 1 entries, zeroed), `fill` (bucket_count), `members` and
+ * `candidate` (count each) and `state` (slot_count, zeroed).
+ * @return 0 on success, -1 if some bucket cannot be placed.
+ */
+static int place_keys(const ConfigEntry** entries, uint32_t count, uint32_t bucket_count,
+                      uint32_t slot_count, uint32_t* displacements, uint32_t* slot_entries,
+                      uint32_t* bucket_start, uint32_t* fill, uint32_t* members,
+                      uint32_t* candidate, uint8_t* state) {
+    // Group the keys by bucket (a counting sort).
+    for (uint32_t i = 0; i < count; ++i) {
+        bucket_start[bucket_of(entries[i]->hash, bucket_count) + 1]++;
+    }
+    uint32_t largest = 0;
+    for (uint32_t b = 0; b < bucket_count; ++b) {
+        if (bucket_start[b + 1] > largest) largest = bucket_start[b + 1];
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    memcpy(fill, bucket_start, (size_t)bucket_count * sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; ++i) {
+        members[fill[bucket_of(entries[i]->hash, bucket_count)]++] = i;
+    }
+
+    // Place the buckets largest first: big buckets are hardest to place.
+    // `fill` is reused to hold the order.
+    uint32_t* order = fill;
+    uint32_t buckets_used = 0;
+    for (uint32_t size = largest; size > 0; --size) {
+        for (uint32_t b = 0; b < bucket_count; ++b) {
+            if (bucket_start[b + 1] - bucket_start[b] == size) order[buckets_used++] = b;
+        }
+    }
+
+    memset(displacements, 0, (size_t)bucket_count * sizeof(uint32_t));
+    for (uint32_t s = 0; s < slot_count; ++s) {
+        slot_entries[s] = EMPTY_SLOT;
+    }
+    for (uint32_t n = 0; n < buckets_used; ++n) {
+        uint32_t b = order[n];
+        uint32_t first = bucket_start[b];
+        uint32_t size = bucket_start[b + 1] - first;
+        uint32_t displacement = 0;
+        for (; displacement < MAX_DISPLACEMENT; ++displacement) {
+            uint32_t tried = 0;
+            for (; tried < size; ++tried) {
+                uint32_t slot = slot_of(entries[members[first + tried]]->hash, displacement, slot_count);
+                if (state[slot] != SLOT_FREE) break;
+                state[slot] = SLOT_TRYING;
+                candidate[tried] = slot;
+            }
+            if (tried == size) break;
+            for (uint32_t i = 0; i < tried; ++i) state[candidate[i]] = SLOT_FREE;
+        }
+        if (displacement == MAX_DISPLACEMENT) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < size; ++i) {
+            state[candidate[i]] = SLOT_TAKEN;
+            slot_entries[candidate[i]] = members[first + i];
+        }
+        displacements[b] = displacement;
+    }
+    return 0;
+}
+
+/**
+ * @brief Builds the perfect hash index.
+ * @param[out] displacements One per bucket.
+ * @param[out] slot_entries For each slot, the index in `entries` of its key,
+ *                          or EMPTY_SLOT.
+ * @return 0 on success, -1 on allocation failure or if some bucket cannot
+ *         be placed (two keys with the same 64-bit hash).
+ */
+static int build_index(const ConfigEntry** entries, uint32_t count, uint32_t bucket_count,
+                       uint32_t slot_count, uint32_t* displacements, uint32_t* slot_entries) {
+    uint32_t* bucket_start = (uint32_t*)calloc((size_t)bucket_count + 1, sizeof(uint32_t));
+    uint32_t* fill = (uint32_t*)malloc((size_t)bucket_count * sizeof(uint32_t));
+    uint32_t* members = (uint32_t*)malloc(((size_t)count + 1) * sizeof(uint32_t));
+    uint32_t* candidate = (uint32_t*)malloc(((size_t)count + 1) * sizeof(uint32_t));
+    uint8_t* state = (uint8_t*)calloc(slot_count, 1);
+    int result = -1;
+    if (bucket_start && fill && members && candidate && state) {
+        result = place_keys(entries, count, bucket_count, slot_count, displacements, slot_entries,
+                            bucket_start, fill, members, candidate, state);
+    }
+    free(bucket_start);
+    free(fill);
+    free(members);
+    free(candidate);
+    free(state);
+    return result;
+}
+
+// --- Public API Implementation ---
+
+/**
+ * @see config_cache.h
+ */
+int config_cache_enabled(void) {
+    const char* setting = getenv(CONFIG_CACHE_ENV);
+    return !setting || strcmp(setting, "0") != 0;
+}
+
+/**
+ * @see config_cache.h
+ */
+int config_cache_open(ConfigCache* cache, const char* path, uint64_t source_size, int64_t source_mtime_ns) {
+    memset(cache, 0, sizeof(*cache));
+    if (!platform_map_file(path, &cache->file)) {
+        return -1;
+    }
+
+    const char* data = cache->file.data;
+    uint64_t size = cache->file.size;
+    const ConfigCacheHeader* header = (const ConfigCacheHeader*)data;
+    if (size < sizeof(ConfigCacheHeader) ||
+        header->magic != CONFIG_CACHE_MAGIC || header->version != CONFIG_CACHE_VERSION ||
+        header->source_size != source_size || header->source_mtime_ns != source_mtime_ns ||
+        header->total_size != size || header->bucket_count == 0 || header->slot_count == 0 ||
+        (header->buckets_offset | header->slots_offset | header->log_offset) % 8 != 0 ||
+        header->arena_offset < sizeof(ConfigCacheHeader) ||
+        !section_fits(header->arena_offset, header->arena_size, 1, size) ||
+        // The index must lie before the arena, where the checksum covers it.
+        !section_fits(header->buckets_offset, header->bucket_count, sizeof(uint32_t), header->arena_offset) ||
+        !section_fits(header->slots_offset, header->slot_count, sizeof(ConfigCacheSlot), header->arena_offset) ||
+        !section_fits(header->log_offset, header->log_count, sizeof(uint32_t), header->arena_offset) ||
+        header->arena_size > UINT32_MAX ||
+        header->checksum != image_checksum(data, header)) {
+        config_cache_close(cache);
+        return -1;
+    }
+
+    cache->header = header;
+    cache->buckets = (const uint32_t*)(data + header->buckets_offset);
+    cache->slots = (const ConfigCacheSlot*)(data + header->slots_offset);
+    cache->log_slots = (const uint32_t*)(data + header->log_offset);
+    cache->arena = data + header->arena_offset;
+    return 0;
+}
+
+/**
+ * @see config_cache.h
+ */
+void config_cache_close(ConfigCache* cache) {
+    platform_unmap_file(&cache->file);
+    memset(cache, 0, sizeof(*cache));
+}
+
+/**
+ * @see config_cache.h
+ */
+int config_cache_entry(const ConfigCache* cache, uint32_t slot, ConfigPair* pair) {
+    if (slot >= cache->header->slot_count) {
+        return -1;
+    }
+    const ConfigCacheSlot* entry = &cache->slots[slot];
+    uint64_t arena_size = cache->header->arena_size;
+    // The checksum does not cover the arena, and would not rule out a
+    // crafted image anyway: bound every string, terminator included, by it.
+    if (entry->key_length == EMPTY_SLOT ||
+        (uint64_t)entry->key_offset + entry->key_length >= arena_size ||
+        (uint64_t)entry->value_offset + entry->value_length >= arena_size ||
+        cache->arena[entry->key_offset + entry->key_length] != '\0' ||
+        cache->arena[entry->value_offset + entry->value_length] != '\0') {
+        return -1;
+    }
+    pair->key = cache->arena + entry->key_offset;
+    pair->key_length = entry->key_length;
+    pair->value = cache->arena + entry->value_offset;
+    pair->value_length = entry->value_length;
+    return 0;
+}
+
+/**
+ * @see config_cache.h
+ */
+const ConfigCacheSlot* config_cache_lookup(const ConfigCache* cache, const char* key, size_t key_length) {
+    const ConfigCacheHeader* header = cache->header;
+    uint64_t hash = config_table_hash(key, key_length);
+    uint32_t displacement = cache->buckets[bucket_of(hash, header->bucket_count)];
+    uint32_t slot = slot_of(hash, displacement, header->slot_count);
+    ConfigPair pair;
+    if (config_cache_entry(cache, slot, &pair) != 0 ||
+        pair.key_length != key_length || memcmp(pair.key, key, key_length) != 0) {
+        return NULL;
+    }
+    return &cache->slots[slot];
+}
+
+/**
+ * @see config_cache.h
+ */
+const char* config_cache_find(const ConfigCache* cache, const char* key, size_t key_length,
+                              size_t* value_length) {
+    const ConfigCacheSlot* slot = config_cache_lookup(cache, key, key_length);
+    if (!slot) {
+        return NULL;
+    }
+    if (value_length) {
+        *value_length = slot->value_length;
+    }
+    return cache->arena + slot->value_offset;
+}
+
+/**
+ * @see config_cache.h
+ */
+int config_cache_to_table(const ConfigCache* cache, ConfigTable* table) {
+    if (config_table_reserve(table, cache->header->count, (size_t)cache->header->arena_size) != 0) {
+        return -1;
+    }
+    ConfigPair pairs[CONFIG_TABLE_BATCH * 4];
+    size_t pending = 0;
+    for (uint32_t slot = 0; slot < cache->header->slot_count; ++slot) {
+        if (config_cache_entry(cache, slot, &pairs[pending]) == 0 &&
+            ++pending == sizeof(pairs) / sizeof(pairs[0])) {
+            if (config_table_set_batch(table, pairs, pending) != 0) return -1;
+            pending = 0;
+        }
+    }
+    return config_table_set_batch(table, pairs, pending);
+}
+
+/**
+ * @brief Lays an image out in memory from a table and its index.
+ * @return The image (freed by the caller), or NULL on allocation failure.
+ */
+static char* compile_image(const ConfigTable* table, const ConfigEntry** entries,
+                           const uint32_t* displacements, const uint32_t* slot_entries,
+                           ConfigCacheHeader* header, const char* log_prefix) {
+    size_t prefix_length = strlen(log_prefix);
+    header->buckets_offset = align8(sizeof(ConfigCacheHeader));
+    header->slots_offset = align8(header->buckets_offset + (uint64_t)header->bucket_count * sizeof(uint32_t));
+    header->log_offset = align8(header->slots_offset + (uint64_t)header->slot_count * sizeof(ConfigCacheSlot));
+    header->arena_offset = align8(header->log_offset + (uint64_t)header->log_count * sizeof(uint32_t));
+    header->total_size = header->arena_offset + header->arena_size;
+
+    char* image = (char*)calloc(1, (size_t)header->total_size);
+    if (!image) {
+        return NULL;
+    }
+    memcpy(image + header->buckets_offset, displacements, (size_t)header->bucket_count * sizeof(uint32_t));
+    ConfigCacheSlot* slots = (ConfigCacheSlot*)(image + header->slots_offset);
+    uint32_t* log_slots = (uint32_t*)(image + header->log_offset);
+    char* arena = image + header->arena_offset;
+    uint32_t arena_used = 0;
+    uint32_t logged = 0;
+    for (uint32_t s = 0; s < header->slot_count; ++s) {
+        if (slot_entries[s] == EMPTY_SLOT) {
+            slots[s].key_length = EMPTY_SLOT;
+            continue;
+        }
+        const ConfigEntry* entry = entries[slot_entries[s]];
+        const char* key = config_table_key(table, entry);
+        slots[s].key_offset = arena_used;
+        slots[s].key_length = entry->key_length;
+        memcpy(arena + arena_used, key, (size_t)entry->key_length + 1);
+        arena_used += entry->key_length + 1;
+        slots[s].value_offset = arena_used;
+        slots[s].value_length = entry->value_length;
+        memcpy(arena + arena_used, config_table_value(table, entry), (size_t)entry->value_length + 1);
+        arena_used += entry->value_length + 1;
+        slots[s].types = entry->types;
+        slots[s].number = entry->number;
+        if (strncmp(key, log_prefix, prefix_length) == 0) {
+            log_slots[logged++] = s;
+        }
+    }
+    header->checksum = image_checksum(image, header);
+    memcpy(image, header, sizeof(*header));
+    return image;
+}
+
+/**
+ * @see config_cache.h
+ */
+int config_cache_write(const ConfigTable* table, const char* path, const char* log_prefix,
+                       uint64_t source_size, int64_t source_mtime_ns) {
+    if (table->count >= UINT32_MAX / 2) {
+        return -1;
+    }
+    ConfigCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = CONFIG_CACHE_MAGIC;
+    header.version = CONFIG_CACHE_VERSION;
+    header.source_size = source_size;
+    header.source_mtime_ns = source_mtime_ns;
+    header.count = (uint32_t)table->count;
+    header.slot_count = header.count + header.count / 4 + 1;
+    header.bucket_count = header.count / 4 + 1;
+
+    const ConfigEntry** entries = (const ConfigEntry**)malloc(((size_t)header.count + 1) * sizeof(ConfigEntry*));
+    uint32_t* displacements = (uint32_t*)malloc((size_t)header.bucket_count * sizeof(uint32_t));
+    uint32_t* slot_entries = (uint32_t*)malloc((size_t)header.slot_count * sizeof(uint32_t));
+    int result = -1;
+    if (entries && displacements && slot_entries) {
+        size_t prefix_length = strlen(log_prefix);
+        size_t cursor = 0;
+        for (uint32_t i = 0; i < header.count; ++i) {
+            entries[i] = config_table_next(table, &cursor);
+            header.arena_size += (uint64_t)entries[i]->key_length + entries[i]->value_length + 2;
+            header.log_count += strncmp(config_table_key(table, entries[i]), log_prefix, prefix_length) == 0;
+        }
+        char* image = NULL;
+        if (header.arena_size <= UINT32_MAX &&
+            build_index(entries, header.count, header.bucket_count, header.slot_count,
+                        displacements, slot_entries) == 0 &&
+            (image = compile_image(table, entries, displacements, slot_entries, &header, log_prefix)) != NULL) {
+            result = platform_write_file_atomic(path, image, (size_t)header.total_size) ? 0 : -1;
+        }
+        free(image);
+    }
+    free(entries);
+    free(displacements);
+    free(slot_entries);
+    return result;
+}
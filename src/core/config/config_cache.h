@@ -0,0 +1,161 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * config_cache.h - Compiled binary images of configuration files.
+ *
+ * Parsing a text configuration costs time proportional to its size on every
+ * invocation. After a file has been parsed once, the configuration manager
+ * writes a compiled image of it next to the file (`<file>.phc`), and later
+ * loads map that image and read it in place: no parsing, no hashing of keys
+ * or values and no allocation proportional to the number of entries.
+ *
+ * An image holds:
+ * - A header with a magic number, a format version, the size and mtime of
+ *   the text file it was compiled from, and a checksum of the header and
+ *   the index (not of the arena).
+ * - A perfect hash index built by "hash and displace": keys are spread over
+ *   buckets, and each bucket stores the displacement that sends all of its
+ *   keys to distinct slots. A lookup hashes the key once, reads one
+ *   displacement and compares one slot, whatever the size of the file.
+ * - The slots themselves, referring to keys and values by offset, with the
+ *   typed reading of each value (see config_value.h).
+ * - The slots of `log.*` keys, which are applied to the logger on load.
+ * - A string arena of NUL-terminated keys and values, so values can be
+ *   handed out as C strings straight from the mapping.
+ *
+ * An image is used only if its stamp matches the text file's current size
+ * and mtime and its checksum is correct; otherwise the text is parsed and
+ * the image rewritten. Checking the checksum is the one step of a load that
+ * is linear: it reads the index, about 30 bytes per key, but none of the
+ * strings. Strings are bounds-checked when read instead, so a damaged arena
+ * can garble or hide a value but never makes a read leave the image.
+ * Images are written to a temporary file and renamed into place, so a
+ * concurrent reader sees either the old or the new image.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef CONFIG_CACHE_H
+#define CONFIG_CACHE_H
+
+#include "config_table.h"
+#include "platform/platform.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Appended to a configuration file's path to name its image.
+#define CONFIG_CACHE_SUFFIX ".phc"
+// Set to "0" to neither read nor write images.
+#define CONFIG_CACHE_ENV "PH_CONFIG_CACHE"
+
+/**
+ * @struct ConfigCacheHeader
+ * @brief The first bytes of an image. All offsets are from the file start.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t source_size;       // Size of the text file compiled.
+    int64_t source_mtime_ns;    // Its modification time.
+    uint64_t checksum;          // Of the header and the index; see config_cache.c.
+    uint64_t total_size;        // Size of the image.
+    uint32_t count;             // Keys stored.
+    uint32_t slot_count;
+    uint32_t bucket_count;
+    uint32_t log_count;         // Entries of `log_offset`.
+    uint64_t buckets_offset;    // uint32_t displacement per bucket.
+    uint64_t slots_offset;      // ConfigCacheSlot per slot.
+    uint64_t log_offset;        // uint32_t slot index per `log.*` key.
+    uint64_t arena_offset;
+    uint64_t arena_size;
+} ConfigCacheHeader;
+
+/**
+ * @struct ConfigCacheSlot
+ * @brief One slot of the index. An empty slot has `key_length` UINT32_MAX.
+ */
+typedef struct {
+    uint32_t key_offset;
+    uint32_t key_length;
+    uint32_t value_offset;
+    uint32_t value_length;
+    uint32_t types;             // As in ConfigEntry.
+    uint32_t reserved;          // 0.
+    int64_t number;
+} ConfigCacheSlot;
+
+/**
+ * @struct ConfigCache
+ * @brief An image opened with `config_cache_open`.
+ */
+typedef struct {
+    platform_mapped_file file;
+    const ConfigCacheHeader* header;
+    const uint32_t* buckets;
+    const ConfigCacheSlot* slots;
+    const uint32_t* log_slots;
+    const char* arena;
+} ConfigCache;
+
+/**
+ * @brief Tells whether images are enabled (see CONFIG_CACHE_ENV).
+ */
+int config_cache_enabled(void);
+
+/**
+ * @brief Maps an image and validates it against a text file's stamp.
+ * @param path The image's path.
+ * @param source_size The text file's current size.
+ * @param source_mtime_ns The text file's current modification time.
+ * @return 0 if the image is usable, -1 if it is missing, stale or corrupt
+ *         (`cache` is then left closed).
+ */
+int config_cache_open(ConfigCache* cache, const char* path, uint64_t source_size, int64_t source_mtime_ns);
+
+/**
+ * @brief Unmaps an image. Safe on a cache that failed to open.
+ */
+void config_cache_close(ConfigCache* cache);
+
+/**
+ * @brief Looks a key up in an open image.
+ * @param[out] value_length Receives the value's length. May be NULL.
+ * @return The NUL-terminated value, valid until the image is closed, or NULL.
+ */
+const char* config_cache_find(const ConfigCache* cache, const char* key, size_t key_length,
+                              size_t* value_length);
+
+/**
+ * @brief Looks a key up in an open image, like `config_cache_find`.
+ * @return The key's slot, whose strings are known to lie in the image and
+ *         be NUL-terminated, or NULL if the key is not present.
+ */
+const ConfigCacheSlot* config_cache_lookup(const ConfigCache* cache, const char* key, size_t key_length);
+
+/**
+ * @brief Reads the entry in a slot of an open image.
+ * @return 0 if the slot holds an entry (stored in `pair`), -1 if it is empty.
+ */
+int config_cache_entry(const ConfigCache* cache, uint32_t slot, ConfigPair* pair);
+
+/**
+ * @brief Copies every entry of an open image into a table.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int config_cache_to_table(const ConfigCache* cache, ConfigTable* table);
+
+/**
+ * @brief Compiles a table into an image file, replacing any previous one.
+ * @param log_prefix Keys starting with this are listed in the image's log
+ *                   section.
+ * @return 0 on success, -1 if the image could not be built or written.
+ */
+int config_cache_write(const ConfigTable* table, const char* path, const char* log_prefix,
+                       uint64_t source_size, int64_t source_mtime_ns);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // CONFIG_CACHE_H
@@ -6,229 +6,1765 @@
  * fast lookups (average O(1) time complexity), which is essential for a
  * responsive application.
  *
+ * Readers never take a lock. The table is published as an immutable snapshot
+ * behind one atomic pointer, in the manner of RCU: a writer copies the
+ * current snapshot, changes the copy and swaps it in, and the old snapshot
+ * is freed once no reader can still be using it. Readers announce
+ * themselves by writing the global epoch into a reader slot of their own (a
+ * cache line that no other thread writes while it is held), and a snapshot
+ * retired in epoch E is reclaimed when no slot holds an epoch at or below E.
+ * Writers are serialized by a mutex and pay for a copy of the table, which
+ * suits configuration: it is read constantly and written rarely, and
+ * `config_load` builds its snapshot privately and publishes it once.
+ *
+ * The configuration is merged from layers (system, user and repository
+ * files, `PH_*` environment variables, command-line overrides), each kept
+ * as a private table of its own. Readers never see the layers: the
+ * published snapshot is their flattened merge, with the layer each value
+ * came from stored in its entry's tag, so a lookup is one probe whatever
+ * the number of layers. When a layer changes, the keys it added, changed
+ * or dropped are re-resolved against the layers and patched into a copy of
+ * the previous merge; the merge is only redone from scratch when the layer
+ * is large compared to the whole, or a key disappears from every layer.
+ * While only one layer is set, it is published as the merge, uncopied.
+ *
  * The implementation handles:
- * - Parsing of `key=value` files, ignoring comments and whitespace.
- * - Dynamic allocation and safe copying of keys and values.
- * - In-memory creation and modification of configuration pairs.
- * - A string hashing function (djb2) to map keys to table indices.
- * - Collision resolution using separate chaining (linked lists).
+ * - Layered sources, merged by priority, with the provenance of each key.
+ * - Parsing of `key=value` files, ignoring comments and whitespace. Files
+ *   are memory-mapped and parsed in a single pass, with no line length
+ *   limit and no allocation per entry. The parsed result is compiled into a
+ *   binary image next to the file, which later loads map and use directly
+ *   while the file is unchanged (see config_cache.h).
+ * - In-memory creation and modification of configuration pairs, stored in an
+ *   open-addressing table that keeps every key and value in one string arena
+ *   (see config_table.h).
+ * - Lock-free reads from published snapshots, with deferred reclamation.
+ * - Typed reads (integers, booleans, durations) served from the reading of
+ *   each value made when it was stored, and comma-separated lists split in
+ *   place.
+ * - Change notification: every publication is compared with the snapshot
+ *   it replaces, and subscribers are given the keys that differ.
+ * - Hot reloading of a watched file by a background thread, which parses
+ *   off the readers' path and publishes the result in a single swap.
  * - A thorough cleanup mechanism to prevent memory leaks.
+ * - Forwarding of logging keys (`log.level`, `log.level.<MODULE>`,
+ *   `log.rotate.*`, `log.rate_limit*`) to the logger as soon as they are
+ *   set, so level filtering, log rotation and rate limiting follow the
+ *   config.
  *
  * SPDX-License-Identifier: Apache-2.0 */
 
 #include "config_manager.h"
+#include "config_table.h"
+#include "config_cache.h"
+#include "config_value.h"
+#include "platform/platform.h" // For the writer mutex and the file watcher
 #include "libs/liblogger/Logger.hpp" // For logging parsing warnings
+#include "libs/liblogger/StartupTrace.hpp" // For timing the loads at startup
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifdef _MSC_VER
+#define CONFIG_THREAD_LOCAL __declspec(thread)
+#else
+#define CONFIG_THREAD_LOCAL _Thread_local
+#endif
 
 // --- Internal Data Structures ---
 
-#define HASH_TABLE_SIZE 128 // A prime number is often a good choice
+// Every key forwarded to the logger starts with this.
+#define LOG_KEY_PREFIX "log."
+// Keys that are forwarded to the logger's level filter.
+#define LOG_LEVEL_KEY "log.level"
+#define LOG_LEVEL_MODULE_PREFIX "log.level."
+// Keys that configure rotation of the text log file.
+#define LOG_ROTATE_PREFIX "log.rotate."
+// Keys that configure the per-call-site rate limit.
+#define LOG_RATE_LIMIT_KEY "log.rate_limit"
+#define LOG_RATE_LIMIT_BURST_KEY "log.rate_limit.burst"
+
+// Reader slots; more concurrent readers than this share a single counter.
+#define CONFIG_READER_SLOTS 128
+#define CONFIG_CACHE_LINE 64
+
+// Most change callbacks that can be registered at once.
+#define CONFIG_MAX_SUBSCRIBERS 32
+// A watched file must be quiet this long before it is reloaded, so that a
+// save made of several writes or renames is loaded once, complete.
+#define CONFIG_WATCH_SETTLE_MS 50
+
+// Layer files: `<system config dir>/ph/ph.conf` and `<home>/.ph.conf`.
+#define CONFIG_SYSTEM_SUBDIR "ph"
+#define CONFIG_SYSTEM_FILE "ph.conf"
+#define CONFIG_USER_FILE ".ph.conf"
+// The repository file loaded by config_load_layers by default.
+#define CONFIG_REPO_FILE ".ph.conf"
+// Environment variables mapped to keys start with this.
+#define CONFIG_ENV_PREFIX "PH_"
+// Longest path of a layer file built by config_load_layers.
+#define CONFIG_PATH_MAX 4096
+// Longest environment variable name mapped to a key.
+#define CONFIG_ENV_MAX_NAME 256
+
+/**
+ * @struct ConfigSnapshot
+ * @brief An immutable set of entries: a layer, or a published merge of the
+ * layers, whose entries are tagged with the layer they came from.
+ *
+ * While a single layer is set, the merge is that layer itself, shared
+ * rather than copied: `layer` points to it and `origin` tells which it is.
+ */
+typedef struct ConfigSnapshot {
+    ConfigTable table;
+    ConfigCache cache;                    // Used instead of `table` if `cached`.
+    int cached;
+    bool log_keys;                        // Whether `table` holds keys forwarded to the logger.
+    struct ConfigSnapshot* layer;         // Used instead of both if set.
+    uint8_t origin;                       // Layer of every entry of `layer`.
+    _Atomic unsigned references;          // One for its owner, one per merge sharing it.
+    uint64_t retired_epoch;               // Epoch in which it was replaced.
+    struct ConfigSnapshot* next_retired;  // Link in g_retired.
+} ConfigSnapshot;
+
+/**
+ * @struct ConfigUpdate
+ * @brief What a change to the layers did, for the work done after the
+ * writer lock is released.
+ */
+typedef struct {
+    const ConfigSnapshot* previous;   // The merge replaced.
+    const ConfigSnapshot* current;    // The merge published.
+    ConfigTable changes;              // Keys whose value may differ, if `diffed`.
+    ConfigTable log_changes;          // Logging keys whose value may differ.
+    bool diffed;
+} ConfigUpdate;
+
+/**
+ * @struct ConfigFileRead
+ * @brief A configuration file read into a layer, and the image to compile
+ * from it once the layer is published.
+ */
+typedef struct {
+    ConfigSnapshot* layer;    // NULL if the file does not exist.
+    char* image_path;         // Set if `layer` was parsed and images are enabled.
+    uint64_t size;            // The file's stamp when it was read.
+    int64_t mtime_ns;
+} ConfigFileRead;
+
+/**
+ * @struct ReaderSlot
+ * @brief The epoch a reader entered its read section in, or 0 if the slot
+ * is free. Padded so that readers never share a cache line.
+ */
+typedef struct {
+    _Alignas(CONFIG_CACHE_LINE) _Atomic uint64_t epoch;
+} ReaderSlot;
+
+/**
+ * @struct ConfigSubscriber
+ * @brief A callback registered with config_subscribe. Free if `callback` is NULL.
+ */
+typedef struct {
+    config_change_callback callback;
+    void* user_data;
+} ConfigSubscriber;
 
 /**
- * @struct ConfigNode
- * @brief A node in the hash table's linked list (for collision handling).
+ * @struct ConfigWatcher
+ * @brief The thread reloading a watched file, and what it last saw of it.
  */
-typedef struct ConfigNode {
-    char* key;
-    char* value;
-    struct ConfigNode* next;
-} ConfigNode;
+typedef struct {
+    char* filename;
+    ConfigLayer layer;        // Layer the file is reloaded into.
+    platform_file_watch* watch;
+    platform_thread_t thread;
+    _Atomic int stopping;
+    bool file_exists;
+    uint64_t size;
+    int64_t mtime_ns;
+} ConfigWatcher;
+
+// The current configuration. NULL is an empty configuration.
+static _Atomic(ConfigSnapshot*) g_snapshot = NULL;
+// Advanced every time a snapshot is retired. Starts at 1: 0 marks a free slot.
+static _Atomic uint64_t g_epoch = 1;
+// Bumped on every modification; see config_generation().
+static _Atomic uint64_t g_config_generation = 0;
+static ReaderSlot g_reader_slots[CONFIG_READER_SLOTS];
+// Readers that found no free slot. While any exist, nothing is reclaimed.
+static _Atomic unsigned g_unslotted_readers = 0;
+
+// Serializes writers. Also guards g_retired, g_layers and g_layer_files.
+static platform_mutex_t g_write_lock = PLATFORM_MUTEX_INIT;
+// The layers, lowest priority first. NULL is an empty layer.
+static ConfigSnapshot* g_layers[CONFIG_LAYER_COUNT];
+// The file each file layer was last loaded from.
+static char* g_layer_files[CONFIG_LAYER_COUNT];
+// Snapshots replaced but possibly still in use, newest first.
+static ConfigSnapshot* g_retired = NULL;
 
-// The global hash table. It's an array of pointers to ConfigNodes.
-// Declared `static` to be private to this file.
-static ConfigNode* g_config_table[HASH_TABLE_SIZE] = {NULL};
+// Nesting depth of the calling thread's read section.
+static CONFIG_THREAD_LOCAL unsigned t_read_depth = 0;
+// Slot held by the calling thread's read section, or -1 if it is unslotted.
+static CONFIG_THREAD_LOCAL int t_reader_slot = -1;
+// Slot the calling thread held last, tried first next time.
+static CONFIG_THREAD_LOCAL int t_preferred_slot = -1;
+
+// Guards g_subscribers, and is held while callbacks run.
+static platform_mutex_t g_subscriber_lock = PLATFORM_MUTEX_INIT;
+static ConfigSubscriber g_subscribers[CONFIG_MAX_SUBSCRIBERS];
+// Registered callbacks; changes are not diffed while there are none.
+static _Atomic unsigned g_subscriber_count = 0;
+// Set while the calling thread runs callbacks, and so holds g_subscriber_lock.
+static CONFIG_THREAD_LOCAL bool t_notifying = false;
+
+// Guards g_watcher.
+static platform_mutex_t g_watch_lock = PLATFORM_MUTEX_INIT;
+static ConfigWatcher* g_watcher = NULL;
 
 
 // --- Private Helper Functions ---
 
 /**
- * @brief The djb2 hash function for strings.
- *
- * A simple, fast, and effective hashing algorithm for strings.
- * See: http://www.cse.yorku.ca/~oz/hash.html
- *
- * @param str The string to hash.
- * @return The calculated hash value.
+ * @brief Trims leading and trailing whitespace from the span [*begin, *end).
  */
-static unsigned long hash_string(const char* str) {
-    unsigned long hash = 5381;
-    int c;
-    while ((c = *str++)) {
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
-    }
-    return hash;
+static void trim_span(const char** begin, const char** end) {
+    while (*begin < *end && isspace((unsigned char)**begin)) (*begin)++;
+    while (*end > *begin && isspace((unsigned char)(*end)[-1])) (*end)--;
 }
 
 /**
- * @brief Trims leading and trailing whitespace from a string in-place.
- * @param str The string to trim.
- * @return A pointer to the beginning of the trimmed string.
+ * @brief Counts the lines of a buffer, which bounds the entries it holds.
  */
-static char* trim_whitespace(char* str) {
-    if (!str) return NULL;
-    char* end;
+static size_t count_lines(const char* data, size_t size) {
+    size_t lines = 1;
+    const char* end = data + size;
+    for (const char* p = data; (p = memchr(p, '\n', (size_t)(end - p))) != NULL; ++p) {
+        lines++;
+    }
+    return lines;
+}
 
-    // Trim leading space
-    while (isspace((unsigned char)*str)) str++;
+/**
+ * @brief Parses a byte size such as "1048576", "512K", "10M" or "1GiB".
+ * @return 0 on success, -1 if the text is not a valid size.
+ */
+static int parse_byte_size(const char* text, uint64_t* bytes) {
+    char* end = NULL;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text) {
+        return -1;
+    }
+    int shift = 0;
+    switch (tolower((unsigned char)*end)) {
+        case '\0': break;
+        case 'k': shift = 10; end++; break;
+        case 'm': shift = 20; end++; break;
+        case 'g': shift = 30; end++; break;
+        default: return -1;
+    }
+    if (shift != 0) {
+        if (tolower((unsigned char)*end) == 'i') end++;
+        if (tolower((unsigned char)*end) == 'b') end++;
+    }
+    if (*end != '\0' || value > (UINT64_MAX >> shift)) {
+        return -1;
+    }
+    *bytes = (uint64_t)value << shift;
+    return 0;
+}
 
-    if (*str == 0) // All spaces?
-        return str;
+/**
+ * @brief Parses a duration such as "3600", "90s", "15m", "1h" or "1d".
+ * @return 0 on success, -1 if the text is not a valid duration.
+ */
+static int parse_seconds(const char* text, uint32_t* seconds) {
+    char* end = NULL;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text) {
+        return -1;
+    }
+    unsigned long long unit = 1;
+    switch (tolower((unsigned char)*end)) {
+        case '\0': break;
+        case 's': unit = 1; end++; break;
+        case 'm': unit = 60; end++; break;
+        case 'h': unit = 3600; end++; break;
+        case 'd': unit = 86400; end++; break;
+        default: return -1;
+    }
+    if (*end != '\0' || value > UINT32_MAX / unit) {
+        return -1;
+    }
+    *seconds = (uint32_t)(value * unit);
+    return 0;
+}
 
-    // Trim trailing space
-    end = str + strlen(str) - 1;
-    while (end > str && isspace((unsigned char)*end)) end--;
+/**
+ * @brief Applies a `log.rotate.*` key to the logger's rotation policy.
+ *
+ * Recognized keys are `max_size` (bytes, with optional K/M/G suffix),
+ * `interval` (seconds, with optional s/m/h/d suffix), `keep` (number of
+ * rotated files) and `compress` (`none`, `gzip` or `zstd`). A size or
+ * interval of 0 disables that trigger.
+ */
+static void apply_rotation_setting(const char* key, const char* value) {
+    phLoggerRotation rotation;
+    if (logger_get_rotation(&rotation) != 0) {
+        return;
+    }
 
-    // Write new null terminator
-    *(end + 1) = '\0';
+    const char* name = key + sizeof(LOG_ROTATE_PREFIX) - 1;
+    int valid = 1;
+    if (strcmp(name, "max_size") == 0) {
+        valid = parse_byte_size(value, &rotation.max_bytes) == 0;
+    } else if (strcmp(name, "interval") == 0) {
+        valid = parse_seconds(value, &rotation.interval_seconds) == 0;
+    } else if (strcmp(name, "keep") == 0) {
+        char* end = NULL;
+        unsigned long keep = strtoul(value, &end, 10);
+        valid = end != value && *end == '\0' && keep <= UINT32_MAX;
+        if (valid) rotation.keep = (uint32_t)keep;
+    } else if (strcmp(name, "compress") == 0) {
+        if (strcmp(value, "none") == 0) rotation.compression = LOGGER_COMPRESS_NONE;
+        else if (strcmp(value, "gzip") == 0) rotation.compression = LOGGER_COMPRESS_GZIP;
+        else if (strcmp(value, "zstd") == 0) rotation.compression = LOGGER_COMPRESS_ZSTD;
+        else valid = 0;
+    } else {
+        logger_log_fmt(LOG_LEVEL_WARN, "CONFIG", "Unknown log rotation key '%s'. Ignoring.", key);
+        return;
+    }
 
-    return str;
+    if (!valid) {
+        logger_log_fmt(LOG_LEVEL_WARN, "CONFIG", "Invalid value '%s' for key '%s'. Ignoring.", value, key);
+        return;
+    }
+    logger_set_rotation(&rotation);
 }
 
-// --- Public API Implementation ---
+/**
+ * @brief Applies `log.rate_limit` (records per second per call site, 0 to
+ * disable) or `log.rate_limit.burst` to the logger's rate limit.
+ */
+static void apply_rate_limit_setting(const char* key, const char* value) {
+    phLoggerRateLimit limit;
+    if (logger_get_rate_limit(&limit) != 0) {
+        return;
+    }
+
+    char* end = NULL;
+    unsigned long number = strtoul(value, &end, 10);
+    if (end == value || *end != '\0' || number > UINT32_MAX) {
+        logger_log_fmt(LOG_LEVEL_WARN, "CONFIG", "Invalid value '%s' for key '%s'. Ignoring.", value, key);
+        return;
+    }
+    if (strcmp(key, LOG_RATE_LIMIT_KEY) == 0) {
+        limit.per_second = (uint32_t)number;
+    } else {
+        limit.burst = (uint32_t)number;
+    }
+    logger_set_rate_limit(&limit);
+}
 
 /**
- * @see config_manager.h
+ * @brief Applies logging keys to the logger when they are set.
+ *
+ * `log.level` sets the global minimum level and `log.level.<MODULE>` sets a
+ * per-module override. Invalid level names are reported and leave the
+ * current level untouched. `log.rotate.*` keys update the rotation policy
+ * and `log.rate_limit*` keys the rate limit. Other keys are ignored.
+ *
+ * @param key The configuration key being set.
+ * @param value The new value.
  */
-void config_cleanup(void) {
-    for (int i = 0; i < HASH_TABLE_SIZE; ++i) {
-        ConfigNode* current = g_config_table[i];
-        while (current != NULL) {
-            ConfigNode* next = current->next;
-            free(current->key);
-            free(current->value);
-            free(current);
-            current = next;
+static void apply_logger_setting(const char* key, const char* value) {
+    if (strncmp(key, LOG_ROTATE_PREFIX, sizeof(LOG_ROTATE_PREFIX) - 1) == 0) {
+        apply_rotation_setting(key, value);
+        return;
+    }
+    if (strcmp(key, LOG_RATE_LIMIT_KEY) == 0 || strcmp(key, LOG_RATE_LIMIT_BURST_KEY) == 0) {
+        apply_rate_limit_setting(key, value);
+        return;
+    }
+    if (strncmp(key, LOG_LEVEL_KEY, sizeof(LOG_LEVEL_KEY) - 1) != 0) {
+        return;
+    }
+
+    phLogLevel level;
+    if (logger_parse_level(value, &level) != 0) {
+        logger_log_fmt(LOG_LEVEL_WARN, "CONFIG", "Invalid log level '%s' for key '%s'. Ignoring.", value, key);
+        return;
+    }
+
+    if (strcmp(key, LOG_LEVEL_KEY) == 0) {
+        logger_set_level(level);
+    } else if (strncmp(key, LOG_LEVEL_MODULE_PREFIX, sizeof(LOG_LEVEL_MODULE_PREFIX) - 1) == 0) {
+        const char* module_name = key + sizeof(LOG_LEVEL_MODULE_PREFIX) - 1;
+        if (logger_set_module_level(module_name, level) != 0) {
+            logger_log_fmt(LOG_LEVEL_WARN, "CONFIG", "Could not set log level for module '%s'.", module_name);
         }
-        g_config_table[i] = NULL;
     }
 }
 
 /**
- * @see config_manager.h
+ * @brief Restores the logger's default for a logging key that no layer
+ * sets anymore.
+ *
+ * `log.level` goes back to LOG_LEVEL_DEBUG, the logger's initial level, and
+ * `log.level.<MODULE>` drops the module's override. Rotation and rate limit
+ * keys go back to 0 (or `none`), as in a zeroed phLoggerRotation or
+ * phLoggerRateLimit.
  */
-phStatus config_load(const char* filename) {
-    // Ensure the previous configuration is cleared before loading a new one.
-    config_cleanup();
-
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        // It's not an error if the config file doesn't exist.
-        // The application will just use default values.
-        logger_log(LOG_LEVEL_INFO, "CONFIG", "Configuration file not found. Using defaults.");
-        return ph_SUCCESS;
+static void reset_logger_setting(const char* key) {
+    if (strncmp(key, LOG_ROTATE_PREFIX, sizeof(LOG_ROTATE_PREFIX) - 1) == 0) {
+        const char* name = key + sizeof(LOG_ROTATE_PREFIX) - 1;
+        apply_rotation_setting(key, strcmp(name, "compress") == 0 ? "none" : "0");
+    } else if (strcmp(key, LOG_RATE_LIMIT_KEY) == 0 || strcmp(key, LOG_RATE_LIMIT_BURST_KEY) == 0) {
+        apply_rate_limit_setting(key, "0");
+    } else if (strcmp(key, LOG_LEVEL_KEY) == 0) {
+        logger_set_level(LOG_LEVEL_DEBUG);
+    } else if (strncmp(key, LOG_LEVEL_MODULE_PREFIX, sizeof(LOG_LEVEL_MODULE_PREFIX) - 1) == 0) {
+        logger_clear_module_level(key + sizeof(LOG_LEVEL_MODULE_PREFIX) - 1);
+    }
+}
+
+/**
+ * @brief Tells whether a key is forwarded to the logger.
+ */
+static bool is_log_key(const char* key, size_t key_length) {
+    return key_length > sizeof(LOG_KEY_PREFIX) - 1 && memcmp(key, LOG_KEY_PREFIX, sizeof(LOG_KEY_PREFIX) - 1) == 0;
+}
+
+/**
+ * @brief Inserts parsed pairs into a table.
+ */
+static void flush_pairs(ConfigTable* table, const ConfigPair* pairs, size_t count) {
+    if (config_table_set_batch(table, pairs, count) != 0) {
+        logger_log(LOG_LEVEL_FATAL, "CONFIG", "Memory allocation failed for config key/value.");
     }
+}
 
-    char line[1024];
+/**
+ * @brief Parses a `key=value` buffer into a table in a single pass.
+ *
+ * Lines and separators are found with `memchr`, which the C library
+ * vectorizes, and keys and values are copied straight from the buffer into
+ * the table's arena, a batch of pairs at a time (see
+ * `config_table_set_batch`). The buffer need not be NUL-terminated.
+ *
+ * @return Whether any key parsed is forwarded to the logger.
+ */
+static bool parse_config(const char* data, size_t size, ConfigTable* table) {
+    ConfigPair pairs[CONFIG_TABLE_BATCH * 4];
+    size_t pending = 0;
+    bool log_keys = false;
+    const char* end = data + size;
+    const char* line = data;
     int line_number = 0;
-    while (fgets(line, sizeof(line), file)) {
+    while (line < end) {
+        const char* newline = memchr(line, '\n', (size_t)(end - line));
+        const char* begin = line;
+        const char* stop = newline ? newline : end;
+        line = newline ? newline + 1 : end;
         line_number++;
-        char* trimmed_line = trim_whitespace(line);
 
-        if (strlen(trimmed_line) == 0 || trimmed_line[0] == '#') {
+        trim_span(&begin, &stop);
+        if (begin == stop || *begin == '#') {
             continue; // Skip empty or commented lines
         }
 
-        char* separator = strchr(trimmed_line, '=');
+        const char* separator = memchr(begin, '=', (size_t)(stop - begin));
         if (!separator) {
             logger_log_fmt(LOG_LEVEL_WARN, "CONFIG", "Malformed line %d in config file. Skipping.", line_number);
             continue;
         }
 
-        *separator = '\0'; // Split the line into key and value
-        char* key = trim_whitespace(trimmed_line);
-        char* value = trim_whitespace(separator + 1);
-
-        if (strlen(key) == 0) {
+        const char* key = begin;
+        const char* key_end = separator;
+        const char* value = separator + 1;
+        const char* value_end = stop;
+        trim_span(&key, &key_end);
+        trim_span(&value, &value_end);
+        size_t key_length = (size_t)(key_end - key);
+        if (key_length == 0) {
             logger_log_fmt(LOG_LEVEL_WARN, "CONFIG", "Empty key on line %d in config file. Skipping.", line_number);
             continue;
         }
 
-        // Use the new set function to add the value, ensuring consistency.
-        config_set_value(key, value);
+        log_keys |= is_log_key(key, key_length);
+        pairs[pending].key = key;
+        pairs[pending].key_length = key_length;
+        pairs[pending].value = value;
+        pairs[pending].value_length = (size_t)(value_end - value);
+        if (++pending == sizeof(pairs) / sizeof(pairs[0])) {
+            flush_pairs(table, pairs, pending);
+            pending = 0;
+        }
     }
+    flush_pairs(table, pairs, pending);
+    return log_keys;
+}
 
-    fclose(file);
-    logger_log(LOG_LEVEL_INFO, "CONFIG", "Configuration loaded successfully.");
-    return ph_SUCCESS;
+
+// --- Snapshot Management ---
+
+/**
+ * @brief Allocates an empty snapshot, with one reference for its owner.
+ * @return The snapshot, or NULL on allocation failure.
+ */
+static ConfigSnapshot* snapshot_create(void) {
+    ConfigSnapshot* snapshot = (ConfigSnapshot*)calloc(1, sizeof(ConfigSnapshot));
+    if (snapshot) {
+        atomic_init(&snapshot->references, 1);
+    }
+    return snapshot;
 }
 
 /**
- * @see config_manager.h
+ * @brief Drops a reference to a snapshot, and frees it with the last one.
  */
-char* config_get_value(const char* key) {
-    if (!key) {
+static void snapshot_destroy(ConfigSnapshot* snapshot) {
+    if (snapshot && atomic_fetch_sub(&snapshot->references, 1) == 1) {
+        config_table_destroy(&snapshot->table);
+        if (snapshot->cached) {
+            config_cache_close(&snapshot->cache);
+        }
+        snapshot_destroy(snapshot->layer);
+        free(snapshot);
+    }
+}
+
+/**
+ * @brief Returns the snapshot holding the entries of `snapshot`: itself,
+ * or the layer it shares.
+ */
+static const ConfigSnapshot* snapshot_entries(const ConfigSnapshot* snapshot) {
+    return snapshot && snapshot->layer ? snapshot->layer : snapshot;
+}
+
+/**
+ * @brief Returns the number of keys in a snapshot, which may be NULL (empty).
+ */
+static size_t snapshot_count(const ConfigSnapshot* snapshot) {
+    snapshot = snapshot_entries(snapshot);
+    if (!snapshot) {
+        return 0;
+    }
+    return snapshot->cached ? snapshot->cache.header->count : snapshot->table.count;
+}
+
+/**
+ * @brief Frees the retired snapshots that no reader can still see.
+ *
+ * A reader that loaded a snapshot entered its read section before the
+ * snapshot was replaced, so its slot holds an epoch no later than the one
+ * the snapshot was retired in. Must be called with g_write_lock held.
+ */
+static void reclaim_snapshots(void) {
+    if (!g_retired || atomic_load(&g_unslotted_readers) != 0) {
+        return;
+    }
+    uint64_t oldest_reader = UINT64_MAX;
+    for (int i = 0; i < CONFIG_READER_SLOTS; ++i) {
+        uint64_t epoch = atomic_load(&g_reader_slots[i].epoch);
+        if (epoch != 0 && epoch < oldest_reader) {
+            oldest_reader = epoch;
+        }
+    }
+
+    ConfigSnapshot** link = &g_retired;
+    while (*link) {
+        ConfigSnapshot* snapshot = *link;
+        if (snapshot->retired_epoch < oldest_reader) {
+            *link = snapshot->next_retired;
+            snapshot_destroy(snapshot);
+        } else {
+            link = &snapshot->next_retired;
+        }
+    }
+}
+
+/**
+ * @brief Queues a snapshot for reclamation once no read section can still
+ * be using it. Layers go through this too: a writer that published a layer
+ * may still be compiling its image. Must be called with g_write_lock held.
+ */
+static void retire_snapshot(ConfigSnapshot* snapshot) {
+    snapshot->retired_epoch = atomic_fetch_add(&g_epoch, 1);
+    snapshot->next_retired = g_retired;
+    g_retired = snapshot;
+}
+
+/**
+ * @brief Makes `snapshot` the current configuration and retires the
+ * previous one. Must be called with g_write_lock held.
+ */
+static void publish_snapshot(ConfigSnapshot* snapshot) {
+    ConfigSnapshot* previous = atomic_exchange(&g_snapshot, snapshot);
+    // Bumped after the swap, so a reader that sees the new generation
+    // can no longer be handed the old snapshot.
+    atomic_fetch_add(&g_config_generation, 1);
+    if (previous) {
+        retire_snapshot(previous);
+    }
+    reclaim_snapshots();
+}
+
+/**
+ * @brief Looks a key up in a snapshot, which may be NULL (empty).
+ * @param[out] length Receives the value's length. May be NULL.
+ * @param[out] origin Receives the layer of the value, for a merge. May be NULL.
+ * @return The NUL-terminated value, or NULL if the key is not set.
+ */
+static const char* snapshot_find(const ConfigSnapshot* snapshot, const char* key, size_t key_length,
+                                 size_t* length, int* origin) {
+    if (!snapshot) {
+        return NULL;
+    }
+    if (snapshot->layer) {
+        const char* value = snapshot_find(snapshot->layer, key, key_length, length, NULL);
+        if (value && origin) {
+            *origin = snapshot->origin;
+        }
+        return value;
+    }
+    if (snapshot->cached) {
+        return config_cache_find(&snapshot->cache, key, key_length, length);
+    }
+    const ConfigEntry* entry = config_table_find(&snapshot->table, key, key_length);
+    if (!entry) {
         return NULL;
     }
+    if (length) {
+        *length = entry->value_length;
+    }
+    if (origin) {
+        *origin = entry->tag;
+    }
+    return config_table_value(&snapshot->table, entry);
+}
 
-    unsigned long hash = hash_string(key);
-    unsigned int index = hash % HASH_TABLE_SIZE;
+/**
+ * @brief Looks up the number a key's value stands for as one type, from the
+ * typed reading stored with it.
+ * @param type A CONFIG_VALUE_* bit.
+ * @return ph_SUCCESS with the number in `number`, ph_ERROR_NOT_FOUND if the
+ *         key is not set, or ph_ERROR_INVALID_ARGS if its value does not
+ *         read as `type`.
+ */
+static phStatus snapshot_find_number(const ConfigSnapshot* snapshot, const char* key, size_t key_length,
+                                     uint8_t type, int64_t* number) {
+    snapshot = snapshot_entries(snapshot);
+    if (!snapshot) {
+        return ph_ERROR_NOT_FOUND;
+    }
+    uint32_t types;
+    int64_t found;
+    if (snapshot->cached) {
+        const ConfigCacheSlot* slot = config_cache_lookup(&snapshot->cache, key, key_length);
+        if (!slot) {
+            return ph_ERROR_NOT_FOUND;
+        }
+        types = slot->types;
+        found = slot->number;
+    } else {
+        const ConfigEntry* entry = config_table_find(&snapshot->table, key, key_length);
+        if (!entry) {
+            return ph_ERROR_NOT_FOUND;
+        }
+        types = entry->types;
+        found = entry->number;
+    }
+    if (!(types & type)) {
+        return ph_ERROR_INVALID_ARGS;
+    }
+    *number = found;
+    return ph_SUCCESS;
+}
 
-    ConfigNode* current = g_config_table[index];
-    while (current != NULL) {
-        if (strcmp(current->key, key) == 0) {
-            // Return a copy that the caller is responsible for freeing.
-            // This is critical for memory safety with external modules.
-            return strdup(current->value);
+/**
+ * @brief Iterates over a snapshot's entries, from its table or its image.
+ * Start with `*cursor` at 0. The strings of `pair` are NUL-terminated.
+ * @return 0 with the next entry in `pair`, or -1 once there are no more.
+ */
+static int snapshot_next(const ConfigSnapshot* snapshot, size_t* cursor, ConfigPair* pair) {
+    snapshot = snapshot_entries(snapshot);
+    if (!snapshot) {
+        return -1;
+    }
+    if (snapshot->cached) {
+        const ConfigCache* cache = &snapshot->cache;
+        while (*cursor < cache->header->slot_count) {
+            if (config_cache_entry(cache, (uint32_t)(*cursor)++, pair) == 0) {
+                return 0;
+            }
         }
-        current = current->next;
+        return -1;
+    }
+    const ConfigEntry* entry = config_table_next(&snapshot->table, cursor);
+    if (!entry) {
+        return -1;
     }
+    pair->key = config_table_key(&snapshot->table, entry);
+    pair->key_length = entry->key_length;
+    pair->value = config_table_value(&snapshot->table, entry);
+    pair->value_length = entry->value_length;
+    return 0;
+}
 
-    return NULL; // Key not found
+/**
+ * @brief Looks a key up in the current snapshot. Must be called inside a
+ * read section, which keeps the result valid.
+ * @param[out] length Receives the value's length. May be NULL.
+ * @return The NUL-terminated value, or NULL if the key is not set.
+ */
+static const char* find_current(const char* key, size_t* length) {
+    return snapshot_find(atomic_load(&g_snapshot), key, strlen(key), length, NULL);
 }
 
 /**
- * @see config_manager.h
+ * @brief Looks up the number a key's value stands for as one type, in the
+ * current snapshot (see snapshot_find_number).
  */
-phStatus config_set_value(const char* key, const char* value) {
-    if (!key || !value) {
+static phStatus find_current_number(const char* key, uint8_t type, int64_t* number) {
+    if (!key || !number) {
         return ph_ERROR_INVALID_ARGS;
     }
+    config_read_begin();
+    phStatus status = snapshot_find_number(atomic_load(&g_snapshot), key, strlen(key), type, number);
+    config_read_end();
+    return status;
+}
+
+// --- Change Notification ---
+
+/**
+ * @brief Calls every subscriber with a list of changed keys, unless the
+ * calling thread is itself running a callback.
+ */
+static void notify_subscribers(const char* const* keys, size_t count) {
+    if (t_notifying) {
+        return;
+    }
+    platform_mutex_lock(&g_subscriber_lock);
+    t_notifying = true;
+    // Callbacks may unsubscribe, which frees their entry but moves no other.
+    for (int i = 0; i < CONFIG_MAX_SUBSCRIBERS; ++i) {
+        if (g_subscribers[i].callback) {
+            g_subscribers[i].callback(keys, count, g_subscribers[i].user_data);
+        }
+    }
+    t_notifying = false;
+    platform_mutex_unlock(&g_subscriber_lock);
+}
+
+/**
+ * @brief Appends a key to a growing list.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int append_key(const char*** keys, size_t* count, size_t* capacity, const char* key) {
+    if (*count == *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 16;
+        const char** grown = (const char**)realloc((void*)*keys, new_capacity * sizeof(const char*));
+        if (!grown) {
+            return -1;
+        }
+        *keys = grown;
+        *capacity = new_capacity;
+    }
+    (*keys)[(*count)++] = key;
+    return 0;
+}
 
-    unsigned long hash = hash_string(key);
-    unsigned int index = hash % HASH_TABLE_SIZE;
+/**
+ * @brief Tells whether two snapshots hold different values for a key.
+ */
+static bool value_differs(const ConfigSnapshot* a, const ConfigSnapshot* b, const char* key, size_t key_length) {
+    size_t a_length = 0;
+    size_t b_length = 0;
+    const char* a_value = snapshot_find(a, key, key_length, &a_length, NULL);
+    const char* b_value = snapshot_find(b, key, key_length, &b_length, NULL);
+    if (!a_value || !b_value) {
+        return a_value != b_value;
+    }
+    return a_length != b_length || memcmp(a_value, b_value, a_length) != 0;
+}
 
-    // First, check if the key already exists to update it.
-    ConfigNode* current = g_config_table[index];
-    while (current != NULL) {
-        if (strcmp(current->key, key) == 0) {
-            // Key found, update the value.
-            char* new_value = strdup(value);
-            if (!new_value) {
-                logger_log(LOG_LEVEL_FATAL, "CONFIG", "Memory allocation failed for config value update.");
-                return ph_ERROR_GENERAL;
+/**
+ * @brief Adds to a set the keys of `from` that `other` lacks or holds with
+ * another value: the keys a layer changed, once called each way.
+ *
+ * @param set A table used as a set: only its keys matter.
+ * @param log_only Only consider keys forwarded to the logger. Images list
+ *                 theirs and tables know if they have any, so this rarely
+ *                 costs a pass over the layer.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int collect_changed_keys(ConfigTable* set, const ConfigSnapshot* from, const ConfigSnapshot* other,
+                                bool log_only) {
+    if (!from) {
+        return 0;
+    }
+    ConfigPair pair;
+    if (log_only && from->cached) {
+        const ConfigCache* cache = &from->cache;
+        for (uint32_t i = 0; i < cache->header->log_count; ++i) {
+            if (config_cache_entry(cache, cache->log_slots[i], &pair) == 0 &&
+                value_differs(from, other, pair.key, pair.key_length) &&
+                config_table_set(set, pair.key, pair.key_length, "", 0) != 0) {
+                return -1;
             }
-            free(current->value); // Free the old value
-            current->value = new_value; // Assign the new one
-            return ph_SUCCESS;
         }
-        current = current->next;
+        return 0;
+    }
+    if (log_only && !from->log_keys) {
+        return 0;
+    }
+    size_t cursor = 0;
+    while (snapshot_next(from, &cursor, &pair) == 0) {
+        if ((!log_only || is_log_key(pair.key, pair.key_length)) &&
+            value_differs(from, other, pair.key, pair.key_length) &&
+            config_table_set(set, pair.key, pair.key_length, "", 0) != 0) {
+            return -1;
+        }
     }
+    return 0;
+}
 
-    // If we reach here, the key does not exist. Create a new node.
-    ConfigNode* new_node = (ConfigNode*)malloc(sizeof(ConfigNode));
-    if (!new_node) {
-        logger_log(LOG_LEVEL_FATAL, "CONFIG", "Memory allocation failed for new config node.");
-        return ph_ERROR_GENERAL;
+/**
+ * @brief Tells the subscribers which keys of an update changed value in
+ * the merge: a layer's change is hidden if a higher layer sets the key.
+ *
+ * The calling thread must be inside a read section that keeps both merges
+ * of the update alive.
+ */
+static void notify_changes(const ConfigUpdate* update) {
+    if (!update->diffed || atomic_load(&g_subscriber_count) == 0 || t_notifying) {
+        return;
+    }
+    const char** keys = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    size_t cursor = 0;
+    const ConfigEntry* entry;
+    while ((entry = config_table_next(&update->changes, &cursor)) != NULL) {
+        const char* key = config_table_key(&update->changes, entry);
+        if (value_differs(update->previous, update->current, key, entry->key_length) &&
+            append_key(&keys, &count, &capacity, key) != 0) {
+            logger_log(LOG_LEVEL_ERROR, "CONFIG", "Memory allocation failed while listing changed keys.");
+            free((void*)keys);
+            return;
+        }
+    }
+    if (count > 0) {
+        notify_subscribers(keys, count);
     }
+    free((void*)keys);
+}
 
-    new_node->key = strdup(key);
-    new_node->value = strdup(value);
+// --- Layer Merging ---
 
-    // Check for allocation failures during strdup and clean up if necessary
-    if (!new_node->key || !new_node->value) {
-        logger_log(LOG_LEVEL_FATAL, "CONFIG", "Memory allocation failed for new config key/value.");
-        free(new_node->key);   // free() on NULL is safe
-        free(new_node->value); // free() on NULL is safe
-        free(new_node);
-        return ph_ERROR_GENERAL;
+/**
+ * @brief Finds the value of a key in the highest layer that sets it. Must
+ * be called with g_write_lock held.
+ * @return The layer, or -1 if no layer sets the key.
+ */
+static int resolve_key(const char* key, size_t key_length, const char** value, size_t* value_length) {
+    for (int layer = CONFIG_LAYER_COUNT - 1; layer >= 0; --layer) {
+        *value = snapshot_find(g_layers[layer], key, key_length, value_length, NULL);
+        if (*value) {
+            return layer;
+        }
     }
+    return -1;
+}
 
-    // Prepend the new node to the list at the calculated index.
-    new_node->next = g_config_table[index];
-    g_config_table[index] = new_node;
+/**
+ * @brief Merges every layer into an empty table, lowest first, so that
+ * higher layers overwrite. Must be called with g_write_lock held.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int merge_layers(ConfigTable* table) {
+    // An upper bound: a key set by several layers is counted in each.
+    size_t count = 0;
+    size_t bytes = 0;
+    for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+        const ConfigSnapshot* source = g_layers[layer];
+        if (source) {
+            count += snapshot_count(source);
+            bytes += source->cached ? (size_t)source->cache.header->arena_size
+                                    : source->table.arena_size - source->table.arena_garbage;
+        }
+    }
+    config_table_reserve(table, count, bytes);
 
-    return ph_SUCCESS;
-}
\ No newline at end of file
+    for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+        const ConfigSnapshot* source = g_layers[layer];
+        if (!source) {
+            continue;
+        }
+        if (!source->cached) {
+            if (config_table_merge(table, &source->table, (uint8_t)layer) != 0) {
+                return -1;
+            }
+            continue;
+        }
+        size_t cursor = 0;
+        ConfigPair pair;
+        while (snapshot_next(source, &cursor, &pair) == 0) {
+            if (config_table_set_tagged(table, pair.key, pair.key_length, pair.value, pair.value_length,
+                                        (uint8_t)layer) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Patches a copy of the previous merge with the current value of
+ * every key in `changes`. Must be called with g_write_lock held.
+ * @return 0 on success, 1 if a key is no longer set by any layer (tables
+ *         cannot remove keys, so the merge must be redone), -1 on
+ *         allocation failure.
+ */
+static int patch_merge(ConfigTable* table, const ConfigTable* previous, const ConfigTable* changes) {
+    if (config_table_clone(table, previous) != 0) {
+        return -1;
+    }
+    size_t cursor = 0;
+    const ConfigEntry* entry;
+    while ((entry = config_table_next(changes, &cursor)) != NULL) {
+        const char* key = config_table_key(changes, entry);
+        const char* value = NULL;
+        size_t value_length = 0;
+        int layer = resolve_key(key, entry->key_length, &value, &value_length);
+        if (layer < 0) {
+            return 1;
+        }
+        // A change hidden by a higher layer leaves the merge as it was.
+        const ConfigEntry* merged = config_table_find(table, key, entry->key_length);
+        if (merged && merged->tag == layer && merged->value_length == value_length &&
+            memcmp(config_table_value(table, merged), value, value_length) == 0) {
+            continue;
+        }
+        if (config_table_set_tagged(table, key, entry->key_length, value, value_length, (uint8_t)layer) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Builds the merge of the current layers. Must be called with
+ * g_write_lock held.
+ *
+ * @param previous The current merge.
+ * @param changes The keys that may differ from `previous`, to patch a copy
+ *                of it, or NULL to merge from scratch.
+ * @return The merge, or NULL on allocation failure.
+ */
+static ConfigSnapshot* build_merge(const ConfigSnapshot* previous, const ConfigTable* changes) {
+    ConfigSnapshot* merged = snapshot_create();
+    if (!merged) {
+        return NULL;
+    }
+
+    // A lone layer is published as it is: nothing is copied, and a layer
+    // read from an image keeps its lookups on the perfect hash.
+    int only = -1;
+    int filled = 0;
+    for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+        if (snapshot_count(g_layers[layer]) > 0) {
+            only = layer;
+            filled++;
+        }
+    }
+    if (filled == 1) {
+        merged->layer = g_layers[only];
+        atomic_fetch_add(&merged->layer->references, 1);
+        merged->origin = (uint8_t)only;
+        return merged;
+    }
+
+    int result = 1;
+    if (changes && previous && !previous->layer && !previous->cached) {
+        result = patch_merge(&merged->table, &previous->table, changes);
+        if (result != 0) {
+            config_table_destroy(&merged->table);
+        }
+    }
+    if (result != 0 && merge_layers(&merged->table) != 0) {
+        snapshot_destroy(merged);
+        return NULL;
+    }
+    return merged;
+}
+
+/**
+ * @brief Replaces some layers and publishes the new merge.
+ *
+ * Must be called with g_write_lock held, inside a read section that lasts
+ * until `finish_update`: it keeps the snapshots of `update` alive.
+ *
+ * @param layers The new layers, indexed by layer. Those in `mask` now
+ *               belong to the configuration, even on failure.
+ * @param mask The layers replaced, one bit per layer.
+ * @param[out] update What changed, for `finish_update`.
+ * @return 0 on success, -1 on allocation failure (the configuration is
+ *         then unchanged).
+ */
+static int update_layers(ConfigSnapshot* const* layers, unsigned mask, ConfigUpdate* update) {
+    memset(update, 0, sizeof(*update));
+    ConfigSnapshot* previous = atomic_load_explicit(&g_snapshot, memory_order_relaxed);
+    update->previous = previous;
+
+    // Listing the keys a layer changed costs a lookup per key of its old
+    // and new versions. That is needed to notify subscribers, and worth it
+    // to patch the previous merge when the layers are small compared to it.
+    size_t touched = 0;
+    for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+        if (mask & (1u << layer)) {
+            touched += snapshot_count(g_layers[layer]) + snapshot_count(layers[layer]);
+        }
+    }
+    bool patch = previous && !previous->layer && !previous->cached && touched * 4 <= snapshot_count(previous);
+    update->diffed = patch || atomic_load(&g_subscriber_count) != 0;
+
+    int failed = 0;
+    for (int layer = 0; layer < CONFIG_LAYER_COUNT && !failed; ++layer) {
+        if (!(mask & (1u << layer))) {
+            continue;
+        }
+        if (update->diffed) {
+            failed |= collect_changed_keys(&update->changes, layers[layer], g_layers[layer], false);
+            failed |= collect_changed_keys(&update->changes, g_layers[layer], layers[layer], false);
+        }
+        failed |= collect_changed_keys(&update->log_changes, layers[layer], g_layers[layer], true);
+        failed |= collect_changed_keys(&update->log_changes, g_layers[layer], layers[layer], true);
+    }
+    if (failed) {
+        // Still publish a complete merge; only the reporting is lost.
+        logger_log(LOG_LEVEL_ERROR, "CONFIG", "Memory allocation failed while listing changed keys.");
+        config_table_destroy(&update->changes);
+        config_table_destroy(&update->log_changes);
+        update->diffed = false;
+        patch = false;
+    }
+
+    ConfigSnapshot* replaced[CONFIG_LAYER_COUNT] = {NULL};
+    for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+        if (mask & (1u << layer)) {
+            replaced[layer] = g_layers[layer];
+            g_layers[layer] = layers[layer];
+        }
+    }
+    ConfigSnapshot* merged = build_merge(previous, patch ? &update->changes : NULL);
+    if (!merged) {
+        for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+            if (mask & (1u << layer)) {
+                g_layers[layer] = replaced[layer];
+                snapshot_destroy(layers[layer]);
+            }
+        }
+        config_table_destroy(&update->changes);
+        config_table_destroy(&update->log_changes);
+        update->diffed = false;
+        return -1;
+    }
+    for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+        if (replaced[layer]) {
+            retire_snapshot(replaced[layer]);
+        }
+    }
+    publish_snapshot(merged);
+    update->current = merged;
+    return 0;
+}
+
+/**
+ * @brief Completes an update once g_write_lock is released: forwards the
+ * logging keys that changed to the logger, resetting those removed from
+ * every layer, then notifies subscribers.
+ */
+static void finish_update(ConfigUpdate* update) {
+    size_t cursor = 0;
+    const ConfigEntry* entry;
+    while ((entry = config_table_next(&update->log_changes, &cursor)) != NULL) {
+        const char* key = config_table_key(&update->log_changes, entry);
+        const char* value = snapshot_find(update->current, key, entry->key_length, NULL, NULL);
+        if (value) {
+            apply_logger_setting(key, value);
+        } else {
+            reset_logger_setting(key);
+        }
+    }
+    notify_changes(update);
+    config_table_destroy(&update->changes);
+    config_table_destroy(&update->log_changes);
+}
+
+/**
+ * @brief Replaces some layers, publishes the new merge and reports what
+ * changed. Takes ownership of the layers in `mask`.
+ */
+static phStatus replace_layers(ConfigSnapshot* const* layers, unsigned mask) {
+    ConfigUpdate update;
+    config_read_begin();
+    platform_mutex_lock(&g_write_lock);
+    int result = update_layers(layers, mask, &update);
+    platform_mutex_unlock(&g_write_lock);
+    if (result == 0) {
+        finish_update(&update);
+    }
+    config_read_end();
+    if (result != 0) {
+        logger_log(LOG_LEVEL_FATAL, "CONFIG", "Memory allocation failed while merging the configuration.");
+        return ph_ERROR_GENERAL;
+    }
+    return ph_SUCCESS;
+}
+
+// --- Layer Sources ---
+
+/**
+ * @brief Returns the path of a configuration file's image, or NULL if
+ * images are disabled or memory runs out. The caller frees it.
+ */
+static char* cache_path_for(const char* filename) {
+    if (!config_cache_enabled()) {
+        return NULL;
+    }
+    size_t length = strlen(filename) + sizeof(CONFIG_CACHE_SUFFIX);
+    char* path = (char*)malloc(length);
+    if (path) {
+        snprintf(path, length, "%s%s", filename, CONFIG_CACHE_SUFFIX);
+    }
+    return path;
+}
+
+/**
+ * @brief Reads a configuration file into a new layer: its compiled image
+ * if one matches the file, otherwise its parsed text.
+ * @return ph_SUCCESS, also if the file does not exist (`read->layer` is
+ *         then NULL), or ph_ERROR_GENERAL on allocation failure.
+ */
+static phStatus read_config_file(const char* filename, ConfigFileRead* read) {
+    memset(read, 0, sizeof(*read));
+    platform_mapped_file file;
+    if (!platform_file_stamp(filename, &read->size, &read->mtime_ns) || !platform_map_file(filename, &file)) {
+        // It's not an error if a config file doesn't exist; its layer is
+        // simply empty.
+        logger_log_fmt(LOG_LEVEL_INFO, "CONFIG", "Configuration file '%s' not found.", filename);
+        return ph_SUCCESS;
+    }
+
+    ConfigSnapshot* layer = snapshot_create();
+    if (!layer) {
+        platform_unmap_file(&file);
+        logger_log(LOG_LEVEL_FATAL, "CONFIG", "Memory allocation failed while loading the configuration.");
+        return ph_ERROR_GENERAL;
+    }
+
+    // An image compiled from this very version of the file replaces parsing.
+    char* image_path = cache_path_for(filename);
+    if (image_path && config_cache_open(&layer->cache, image_path, read->size, read->mtime_ns) == 0) {
+        layer->cached = 1;
+        platform_unmap_file(&file);
+        free(image_path);
+        read->layer = layer;
+        logger_log_fmt(LOG_LEVEL_INFO, "CONFIG", "Configuration file '%s' loaded from its compiled image.", filename);
+        return ph_SUCCESS;
+    }
+
+    if (file.size > 0) {
+        // Size the table once. Each line stores at most its key and value
+        // plus two terminators, which take the place of its '=' and newline,
+        // so the arena never needs more than the file (and one byte for a
+        // last line without a newline). This is only an optimization: if it
+        // fails, the table grows as usual.
+        config_table_reserve(&layer->table, count_lines(file.data, file.size), file.size + 1);
+        layer->log_keys = parse_config(file.data, file.size, &layer->table);
+    }
+    platform_unmap_file(&file);
+    read->layer = layer;
+    read->image_path = image_path;
+    logger_log_fmt(LOG_LEVEL_INFO, "CONFIG", "Configuration file '%s' loaded successfully.", filename);
+    return ph_SUCCESS;
+}
+
+/**
+ * @brief Compiles the image of a parsed file once its layer is published,
+ * and frees what the read still holds.
+ *
+ * Layers are never modified, so the table can be compiled after
+ * publication; the caller's read section, entered before it, keeps the
+ * layer alive meanwhile.
+ */
+static void finish_config_file(ConfigFileRead* read, bool published) {
+    if (published && read->image_path) {
+        // The stamp was taken before the file was read: if it changed
+        // meanwhile, the image is stale from the start and simply rebuilt.
+        if (config_cache_write(&read->layer->table, read->image_path, LOG_KEY_PREFIX, read->size,
+                               read->mtime_ns) != 0) {
+            logger_log(LOG_LEVEL_DEBUG, "CONFIG", "Could not write the compiled configuration image.");
+        }
+    }
+    free(read->image_path);
+    read->image_path = NULL;
+}
+
+/**
+ * @brief Reads the `PH_*` environment variables into a new layer.
+ *
+ * The rest of the name is lowercased, `_` becomes `.` and `__` becomes `_`:
+ * `PH_LOG_LEVEL` sets `log.level` and `PH_LOG_RATE__LIMIT` sets
+ * `log.rate_limit`.
+ *
+ * @return The layer, or NULL on allocation failure.
+ */
+static ConfigSnapshot* read_environment(void) {
+    ConfigSnapshot* layer = snapshot_create();
+    if (!layer) {
+        return NULL;
+    }
+    char key[CONFIG_ENV_MAX_NAME];
+    for (char** variable = platform_get_environment(); variable && *variable; ++variable) {
+        const char* name = *variable;
+        const char* separator = strchr(name, '=');
+        if (!separator || strncmp(name, CONFIG_ENV_PREFIX, sizeof(CONFIG_ENV_PREFIX) - 1) != 0) {
+            continue;
+        }
+        const char* p = name + sizeof(CONFIG_ENV_PREFIX) - 1;
+        size_t key_length = 0;
+        for (; p < separator && key_length < sizeof(key); ++p) {
+            if (*p == '_' && p + 1 < separator && p[1] == '_') {
+                key[key_length++] = '_';
+                ++p;
+            } else if (*p == '_') {
+                key[key_length++] = '.';
+            } else {
+                key[key_length++] = (char)tolower((unsigned char)*p);
+            }
+        }
+        if (p < separator) {
+            logger_log(LOG_LEVEL_WARN, "CONFIG", "Environment variable name too long for a configuration key. Skipping.");
+            continue;
+        }
+        if (key_length == 0) {
+            continue;
+        }
+        if (config_table_set(&layer->table, key, key_length, separator + 1, strlen(separator + 1)) != 0) {
+            snapshot_destroy(layer);
+            return NULL;
+        }
+        layer->log_keys |= is_log_key(key, key_length);
+    }
+    return layer;
+}
+
+/**
+ * @brief Reads files into their layers, and the environment if asked,
+ * then publishes a single merge of the result.
+ *
+ * @param filenames The file of each layer, indexed by layer; NULL leaves
+ *                  the layer as it is.
+ */
+static phStatus load_layers(const char* const* filenames, bool environment) {
+    ConfigFileRead reads[CONFIG_LAYER_COUNT];
+    ConfigSnapshot* layers[CONFIG_LAYER_COUNT] = {NULL};
+    unsigned mask = 0;
+    phStatus status = ph_SUCCESS;
+    memset(reads, 0, sizeof(reads));
+    uint64_t trace = startup_trace_begin();
+
+    for (int layer = 0; layer < CONFIG_LAYER_COUNT && status == ph_SUCCESS; ++layer) {
+        if (filenames[layer]) {
+            uint64_t file_trace = startup_trace_begin();
+            status = read_config_file(filenames[layer], &reads[layer]);
+            startup_trace_end("config", filenames[layer], file_trace);
+            layers[layer] = reads[layer].layer;
+            mask |= 1u << layer;
+        }
+    }
+    if (status == ph_SUCCESS && environment) {
+        layers[CONFIG_LAYER_ENV] = read_environment();
+        mask |= 1u << CONFIG_LAYER_ENV;
+        if (!layers[CONFIG_LAYER_ENV]) {
+            logger_log(LOG_LEVEL_FATAL, "CONFIG", "Memory allocation failed while reading the environment.");
+            status = ph_ERROR_GENERAL;
+        }
+    }
+    if (status != ph_SUCCESS) {
+        for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+            snapshot_destroy(layers[layer]);
+            finish_config_file(&reads[layer], false);
+        }
+        startup_trace_end("config", "config_load", trace);
+        return status;
+    }
+
+    config_read_begin();
+    status = replace_layers(layers, mask);
+    for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+        finish_config_file(&reads[layer], status == ph_SUCCESS);
+    }
+    config_read_end();
+
+    if (status == ph_SUCCESS) {
+        platform_mutex_lock(&g_write_lock);
+        for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+            if (filenames[layer]) {
+                free(g_layer_files[layer]);
+                g_layer_files[layer] = strdup(filenames[layer]);
+            }
+        }
+        platform_mutex_unlock(&g_write_lock);
+    }
+    startup_trace_end("config", "config_load", trace);
+    return status;
+}
+
+// --- File Watching ---
+
+/**
+ * @brief Reloads the watched file if its stamp differs from the last one seen.
+ */
+static void reload_if_changed(ConfigWatcher* watcher) {
+    uint64_t size = 0;
+    int64_t mtime_ns = 0;
+    bool exists = platform_file_stamp(watcher->filename, &size, &mtime_ns);
+    if (exists == watcher->file_exists && (!exists || (size == watcher->size && mtime_ns == watcher->mtime_ns))) {
+        return;
+    }
+    watcher->file_exists = exists;
+    watcher->size = size;
+    watcher->mtime_ns = mtime_ns;
+    logger_log_fmt(LOG_LEVEL_INFO, "CONFIG", "Configuration file '%s' changed. Reloading.", watcher->filename);
+    config_load_layer(watcher->layer, watcher->filename);
+}
+
+/**
+ * @brief The watcher thread: waits for changes to the file and reloads it.
+ */
+static void watcher_main(void* arg) {
+    ConfigWatcher* watcher = (ConfigWatcher*)arg;
+    for (;;) {
+        int ready = platform_watch_wait(watcher->watch, -1);
+        if (atomic_load(&watcher->stopping)) {
+            break;
+        }
+        if (ready < 0) {
+            logger_log_fmt(LOG_LEVEL_WARN, "CONFIG", "Stopped watching '%s': the watch failed.", watcher->filename);
+            break;
+        }
+        if (ready == 0) {
+            continue;
+        }
+        // Let the save finish: wait until the file has been quiet a moment.
+        while (platform_watch_wait(watcher->watch, CONFIG_WATCH_SETTLE_MS) > 0) {
+        }
+        if (atomic_load(&watcher->stopping)) {
+            break;
+        }
+        reload_if_changed(watcher);
+    }
+}
+
+/**
+ * @brief Stops and frees the current watcher, if any. Must be called with
+ * g_watch_lock held.
+ */
+static void stop_watcher(void) {
+    ConfigWatcher* watcher = g_watcher;
+    if (!watcher) {
+        return;
+    }
+    g_watcher = NULL;
+    atomic_store(&watcher->stopping, 1);
+    platform_watch_interrupt(watcher->watch);
+    platform_thread_join(watcher->thread);
+    platform_watch_close(watcher->watch);
+    free(watcher->filename);
+    free(watcher);
+}
+
+// --- Public API Implementation ---
+
+/**
+ * @see config_manager.h
+ */
+void config_read_begin(void) {
+    if (t_read_depth++ != 0) {
+        return;
+    }
+
+    // The epoch is read before the slot is claimed, so it can only be older
+    // than the current one, which keeps more snapshots alive, never fewer.
+    uint64_t epoch = atomic_load(&g_epoch);
+    int start = t_preferred_slot;
+    if (start < 0) {
+        // Spread threads over the slots by the address of their TLS block.
+        start = (int)((((uintptr_t)&t_read_depth) >> 6) * 2654435761u % CONFIG_READER_SLOTS);
+    }
+    for (int i = 0; i < CONFIG_READER_SLOTS; ++i) {
+        int index = (start + i) % CONFIG_READER_SLOTS;
+        uint64_t expected = 0;
+        if (atomic_load_explicit(&g_reader_slots[index].epoch, memory_order_relaxed) == 0 &&
+            atomic_compare_exchange_strong(&g_reader_slots[index].epoch, &expected, epoch)) {
+            t_reader_slot = index;
+            t_preferred_slot = index;
+            return;
+        }
+    }
+    atomic_fetch_add(&g_unslotted_readers, 1);
+    t_reader_slot = -1;
+}
+
+/**
+ * @see config_manager.h
+ */
+void config_read_end(void) {
+    if (t_read_depth == 0 || --t_read_depth != 0) {
+        return;
+    }
+    if (t_reader_slot >= 0) {
+        atomic_store_explicit(&g_reader_slots[t_reader_slot].epoch, 0, memory_order_release);
+    } else {
+        atomic_fetch_sub_explicit(&g_unslotted_readers, 1, memory_order_release);
+    }
+}
+
+/**
+ * @see config_manager.h
+ */
+void config_cleanup(void) {
+    config_watch_stop();
+    platform_mutex_lock(&g_write_lock);
+    for (int layer = 0; layer < CONFIG_LAYER_COUNT; ++layer) {
+        if (g_layers[layer]) {
+            retire_snapshot(g_layers[layer]);
+            g_layers[layer] = NULL;
+        }
+        free(g_layer_files[layer]);
+        g_layer_files[layer] = NULL;
+    }
+    publish_snapshot(NULL);
+    platform_mutex_unlock(&g_write_lock);
+}
+
+/**
+ * @see config_manager.h
+ */
+phStatus config_load(const char* filename) {
+    return config_load_layer(CONFIG_LAYER_REPO, filename);
+}
+
+/**
+ * @see config_manager.h
+ */
+phStatus config_load_layer(ConfigLayer layer, const char* filename) {
+    if (!filename || (unsigned)layer > CONFIG_LAYER_REPO) {
+        return ph_ERROR_INVALID_ARGS;
+    }
+    const char* filenames[CONFIG_LAYER_COUNT] = {NULL};
+    filenames[layer] = filename;
+    return load_layers(filenames, false);
+}
+
+/**
+ * @see config_manager.h
+ */
+phStatus config_load_layers(const char* repo_file) {
+    char system_file[CONFIG_PATH_MAX];
+    char user_file[CONFIG_PATH_MAX];
+    char directory[CONFIG_PATH_MAX];
+    const char* filenames[CONFIG_LAYER_COUNT] = {NULL};
+
+    if (platform_get_system_config_dir(directory, sizeof(directory)) &&
+        snprintf(system_file, sizeof(system_file), "%s%c%s%c%s", directory, PATH_SEPARATOR,
+                 CONFIG_SYSTEM_SUBDIR, PATH_SEPARATOR, CONFIG_SYSTEM_FILE) < (int)sizeof(system_file)) {
+        filenames[CONFIG_LAYER_SYSTEM] = system_file;
+    }
+    if (platform_get_home_dir(directory, sizeof(directory)) &&
+        snprintf(user_file, sizeof(user_file), "%s%c%s", directory, PATH_SEPARATOR, CONFIG_USER_FILE) <
+            (int)sizeof(user_file)) {
+        filenames[CONFIG_LAYER_USER] = user_file;
+    }
+    filenames[CONFIG_LAYER_REPO] = repo_file ? repo_file : CONFIG_REPO_FILE;
+    return load_layers(filenames, true);
+}
+
+/**
+ * @see config_manager.h
+ */
+phStatus config_load_environment(void) {
+    const char* filenames[CONFIG_LAYER_COUNT] = {NULL};
+    return load_layers(filenames, true);
+}
+
+/**
+ * @see config_manager.h
+ */
+char* config_get_value(const char* key) {
+    if (!key) {
+        return NULL;
+    }
+
+    char* copy = NULL;
+    config_read_begin();
+    const char* value = find_current(key, NULL);
+    if (value) {
+        // Return a copy that the caller is responsible for freeing.
+        // This is critical for memory safety with external modules.
+        copy = strdup(value);
+    }
+    config_read_end();
+    return copy;
+}
+
+/**
+ * @see config_manager.h
+ */
+const char* config_get_view(const char* key, size_t* length) {
+    if (!key) {
+        return NULL;
+    }
+
+    config_read_begin();
+    const char* value = find_current(key, length);
+    // The caller's own read section, if any, keeps the value alive.
+    config_read_end();
+    return value;
+}
+
+/**
+ * @see config_manager.h
+ */
+phStatus config_get_int(const char* key, int64_t* value) {
+    return find_current_number(key, CONFIG_VALUE_INT, value);
+}
+
+/**
+ * @see config_manager.h
+ */
+phStatus config_get_bool(const char* key, bool* value) {
+    if (!value) {
+        return ph_ERROR_INVALID_ARGS;
+    }
+    int64_t number;
+    phStatus status = find_current_number(key, CONFIG_VALUE_BOOL, &number);
+    if (status == ph_SUCCESS) {
+        *value = number != 0;
+    }
+    return status;
+}
+
+/**
+ * @see config_manager.h
+ */
+phStatus config_get_duration_ms(const char* key, int64_t* value) {
+    return find_current_number(key, CONFIG_VALUE_DURATION, value);
+}
+
+/**
+ * @see config_manager.h
+ */
+size_t config_get_list(const char* key, ConfigListItem* items, size_t max_items) {
+    size_t length = 0;
+    const char* value = config_get_view(key, &length);
+    if (!value) {
+        return 0;
+    }
+    // The view stays valid for the caller as long as the items do.
+    size_t count = 0;
+    const char* end = value + length;
+    const char* begin = value;
+    while (begin < end) {
+        const char* comma = (const char*)memchr(begin, ',', (size_t)(end - begin));
+        const char* item_end = comma ? comma : end;
+        const char* item = begin;
+        trim_span(&item, &item_end);
+        if (item < item_end) {
+            if (count < max_items) {
+                items[count].data = item;
+                items[count].length = (size_t)(item_end - item);
+            }
+            count++;
+        }
+        begin = comma ? comma + 1 : end;
+    }
+    return count;
+}
+
+/**
+ * @see config_manager.h
+ */
+int config_get_origin(const char* key) {
+    if (!key) {
+        return -1;
+    }
+    int origin = -1;
+    config_read_begin();
+    snapshot_find(atomic_load(&g_snapshot), key, strlen(key), NULL, &origin);
+    config_read_end();
+    return origin;
+}
+
+/**
+ * @see config_manager.h
+ */
+const char* config_layer_name(ConfigLayer layer) {
+    static const char* const names[CONFIG_LAYER_COUNT] = {"system", "user", "repo", "env", "cli"};
+    return (unsigned)layer < CONFIG_LAYER_COUNT ? names[layer] : "unknown";
+}
+
+/**
+ * @see config_manager.h
+ */
+uint64_t config_generation(void) {
+    return atomic_load_explicit(&g_config_generation, memory_order_acquire);
+}
+
+/**
+ * @see config_manager.h
+ */
+phStatus config_set_value(const char* key, const char* value) {
+    if (!key || !value) {
+        return ph_ERROR_INVALID_ARGS;
+    }
+
+    // Overrides go to the command-line layer, which is small: the merge is
+    // usually patched rather than redone.
+    ConfigSnapshot* layers[CONFIG_LAYER_COUNT] = {NULL};
+    ConfigUpdate update;
+    config_read_begin();
+    platform_mutex_lock(&g_write_lock);
+    const ConfigSnapshot* cli = g_layers[CONFIG_LAYER_CLI];
+    ConfigSnapshot* layer = snapshot_create();
+    int result = -1;
+    size_t key_length = strlen(key);
+    if (layer && (!cli || config_table_clone(&layer->table, &cli->table) == 0) &&
+        config_table_set(&layer->table, key, key_length, value, strlen(value)) == 0) {
+        layer->log_keys = (cli && cli->log_keys) || is_log_key(key, key_length);
+        layers[CONFIG_LAYER_CLI] = layer;
+        result = update_layers(layers, 1u << CONFIG_LAYER_CLI, &update);
+    } else {
+        snapshot_destroy(layer);
+    }
+    platform_mutex_unlock(&g_write_lock);
+    if (result == 0) {
+        finish_update(&update);
+    }
+    config_read_end();
+
+    if (result != 0) {
+        logger_log(LOG_LEVEL_FATAL, "CONFIG", "Memory allocation failed for config key/value.");
+        return ph_ERROR_GENERAL;
+    }
+    return ph_SUCCESS;
+}
+
+/**
+ * @see config_manager.h
+ */
+int config_subscribe(config_change_callback callback, void* user_data) {
+    if (!callback) {
+        return -1;
+    }
+    // A callback subscribing already holds the lock.
+    if (!t_notifying) platform_mutex_lock(&g_subscriber_lock);
+    int subscription = -1;
+    for (int i = 0; i < CONFIG_MAX_SUBSCRIBERS; ++i) {
+        if (!g_subscribers[i].callback) {
+            g_subscribers[i].callback = callback;
+            g_subscribers[i].user_data = user_data;
+            atomic_fetch_add(&g_subscriber_count, 1);
+            subscription = i;
+            break;
+        }
+    }
+    if (!t_notifying) platform_mutex_unlock(&g_subscriber_lock);
+    if (subscription < 0) {
+        logger_log(LOG_LEVEL_ERROR, "CONFIG", "Too many configuration change subscribers.");
+    }
+    return subscription;
+}
+
+/**
+ * @see config_manager.h
+ */
+void config_unsubscribe(int subscription) {
+    if (subscription < 0 || subscription >= CONFIG_MAX_SUBSCRIBERS) {
+        return;
+    }
+    // Taking the lock waits for callbacks running on other threads.
+    if (!t_notifying) platform_mutex_lock(&g_subscriber_lock);
+    if (g_subscribers[subscription].callback) {
+        g_subscribers[subscription].callback = NULL;
+        g_subscribers[subscription].user_data = NULL;
+        atomic_fetch_sub(&g_subscriber_count, 1);
+    }
+    if (!t_notifying) platform_mutex_unlock(&g_subscriber_lock);
+}
+
+/**
+ * @see config_manager.h
+ */
+phStatus config_watch_start(const char* filename) {
+    if (!filename) {
+        return ph_ERROR_INVALID_ARGS;
+    }
+    ConfigWatcher* watcher = (ConfigWatcher*)calloc(1, sizeof(ConfigWatcher));
+    if (!watcher) {
+        return ph_ERROR_GENERAL;
+    }
+    watcher->filename = strdup(filename);
+    watcher->watch = watcher->filename ? platform_watch_open(filename) : NULL;
+    if (!watcher->watch) {
+        free(watcher->filename);
+        free(watcher);
+        logger_log_fmt(LOG_LEVEL_ERROR, "CONFIG", "Could not watch configuration file '%s'.", filename);
+        return ph_ERROR_GENERAL;
+    }
+    // Changes are counted from now, not from the last load.
+    watcher->file_exists = platform_file_stamp(filename, &watcher->size, &watcher->mtime_ns);
+
+    // Reload into the layer the file was loaded into, the repository's if none.
+    watcher->layer = CONFIG_LAYER_REPO;
+    platform_mutex_lock(&g_write_lock);
+    for (int layer = 0; layer <= CONFIG_LAYER_REPO; ++layer) {
+        if (g_layer_files[layer] && strcmp(g_layer_files[layer], filename) == 0) {
+            watcher->layer = (ConfigLayer)layer;
+        }
+    }
+    platform_mutex_unlock(&g_write_lock);
+
+    platform_mutex_lock(&g_watch_lock);
+    stop_watcher();
+    if (!platform_thread_create(&watcher->thread, watcher_main, watcher)) {
+        platform_mutex_unlock(&g_watch_lock);
+        platform_watch_close(watcher->watch);
+        free(watcher->filename);
+        free(watcher);
+        logger_log(LOG_LEVEL_ERROR, "CONFIG", "Could not start the configuration watcher thread.");
+        return ph_ERROR_GENERAL;
+    }
+    g_watcher = watcher;
+    platform_mutex_unlock(&g_watch_lock);
+    logger_log_fmt(LOG_LEVEL_INFO, "CONFIG", "Watching configuration file '%s' for changes.", filename);
+    return ph_SUCCESS;
+}
+
+/**
+ * @see config_manager.h
+ */
+void config_watch_stop(void) {
+    platform_mutex_lock(&g_watch_lock);
+    stop_watcher();
+    platform_mutex_unlock(&g_watch_lock);
+}
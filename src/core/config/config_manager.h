@@ -12,25 +12,106 @@
  * centralization prevents configuration logic from being scattered throughout
  * the codebase.
  *
+ * All functions are thread-safe. Lookups never block: they read an immutable
+ * snapshot of the configuration, and changes publish a new snapshot.
+ *
+ * Settings come from layers of increasing priority (see ConfigLayer): a key
+ * set by a higher layer hides the same key in lower ones, and
+ * `config_get_origin` tells which layer a value came from. Lookups cost the
+ * same whatever the number of layers, as they read a precomputed merge.
+ *
+ * Long-running processes can watch the loaded file with `config_watch_start`
+ * to pick up edits without a restart, and subscribe with `config_subscribe`
+ * to learn which keys changed.
+ *
  * SPDX-License-Identifier: Apache-2.0 */
 
 #ifndef CONFIG_MANAGER_H
 #define CONFIG_MANAGER_H
 
 #include "../../ipc/include/ph_core_api.h" // For phStatus enum
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @enum ConfigLayer
+ * @brief The sources of the configuration, from lowest to highest priority.
+ */
+typedef enum {
+    CONFIG_LAYER_SYSTEM,    // `/etc/ph/ph.conf`, or `%ProgramData%\ph\ph.conf` on Windows.
+    CONFIG_LAYER_USER,      // `~/.ph.conf`.
+    CONFIG_LAYER_REPO,      // The repository's `.ph.conf`, loaded by `config_load`.
+    CONFIG_LAYER_ENV,       // `PH_*` environment variables.
+    CONFIG_LAYER_CLI,       // Command-line overrides, made with `config_set_value`.
+    CONFIG_LAYER_COUNT
+} ConfigLayer;
+
+/**
+ * @brief Loads the system, user and repository files and the environment.
+ *
+ * Each source replaces its layer, and the merge of all layers is published
+ * once, so readers never see a partly loaded configuration. Missing files
+ * leave their layer empty. Environment variables named `PH_<NAME>` set the
+ * key `<name>` in lowercase, with `_` read as `.` and `__` as `_`:
+ * `PH_LOG_LEVEL=DEBUG` sets `log.level`.
+ *
+ * @param repo_file The repository file, or NULL for `.ph.conf`.
+ * @return ph_SUCCESS, also if files are missing, or ph_ERROR_GENERAL if
+ *         memory runs out (the configuration is then unchanged).
+ */
+phStatus config_load_layers(const char* repo_file);
+
+/**
+ * @brief Loads a file into one of the file layers, as `config_load` does
+ * for the repository layer.
+ *
+ * @param layer CONFIG_LAYER_SYSTEM, CONFIG_LAYER_USER or CONFIG_LAYER_REPO.
+ * @param filename The path to the configuration file.
+ * @return ph_SUCCESS, also if the file doesn't exist (the layer is then
+ *         empty), ph_ERROR_INVALID_ARGS for another layer, or
+ *         ph_ERROR_GENERAL if memory runs out.
+ */
+phStatus config_load_layer(ConfigLayer layer, const char* filename);
+
+/**
+ * @brief Reloads the environment layer from the `PH_*` variables, as
+ * `config_load_layers` reads them.
+ */
+phStatus config_load_environment(void);
+
+/**
+ * @brief Tells which layer the current value of a key came from.
+ * @return The layer, or -1 if the key is not set.
+ */
+int config_get_origin(const char* key);
+
+/**
+ * @brief Returns the name of a layer ("system", "user", "repo", "env" or
+ * "cli"), for diagnostics.
+ */
+const char* config_layer_name(ConfigLayer layer);
+
 /**
  * @brief Loads configuration settings from a specified file into memory.
  *
- * This function reads the given file line by line, parsing `key=value` pairs.
- * It ignores empty lines and lines starting with '#' (comments). Any existing
- * configuration in memory is cleared before loading the new file. If the file
- * cannot be opened, it returns an error, but the application can proceed with
- * default values.
+ * This function maps the given file into memory and parses its `key=value`
+ * lines in a single pass; lines may be of any length. It ignores empty
+ * lines and lines starting with '#' (comments). The file replaces the
+ * repository layer (see ConfigLayer) and whatever it held; the other layers
+ * keep their values. If the file cannot be opened, the layer is left empty
+ * and the application can proceed with default values.
+ *
+ * After parsing, a compiled image of the file is written next to it
+ * (`<filename>.phc`). As long as the file's size and modification time stay
+ * the same, later loads map that image instead of parsing. Such a load is
+ * still linear in the number of keys, since the image's index is
+ * checksummed, but reads a few dozen bytes per key instead of every line.
+ * Set the environment variable PH_CONFIG_CACHE=0 to disable images.
  *
  * @param filename The path to the configuration file.
  * @return ph_SUCCESS if the file was loaded successfully or if it doesn't
@@ -54,6 +135,103 @@ phStatus config_load(const char* filename);
  */
 char* config_get_value(const char* key);
 
+/**
+ * @brief Looks up a configuration value without copying it.
+ *
+ * Unlike `config_get_value`, this returns a borrowed pointer into the
+ * configuration store, so reading settings in a loop costs no allocation.
+ * The pointer must NOT be freed. It stays valid until the configuration is
+ * next modified, which callers detect with `config_generation`: a value
+ * fetched under one generation may be cached and reused for as long as
+ * `config_generation()` keeps returning that same number.
+ *
+ * When another thread may modify the configuration at the same time, take
+ * and use the view inside a `config_read_begin`/`config_read_end` section,
+ * which keeps it valid until the section ends whatever writers do.
+ *
+ * @param key The null-terminated string key to look up.
+ * @param[out] length Receives the length of the value in bytes. May be NULL.
+ * @return A pointer to the null-terminated value, or NULL if the key is not found.
+ */
+const char* config_get_view(const char* key, size_t* length);
+
+/**
+ * @brief One item of a list value, as returned by `config_get_list`.
+ */
+typedef phConfigListItem ConfigListItem;
+
+/**
+ * @brief Reads a value as an integer: decimal, with an optional sign.
+ *
+ * Values are classified once, when they are stored (see config_value.h for
+ * the forms accepted by this and the next two functions), so typed reads
+ * cost one lookup and no parsing.
+ *
+ * @param key The null-terminated string key to look up.
+ * @param[out] value Receives the integer. Unchanged unless ph_SUCCESS is returned.
+ * @return ph_SUCCESS, ph_ERROR_NOT_FOUND if the key is not set, or
+ *         ph_ERROR_INVALID_ARGS if an argument is NULL or the value is not
+ *         an integer.
+ */
+phStatus config_get_int(const char* key, int64_t* value);
+
+/**
+ * @brief Reads a value as a boolean: `true`/`false`, `yes`/`no`, `on`/`off`
+ * (in any case) or `1`/`0`.
+ * @return As `config_get_int`.
+ */
+phStatus config_get_bool(const char* key, bool* value);
+
+/**
+ * @brief Reads a value as a duration in milliseconds: a plain number of
+ * milliseconds, or numbers with units (`ms`, `s`, `m`, `h`, `d`) such as
+ * `30s` or `1h30m`.
+ * @return As `config_get_int`.
+ */
+phStatus config_get_duration_ms(const char* key, int64_t* value);
+
+/**
+ * @brief Reads a value as a comma-separated list.
+ *
+ * Items are trimmed of surrounding whitespace and empty items are skipped,
+ * so `a, b,,c` has three items. The items point into the value and are
+ * valid for as long as a view from `config_get_view` would be; nothing is
+ * allocated.
+ *
+ * @param key The null-terminated string key to look up.
+ * @param[out] items Receives the first `max_items` items. May be NULL if
+ *                   `max_items` is 0.
+ * @return The number of items in the list, which may exceed `max_items`,
+ *         or 0 if the key is not set.
+ */
+size_t config_get_list(const char* key, ConfigListItem* items, size_t max_items);
+
+/**
+ * @brief Enters a read section.
+ *
+ * Until the matching `config_read_end`, every view returned on this thread
+ * stays valid, even if other threads replace the values meanwhile. Entering
+ * costs an atomic store to a cache line private to the thread and never
+ * blocks; writers are never blocked by readers either, they only defer
+ * freeing the data readers may still see. Sections nest. Keep them short:
+ * memory of replaced configurations is held until they end.
+ */
+void config_read_begin(void);
+
+/**
+ * @brief Leaves a read section entered with `config_read_begin`.
+ */
+void config_read_end(void);
+
+/**
+ * @brief Returns the configuration generation.
+ *
+ * The number changes every time a value is set, a file is loaded or the
+ * configuration is cleared. Views obtained from `config_get_view` are valid
+ * only while it stays the same.
+ */
+uint64_t config_generation(void);
+
 /**
  * @brief Sets or updates a configuration value in memory.
  *
@@ -61,6 +239,8 @@ char* config_get_value(const char* key);
  * value of an existing key. The key and value strings are copied internally,
  * so the caller does not need to keep the original strings valid after this
  * function returns. This function does not persist the change to a file.
+ * The value goes to the command-line layer, so it overrides every file and
+ * the environment, and survives their reloading.
  *
  * @param key The null-terminated string key to set. Cannot be NULL.
  * @param value The null-terminated string value to associate with the key. Cannot be NULL.
@@ -74,10 +254,67 @@ phStatus config_set_value(const char* key, const char* value);
  *
  * This function should be called once at application shutdown to deallocate
  * all memory used for storing the configuration keys and values, preventing
- * memory leaks.
+ * memory leaks. Every layer is cleared.
  */
 void config_cleanup(void);
 
+/**
+ * @brief Receives the keys whose values a change added, modified or removed.
+ *
+ * @param keys The changed keys, each listed once, in no particular order.
+ *             They are valid only until the callback returns.
+ * @param count The number of keys, at least 1.
+ * @param user_data The pointer given to `config_subscribe`.
+ */
+typedef void (*config_change_callback)(const char* const* keys, size_t count, void* user_data);
+
+/**
+ * @brief Registers a callback to be told about configuration changes.
+ *
+ * The callback runs on the thread that made the change, after the new
+ * configuration is published: the thread calling `config_load` or
+ * `config_set_value`, or the watcher thread of `config_watch_start`.
+ * Callbacks are called one at a time. They may read the configuration and
+ * (un)subscribe; changes they make to the configuration themselves are not
+ * reported. Clearing the configuration with `config_cleanup` is not reported
+ * either.
+ *
+ * @return A subscription id for `config_unsubscribe`, or -1 if the callback
+ *         is NULL or too many callbacks are registered.
+ */
+int config_subscribe(config_change_callback callback, void* user_data);
+
+/**
+ * @brief Removes a subscription. Once this returns, its callback is not
+ * running and will not be called again.
+ */
+void config_unsubscribe(int subscription);
+
+/**
+ * @brief Reloads a configuration file whenever it changes.
+ *
+ * A watcher thread waits for changes to the file (see `platform_watch_open`)
+ * and, once the file has been quiet for a moment, loads it as
+ * `config_load` would if its size or modification time differs from when it
+ * was last seen, into the layer it was last loaded into (the repository
+ * layer if none). Readers keep using the previous configuration until the
+ * new one is published in a single step, and subscribers are told which
+ * keys changed. Deleting the file clears its layer.
+ *
+ * Only one file is watched at a time; watching another replaces the watch.
+ * The file itself is not loaded by this call.
+ *
+ * @param filename The path to the configuration file. Its directory must exist.
+ * @return ph_SUCCESS if the file is being watched, ph_ERROR_GENERAL otherwise.
+ */
+phStatus config_watch_start(const char* filename);
+
+/**
+ * @brief Stops watching the file given to `config_watch_start`, waiting for
+ * a reload in progress to finish. Does nothing if no file is watched.
+ */
+void config_watch_stop(void);
+
 
 #ifdef __cplusplus
 } // extern "C"
@@ -0,0 +1,518 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * config_table.c - Implementation of the configuration hash table.
+ *
+ * See config_table.h for the layout. The probe sequence visits whole groups
+ * in triangular order (g, g+1, g+3, g+6, ...), which reaches every group of
+ * a power-of-two table. Because entries are never removed, the first group
+ * with an empty slot ends a lookup, and that same slot is where a missing
+ * key is inserted, so insertion needs a single pass.
+ *
+ * The table grows (doubling) when it would exceed a load factor of 7/8.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "config_table.h"
+#include "config_value.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONFIG_TABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// --- Internal Helpers ---
+
+// Control byte of an empty slot. Full slots hold the low 7 bits of the hash.
+#define CTRL_EMPTY 0x80
+#define MIN_CAPACITY CONFIG_TABLE_GROUP_WIDTH
+#define MIN_ARENA_CAPACITY 4096
+// The arena is compacted when replaced values take at least half of it,
+// but not while it is small enough for the waste not to matter.
+#define MIN_COMPACT_SIZE (64 * 1024)
+
+/**
+ * @brief Hashes a key eight bytes at a time.
+ *
+ * A multiply-xorshift mix per word, finished with the splitmix64 finalizer.
+ * Every bit of the result depends on every input byte, which matters because
+ * the low 7 bits become the control tag and the rest select the group.
+ */
+static uint64_t hash_key(const char* key, size_t length) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ (uint64_t)length;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, key, 8);
+        hash = (hash ^ word) * 0xbf58476d1ce4e5b9ull;
+        hash ^= hash >> 29;
+        key += 8;
+        length -= 8;
+    }
+    if (length > 0) {
+        uint64_t word = 0;
+        memcpy(&word, key, length);
+        hash = (hash ^ word) * 0xbf58476d1ce4e5b9ull;
+        hash ^= hash >> 29;
+    }
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+static inline uint8_t hash_tag(uint64_t hash) {
+    return (uint8_t)(hash & 0x7f);
+}
+
+static inline unsigned lowest_bit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+/**
+ * @brief Returns a bitmask of the slots in a group whose control byte is `tag`.
+ */
+static inline uint32_t group_match(const uint8_t* group, uint8_t tag) {
+#ifdef CONFIG_TABLE_SSE2
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < CONFIG_TABLE_GROUP_WIDTH; ++i) {
+        mask |= (uint32_t)(group[i] == tag) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * @brief Returns a bitmask of the empty slots in a group.
+ */
+static inline uint32_t group_match_empty(const uint8_t* group) {
+#ifdef CONFIG_TABLE_SSE2
+    // Only empty slots have the high bit set.
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    return group_match(group, CTRL_EMPTY);
+#endif
+}
+
+/**
+ * @brief Finds the first empty slot on a hash's probe sequence.
+ */
+static size_t find_empty_slot(const uint8_t* ctrl, size_t capacity, uint64_t hash) {
+    size_t group_mask = capacity / CONFIG_TABLE_GROUP_WIDTH - 1;
+    size_t group = (size_t)(hash >> 7) & group_mask;
+    for (size_t step = 1;; ++step) {
+        uint32_t empty = group_match_empty(ctrl + group * CONFIG_TABLE_GROUP_WIDTH);
+        if (empty != 0) {
+            return group * CONFIG_TABLE_GROUP_WIDTH + lowest_bit(empty);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+/**
+ * @brief Probes for a key.
+ * @param[out] empty_slot If the key is missing, receives the slot to insert it in.
+ * @return The slot holding the key, or (size_t)-1.
+ */
+static size_t probe(const ConfigTable* table, const char* key, size_t key_length,
+                    uint64_t hash, size_t* empty_slot) {
+    size_t group_mask = table->capacity / CONFIG_TABLE_GROUP_WIDTH - 1;
+    size_t group = (size_t)(hash >> 7) & group_mask;
+    uint8_t tag = hash_tag(hash);
+    for (size_t step = 1;; ++step) {
+        const uint8_t* ctrl = table->ctrl + group * CONFIG_TABLE_GROUP_WIDTH;
+        uint32_t candidates = group_match(ctrl, tag);
+        while (candidates != 0) {
+            size_t slot = group * CONFIG_TABLE_GROUP_WIDTH + lowest_bit(candidates);
+            const ConfigEntry* entry = &table->entries[slot];
+            if (entry->hash == hash && entry->key_length == key_length &&
+                memcmp(table->arena + entry->key_offset, key, key_length) == 0) {
+                return slot;
+            }
+            candidates &= candidates - 1;
+        }
+        uint32_t empty = group_match_empty(ctrl);
+        if (empty != 0) {
+            if (empty_slot) {
+                *empty_slot = group * CONFIG_TABLE_GROUP_WIDTH + lowest_bit(empty);
+            }
+            return (size_t)-1;
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+/**
+ * @brief Moves every entry into a table of `capacity` slots. Hashes are
+ * stored, so no key is rehashed.
+ * @return 0 on success, -1 on allocation failure (the table is unchanged).
+ */
+static int resize(ConfigTable* table, size_t capacity) {
+    uint8_t* ctrl = (uint8_t*)malloc(capacity);
+    ConfigEntry* entries = (ConfigEntry*)malloc(capacity * sizeof(ConfigEntry));
+    if (!ctrl || !entries) {
+        free(ctrl);
+        free(entries);
+        return -1;
+    }
+    memset(ctrl, CTRL_EMPTY, capacity);
+
+    for (size_t i = 0; i < table->capacity; ++i) {
+        if (table->ctrl[i] == CTRL_EMPTY) {
+            continue;
+        }
+        const ConfigEntry* entry = &table->entries[i];
+        size_t slot = find_empty_slot(ctrl, capacity, entry->hash);
+        ctrl[slot] = hash_tag(entry->hash);
+        entries[slot] = *entry;
+    }
+
+    free(table->ctrl);
+    free(table->entries);
+    table->ctrl = ctrl;
+    table->entries = entries;
+    table->capacity = capacity;
+    table->growth_left = capacity - capacity / 8 - table->count;
+    return 0;
+}
+
+/**
+ * @brief Makes room for `needed` more bytes in the arena.
+ * @return 0 on success, -1 on allocation failure or if offsets would
+ *         overflow 32 bits.
+ */
+static int reserve_arena(ConfigTable* table, size_t needed) {
+    if (needed > UINT32_MAX - table->arena_size) {
+        return -1;
+    }
+    size_t required = table->arena_size + needed;
+    if (required <= table->arena_capacity) {
+        return 0;
+    }
+    size_t capacity = table->arena_capacity ? table->arena_capacity : MIN_ARENA_CAPACITY;
+    while (capacity < required) {
+        capacity *= 2;
+    }
+    char* arena = (char*)realloc(table->arena, capacity);
+    if (!arena) {
+        return -1;
+    }
+    table->arena = arena;
+    table->arena_capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Copies a string and its terminator to the end of the arena, which
+ * must have room for it.
+ * @return The string's offset.
+ */
+static uint32_t arena_append(ConfigTable* table, const char* text, size_t length) {
+    uint32_t offset = (uint32_t)table->arena_size;
+    memcpy(table->arena + offset, text, length);
+    table->arena[offset + length] = '\0';
+    table->arena_size += length + 1;
+    return offset;
+}
+
+/**
+ * @brief Rewrites the arena without the replaced values. On allocation
+ * failure the garbage simply stays.
+ */
+static void compact_arena(ConfigTable* table) {
+    size_t live = table->arena_size - table->arena_garbage;
+    char* arena = (char*)malloc(live > MIN_ARENA_CAPACITY ? live : MIN_ARENA_CAPACITY);
+    if (!arena) {
+        return;
+    }
+    char* old_arena = table->arena;
+    table->arena = arena;
+    table->arena_capacity = live > MIN_ARENA_CAPACITY ? live : MIN_ARENA_CAPACITY;
+    table->arena_size = 0;
+    table->arena_garbage = 0;
+    for (size_t i = 0; i < table->capacity; ++i) {
+        if (table->ctrl[i] == CTRL_EMPTY) {
+            continue;
+        }
+        ConfigEntry* entry = &table->entries[i];
+        entry->key_offset = arena_append(table, old_arena + entry->key_offset, entry->key_length);
+        entry->value_offset = arena_append(table, old_arena + entry->value_offset, entry->value_length);
+    }
+    free(old_arena);
+}
+
+/**
+ * @brief Starts loading the cache line at `address`.
+ */
+static inline void prefetch(const void* address) {
+#if defined(_MSC_VER)
+    _mm_prefetch((const char*)address, _MM_HINT_T0);
+#else
+    __builtin_prefetch(address);
+#endif
+}
+
+/**
+ * @brief Returns the first slot of the first group a hash probes. The table
+ * must have slots.
+ */
+static inline size_t first_probe_slot(const ConfigTable* table, uint64_t hash) {
+    size_t group_mask = table->capacity / CONFIG_TABLE_GROUP_WIDTH - 1;
+    return ((size_t)(hash >> 7) & group_mask) * CONFIG_TABLE_GROUP_WIDTH;
+}
+
+/**
+ * @brief The typed reading of a value, as stored in its entry.
+ */
+typedef struct {
+    uint8_t types;
+    int64_t number;
+} TypedValue;
+
+static inline TypedValue classify(const char* value, size_t value_length) {
+    TypedValue typed;
+    typed.types = config_value_classify(value, value_length, &typed.number);
+    return typed;
+}
+
+/**
+ * @brief Inserts or replaces a key whose hash and value types are already known.
+ */
+static int insert_hashed(ConfigTable* table, const char* key, size_t key_length,
+                         const char* value, size_t value_length, uint64_t hash, uint8_t tag,
+                         TypedValue typed) {
+    if (key_length > CONFIG_TABLE_MAX_KEY_LENGTH || value_length > CONFIG_TABLE_MAX_VALUE_LENGTH) {
+        return -1;
+    }
+    size_t empty_slot = 0;
+    size_t slot = table->capacity ? probe(table, key, key_length, hash, &empty_slot) : (size_t)-1;
+
+    if (slot != (size_t)-1) {
+        // Existing key: append the new value and retire the old one.
+        ConfigEntry* entry = &table->entries[slot];
+        if (reserve_arena(table, value_length + 1) != 0) {
+            return -1;
+        }
+        table->arena_garbage += entry->value_length + 1;
+        entry->value_offset = arena_append(table, value, value_length);
+        entry->value_length = (uint32_t)value_length;
+        entry->types = typed.types;
+        entry->number = typed.number;
+        entry->tag = tag;
+        if (table->arena_size >= MIN_COMPACT_SIZE && table->arena_garbage * 2 >= table->arena_size) {
+            compact_arena(table);
+        }
+        return 0;
+    }
+
+    if (reserve_arena(table, key_length + value_length + 2) != 0) {
+        return -1;
+    }
+    if (table->growth_left == 0) {
+        size_t capacity = table->capacity ? table->capacity * 2 : MIN_CAPACITY;
+        if (resize(table, capacity) != 0) {
+            return -1;
+        }
+        empty_slot = find_empty_slot(table->ctrl, table->capacity, hash);
+    }
+
+    ConfigEntry* entry = &table->entries[empty_slot];
+    entry->hash = hash;
+    entry->key_offset = arena_append(table, key, key_length);
+    entry->key_length = (uint32_t)key_length;
+    entry->tag = tag;
+    entry->value_offset = arena_append(table, value, value_length);
+    entry->value_length = (uint32_t)value_length;
+    entry->types = typed.types;
+    entry->number = typed.number;
+    table->ctrl[empty_slot] = hash_tag(hash);
+    table->count++;
+    table->growth_left--;
+    return 0;
+}
+
+// --- Public API Implementation ---
+
+/**
+ * @see config_table.h
+ */
+uint64_t config_table_hash(const char* data, size_t length) {
+    return hash_key(data, length);
+}
+
+/**
+ * @see config_table.h
+ */
+void config_table_init(ConfigTable* table) {
+    memset(table, 0, sizeof(*table));
+}
+
+/**
+ * @see config_table.h
+ */
+void config_table_destroy(ConfigTable* table) {
+    free(table->ctrl);
+    free(table->entries);
+    free(table->arena);
+    config_table_init(table);
+}
+
+/**
+ * @see config_table.h
+ */
+int config_table_reserve(ConfigTable* table, size_t count, size_t bytes) {
+    size_t needed = table->count + count;
+    size_t capacity = table->capacity ? table->capacity : MIN_CAPACITY;
+    while (capacity - capacity / 8 < needed) {
+        capacity *= 2;
+    }
+    if (capacity > table->capacity && resize(table, capacity) != 0) {
+        return -1;
+    }
+    return reserve_arena(table, bytes);
+}
+
+/**
+ * @see config_table.h
+ */
+int config_table_clone(ConfigTable* dst, const ConfigTable* src) {
+    config_table_init(dst);
+    if (src->capacity == 0) {
+        return 0;
+    }
+    dst->ctrl = (uint8_t*)malloc(src->capacity);
+    dst->entries = (ConfigEntry*)malloc(src->capacity * sizeof(ConfigEntry));
+    dst->arena = (char*)malloc(src->arena_capacity);
+    if (!dst->ctrl || !dst->entries || !dst->arena) {
+        config_table_destroy(dst);
+        return -1;
+    }
+    memcpy(dst->ctrl, src->ctrl, src->capacity);
+    memcpy(dst->entries, src->entries, src->capacity * sizeof(ConfigEntry));
+    memcpy(dst->arena, src->arena, src->arena_size);
+    dst->capacity = src->capacity;
+    dst->count = src->count;
+    dst->growth_left = src->growth_left;
+    dst->arena_size = src->arena_size;
+    dst->arena_capacity = src->arena_capacity;
+    dst->arena_garbage = src->arena_garbage;
+    if (dst->arena_garbage != 0) {
+        compact_arena(dst);
+    }
+    return 0;
+}
+
+/**
+ * @see config_table.h
+ */
+const ConfigEntry* config_table_find(const ConfigTable* table, const char* key, size_t key_length) {
+    if (table->count == 0) {
+        return NULL;
+    }
+    size_t slot = probe(table, key, key_length, hash_key(key, key_length), NULL);
+    return slot == (size_t)-1 ? NULL : &table->entries[slot];
+}
+
+/**
+ * @see config_table.h
+ */
+int config_table_set(ConfigTable* table, const char* key, size_t key_length,
+                     const char* value, size_t value_length) {
+    return insert_hashed(table, key, key_length, value, value_length, hash_key(key, key_length), 0,
+                         classify(value, value_length));
+}
+
+/**
+ * @see config_table.h
+ */
+int config_table_set_tagged(ConfigTable* table, const char* key, size_t key_length,
+                            const char* value, size_t value_length, uint8_t tag) {
+    return insert_hashed(table, key, key_length, value, value_length, hash_key(key, key_length), tag,
+                         classify(value, value_length));
+}
+
+/**
+ * @see config_table.h
+ */
+int config_table_merge(ConfigTable* dst, const ConfigTable* src, uint8_t tag) {
+    const ConfigEntry* batch[CONFIG_TABLE_BATCH];
+    size_t cursor = 0;
+    int result = 0;
+    for (;;) {
+        size_t count = 0;
+        const ConfigEntry* entry;
+        while (count < CONFIG_TABLE_BATCH && (entry = config_table_next(src, &cursor)) != NULL) {
+            if (dst->capacity != 0) {
+                size_t slot = first_probe_slot(dst, entry->hash);
+                prefetch(dst->ctrl + slot);
+                prefetch(dst->entries + slot);
+            }
+            batch[count++] = entry;
+        }
+        if (count == 0) {
+            return result;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            TypedValue typed = {batch[i]->types, batch[i]->number};
+            if (insert_hashed(dst, config_table_key(src, batch[i]), batch[i]->key_length,
+                              config_table_value(src, batch[i]), batch[i]->value_length,
+                              batch[i]->hash, tag, typed) != 0) {
+                result = -1;
+            }
+        }
+    }
+}
+
+/**
+ * @see config_table.h
+ */
+int config_table_set_batch(ConfigTable* table, const ConfigPair* pairs, size_t count) {
+    uint64_t hashes[CONFIG_TABLE_BATCH];
+    int result = 0;
+    for (size_t start = 0; start < count; start += CONFIG_TABLE_BATCH) {
+        size_t batch = count - start < CONFIG_TABLE_BATCH ? count - start : CONFIG_TABLE_BATCH;
+        // Hash the whole batch and start fetching every group it will
+        // probe, so the cache misses of the inserts overlap.
+        for (size_t i = 0; i < batch; ++i) {
+            const ConfigPair* pair = &pairs[start + i];
+            hashes[i] = hash_key(pair->key, pair->key_length);
+            if (table->capacity != 0) {
+                size_t slot = first_probe_slot(table, hashes[i]);
+                prefetch(table->ctrl + slot);
+                prefetch(table->entries + slot);
+            }
+        }
+        for (size_t i = 0; i < batch; ++i) {
+            const ConfigPair* pair = &pairs[start + i];
+            if (insert_hashed(table, pair->key, pair->key_length, pair->value, pair->value_length,
+                              hashes[i], 0, classify(pair->value, pair->value_length)) != 0) {
+                result = -1;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @see config_table.h
+ */
+const ConfigEntry* config_table_next(const ConfigTable* table, size_t* cursor) {
+    while (*cursor < table->capacity) {
+        size_t slot = (*cursor)++;
+        if (table->ctrl[slot] != CTRL_EMPTY) {
+            return &table->entries[slot];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,194 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * config_table.h - Open-addressing string table backing the configuration.
+ *
+ * This header declares the hash table used by the configuration manager to
+ * store `key=value` pairs. It is a "Swiss table": a flat array of entries
+ * paired with an array of one-byte control tags, probed sixteen slots at a
+ * time. Each control byte holds 7 bits of the key's hash (or marks the slot
+ * as empty), so a single SSE2 compare finds every candidate slot of a group
+ * and most lookups touch exactly one group and one entry. A portable scalar
+ * loop is used where SSE2 is not available.
+ *
+ * Entries store the full 64-bit hash inline, so growing the table never
+ * rehashes a string, and refer to their key and value by offset into one
+ * contiguous string arena. Keys and values are kept NUL-terminated in the
+ * arena, so they can be handed out as C strings without copying. Replacing a
+ * value appends the new text; the space of replaced values is reclaimed by
+ * compacting the arena once it makes up half of it.
+ *
+ * Each entry also carries a small tag that the table stores but never
+ * interprets; the configuration manager records there which layer a merged
+ * value came from.
+ *
+ * Values are read as numbers, booleans and durations when they are stored
+ * (see config_value.h), and each entry keeps the types its value reads as
+ * and the number it stands for, so typed lookups never parse.
+ *
+ * Entries are never removed, which keeps probing free of tombstones.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef CONFIG_TABLE_H
+#define CONFIG_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Slots probed together; one SSE2 register of control bytes.
+#define CONFIG_TABLE_GROUP_WIDTH 16
+// Pairs whose probes config_table_set_batch overlaps.
+#define CONFIG_TABLE_BATCH 16
+// Longest key the table stores; its length shares a word with the tag.
+#define CONFIG_TABLE_MAX_KEY_LENGTH 0xFFFFFF
+// Longest value the table stores; its length shares a word with its types.
+#define CONFIG_TABLE_MAX_VALUE_LENGTH 0xFFFFFF
+
+/**
+ * @struct ConfigEntry
+ * @brief One key/value pair. Strings live in the table's arena.
+ */
+typedef struct {
+    uint64_t hash;
+    uint32_t key_offset;
+    uint32_t key_length : 24;
+    uint32_t tag : 8;       // Set by config_table_set_tagged, 0 otherwise.
+    uint32_t value_offset;
+    uint32_t value_length : 24;
+    uint32_t types : 8;     // CONFIG_VALUE_* bits of the types the value reads as.
+    int64_t number;         // The number it stands for as any of them.
+} ConfigEntry;
+
+/**
+ * @struct ConfigPair
+ * @brief A key/value pair to insert, given by pointer and length. Neither
+ * string needs to be NUL-terminated.
+ */
+typedef struct {
+    const char* key;
+    size_t key_length;
+    const char* value;
+    size_t value_length;
+} ConfigPair;
+
+/**
+ * @struct ConfigTable
+ * @brief The table itself. Zero-initialized (or `config_table_init`) is empty.
+ */
+typedef struct {
+    uint8_t* ctrl;          // One control byte per slot.
+    ConfigEntry* entries;   // `capacity` slots.
+    size_t capacity;        // A power of two, at least one group, or 0.
+    size_t count;           // Keys stored.
+    size_t growth_left;     // Insertions left before the table must grow.
+    char* arena;            // Keys and values, NUL-terminated.
+    size_t arena_size;      // Bytes used in `arena`.
+    size_t arena_capacity;
+    size_t arena_garbage;   // Bytes held by replaced values.
+} ConfigTable;
+
+/**
+ * @brief The table's key hash: 64 bits, every bit depending on every byte.
+ * Stable for a given build, so it may be used by persisted indexes that
+ * record the format version they were built with.
+ */
+uint64_t config_table_hash(const char* data, size_t length);
+
+/**
+ * @brief Initializes an empty table. No memory is allocated until the first insert.
+ */
+void config_table_init(ConfigTable* table);
+
+/**
+ * @brief Frees everything owned by the table and leaves it empty.
+ */
+void config_table_destroy(ConfigTable* table);
+
+/**
+ * @brief Sizes the table for `count` more keys and the arena for `bytes`
+ * more bytes of strings (terminators included), so that inserting them
+ * allocates nothing.
+ * @return 0 on success, -1 on allocation failure (the table is unchanged).
+ */
+int config_table_reserve(ConfigTable* table, size_t count, size_t bytes);
+
+/**
+ * @brief Makes `dst` an independent copy of `src`, dropping replaced values.
+ * @return 0 on success, -1 on allocation failure (`dst` is then empty).
+ */
+int config_table_clone(ConfigTable* dst, const ConfigTable* src);
+
+/**
+ * @brief Looks a key up.
+ * @return The entry, or NULL if the key is not present. The pointer is valid
+ *         until the table is next modified.
+ */
+const ConfigEntry* config_table_find(const ConfigTable* table, const char* key, size_t key_length);
+
+/**
+ * @brief Inserts a key or replaces its value. Both strings are copied.
+ * @return 0 on success, -1 if memory could not be allocated, the key is
+ *         longer than CONFIG_TABLE_MAX_KEY_LENGTH or the value longer than
+ *         CONFIG_TABLE_MAX_VALUE_LENGTH (the table is left unchanged).
+ */
+int config_table_set(ConfigTable* table, const char* key, size_t key_length,
+                     const char* value, size_t value_length);
+
+/**
+ * @brief Like `config_table_set`, but also stores `tag` in the entry.
+ */
+int config_table_set_tagged(ConfigTable* table, const char* key, size_t key_length,
+                            const char* value, size_t value_length, uint8_t tag);
+
+/**
+ * @brief Inserts or replaces every entry of `src` in `dst`, tagged with `tag`.
+ *
+ * Uses the hashes and types stored in `src`, so no key is hashed and no
+ * value classified again, and overlaps
+ * the probes of a batch of entries as `config_table_set_batch` does.
+ *
+ * @return 0 on success, -1 if any entry could not be stored (the others are).
+ */
+int config_table_merge(ConfigTable* dst, const ConfigTable* src, uint8_t tag);
+
+/**
+ * @brief Inserts or replaces many pairs, in order, so later pairs win.
+ *
+ * Equivalent to calling `config_table_set` for each pair, but pairs are
+ * hashed a batch at a time and the memory each will probe is prefetched
+ * first, so a large table pays for its cache misses in parallel rather
+ * than one insert after another.
+ *
+ * @return 0 on success, -1 if any pair could not be stored (the others are).
+ */
+int config_table_set_batch(ConfigTable* table, const ConfigPair* pairs, size_t count);
+
+/**
+ * @brief Iterates over the entries in slot order.
+ * @param cursor Set to 0 before the first call.
+ * @return The next entry, or NULL when every entry has been visited.
+ */
+const ConfigEntry* config_table_next(const ConfigTable* table, size_t* cursor);
+
+/**
+ * @brief Returns an entry's key as a NUL-terminated string.
+ */
+static inline const char* config_table_key(const ConfigTable* table, const ConfigEntry* entry) {
+    return table->arena + entry->key_offset;
+}
+
+/**
+ * @brief Returns an entry's value as a NUL-terminated string.
+ */
+static inline const char* config_table_value(const ConfigTable* table, const ConfigEntry* entry) {
+    return table->arena + entry->value_offset;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // CONFIG_TABLE_H
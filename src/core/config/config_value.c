@@ -0,0 +1,151 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * config_value.c - Typed readings of configuration values.
+ *
+ * See config_value.h for the accepted forms. Classification runs on every
+ * value stored, so it rejects the common case, a value that is plain text,
+ * on its first byte.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "config_value.h"
+#include <stdbool.h>
+
+// --- Internal Helpers ---
+
+static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline char to_lower(char c) {
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+/**
+ * @brief Compares a value with a lowercase word, ignoring case.
+ */
+static bool equals_word(const char* text, size_t length, const char* word) {
+    size_t i = 0;
+    for (; i < length && word[i] != '\0'; ++i) {
+        if (to_lower(text[i]) != word[i]) {
+            return false;
+        }
+    }
+    return i == length && word[i] == '\0';
+}
+
+/**
+ * @brief Reads a run of decimal digits at `*cursor`, advancing it.
+ * @return false if there is no digit or the number does not fit 64 bits.
+ */
+static bool read_digits(const char** cursor, const char* end, uint64_t* value) {
+    const char* p = *cursor;
+    uint64_t result = 0;
+    for (; p < end && is_digit(*p); ++p) {
+        unsigned digit = (unsigned)(*p - '0');
+        if (result > (UINT64_MAX - digit) / 10) {
+            return false;
+        }
+        result = result * 10 + digit;
+    }
+    if (p == *cursor) {
+        return false;
+    }
+    *cursor = p;
+    *value = result;
+    return true;
+}
+
+/**
+ * @brief Reads a value as a boolean word.
+ */
+static uint8_t classify_word(const char* text, size_t length, int64_t* number) {
+    static const struct {
+        const char* word;
+        int64_t value;
+    } words[] = {
+        {"true", 1}, {"yes", 1}, {"on", 1}, {"false", 0}, {"no", 0}, {"off", 0},
+    };
+    if (length > 5) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i) {
+        if (equals_word(text, length, words[i].word)) {
+            *number = words[i].value;
+            return CONFIG_VALUE_BOOL;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads a value as a sum of numbers with units, in milliseconds.
+ */
+static uint8_t classify_duration(const char* text, const char* end, int64_t* number) {
+    uint64_t total = 0;
+    const char* cursor = text;
+    while (cursor < end) {
+        uint64_t amount;
+        if (!read_digits(&cursor, end, &amount) || cursor == end) {
+            return 0;
+        }
+        uint64_t scale;
+        if (end - cursor >= 2 && cursor[0] == 'm' && cursor[1] == 's') {
+            scale = 1;
+            cursor += 2;
+        } else {
+            switch (*cursor++) {
+                case 's': scale = 1000; break;
+                case 'm': scale = 60 * 1000; break;
+                case 'h': scale = 60 * 60 * 1000; break;
+                case 'd': scale = 24 * 60 * 60 * 1000; break;
+                default: return 0;
+            }
+        }
+        if (amount > ((uint64_t)INT64_MAX - total) / scale) {
+            return 0;
+        }
+        total += amount * scale;
+    }
+    *number = (int64_t)total;
+    return CONFIG_VALUE_DURATION;
+}
+
+// --- Public API Implementation ---
+
+/**
+ * @see config_value.h
+ */
+uint8_t config_value_classify(const char* text, size_t length, int64_t* number) {
+    *number = 0;
+    if (length == 0) {
+        return 0;
+    }
+    const char* end = text + length;
+    bool negative = text[0] == '-';
+    if (!is_digit(text[0]) && !negative && text[0] != '+') {
+        return classify_word(text, length, number);
+    }
+
+    const char* cursor = negative || text[0] == '+' ? text + 1 : text;
+    uint64_t magnitude;
+    if (!read_digits(&cursor, end, &magnitude)) {
+        return 0;
+    }
+    if (cursor != end) {
+        // Unsigned digits followed by more: a duration with units, or nothing.
+        return is_digit(text[0]) ? classify_duration(text, end, number) : 0;
+    }
+    if (magnitude > (uint64_t)INT64_MAX + negative) {
+        return 0;
+    }
+    // Negate through INT64_MAX so that INT64_MIN does not overflow.
+    *number = negative && magnitude > 0 ? -(int64_t)(magnitude - 1) - 1 : (int64_t)magnitude;
+    uint8_t types = CONFIG_VALUE_INT;
+    if (!negative) {
+        types |= CONFIG_VALUE_DURATION;
+    }
+    if (length == 1 && *number <= 1) {
+        types |= CONFIG_VALUE_BOOL;
+    }
+    return types;
+}
@@ -0,0 +1,51 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * config_value.h - Typed readings of configuration values.
+ *
+ * Configuration values are text, but most settings are numbers, switches or
+ * timeouts. When a value is stored, the configuration table asks this module
+ * which types the text reads as and what number it stands for, and keeps
+ * both in the value's entry (and in compiled images), so the typed
+ * accessors of config_manager.h never parse.
+ *
+ * A value may read as several types at once, always as the same number:
+ * - An integer: decimal, with an optional sign, within 64 bits.
+ * - A boolean: `true`, `yes`, `on` or `1` (1), `false`, `no`, `off` or `0`
+ *   (0), in any case.
+ * - A duration, in milliseconds: a non-negative integer (milliseconds), or
+ *   one or more integers each followed by a unit, `ms`, `s`, `m`, `h` or
+ *   `d`, as in `1500ms`, `30s` or `1h30m`.
+ *
+ * So `"30"` is both an integer and a duration of 30 ms, and `"1"` is an
+ * integer, a boolean and a duration.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef CONFIG_VALUE_H
+#define CONFIG_VALUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bits of a value's types.
+#define CONFIG_VALUE_INT 0x01
+#define CONFIG_VALUE_BOOL 0x02
+#define CONFIG_VALUE_DURATION 0x04
+
+/**
+ * @brief Works out which types a value reads as.
+ * @param text The value; it need not be NUL-terminated.
+ * @param[out] number Receives the number the value stands for, or 0 if it
+ *                    reads as no type.
+ * @return The CONFIG_VALUE_* bits of every type the value reads as, or 0.
+ */
+uint8_t config_value_classify(const char* text, size_t length, int64_t* number);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // CONFIG_VALUE_H
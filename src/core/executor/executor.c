@@ -0,0 +1,174 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * executor.c - The core's shared pool of worker threads.
+ *
+ * A FIFO of tasks under one mutex, with a condition variable the workers
+ * sleep on. Submitting a task is a malloc and a short critical section;
+ * the tasks modules submit (fetching a repository, talking to a cluster)
+ * take orders of magnitude longer, so a lock-free queue would buy nothing.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "executor.h"
+#include "config/config_manager.h"   // For the thread count
+#include "platform/platform.h"       // For the threads and the queue lock
+#include "libs/liblogger/Logger.hpp" // For reporting failures to start workers
+#include <stdlib.h>
+
+// --- Internal State ---
+
+typedef struct Task {
+    phTaskFn run;
+    void* arg;
+    struct Task* next;
+} Task;
+
+static platform_mutex_t g_lock = PLATFORM_MUTEX_INIT;
+static platform_cond_t g_work = PLATFORM_COND_INIT;
+static Task* g_head = NULL;                 // Next task to run.
+static Task* g_tail = NULL;
+static bool g_stopping = false;             // Workers exit once the queue is empty.
+static unsigned g_live_workers = 0;         // Workers that have not exited yet.
+// Serializes starting and stopping the pool, which create or join threads
+// outside g_lock; the thread list is only used under it.
+static platform_mutex_t g_lifecycle_lock = PLATFORM_MUTEX_INIT;
+static platform_thread_t g_workers[EXECUTOR_MAX_THREADS];
+static unsigned g_worker_count = 0;         // Threads in g_workers.
+
+// --- Internal Helpers ---
+
+static unsigned configured_thread_count(void) {
+    int64_t configured = 0;
+    int64_t threads = config_get_int(EXECUTOR_THREADS_KEY, &configured) == ph_SUCCESS ? configured
+                                                                                      : (int64_t)platform_cpu_count();
+    if (threads < 1) return 1;
+    if (threads > EXECUTOR_MAX_THREADS) return EXECUTOR_MAX_THREADS;
+    return (unsigned)threads;
+}
+
+static void worker_main(void* arg) {
+    (void)arg;
+    platform_mutex_lock(&g_lock);
+    for (;;) {
+        while (!g_head && !g_stopping) {
+            platform_cond_wait(&g_work, &g_lock, -1);
+        }
+        Task* task = g_head;
+        if (!task) {
+            g_live_workers--; // Stopping, and nothing left to run.
+            break;
+        }
+        g_head = task->next;
+        if (!g_head) {
+            g_tail = NULL;
+        }
+        platform_mutex_unlock(&g_lock);
+        task->run(task->arg);
+        free(task);
+        platform_mutex_lock(&g_lock);
+    }
+    platform_mutex_unlock(&g_lock);
+}
+
+/**
+ * @brief Starts the workers if none is running. Workers only exit during
+ *        `executor_shutdown`, which holds the lifecycle lock until it has
+ *        joined them, so none is left to join here.
+ * @return false if not even one worker could be started.
+ */
+static bool start_pool(void) {
+    platform_mutex_lock(&g_lifecycle_lock);
+    if (g_worker_count == 0) {
+        unsigned wanted = configured_thread_count();
+        // Counted as live before they start, so a submission made meanwhile
+        // does not start a second pool.
+        platform_mutex_lock(&g_lock);
+        g_live_workers = wanted;
+        platform_mutex_unlock(&g_lock);
+        while (g_worker_count < wanted &&
+               platform_thread_create(&g_workers[g_worker_count], worker_main, NULL)) {
+            g_worker_count++;
+        }
+        platform_mutex_lock(&g_lock);
+        g_live_workers -= wanted - g_worker_count;
+        platform_mutex_unlock(&g_lock);
+        if (g_worker_count < wanted) {
+            logger_log_fmt(LOG_LEVEL_WARN, "EXECUTOR", "Started %u of %u worker threads.", g_worker_count, wanted);
+        }
+    }
+    bool running = g_worker_count > 0;
+    platform_mutex_unlock(&g_lifecycle_lock);
+    return running;
+}
+
+// --- Public API Implementation ---
+
+/**
+ * @see executor.h
+ */
+phStatus executor_submit(phTaskFn run, void* arg) {
+    if (!run) {
+        return ph_ERROR_INVALID_ARGS;
+    }
+    Task* task = (Task*)malloc(sizeof(Task));
+    if (!task) {
+        logger_log(LOG_LEVEL_ERROR, "EXECUTOR", "Out of memory submitting a task.");
+        return ph_ERROR_GENERAL;
+    }
+    task->run = run;
+    task->arg = arg;
+    task->next = NULL;
+
+    // Workers only exit once the queue is empty, so a task queued while one
+    // is live runs, even if the pool is being shut down; this is also what
+    // lets a task submit more work during the shutdown.
+    platform_mutex_lock(&g_lock);
+    while (g_live_workers == 0) {
+        platform_mutex_unlock(&g_lock);
+        if (!start_pool()) {
+            logger_log(LOG_LEVEL_ERROR, "EXECUTOR", "Could not start a worker thread.");
+            free(task);
+            return ph_ERROR_GENERAL;
+        }
+        platform_mutex_lock(&g_lock);
+    }
+    if (g_tail) {
+        g_tail->next = task;
+    } else {
+        g_head = task;
+    }
+    g_tail = task;
+    platform_cond_broadcast(&g_work);
+    platform_mutex_unlock(&g_lock);
+    return ph_SUCCESS;
+}
+
+/**
+ * @see executor.h
+ */
+unsigned executor_thread_count(void) {
+    platform_mutex_lock(&g_lifecycle_lock);
+    unsigned count = g_worker_count;
+    platform_mutex_unlock(&g_lifecycle_lock);
+    return count > 0 ? count : configured_thread_count();
+}
+
+/**
+ * @see executor.h
+ */
+void executor_shutdown(void) {
+    platform_mutex_lock(&g_lifecycle_lock);
+    platform_mutex_lock(&g_lock);
+    g_stopping = true;
+    platform_cond_broadcast(&g_work);
+    platform_mutex_unlock(&g_lock);
+
+    for (unsigned i = 0; i < g_worker_count; ++i) {
+        platform_thread_join(g_workers[i]);
+    }
+    g_worker_count = 0;
+
+    platform_mutex_lock(&g_lock);
+    g_stopping = false;
+    platform_mutex_unlock(&g_lock);
+    platform_mutex_unlock(&g_lifecycle_lock);
+}
@@ -0,0 +1,58 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * executor.h - The core's shared pool of worker threads.
+ *
+ * Modules used to bring their own thread pools: every Rust module that runs
+ * async code started a Tokio runtime with one worker per processor, so a
+ * process with several active modules ran several times more threads than
+ * there are processors. The core now owns a single pool, sized by the
+ * `core.worker_threads` configuration key (one thread per processor by
+ * default), and modules submit their blocking or CPU-bound work to it
+ * through `phCoreContext.submit_task`.
+ *
+ * The pool starts on the first submission, so a run that never uses it
+ * starts no thread. Tasks run in submission order, on whichever worker is
+ * free; a task must not wait for a task submitted after it, since all
+ * workers may be busy with tasks like itself.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include "../../ipc/include/ph_core_api.h" // For phStatus and phTaskFn
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The number of worker threads. Read when the pool starts.
+#define EXECUTOR_THREADS_KEY "core.worker_threads"
+#define EXECUTOR_MAX_THREADS 256
+
+/**
+ * @brief Queues `task(arg)` to run on a worker thread, starting the pool if
+ *        it is not running. Thread-safe.
+ * @return ph_SUCCESS, ph_ERROR_INVALID_ARGS if `task` is NULL, or
+ *         ph_ERROR_GENERAL if memory runs out or no worker can be started.
+ */
+phStatus executor_submit(phTaskFn task, void* arg);
+
+/**
+ * @brief Returns the number of worker threads: those running, or those the
+ *        pool would start now.
+ */
+unsigned executor_thread_count(void);
+
+/**
+ * @brief Runs the tasks still queued, including any they submit, then stops
+ *        the workers and waits for them. Must be called before the code of
+ *        any submitted task is unloaded, and not from a task. A later
+ *        submission starts the pool again.
+ */
+void executor_shutdown(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // EXECUTOR_H
@@ -18,14 +18,28 @@
  * - On Windows, it uses `LoadLibrary`, `GetProcAddress`, and `FreeLibrary` from
  * `<windows.h>`.
  *
- * A central private function, `ffi_call_rust_module`, encapsulates this platform-specific
- * logic. It takes the library name and the JSON payload as input, handles the
- * entire process of loading, symbol resolution, function execution, and error
- * reporting, and then unloads the library. This approach provides a high degree
- * of robustness and simplifies the public-facing API.
+ * Libraries are kept in a process-wide registry. The first call to a module
+ * loads its library and resolves its `invoke` symbol; later calls find both
+ * in the registry, so the library, and any Rust runtime it starts, is loaded
+ * once per process instead of once per call. The registry is a list that
+ * only grows until `ffi_shutdown`: lookups walk it without a lock, and only
+ * loading a new library takes the registry mutex. Each entry counts the
+ * references callers hold on it, so that shutdown never unloads a library
+ * whose code may still be running.
  *
- * Public functions like `ffi_call_preview_module` are thin wrappers around this
- * central function, providing a clean, command-specific entry point that the
+ * Requests are passed either as JSON strings, to `invoke`, or as binary
+ * payloads, to `invoke_buffer` when the module exports it. This file also
+ * builds the payloads: fields and strings are accumulated in growable arrays,
+ * then laid out in one block that the module reads in place.
+ *
+ * `ffi_call_async` runs a payload call on a thread of its own. The thread
+ * holds a reference to the library and ownership of the payload until the
+ * module returns; a mutex and a condition variable publish the status to
+ * whoever polls or waits, and the cancel token is a plain atomic flag that
+ * the module reads directly.
+ *
+ * Public functions like `ffi_call_preview_module` are thin wrappers around
+ * `ffi_call_module`, providing a clean, command-specific entry point that the
  * `cli_parser` can use without needing to know the underlying FFI implementation
  * details. This design is highly scalable for adding new Rust modules in the future.
  *
@@ -41,8 +55,11 @@
  */
 
 #include "rust_ffi.h"
+#include "platform/platform.h" // For the registry mutex
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Platform-specific includes for dynamic library loading.
 #ifdef _WIN32
@@ -54,87 +71,135 @@
 // Define the name of the exported function that all Rust modules must implement.
 // This standardization is the core of our FFI contract.
 #define RUST_FUNCTION_NAME "invoke"
+// The optional entry point of the binary payload ABI.
+#define RUST_BUFFER_FUNCTION_NAME "invoke_buffer"
+// The optional entry point of modules that support cancellation.
+#define RUST_CANCELLABLE_FUNCTION_NAME "invoke_cancellable"
 // Define the expected signature of the Rust function.
 typedef int (*rust_function_t)(const char *);
+typedef int (*rust_buffer_function_t)(const ph_buffer *);
+typedef int (*rust_cancellable_function_t)(const ph_buffer *,
+					   const ph_cancel_token *);
+
+#ifdef _WIN32
+typedef HINSTANCE library_handle_t;
+#else
+typedef void *library_handle_t;
+#endif
+
+/**
+ * @brief An entry of the registry. Entries are never moved or freed before
+ * `ffi_shutdown`, so callers may keep pointers to them.
+ */
+struct ffi_library {
+	char *name;
+	library_handle_t handle;
+	rust_function_t invoke;
+	rust_buffer_function_t invoke_buffer; // NULL if not exported.
+	rust_cancellable_function_t invoke_cancellable; // NULL if not exported.
+	atomic_int references;
+	struct ffi_library *next;
+};
+
+// The registry. Entries are pushed at the head with a release store, so a
+// reader that sees an entry also sees it fully initialized.
+static struct ffi_library *_Atomic g_libraries = NULL;
+// Serializes loading, so each library is loaded once.
+static platform_mutex_t g_registry_lock = PLATFORM_MUTEX_INIT;
 
 /**
- * @brief A generic, internal function to call any Rust module.
+ * @brief Loads a shared library and resolves its `invoke` function.
  *
  * @param library_name The name of the shared library file (e.g., "libk8s_preview.so").
- * @param json_config The JSON configuration string to pass to the Rust function.
- * @return An integer status code: 0 on success, non-zero on failure.
- *
- * Pre-conditions:
- * - `library_name` and `json_config` must be valid, null-terminated strings.
- *
- * Post-conditions:
- * - The specified Rust library is dynamically loaded, the `invoke` function is called,
- * and the library is then unloaded.
- * - Errors at any stage (loading, symbol resolution) are printed to stderr.
- *
- * This function encapsulates all platform-specific FFI logic, providing a single,
- * reliable implementation for interacting with our Rust modules.
+ * @param[out] handle Receives the library handle.
+ * @return The `invoke` function, or NULL if the library cannot be loaded or
+ * does not export it. Errors are printed to stderr.
  */
-static int ffi_call_rust_module(const char *library_name,
-				const char *json_config)
+static rust_function_t load_library(const char *library_name,
+				    library_handle_t *handle)
 {
 #ifdef _WIN32
 	// Windows-specific dynamic library loading logic.
-	HINSTANCE handle = LoadLibrary(library_name);
-	if (!handle)
+	*handle = LoadLibrary(library_name);
+	if (!*handle)
 	{
 		fprintf(stderr, "FFI Error: Could not load library %s. Error code: %lu\n",
 			library_name, GetLastError());
-		return -1;
+		return NULL;
 	}
 
 	rust_function_t rust_function =
-		(rust_function_t)GetProcAddress(handle, RUST_FUNCTION_NAME);
+		(rust_function_t)GetProcAddress(*handle, RUST_FUNCTION_NAME);
 	if (!rust_function)
 	{
 		fprintf(stderr,
 			"FFI Error: Could not find function '%s' in library %s. Error code: %lu\n",
 			RUST_FUNCTION_NAME, library_name, GetLastError());
-		FreeLibrary(handle);
-		return -1;
+		FreeLibrary(*handle);
+		return NULL;
 	}
 #else
 	// POSIX-specific dynamic library loading logic.
-	void *handle = dlopen(library_name, RTLD_LAZY);
-	if (!handle)
+	*handle = dlopen(library_name, RTLD_LAZY);
+	if (!*handle)
 	{
 		fprintf(stderr, "FFI Error: Could not load library %s. Reason: %s\n",
 			library_name, dlerror());
-		return -1;
+		return NULL;
 	}
 
 	// Clear any existing error conditions before calling dlsym.
 	dlerror();
 
 	rust_function_t rust_function =
-		(rust_function_t)dlsym(handle, RUST_FUNCTION_NAME);
+		(rust_function_t)dlsym(*handle, RUST_FUNCTION_NAME);
 	const char *dlsym_error = dlerror();
 	if (dlsym_error)
 	{
 		fprintf(stderr,
 			"FFI Error: Could not find function '%s' in library %s. Reason: %s\n",
 			RUST_FUNCTION_NAME, library_name, dlsym_error);
-		dlclose(handle);
-		return -1;
+		dlclose(*handle);
+		return NULL;
 	}
 #endif
+	return rust_function;
+}
 
-	// At this point, we have a valid function pointer. Execute the Rust code.
-	int status = rust_function(json_config);
+/**
+ * @brief Resolves an entry point a library may not export, without reporting
+ * its absence.
+ */
+static void *find_optional_symbol(library_handle_t handle, const char *name)
+{
+#ifdef _WIN32
+	return (void *)GetProcAddress(handle, name);
+#else
+	void *symbol = dlsym(handle, name);
+	dlerror();
+	return symbol;
+#endif
+}
 
-// Clean up: unload the library.
+static void unload_library(library_handle_t handle)
+{
 #ifdef _WIN32
 	FreeLibrary(handle);
 #else
 	dlclose(handle);
 #endif
+}
 
-	return status;
+/**
+ * @brief Looks a library up in the registry, without locking.
+ */
+static struct ffi_library *find_library(const char *library_name)
+{
+	struct ffi_library *library =
+		atomic_load_explicit(&g_libraries, memory_order_acquire);
+	while (library && strcmp(library->name, library_name) != 0)
+		library = library->next;
+	return library;
 }
 
 /*
@@ -146,23 +211,482 @@ static int ffi_call_rust_module(const char *library_name,
 /**
  * See header file `rust_ffi.h` for function documentation.
  */
-int ffi_call_preview_module(const char *json_config)
+ffi_library *ffi_library_acquire(const char *library_name)
+{
+	if (!library_name)
+		return NULL;
+
+	struct ffi_library *library = find_library(library_name);
+	if (!library)
+	{
+		platform_mutex_lock(&g_registry_lock);
+		// Another thread may have loaded it while we waited.
+		library = find_library(library_name);
+		if (!library)
+		{
+			library = calloc(1, sizeof(*library));
+			char *name = library ? strdup(library_name) : NULL;
+			if (!name)
+			{
+				fprintf(stderr, "FFI Error: Out of memory loading library %s.\n",
+					library_name);
+				free(library);
+				platform_mutex_unlock(&g_registry_lock);
+				return NULL;
+			}
+			library->invoke = load_library(library_name, &library->handle);
+			if (!library->invoke)
+			{
+				free(name);
+				free(library);
+				platform_mutex_unlock(&g_registry_lock);
+				return NULL;
+			}
+			library->invoke_buffer = (rust_buffer_function_t)find_optional_symbol(
+				library->handle, RUST_BUFFER_FUNCTION_NAME);
+			library->invoke_cancellable =
+				(rust_cancellable_function_t)find_optional_symbol(
+					library->handle,
+					RUST_CANCELLABLE_FUNCTION_NAME);
+			library->name = name;
+			atomic_init(&library->references, 0);
+			library->next = atomic_load_explicit(&g_libraries, memory_order_relaxed);
+			atomic_store_explicit(&g_libraries, library, memory_order_release);
+		}
+		platform_mutex_unlock(&g_registry_lock);
+	}
+	atomic_fetch_add_explicit(&library->references, 1, memory_order_relaxed);
+	return library;
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+int ffi_library_invoke(ffi_library *library, const char *json_config)
+{
+	return library->invoke(json_config);
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+void ffi_library_release(ffi_library *library)
+{
+	if (library)
+		atomic_fetch_sub_explicit(&library->references, 1, memory_order_release);
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+int ffi_call_module(const char *library_name, const char *json_config)
+{
+	ffi_library *library = ffi_library_acquire(library_name);
+	if (!library)
+		return -1;
+	int status = ffi_library_invoke(library, json_config);
+	ffi_library_release(library);
+	return status;
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+int ffi_library_invoke_buffer(ffi_library *library, const ph_buffer *payload)
 {
-	// Define platform-specific library names. The build system (e.g., Cargo, CMake)
-	// must produce artifacts with these names.
+	if (!library->invoke_buffer)
+	{
+		fprintf(stderr,
+			"FFI Error: Library %s does not export '%s'.\n",
+			library->name, RUST_BUFFER_FUNCTION_NAME);
+		return -1;
+	}
+	return library->invoke_buffer(payload);
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+int ffi_call_module_buffer(const char *library_name, const ph_buffer *payload)
+{
+	ffi_library *library = ffi_library_acquire(library_name);
+	if (!library)
+		return -1;
+	int status = ffi_library_invoke_buffer(library, payload);
+	ffi_library_release(library);
+	return status;
+}
+
+// Define platform-specific library names. The build system (e.g., Cargo, CMake)
+// must produce artifacts with these names.
 #ifdef _WIN32
-	const char *library_name = "k8s_preview.dll";
+#define PREVIEW_LIBRARY_NAME "k8s_preview.dll"
 #elif __APPLE__
-	const char *library_name = "libk8s_preview.dylib";
+#define PREVIEW_LIBRARY_NAME "libk8s_preview.dylib"
 #else
-	const char *library_name = "./libk8s_preview.so"; // Assuming the library is in the current directory for Linux.
+#define PREVIEW_LIBRARY_NAME "./libk8s_preview.so" // Assuming the library is in the current directory for Linux.
 #endif
 
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+int ffi_call_preview_module(const char *json_config)
+{
 	printf("C Core: Attempting to call Rust module '%s' via FFI.\n",
-	       library_name);
-	return ffi_call_rust_module(library_name, json_config);
+	       PREVIEW_LIBRARY_NAME);
+	return ffi_call_module(PREVIEW_LIBRARY_NAME, json_config);
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+int ffi_call_preview_module_buffer(const ph_buffer *payload)
+{
+	printf("C Core: Attempting to call Rust module '%s' via FFI.\n",
+	       PREVIEW_LIBRARY_NAME);
+	return ffi_call_module_buffer(PREVIEW_LIBRARY_NAME, payload);
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+void ffi_shutdown(void)
+{
+	platform_mutex_lock(&g_registry_lock);
+	struct ffi_library *library =
+		atomic_exchange_explicit(&g_libraries, NULL, memory_order_acquire);
+	while (library)
+	{
+		struct ffi_library *next = library->next;
+		int references = atomic_load_explicit(&library->references,
+						      memory_order_acquire);
+		if (references > 0)
+		{
+			// Its code may still be running: leave it loaded.
+			fprintf(stderr,
+				"FFI Warning: Library %s is still in use (%d references) at shutdown. Leaving it loaded.\n",
+				library->name, references);
+		}
+		else
+		{
+			unload_library(library->handle);
+			free(library->name);
+			free(library);
+		}
+		library = next;
+	}
+	platform_mutex_unlock(&g_registry_lock);
+}
+
+/*
+================================================================================
+ Binary Payloads
+================================================================================
+*/
+
+// Every part of a payload starts on this boundary.
+#define PAYLOAD_ALIGNMENT 8
+
+static size_t align_payload(size_t size)
+{
+	return (size + PAYLOAD_ALIGNMENT - 1) & ~(size_t)(PAYLOAD_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Grows an array to hold at least `needed` items.
+ * @return 0, or -1 if memory runs out, leaving the array as it was.
+ */
+static int reserve(void **items, size_t *capacity, size_t needed,
+		   size_t item_size)
+{
+	if (needed <= *capacity)
+		return 0;
+	size_t new_capacity = *capacity ? *capacity : 16;
+	while (new_capacity < needed)
+		new_capacity *= 2;
+	void *grown = realloc(*items, new_capacity * item_size);
+	if (!grown)
+		return -1;
+	*items = grown;
+	*capacity = new_capacity;
+	return 0;
+}
+
+static void add_field(ph_payload_builder *builder, uint16_t id, uint16_t type,
+		      uint32_t index, uint64_t value)
+{
+	if (builder->failed ||
+	    reserve((void **)&builder->fields, &builder->field_capacity,
+		    builder->field_count + 1, sizeof(ph_payload_field)) != 0)
+	{
+		builder->failed = 1;
+		return;
+	}
+	ph_payload_field *field = &builder->fields[builder->field_count++];
+	field->id = id;
+	field->type = type;
+	field->index = index;
+	field->value = value;
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+void ph_buffer_free(ph_buffer *buffer)
+{
+	if (!buffer)
+		return;
+	if (buffer->free_fn)
+		buffer->free_fn(buffer->owner);
+	memset(buffer, 0, sizeof(*buffer));
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+void ph_payload_init(ph_payload_builder *builder, uint16_t schema)
+{
+	memset(builder, 0, sizeof(*builder));
+	builder->schema = schema;
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+void ph_payload_add_u64(ph_payload_builder *builder, uint16_t id,
+			uint32_t index, uint64_t value)
+{
+	add_field(builder, id, PH_FIELD_U64, index, value);
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+void ph_payload_add_string(ph_payload_builder *builder, uint16_t id,
+			   uint32_t index, const char *value)
+{
+	if (!value || builder->failed)
+		return;
+	size_t length = strlen(value);
+	size_t offset = builder->strings_size;
+	if (length >= UINT32_MAX - offset ||
+	    reserve((void **)&builder->strings, &builder->strings_capacity,
+		    offset + length + 1, 1) != 0)
+	{
+		builder->failed = 1;
+		return;
+	}
+	memcpy(builder->strings + offset, value, length + 1);
+	builder->strings_size += length + 1;
+	add_field(builder, id, PH_FIELD_STRING, index,
+		  (uint64_t)offset | (uint64_t)length << 32);
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+int ph_payload_finish(ph_payload_builder *builder, ph_buffer *buffer)
+{
+	memset(buffer, 0, sizeof(*buffer));
+	size_t strings_offset = sizeof(ph_payload_header) +
+				builder->field_count * sizeof(ph_payload_field);
+	size_t size = align_payload(strings_offset + builder->strings_size);
+	uint8_t *data = builder->failed || size > UINT32_MAX ? NULL : malloc(size);
+	if (!data)
+	{
+		ph_payload_discard(builder);
+		return -1;
+	}
+
+	ph_payload_header header = {
+		.magic = PH_PAYLOAD_MAGIC,
+		.version = PH_PAYLOAD_VERSION,
+		.schema = builder->schema,
+		.size = (uint32_t)size,
+		.field_count = (uint32_t)builder->field_count,
+		.strings_offset = (uint32_t)strings_offset,
+		.strings_size = (uint32_t)builder->strings_size,
+	};
+	memcpy(data, &header, sizeof(header));
+	if (builder->field_count)
+		memcpy(data + sizeof(header), builder->fields,
+		       builder->field_count * sizeof(ph_payload_field));
+	if (builder->strings_size)
+		memcpy(data + strings_offset, builder->strings,
+		       builder->strings_size);
+	// Zero the padding, so that no uninitialized byte crosses the boundary.
+	memset(data + strings_offset + builder->strings_size, 0,
+	       size - strings_offset - builder->strings_size);
+
+	buffer->data = data;
+	buffer->size = size;
+	buffer->free_fn = free;
+	buffer->owner = data;
+	ph_payload_discard(builder);
+	return 0;
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+void ph_payload_discard(ph_payload_builder *builder)
+{
+	uint16_t schema = builder->schema;
+	free(builder->fields);
+	free(builder->strings);
+	ph_payload_init(builder, schema);
+}
+
+/*
+================================================================================
+ Asynchronous Calls
+================================================================================
+*/
+
+struct ffi_call {
+	ffi_library *library; // Referenced until the module returns.
+	ph_buffer payload;
+	ph_cancel_token cancel;
+	ffi_completion_fn on_complete;
+	void *user_data;
+	platform_thread_t thread;
+	platform_mutex_t lock; // Guards `done` and `status`.
+	platform_cond_t finished;
+	int done;
+	int status;
+};
+
+static void call_main(void *arg)
+{
+	ffi_call *call = arg;
+	ffi_library *library = call->library;
+	int status = library->invoke_cancellable ?
+			     library->invoke_cancellable(&call->payload,
+							 &call->cancel) :
+			     library->invoke_buffer(&call->payload);
+	ph_buffer_free(&call->payload);
+	ffi_library_release(library);
+
+	if (call->on_complete)
+		call->on_complete(call, status, call->user_data);
+
+	platform_mutex_lock(&call->lock);
+	call->status = status;
+	call->done = 1;
+	platform_cond_broadcast(&call->finished);
+	platform_mutex_unlock(&call->lock);
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+ffi_call *ffi_call_async(const char *library_name, ph_buffer *payload,
+			 ffi_completion_fn on_complete, void *user_data)
+{
+	if (!payload)
+		return NULL;
+	ph_buffer request = *payload;
+	memset(payload, 0, sizeof(*payload));
+
+	ffi_library *library = ffi_library_acquire(library_name);
+	if (library && !library->invoke_buffer && !library->invoke_cancellable)
+	{
+		fprintf(stderr,
+			"FFI Error: Library %s exports neither '%s' nor '%s'.\n",
+			library->name, RUST_BUFFER_FUNCTION_NAME,
+			RUST_CANCELLABLE_FUNCTION_NAME);
+		ffi_library_release(library);
+		library = NULL;
+	}
+	ffi_call *call = library ? calloc(1, sizeof(*call)) : NULL;
+	if (!call)
+	{
+		if (library)
+			fprintf(stderr, "FFI Error: Out of memory calling %s.\n",
+				library_name);
+		ffi_library_release(library);
+		ph_buffer_free(&request);
+		return NULL;
+	}
+
+	call->library = library;
+	call->payload = request;
+	atomic_init(&call->cancel.cancelled, 0);
+	call->on_complete = on_complete;
+	call->user_data = user_data;
+	call->lock = (platform_mutex_t)PLATFORM_MUTEX_INIT;
+	call->finished = (platform_cond_t)PLATFORM_COND_INIT;
+	if (!platform_thread_create(&call->thread, call_main, call))
+	{
+		fprintf(stderr, "FFI Error: Could not start a thread to call %s.\n",
+			library_name);
+		ffi_library_release(library);
+		ph_buffer_free(&call->payload);
+		platform_cond_destroy(&call->finished);
+		platform_mutex_destroy(&call->lock);
+		free(call);
+		return NULL;
+	}
+	return call;
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+int ffi_call_poll(ffi_call *call, int *status)
+{
+	return ffi_call_wait(call, 0, status);
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+int ffi_call_wait(ffi_call *call, int timeout_ms, int *status)
+{
+	uint64_t deadline = platform_monotonic_ns() +
+			    (uint64_t)(timeout_ms > 0 ? timeout_ms : 0) * 1000000u;
+	platform_mutex_lock(&call->lock);
+	while (!call->done && timeout_ms != 0)
+	{
+		int remaining_ms = -1;
+		if (timeout_ms > 0)
+		{
+			uint64_t now = platform_monotonic_ns();
+			if (now >= deadline)
+				break;
+			// Round up, so as not to wake just before the deadline.
+			remaining_ms = (int)((deadline - now + 999999u) / 1000000u);
+		}
+		platform_cond_wait(&call->finished, &call->lock, remaining_ms);
+	}
+	int done = call->done;
+	if (done && status)
+		*status = call->status;
+	platform_mutex_unlock(&call->lock);
+	return done;
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+void ffi_call_cancel(ffi_call *call)
+{
+	atomic_store_explicit(&call->cancel.cancelled, 1, memory_order_release);
+}
+
+/**
+ * See header file `rust_ffi.h` for function documentation.
+ */
+void ffi_call_release(ffi_call *call)
+{
+	if (!call)
+		return;
+	platform_thread_join(call->thread);
+	platform_cond_destroy(&call->finished);
+	platform_mutex_destroy(&call->lock);
+	free(call);
 }
 
 // Implementations for other modules like `ffi_call_release_module` would follow
 // the exact same pattern, just specifying a different library name. This demonstrates
-// the scalability of the FFI design.
\ No newline at end of file
+// the scalability of the FFI design.
@@ -30,6 +30,7 @@
 #ifndef RUST_FFI_H
 #define RUST_FFI_H
 
+#include <stddef.h> // For size_t
 #include <stdint.h> // Required for fixed-width integer types like int32_t
 
 // --- FFI Function Prototypes ---
@@ -71,6 +72,347 @@ void rust_hello_world(void);
  */
 int32_t run_policy_check(const char *policy_path, const char *manifest_path);
 
+// --- Dynamically Loaded Rust Modules ---
+
+/**
+ * @brief A Rust module library loaded through the FFI registry.
+ *
+ * Rust modules built as separate shared libraries export an entry point,
+ * `int invoke(const char *json_config)`, and optionally `invoke_buffer` (see
+ * the binary payload ABI below). The registry loads each library once per
+ * process, resolves its entry points once, and keeps them until
+ * `ffi_shutdown`, so a call costs a lookup rather than a full load and unload
+ * of the library and of any Rust runtime it starts. The registry is thread-safe.
+ */
+typedef struct ffi_library ffi_library;
+
+/**
+ * @brief Finds a library in the registry, loading it on first use, and takes
+ * a reference to it.
+ *
+ * @param library_name The shared library to load, as given to dlopen/LoadLibrary.
+ * @return The library, to pass to `ffi_library_invoke` and then release with
+ * `ffi_library_release`, or NULL if it cannot be loaded or does not export
+ * `invoke` (the reason is printed to stderr).
+ */
+ffi_library *ffi_library_acquire(const char *library_name);
+
+/**
+ * @brief Calls a library's `invoke` function. Several threads may call it at
+ * once, on the same library or different ones.
+ *
+ * @return The status returned by the Rust module.
+ */
+int ffi_library_invoke(ffi_library *library, const char *json_config);
+
+/**
+ * @brief Releases a reference taken by `ffi_library_acquire`. The library
+ * stays loaded for later calls.
+ */
+void ffi_library_release(ffi_library *library);
+
+/**
+ * @brief Loads a library if needed and calls its `invoke` function once.
+ *
+ * @return The status returned by the Rust module, or -1 if the library cannot
+ * be loaded.
+ */
+int ffi_call_module(const char *library_name, const char *json_config);
+
+/**
+ * @brief Calls the `k8s_preview` Rust module.
+ *
+ * @param json_config The preview request, as JSON.
+ * @return The module's status, or -1 if the module cannot be loaded.
+ */
+int ffi_call_preview_module(const char *json_config);
+
+/**
+ * @brief Unloads every library of the registry. Must be called once at
+ * application shutdown, when no FFI call is running anymore.
+ *
+ * A library still referenced is reported and left loaded, since a caller may
+ * still be running its code.
+ */
+void ffi_shutdown(void);
+
+// --- Binary Payload ABI (Generation 2) ---
+
+/*
+ * The first generation of the ABI passes every request as a JSON string, which
+ * the caller formats and the module parses on every call. The second passes a
+ * payload: a flat, length-prefixed, schema-versioned binary buffer that the
+ * module reads in place, with no parsing and no copy. Both generations are
+ * supported; a module opts into the second by exporting
+ * `int invoke_buffer(const ph_buffer *payload)` next to `invoke`.
+ *
+ * A payload is laid out as follows, in native byte order (the caller and the
+ * module run in the same process), every part aligned to 8 bytes:
+ * - A `ph_payload_header`, whose `size` is the length of the whole payload.
+ * - `field_count` `ph_payload_field` records.
+ * - A string area: the strings of the fields, each followed by a NUL.
+ *
+ * A field is identified by its schema-specific `id`. A repeated field (a list
+ * or map) has one record per element, numbered by `index`; a field that is
+ * absent has no record. A module must reject a payload whose magic, version,
+ * schema or sizes it does not expect, and ignore fields it does not know, so
+ * that fields can be added without a new version.
+ */
+
+#define PH_PAYLOAD_MAGIC 0x4C504850u // "PHPL" read as a little-endian word.
+#define PH_PAYLOAD_VERSION 1
+
+/**
+ * @brief Who a payload is for, and so what its field ids mean.
+ */
+typedef enum {
+	PH_SCHEMA_PREVIEW = 1, // k8s_preview: PH_PREVIEW_* fields.
+	PH_SCHEMA_MULTI_CLUSTER = 2, // multi_cluster_orchestrator: PH_MULTI_CLUSTER_* fields.
+} ph_payload_schema;
+
+/**
+ * @brief The type of a field's value.
+ */
+typedef enum {
+	PH_FIELD_U64 = 1, // `value` is the value.
+	PH_FIELD_STRING = 2, // `value` holds the string's offset in the string area
+			     // (low 32 bits) and its length without the NUL (high 32 bits).
+} ph_payload_field_type;
+
+// Fields of PH_SCHEMA_PREVIEW, the JSON `PreviewConfig`.
+enum {
+	PH_PREVIEW_ACTION = 1, // U64: 0 to create, 1 to destroy.
+	PH_PREVIEW_PR_NUMBER = 2, // U64.
+	PH_PREVIEW_GIT_REPO_URL = 3, // String.
+	PH_PREVIEW_COMMIT_SHA = 4, // String.
+	PH_PREVIEW_KUBECONFIG_PATH = 5, // String, optional.
+};
+
+// Fields of PH_SCHEMA_MULTI_CLUSTER, the JSON `MultiClusterConfig`.
+enum {
+	PH_MULTI_CLUSTER_CLUSTER_NAME = 1, // String, repeated: keys of `cluster_configs`.
+	PH_MULTI_CLUSTER_KUBECONFIG = 2, // String, repeated: the value of the same index.
+	PH_MULTI_CLUSTER_TARGET = 3, // String, repeated: names of `targets`.
+	PH_MULTI_CLUSTER_ACTION = 4, // U64: 0 to apply, 1 for status.
+	PH_MULTI_CLUSTER_MANIFESTS = 5, // String: for apply.
+	PH_MULTI_CLUSTER_KIND = 6, // String: for status.
+	PH_MULTI_CLUSTER_NAME = 7, // String: for status.
+	PH_MULTI_CLUSTER_NAMESPACE = 8, // String: for status, optional.
+};
+
+/**
+ * @brief The first bytes of a payload.
+ */
+typedef struct {
+	uint32_t magic; // PH_PAYLOAD_MAGIC.
+	uint16_t version; // PH_PAYLOAD_VERSION.
+	uint16_t schema; // A ph_payload_schema.
+	uint32_t size; // Of the whole payload, header included.
+	uint32_t field_count;
+	uint32_t strings_offset; // From the start of the payload.
+	uint32_t strings_size;
+} ph_payload_header;
+
+/**
+ * @brief One value of a payload.
+ */
+typedef struct {
+	uint16_t id;
+	uint16_t type; // A ph_payload_field_type.
+	uint32_t index; // Element of a repeated field, 0 otherwise.
+	uint64_t value;
+} ph_payload_field;
+
+/**
+ * @brief A block of bytes and how to free it.
+ *
+ * Whoever holds a buffer frees it with `ph_buffer_free`, which calls
+ * `free_fn(owner)`, so a buffer can cross the FFI boundary in either
+ * direction without the receiver knowing which allocator made it. A module
+ * called with a payload only borrows it for the duration of the call.
+ */
+typedef struct ph_buffer {
+	const uint8_t *data;
+	size_t size;
+	void (*free_fn)(void *owner); // NULL if the buffer owns nothing.
+	void *owner;
+} ph_buffer;
+
+/**
+ * @brief Frees a buffer through its callback and empties it. Accepts NULL and
+ * empty buffers.
+ */
+void ph_buffer_free(ph_buffer *buffer);
+
+/**
+ * @brief Builds a payload field by field.
+ *
+ * Adding a field never fails by itself: a failure (out of memory, payload over
+ * 4 GiB) is remembered and reported by `ph_payload_finish`, so a request can
+ * be built without checking every call.
+ */
+typedef struct {
+	uint16_t schema;
+	ph_payload_field *fields;
+	size_t field_count;
+	size_t field_capacity;
+	char *strings;
+	size_t strings_size;
+	size_t strings_capacity;
+	int failed;
+} ph_payload_builder;
+
+/**
+ * @brief Starts a payload for the given schema.
+ */
+void ph_payload_init(ph_payload_builder *builder, uint16_t schema);
+
+/**
+ * @brief Adds an integer field.
+ * @param index The element of a repeated field, 0 otherwise.
+ */
+void ph_payload_add_u64(ph_payload_builder *builder, uint16_t id,
+			uint32_t index, uint64_t value);
+
+/**
+ * @brief Adds a string field. The string is copied. A NULL string adds nothing,
+ * which is how an optional field is left out.
+ */
+void ph_payload_add_string(ph_payload_builder *builder, uint16_t id,
+			   uint32_t index, const char *value);
+
+/**
+ * @brief Lays the payload out in a single block and resets the builder.
+ *
+ * @param[out] buffer Receives the payload, to free with `ph_buffer_free`.
+ * @return 0 on success, -1 if a field could not be added or memory runs out,
+ * in which case `buffer` is empty.
+ */
+int ph_payload_finish(ph_payload_builder *builder, ph_buffer *buffer);
+
+/**
+ * @brief Frees a builder that will not be finished.
+ */
+void ph_payload_discard(ph_payload_builder *builder);
+
+/**
+ * @brief Calls a library's `invoke_buffer` function with a payload, which the
+ * module borrows for the duration of the call.
+ *
+ * @return The status returned by the Rust module, or -1 if the library does
+ * not export `invoke_buffer`.
+ */
+int ffi_library_invoke_buffer(ffi_library *library, const ph_buffer *payload);
+
+/**
+ * @brief Loads a library if needed and calls its `invoke_buffer` function once.
+ *
+ * @return The status returned by the Rust module, or -1 if the library cannot
+ * be loaded or does not export `invoke_buffer`.
+ */
+int ffi_call_module_buffer(const char *library_name, const ph_buffer *payload);
+
+/**
+ * @brief Calls the `k8s_preview` Rust module with a PH_SCHEMA_PREVIEW payload.
+ *
+ * @return The module's status, or -1 if the module cannot be loaded.
+ */
+int ffi_call_preview_module_buffer(const ph_buffer *payload);
+
+// --- Asynchronous Calls ---
+
+/*
+ * A module call can take minutes (provisioning a preview environment, rolling
+ * out to many clusters). `ffi_call_async` runs it on a thread of its own and
+ * returns at once with a handle, which can be polled, waited on with a
+ * timeout, and cancelled, so one core process can run several module calls
+ * at a time.
+ *
+ * Cancellation is cooperative. The core sets the call's cancel token, and a
+ * module that exports
+ * `int invoke_cancellable(const ph_buffer *payload, const ph_cancel_token *cancel)`
+ * checks it while it works and returns PH_STATUS_CANCELLED once it has
+ * stopped. A module that only exports `invoke_buffer` ignores the token and
+ * runs to completion.
+ */
+
+// Returned by a module that stopped because its call was cancelled. Outside
+// the range modules use for their own errors.
+#define PH_STATUS_CANCELLED (-125)
+
+/**
+ * @brief Tells a running module that its call was cancelled.
+ *
+ * `cancelled` goes from 0 to 1, once; a module reads it atomically (it is an
+ * `AtomicI32` on the Rust side) and may poll it as often as it likes.
+ */
+typedef struct {
+	_Atomic int32_t cancelled;
+} ph_cancel_token;
+
+/**
+ * @brief A module call running on its own thread.
+ */
+typedef struct ffi_call ffi_call;
+
+/**
+ * @brief Called when a module call returns, on the call's thread, with the
+ * module's status and the `user_data` given to `ffi_call_async`. The call is
+ * reported as done, and waiters are woken, only after it returns.
+ */
+typedef void (*ffi_completion_fn)(ffi_call *call, int status, void *user_data);
+
+/**
+ * @brief Starts a module call on a new thread and returns at once.
+ *
+ * The library is loaded if needed. The module is called with
+ * `invoke_cancellable` if it exports it, `invoke_buffer` otherwise.
+ *
+ * @param library_name The shared library to call, as for `ffi_library_acquire`.
+ * @param payload The request. The call takes ownership of it, whether it
+ * starts or not, and frees it once the module returns; `*payload` is emptied.
+ * @param on_complete Called when the module returns. May be NULL.
+ * @return The call, to release with `ffi_call_release`, or NULL if `payload`
+ * is NULL, the library cannot be loaded, exports neither entry point, or no
+ * thread can be started. `on_complete` is not called then.
+ */
+ffi_call *ffi_call_async(const char *library_name, ph_buffer *payload,
+			 ffi_completion_fn on_complete, void *user_data);
+
+/**
+ * @brief Checks whether a call is done, without waiting.
+ *
+ * @param[out] status Receives the module's status if the call is done. May
+ * be NULL.
+ * @return 1 if the call is done, 0 if it is still running.
+ */
+int ffi_call_poll(ffi_call *call, int *status);
+
+/**
+ * @brief Waits for a call to be done.
+ *
+ * @param timeout_ms The longest wait, 0 to poll, or a negative value to wait
+ * as long as necessary.
+ * @param[out] status Receives the module's status if the call is done. May
+ * be NULL.
+ * @return 1 if the call is done, 0 if the timeout expired first.
+ */
+int ffi_call_wait(ffi_call *call, int timeout_ms, int *status);
+
+/**
+ * @brief Asks a call to stop, by setting its cancel token. Returns at once;
+ * wait for the call to learn when, and with what status, the module stopped.
+ */
+void ffi_call_cancel(ffi_call *call);
+
+/**
+ * @brief Waits for a call to be done if it is not, then frees it.
+ *
+ * To abandon a call, cancel it first. Every call must be released before
+ * `ffi_shutdown`.
+ */
+void ffi_call_release(ffi_call *call);
+
 // Add other Rust FFI function declarations here as the application grows.
 // For example:
 // int32_t git_ops_sync(const char *repo_url, const char *local_path);
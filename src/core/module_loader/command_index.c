@@ -0,0 +1,171 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * command_index.c - Implementation of the command index.
+ *
+ * See command_index.h. Slots store the full hash of their name, so a probe
+ * compares strings only on a 64-bit hash match, and growing the index
+ * never hashes a name again. Removal shifts the commands that follow back
+ * ("backward shift deletion"), so no tombstones are needed. Names are
+ * hashed with the configuration table's hash.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "command_index.h"
+#include "config/config_table.h" // For config_table_hash
+#include <stdlib.h>
+#include <string.h>
+
+// --- Module-level static variables ---
+
+typedef struct {
+    uint64_t hash;
+    char* name;             // NULL for an empty slot.
+    CommandHandler handler;
+} IndexSlot;
+
+#define MIN_CAPACITY 64
+
+static IndexSlot* g_slots = NULL;
+static size_t g_capacity = 0;   // A power of two, or 0.
+static size_t g_count = 0;
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Probes for a name in a slot array.
+ * @return The slot holding the name, or the empty slot where it belongs.
+ */
+static size_t probe(const IndexSlot* slots, size_t capacity, const char* name, uint64_t hash) {
+    size_t mask = capacity - 1;
+    size_t slot = (size_t)hash & mask;
+    while (slots[slot].name &&
+           (slots[slot].hash != hash || strcmp(slots[slot].name, name) != 0)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Moves the commands into an array of `capacity` slots.
+ * @return ph_SUCCESS, or ph_ERROR_GENERAL on allocation failure (the index
+ *         is then unchanged).
+ */
+static phStatus resize(size_t capacity) {
+    IndexSlot* slots = (IndexSlot*)calloc(capacity, sizeof(IndexSlot));
+    if (!slots) {
+        return ph_ERROR_GENERAL;
+    }
+    for (size_t i = 0; i < g_capacity; ++i) {
+        if (g_slots[i].name) {
+            slots[probe(slots, capacity, g_slots[i].name, g_slots[i].hash)] = g_slots[i];
+        }
+    }
+    free(g_slots);
+    g_slots = slots;
+    g_capacity = capacity;
+    return ph_SUCCESS;
+}
+
+/**
+ * @brief Empties a slot, then shifts back the commands after it that probed
+ * past it, so that no probe sequence is cut short.
+ */
+static void remove_slot(size_t hole) {
+    size_t mask = g_capacity - 1;
+    free(g_slots[hole].name);
+    g_slots[hole].name = NULL;
+    g_count--;
+    for (size_t next = (hole + 1) & mask; g_slots[next].name; next = (next + 1) & mask) {
+        // A command can fill the hole if its home slot is not in (hole, next].
+        size_t home = (size_t)g_slots[next].hash & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            g_slots[hole] = g_slots[next];
+            g_slots[next].name = NULL;
+            hole = next;
+        }
+    }
+}
+
+// --- Public API Implementation ---
+
+/**
+ * @see command_index.h
+ */
+phStatus command_index_add(const char* name, const CommandHandler* handler) {
+    if (!name || !handler) {
+        return ph_ERROR_INVALID_ARGS;
+    }
+    // Keep the index at most half full, so probes stay short.
+    if ((g_count + 1) * 2 > g_capacity &&
+        resize(g_capacity ? g_capacity * 2 : MIN_CAPACITY) != ph_SUCCESS) {
+        return ph_ERROR_GENERAL;
+    }
+
+    uint64_t hash = config_table_hash(name, strlen(name));
+    IndexSlot* slot = &g_slots[probe(g_slots, g_capacity, name, hash)];
+    if (slot->name) {
+        return ph_ERROR_INVALID_ARGS;
+    }
+    slot->name = strdup(name);
+    if (!slot->name) {
+        return ph_ERROR_GENERAL;
+    }
+    slot->hash = hash;
+    slot->handler = *handler;
+    g_count++;
+    return ph_SUCCESS;
+}
+
+/**
+ * @see command_index.h
+ */
+const CommandHandler* command_index_find(const char* name) {
+    if (!name || g_count == 0) {
+        return NULL;
+    }
+    const IndexSlot* slot = &g_slots[probe(g_slots, g_capacity, name, config_table_hash(name, strlen(name)))];
+    return slot->name ? &slot->handler : NULL;
+}
+
+/**
+ * @see command_index.h
+ */
+size_t command_index_count(void) {
+    return g_count;
+}
+
+/**
+ * @see command_index.h
+ */
+void command_index_remove_kind(CommandHandlerKind kind) {
+    if (g_count == 0) {
+        return;
+    }
+    // Scan from an empty slot, which the index being at most half full
+    // guarantees: no probe sequence runs across it, so the commands that
+    // removals shift back all land in slots not yet scanned or rescanned.
+    size_t mask = g_capacity - 1;
+    size_t start = 0;
+    while (g_slots[start].name) {
+        start++;
+    }
+    for (size_t n = 1; n <= g_capacity; ++n) {
+        size_t i = (start + n) & mask;
+        // Removing shifts another command into the slot: look at it again.
+        while (g_slots[i].name && g_slots[i].handler.kind == kind) {
+            remove_slot(i);
+        }
+    }
+}
+
+/**
+ * @see command_index.h
+ */
+void command_index_cleanup(void) {
+    for (size_t i = 0; i < g_capacity; ++i) {
+        free(g_slots[i].name);
+    }
+    free(g_slots);
+    g_slots = NULL;
+    g_capacity = 0;
+    g_count = 0;
+}
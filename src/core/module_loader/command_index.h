@@ -0,0 +1,86 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * command_index.h - Index of every command the application can run.
+ *
+ * Commands come from two places: native modules list theirs in
+ * `phModuleInfo.commands`, and Lua plugins register theirs with
+ * `ph.register_command`. This index maps a command name to whichever of
+ * them handles it, so dispatching a command is one hash and, almost always,
+ * one probe, whatever the number of modules and plugins.
+ *
+ * The index is an open-addressing table with linear probing, kept at most
+ * half full. It is filled incrementally: the loader adds a module's commands
+ * as the module is loaded, and the Lua bridge adds a command as a script
+ * registers it, so the index is always complete and never rebuilt from
+ * scratch. A name is handled by one handler only; the first to register it
+ * keeps it.
+ *
+ * The index is not thread-safe. Like the loader and the Lua bridge, it
+ * belongs to the main thread.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef COMMAND_INDEX_H
+#define COMMAND_INDEX_H
+
+#include "loader.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @enum CommandHandlerKind
+ * @brief Where a command is implemented.
+ */
+typedef enum {
+    COMMAND_HANDLER_NATIVE, // By a loaded module.
+    COMMAND_HANDLER_LUA     // By a function of a Lua plugin.
+} CommandHandlerKind;
+
+/**
+ * @struct CommandHandler
+ * @brief The handler of a command.
+ */
+typedef struct {
+    CommandHandlerKind kind;
+    const LoadedModule* module; // For COMMAND_HANDLER_NATIVE.
+    size_t lua_command;         // For COMMAND_HANDLER_LUA: the Lua bridge's registry index.
+} CommandHandler;
+
+/**
+ * @brief Adds a command to the index. The name is copied.
+ * @return ph_SUCCESS, ph_ERROR_INVALID_ARGS if the name is NULL or already
+ *         indexed (the existing handler is kept), or ph_ERROR_GENERAL on
+ *         allocation failure.
+ */
+phStatus command_index_add(const char* name, const CommandHandler* handler);
+
+/**
+ * @brief Looks a command up.
+ * @return Its handler, or NULL if no handler has registered it. The pointer
+ *         is valid until the index is next modified.
+ */
+const CommandHandler* command_index_find(const char* name);
+
+/**
+ * @brief Returns the number of commands indexed.
+ */
+size_t command_index_count(void);
+
+/**
+ * @brief Removes every command of one kind, as when the modules are unloaded
+ * or the Lua bridge shut down.
+ */
+void command_index_remove_kind(CommandHandlerKind kind);
+
+/**
+ * @brief Empties the index and frees its memory.
+ */
+void command_index_cleanup(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // COMMAND_INDEX_H
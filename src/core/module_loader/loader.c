@@ -8,24 +8,51 @@
  * buffer, replacing it with calls to a variadic logging function `logger_log_fmt`
  * to dynamically allocate memory for log messages and prevent buffer overflows.
  *
- * The process for loading a module is as follows:
- * 1. Scan the specified directory for files with the correct extension.
- * 2. Attempt to load the file as a shared library.
- * 3. Resolve pointers to the five required functions defined in the API contract.
- * 4. If any function is missing, the module is invalid and rejected.
- * 5. Call the module's `module_get_info` to learn about it.
- * 6. Create a core context and call the module's `module_init` function.
- * 7. If initialization succeeds, the module is added to a global registry.
+ * The process for loading modules is as follows:
+ * 1. Scan the specified directory for files with the correct extension, and
+ *    sort them by name.
+ * 2. Look each file up in the module manifest (see module_manifest.h). A
+ *    file with the stamp recorded there is known without being opened.
+ * 3. Attempt to load each other file as a shared library.
+ * 4. Resolve pointers to the required functions defined in the API contract,
+ *    and to the optional `module_get_dependencies`.
+ * 5. If any required function is missing, the module is invalid and rejected.
+ * 6. Call the module's `module_get_info` to learn about it, and record it
+ *    in the manifest.
+ * 7. Add the module to a global registry, and its commands to the command
+ *    index (see command_index.h).
+ * 8. When a command is first looked up, open its module if needed, create a
+ *    core context and call the module's `module_init` function, after that
+ *    of its dependencies.
+ *
+ * Steps 3 to 6 run for all stale files at once, on several threads. So a
+ * run opens only the libraries that changed since the last one and the
+ * module of the command it executes; with an up-to-date manifest, startup
+ * costs one stat per module.
+ *
+ * With `modules.lazy_init` set to false, every file is opened in step 3 and
+ * step 8 runs for all modules before step 7, in waves: each wave
+ * initializes, concurrently, the modules whose dependencies the previous
+ * waves initialized. Rust modules start their async runtimes in
+ * `module_init`, so startup then takes about as long as the slowest chain
+ * of dependent inits rather than the sum of all of them. Step 7 runs on
+ * the calling thread, in file name order, so the registry is the same from
+ * one run to the next. Each module's init time is logged.
  *
  * SPDX-License-Identifier: Apache-2.0 */
 
 #include "loader.h"
+#include "command_index.h"          // For dispatching commands in one probe
+#include "module_manifest.h"        // For knowing modules without opening them
 #include "platform/platform.h"      // For MODULE_EXTENSION
 #include "config/config_manager.h"  // For providing config access to modules
+#include "executor/executor.h"      // For sharing the worker pool with modules
 #include "libs/liblogger/Logger.hpp"  // For logging loading process
+#include "libs/liblogger/StartupTrace.hpp" // For timing each module at startup
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdatomic.h>
 
 // Platform-specific includes for dynamic loading and directory traversal
 #ifdef PLATFORM_WINDOWS
@@ -45,6 +72,9 @@ static int g_module_capacity = 0;
 // The context passed to modules, containing pointers to core functions.
 static phCoreContext g_core_context;
 
+// The manifest read at load time; modules known from it point into it.
+static ModuleManifest g_manifest;
+
 
 // --- Private Helper Functions ---
 
@@ -67,6 +97,33 @@ static phStatus add_module_to_registry(LoadedModule* module) {
     return ph_SUCCESS;
 }
 
+/**
+ * @brief Adds a module's commands to the command index. A command already
+ *        handled by an earlier module or a Lua plugin stays with it.
+ */
+static void index_module_commands(const LoadedModule* module) {
+    CommandHandler handler = {COMMAND_HANDLER_NATIVE, module, 0};
+    for (const char** cmd_ptr = module->info.commands; cmd_ptr && *cmd_ptr; cmd_ptr++) {
+        phStatus status = command_index_add(*cmd_ptr, &handler);
+        if (status == ph_ERROR_INVALID_ARGS) {
+            logger_log_fmt(LOG_LEVEL_WARN, "LOADER", "Command '%s' of module '%s' is already handled. Ignoring it.",
+                           *cmd_ptr, module->info.name);
+        } else if (status != ph_SUCCESS) {
+            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Failed to index command '%s' of module '%s'.",
+                           *cmd_ptr, module->info.name);
+        }
+    }
+}
+
+/**
+ * @brief `phCoreContext.free_config_value`: frees a copy returned by
+ *        `get_config_value` with the core's allocator, which may not be the
+ *        module's.
+ */
+static void free_config_value(char* value) {
+    free(value);
+}
+
 /**
  * @brief Frees all memory associated with a LoadedModule struct.
  */
@@ -78,24 +135,178 @@ static void free_loaded_module(LoadedModule* module) {
     free(module);
 }
 
-// --- Public API Implementation ---
+// --- Library Access ---
 
 /**
- * @see loader.h
+ * @brief The functions a module exports, as resolved from its library.
  */
-phStatus modules_load(const char* directory_path) {
-    // NOTE: The fixed-size `log_buffer` has been removed to prevent buffer overflows.
-    // We now use `logger_log_fmt` for safe, dynamically-sized log messages.
-    logger_log_fmt(LOG_LEVEL_INFO, "LOADER", "Scanning for modules in: %s", directory_path);
+typedef struct {
+    PFN_module_get_info get_info;
+    PFN_module_init init;
+    PFN_module_exec exec;
+    PFN_module_cleanup cleanup;
+    PFN_module_get_dependencies get_dependencies; // Optional.
+} ModuleSymbols;
 
-    // Setup the core context to be passed to modules
-    g_core_context.log = logger_log; // The old function pointer remains for modules
-    g_core_context.log_fmt = logger_log_fmt; // Expose the new formatted logger
-    g_core_context.get_config_value = config_get_value;
-    // g_core_context.print_ui will be set once the TUI is initialized.
+#ifdef PLATFORM_WINDOWS
+static void* library_open(const char* path) {
+    return (void*)LoadLibraryA(path);
+}
+
+static void* library_symbol(void* handle, const char* name) {
+    return (void*)GetProcAddress((HMODULE)handle, name);
+}
+
+static void library_close(void* handle) {
+    FreeLibrary((HMODULE)handle);
+}
+
+static const char* library_error(void) {
+    return "see GetLastError";
+}
+#else
+static void* library_open(const char* path) {
+    return dlopen(path, RTLD_LAZY);
+}
+
+static void* library_symbol(void* handle, const char* name) {
+    return dlsym(handle, name);
+}
+
+static void library_close(void* handle) {
+    dlclose(handle);
+}
+
+static const char* library_error(void) {
+    const char* error = dlerror();
+    return error ? error : "unknown error";
+}
+#endif
+
+/**
+ * @brief Opens a module file and checks it against the API contract.
+ * @return The library handle, or NULL (logged) if it cannot be opened or
+ *         does not conform.
+ */
+static void* open_module_library(const char* file_path, ModuleSymbols* symbols) {
+    void* handle = library_open(file_path);
+    if (!handle) {
+        logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Failed to load library: %s (Reason: %s)",
+                       file_path, library_error());
+        return NULL;
+    }
+
+    // Resolve all required functions, and the optional one.
+    symbols->get_info = (PFN_module_get_info)library_symbol(handle, "module_get_info");
+    symbols->init = (PFN_module_init)library_symbol(handle, "module_init");
+    symbols->exec = (PFN_module_exec)library_symbol(handle, "module_exec");
+    symbols->cleanup = (PFN_module_cleanup)library_symbol(handle, "module_cleanup");
+    symbols->get_dependencies = (PFN_module_get_dependencies)library_symbol(handle, "module_get_dependencies");
+    if (!symbols->get_info || !symbols->init || !symbols->exec || !symbols->cleanup) {
+        logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' does not conform to API contract. Skipping.", file_path);
+        library_close(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+// --- Parallel Loading ---
+
+// Most threads used to open and initialize modules.
+#define LOADER_MAX_THREADS 16
+// Overrides the number of loader threads; 1 loads modules one at a time.
+#define LOADER_THREADS_KEY "modules.init_threads"
+// Set to false to open and initialize every module in modules_load.
+#define LOADER_LAZY_KEY "modules.lazy_init"
+
+typedef enum {
+    CANDIDATE_FOUND,    // Listed, not opened yet.
+    CANDIDATE_LISTED,   // Known from the manifest; left closed.
+    CANDIDATE_OPENED,   // Opened and conforming; waiting to be initialized.
+    CANDIDATE_READY,    // Initialized.
+    CANDIDATE_FAILED    // Rejected, or failed to initialize; closed.
+} CandidateState;
+
+/**
+ * @brief A module file between discovery and registration. Each is written
+ *        by one loader thread at a time.
+ */
+typedef struct {
+    char* file_path;
+    uint64_t file_size;             // The file's stamp, for the manifest.
+    int64_t file_mtime_ns;
+    bool in_manifest;               // The manifest has this very version.
+    void* handle;
+    const phModuleInfo* info;
+    ModuleSymbols symbols;
+    const char** dependencies;      // From module_get_dependencies, or NULL.
+    size_t* dependency_indices;     // The candidates they name.
+    size_t dependency_count;
+    CandidateState state;
+    uint64_t init_ns;               // Time spent in module_init.
+} ModuleCandidate;
+
+/**
+ * @brief Work shared by the threads of `run_jobs`.
+ */
+typedef struct {
+    ModuleCandidate* candidates;
+    const size_t* jobs;             // Indices of the candidates to process.
+    size_t job_count;
+    _Atomic size_t next_job;
+    void (*process)(ModuleCandidate* candidate);
+} JobBatch;
+
+static int compare_candidates(const void* a, const void* b) {
+    return strcmp(((const ModuleCandidate*)a)->file_path, ((const ModuleCandidate*)b)->file_path);
+}
+
+/**
+ * @brief Appends a module file to the candidates.
+ * @return false on allocation failure.
+ */
+static bool add_candidate(ModuleCandidate** candidates, size_t* count, size_t* capacity, const char* path) {
+    if (*count == *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 8;
+        ModuleCandidate* grown = (ModuleCandidate*)realloc(*candidates, new_capacity * sizeof(ModuleCandidate));
+        if (!grown) {
+            return false;
+        }
+        *candidates = grown;
+        *capacity = new_capacity;
+    }
+    ModuleCandidate* candidate = &(*candidates)[*count];
+    memset(candidate, 0, sizeof(*candidate));
+    candidate->file_path = strdup(path);
+    if (!candidate->file_path) {
+        return false;
+    }
+    (*count)++;
+    return true;
+}
+
+static void free_candidates(ModuleCandidate* candidates, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        free(candidates[i].file_path);
+        free(candidates[i].dependency_indices);
+    }
+    free(candidates);
+}
+
+/**
+ * @brief Lists the module files of a directory, sorted by path so that
+ *        loading is deterministic.
+ * @return ph_SUCCESS (with no candidates if none were found),
+ *         ph_ERROR_NOT_FOUND if the directory cannot be read, or
+ *         ph_ERROR_GENERAL on allocation failure.
+ */
+static phStatus discover_modules(const char* directory_path, ModuleCandidate** candidates, size_t* count) {
+    size_t capacity = 0;
+    bool ok = true;
+    *candidates = NULL;
+    *count = 0;
 
 #ifdef PLATFORM_WINDOWS
-    // --- Windows Implementation ---
     char search_path[MAX_PATH];
     snprintf(search_path, sizeof(search_path), "%s\\*%s", directory_path, MODULE_EXTENSION);
 
@@ -105,120 +316,534 @@ phStatus modules_load(const char* directory_path) {
         logger_log(LOG_LEVEL_WARN, "LOADER", "Could not find any modules or read directory. This is not a fatal error.");
         return ph_SUCCESS;
     }
-
     do {
         char full_path[MAX_PATH];
         snprintf(full_path, sizeof(full_path), "%s\\%s", directory_path, fd.cFileName);
+        ok = add_candidate(candidates, count, &capacity, full_path);
+    } while (ok && FindNextFile(hFind, &fd) != 0);
+    FindClose(hFind);
+#else
+    DIR* d = opendir(directory_path);
+    if (!d) {
+        logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Cannot open modules directory: %s", directory_path);
+        return ph_ERROR_NOT_FOUND;
+    }
+    struct dirent* dir;
+    while (ok && (dir = readdir(d)) != NULL) {
+        if (strstr(dir->d_name, MODULE_EXTENSION) == NULL) {
+            continue; // Not a shared library
+        }
+        char full_path[1024]; // This buffer is for path construction, not logging. It's acceptable if paths are reasonably limited.
+        snprintf(full_path, sizeof(full_path), "%s/%s", directory_path, dir->d_name);
+        ok = add_candidate(candidates, count, &capacity, full_path);
+    }
+    closedir(d);
+#endif
 
-        HMODULE handle = LoadLibrary(full_path);
-        if (!handle) {
-            // SAFETIFY: Replaced snprintf + logger_log with a single safe call.
-            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Failed to load library: %s", full_path);
-            continue;
+    if (!ok) {
+        logger_log(LOG_LEVEL_FATAL, "LOADER", "Failed to allocate memory for module loading.");
+        free_candidates(*candidates, *count);
+        *candidates = NULL;
+        *count = 0;
+        return ph_ERROR_GENERAL;
+    }
+    if (*count > 1) {
+        qsort(*candidates, *count, sizeof(ModuleCandidate), compare_candidates);
+    }
+    return ph_SUCCESS;
+}
+
+/**
+ * @brief Opens a module file and learns what it is. Runs on a loader thread.
+ */
+static void open_candidate(ModuleCandidate* candidate) {
+    candidate->state = CANDIDATE_FAILED;
+    uint64_t trace = startup_trace_begin();
+    void* handle = open_module_library(candidate->file_path, &candidate->symbols);
+    startup_trace_end("module_open", candidate->file_path, trace);
+    if (!handle) {
+        return;
+    }
+    candidate->info = candidate->symbols.get_info();
+    if (!candidate->info || !candidate->info->name) {
+        logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' returned no module info. Skipping.", candidate->file_path);
+        library_close(handle);
+        return;
+    }
+    candidate->dependencies = candidate->symbols.get_dependencies ? candidate->symbols.get_dependencies() : NULL;
+    candidate->handle = handle;
+    candidate->state = CANDIDATE_OPENED;
+}
+
+/**
+ * @brief Initializes an opened module, timing it. Runs on a loader thread.
+ */
+static void init_candidate(ModuleCandidate* candidate) {
+    uint64_t trace = startup_trace_begin();
+    uint64_t started = platform_monotonic_ns();
+    phStatus status = candidate->symbols.init(&g_core_context);
+    candidate->init_ns = platform_monotonic_ns() - started;
+    startup_trace_end("module_init", candidate->info->name, trace);
+    if (status != ph_SUCCESS) {
+        logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' failed to initialize. Skipping.", candidate->info->name);
+        library_close(candidate->handle);
+        candidate->handle = NULL;
+        candidate->state = CANDIDATE_FAILED;
+        return;
+    }
+    candidate->state = CANDIDATE_READY;
+}
+
+static void job_worker(void* arg) {
+    JobBatch* batch = (JobBatch*)arg;
+    for (;;) {
+        size_t job = atomic_fetch_add(&batch->next_job, 1);
+        if (job >= batch->job_count) {
+            return;
         }
+        batch->process(&batch->candidates[batch->jobs[job]]);
+    }
+}
+
+/**
+ * @brief Processes candidates on up to `threads` threads, the calling one
+ *        included, and returns once all are done. If threads cannot be
+ *        started, the calling thread does their share.
+ */
+static void run_jobs(ModuleCandidate* candidates, const size_t* jobs, size_t job_count,
+                     void (*process)(ModuleCandidate*), unsigned threads) {
+    JobBatch batch;
+    batch.candidates = candidates;
+    batch.jobs = jobs;
+    batch.job_count = job_count;
+    atomic_init(&batch.next_job, 0);
+    batch.process = process;
+
+    platform_thread_t workers[LOADER_MAX_THREADS];
+    size_t started = 0;
+    size_t wanted = job_count < threads ? job_count : threads;
+    while (started + 1 < wanted && platform_thread_create(&workers[started], job_worker, &batch)) {
+        started++;
+    }
+    job_worker(&batch);
+    for (size_t i = 0; i < started; ++i) {
+        platform_thread_join(workers[i]);
+    }
+}
 
-        // Resolve all required functions
-        PFN_module_get_info get_info_func = (PFN_module_get_info)GetProcAddress(handle, "module_get_info");
-        PFN_module_init init_func = (PFN_module_init)GetProcAddress(handle, "module_init");
-        PFN_module_exec exec_func = (PFN_module_exec)GetProcAddress(handle, "module_exec");
-        PFN_module_cleanup cleanup_func = (PFN_module_cleanup)GetProcAddress(handle, "module_cleanup");
+/**
+ * @brief Returns the number of loader threads: LOADER_THREADS_KEY if set,
+ *        otherwise one per processor, within [1, LOADER_MAX_THREADS].
+ */
+static unsigned loader_thread_count(void) {
+    int64_t configured = 0;
+    int64_t threads = config_get_int(LOADER_THREADS_KEY, &configured) == ph_SUCCESS ? configured
+                                                                                   : (int64_t)platform_cpu_count();
+    if (threads < 1) return 1;
+    if (threads > LOADER_MAX_THREADS) return LOADER_MAX_THREADS;
+    return (unsigned)threads;
+}
 
-        if (!get_info_func || !init_func || !exec_func || !cleanup_func) {
-            // SAFETIFY: Replaced snprintf + logger_log with a single safe call.
-            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' does not conform to API contract. Skipping.", full_path);
-            FreeLibrary(handle);
+/**
+ * @brief Links each opened module's dependencies to the candidates they
+ *        name. A module naming a module that is not available fails.
+ */
+static void resolve_dependencies(ModuleCandidate* candidates, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        ModuleCandidate* candidate = &candidates[i];
+        if (candidate->state != CANDIDATE_OPENED || !candidate->dependencies) {
             continue;
         }
+        size_t wanted = 0;
+        while (candidate->dependencies[wanted]) wanted++;
+        candidate->dependency_indices = (size_t*)malloc((wanted + 1) * sizeof(size_t));
+        for (size_t d = 0; d < wanted && candidate->state == CANDIDATE_OPENED; ++d) {
+            size_t found = count;
+            for (size_t j = 0; j < count && found == count; ++j) {
+                if (j != i && candidates[j].state == CANDIDATE_OPENED &&
+                    strcmp(candidates[j].info->name, candidate->dependencies[d]) == 0) {
+                    found = j;
+                }
+            }
+            if (!candidate->dependency_indices || found == count) {
+                logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' depends on '%s', which is not available. Skipping.",
+                               candidate->info->name, candidate->dependencies[d]);
+                candidate->state = CANDIDATE_FAILED;
+            } else {
+                candidate->dependency_indices[candidate->dependency_count++] = found;
+            }
+        }
+        if (candidate->state == CANDIDATE_FAILED) {
+            library_close(candidate->handle);
+            candidate->handle = NULL;
+        }
+    }
+}
 
-        // Initialize and register the module
-        const phModuleInfo* info = get_info_func();
-        if (init_func(&g_core_context) != ph_SUCCESS) {
-            // SAFETIFY: Replaced snprintf + logger_log with a single safe call.
-            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' failed to initialize. Skipping.", info->name);
-            FreeLibrary(handle);
-            continue;
+/**
+ * @brief Sums up the state of a module's dependencies.
+ * @return CANDIDATE_READY if all are initialized, CANDIDATE_FAILED if one
+ *         failed, CANDIDATE_OPENED otherwise.
+ */
+static CandidateState dependencies_state(const ModuleCandidate* candidates, const ModuleCandidate* candidate) {
+    CandidateState state = CANDIDATE_READY;
+    for (size_t d = 0; d < candidate->dependency_count; ++d) {
+        CandidateState dependency = candidates[candidate->dependency_indices[d]].state;
+        if (dependency == CANDIDATE_FAILED) {
+            return CANDIDATE_FAILED;
+        }
+        if (dependency != CANDIDATE_READY) {
+            state = CANDIDATE_OPENED;
         }
+    }
+    return state;
+}
 
-        LoadedModule* new_module = malloc(sizeof(LoadedModule));
-        new_module->handle = handle;
-        new_module->file_path = _strdup(full_path); // Use _strdup on Windows
-        new_module->info = *info;
-        new_module->init_func = init_func;
-        new_module->exec_func = exec_func;
-        new_module->cleanup_func = cleanup_func;
+/**
+ * @brief Initializes every opened module, in waves: each wave runs,
+ *        concurrently, every module whose dependencies have all been
+ *        initialized by earlier waves.
+ * @return The number of waves.
+ */
+static size_t init_candidates(ModuleCandidate* candidates, size_t count, size_t* jobs, unsigned threads) {
+    resolve_dependencies(candidates, count);
+    size_t waves = 0;
+    for (;;) {
+        size_t ready = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (candidates[i].state == CANDIDATE_OPENED && dependencies_state(candidates, &candidates[i]) == CANDIDATE_READY) {
+                jobs[ready++] = i;
+            }
+        }
+        if (ready == 0) {
+            break;
+        }
+        run_jobs(candidates, jobs, ready, init_candidate, threads);
+        waves++;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (candidates[i].state == CANDIDATE_OPENED) {
+            // Still waiting: a dependency failed, or the dependencies form a cycle.
+            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' has a dependency that failed or is circular. Skipping.",
+                           candidates[i].info->name);
+            library_close(candidates[i].handle);
+            candidates[i].handle = NULL;
+            candidates[i].state = CANDIDATE_FAILED;
+        }
+    }
+    return waves;
+}
 
-        add_module_to_registry(new_module);
-        // SAFETIFY: Replaced snprintf + logger_log with a single safe call.
-        logger_log_fmt(LOG_LEVEL_INFO, "LOADER", "Successfully loaded module: %s (v%s)", info->name, info->version);
+/**
+ * @brief Returns the path of a modules directory's manifest, or NULL if the
+ *        manifest is disabled or memory runs out. The caller frees it.
+ */
+static char* manifest_path_for(const char* directory_path) {
+    if (!module_manifest_enabled()) {
+        return NULL;
+    }
+    size_t length = strlen(directory_path) + sizeof(MODULE_MANIFEST_FILE) + 1;
+    char* path = (char*)malloc(length);
+    if (path) {
+#ifdef PLATFORM_WINDOWS
+        snprintf(path, length, "%s\\%s", directory_path, MODULE_MANIFEST_FILE);
+#else
+        snprintf(path, length, "%s/%s", directory_path, MODULE_MANIFEST_FILE);
+#endif
+    }
+    return path;
+}
 
-    } while (FindNextFile(hFind, &fd) != 0);
-    FindClose(hFind);
+/**
+ * @brief Rewrites the manifest with every module whose info is known, if it
+ *        differs from the manifest read. Must run before any library is
+ *        closed, as opened modules' info lives in their library.
+ */
+static void update_manifest(const char* path, const ModuleCandidate* candidates, size_t count) {
+    size_t known = 0;
+    bool changed = false;
+    for (size_t i = 0; i < count; ++i) {
+        if (candidates[i].state == CANDIDATE_LISTED || candidates[i].state == CANDIDATE_OPENED) {
+            known++;
+            changed |= !candidates[i].in_manifest;
+        }
+    }
+    // Every known module matched a distinct entry; any other entry is gone.
+    if (!changed && known == g_manifest.count) {
+        return;
+    }
 
-#else
-    // --- POSIX Implementation ---
-    DIR* d = opendir(directory_path);
-    if (!d) {
-        logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Cannot open modules directory: %s", directory_path);
-        return ph_ERROR_NOT_FOUND;
+    ModuleManifestEntry* entries = (ModuleManifestEntry*)calloc(known + 1, sizeof(ModuleManifestEntry));
+    if (!entries) {
+        return;
     }
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const ModuleCandidate* candidate = &candidates[i];
+        if (candidate->state == CANDIDATE_LISTED || candidate->state == CANDIDATE_OPENED) {
+            ModuleManifestEntry* entry = &entries[written++];
+            entry->file_path = candidate->file_path;
+            entry->file_size = candidate->file_size;
+            entry->file_mtime_ns = candidate->file_mtime_ns;
+            entry->info = *candidate->info;
+            entry->dependencies = candidate->dependencies;
+        }
+    }
+    if (module_manifest_write(path, entries, written) == 0) {
+        logger_log_fmt(LOG_LEVEL_DEBUG, "LOADER", "Module manifest '%s' updated.", path);
+    } else {
+        logger_log_fmt(LOG_LEVEL_DEBUG, "LOADER", "Could not write the module manifest '%s'.", path);
+    }
+    free(entries);
+}
 
-    struct dirent* dir;
-    while ((dir = readdir(d)) != NULL) {
-        if (strstr(dir->d_name, MODULE_EXTENSION) == NULL) {
-            continue; // Not a shared library
+/**
+ * @brief Moves a module into the registry and indexes its commands.
+ */
+static phStatus register_candidate(const ModuleCandidate* candidate) {
+    LoadedModule* module = (LoadedModule*)calloc(1, sizeof(LoadedModule));
+    char* file_path = strdup(candidate->file_path);
+    if (!module || !file_path) {
+        logger_log(LOG_LEVEL_FATAL, "LOADER", "Failed to allocate memory for module registry.");
+        free(module);
+        free(file_path);
+        module = NULL;
+    } else {
+        module->handle = candidate->handle;
+        module->file_path = file_path;
+        module->info = *candidate->info;
+        module->init_func = candidate->symbols.init;
+        module->exec_func = candidate->symbols.exec;
+        module->cleanup_func = candidate->symbols.cleanup;
+        module->dependencies = candidate->dependencies;
+        module->state = candidate->state == CANDIDATE_READY ? MODULE_INITIALIZED
+                      : candidate->state == CANDIDATE_OPENED ? MODULE_OPENED
+                      : MODULE_LISTED;
+        if (add_module_to_registry(module) != ph_SUCCESS) {
+            free_loaded_module(module);
+            module = NULL;
+        }
+    }
+    if (!module) {
+        if (candidate->state == CANDIDATE_READY) {
+            candidate->symbols.cleanup();
+        }
+        if (candidate->handle) {
+            library_close(candidate->handle);
         }
+        return ph_ERROR_GENERAL;
+    }
+    index_module_commands(module);
+    return ph_SUCCESS;
+}
 
-        char full_path[1024]; // This buffer is for path construction, not logging. It's acceptable if paths are reasonably limited.
-        snprintf(full_path, sizeof(full_path), "%s/%s", directory_path, dir->d_name);
+// --- Initialization On First Use ---
 
-        void* handle = dlopen(full_path, RTLD_LAZY);
-        if (!handle) {
-            // SAFETIFY: Replaced snprintf + logger_log with a single safe call.
-            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Failed to load library: %s (Reason: %s)", full_path, dlerror());
-            continue;
+static LoadedModule* find_module_by_name(const char* name) {
+    for (int i = 0; i < g_module_count; ++i) {
+        if (strcmp(g_loaded_modules[i]->info.name, name) == 0) {
+            return g_loaded_modules[i];
         }
+    }
+    return NULL;
+}
 
-        // Clear any existing error
-        dlerror();
+/**
+ * @brief Opens the library of a module known from the manifest.
+ * @return false (logged) if it cannot be opened, or is no longer the module
+ *         the manifest describes.
+ */
+static bool open_listed_module(LoadedModule* module) {
+    ModuleSymbols symbols;
+    uint64_t trace = startup_trace_begin();
+    void* handle = open_module_library(module->file_path, &symbols);
+    startup_trace_end("module_open", module->file_path, trace);
+    if (!handle) {
+        return false;
+    }
+    const phModuleInfo* info = symbols.get_info();
+    if (!info || !info->name || strcmp(info->name, module->info.name) != 0) {
+        logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' changed since it was scanned. Skipping it until the next run.",
+                       module->file_path);
+        library_close(handle);
+        return false;
+    }
+    // The commands and dependencies stay those of the manifest, which the
+    // index was built from; the file has the same stamp, so they match.
+    module->handle = handle;
+    module->init_func = symbols.init;
+    module->exec_func = symbols.exec;
+    module->cleanup_func = symbols.cleanup;
+    return true;
+}
 
-        // Resolve all required functions
-        PFN_module_get_info get_info_func = dlsym(handle, "module_get_info");
-        PFN_module_init init_func = dlsym(handle, "module_init");
-        PFN_module_exec exec_func = dlsym(handle, "module_exec");
-        PFN_module_cleanup cleanup_func = dlsym(handle, "module_cleanup");
+/**
+ * @brief Opens and initializes a module if it has not been yet, after its
+ *        dependencies. A module that fails is never retried.
+ * @return true if the module is initialized.
+ */
+static bool activate_module(LoadedModule* module) {
+    if (module->state == MODULE_INITIALIZED) {
+        return true;
+    }
+    if (module->state == MODULE_FAILED || module->state == MODULE_INITIALIZING) {
+        // Initializing means a dependency cycle led back here; the modules
+        // along the cycle report it as they fail.
+        return false;
+    }
 
-        const char* dlsym_error = dlerror();
-        if (dlsym_error) {
-            // SAFETIFY: Replaced snprintf + logger_log with a single safe call.
-            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' does not conform to API contract. Skipping. (Error: %s)", full_path, dlsym_error);
-            dlclose(handle);
-            continue;
+    uint64_t started = platform_monotonic_ns();
+    bool ok = module->state == MODULE_OPENED || open_listed_module(module);
+    module->state = MODULE_INITIALIZING;
+    for (const char** name = module->dependencies; ok && name && *name; ++name) {
+        LoadedModule* dependency = find_module_by_name(*name);
+        if (!dependency) {
+            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' depends on '%s', which is not available. Skipping.",
+                           module->info.name, *name);
+            ok = false;
+        } else if (!activate_module(dependency)) {
+            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' has a dependency that failed or is circular. Skipping.",
+                           module->info.name);
+            ok = false;
         }
+    }
+    // Dependencies' init time is reported with theirs.
+    uint64_t init_started = platform_monotonic_ns();
+    if (ok) {
+        uint64_t trace = startup_trace_begin();
+        ok = module->init_func(&g_core_context) == ph_SUCCESS;
+        startup_trace_end("module_init", module->info.name, trace);
+        if (!ok) {
+            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' failed to initialize. Skipping.", module->info.name);
+        }
+    }
+    if (!ok) {
+        // The library stays open until modules_cleanup: the info of a
+        // module scanned in this run lives in it.
+        module->state = MODULE_FAILED;
+        return false;
+    }
+    uint64_t finished = platform_monotonic_ns();
+    module->state = MODULE_INITIALIZED;
+    logger_log_fmt(LOG_LEVEL_INFO, "LOADER", "Initialized module on first use: %s (v%s) in %.1f ms (%.1f ms to open it and its dependencies)",
+                   module->info.name, module->info.version, (finished - init_started) / 1e6,
+                   (init_started - started) / 1e6);
+    return true;
+}
 
-        // Initialize and register the module
-        const phModuleInfo* info = get_info_func();
-        if (init_func(&g_core_context) != ph_SUCCESS) {
-            // SAFETIFY: Replaced snprintf + logger_log with a single safe call.
-            logger_log_fmt(LOG_LEVEL_ERROR, "LOADER", "Module '%s' failed to initialize. Skipping.", info->name);
-            dlclose(handle);
-            continue;
+// --- Public API Implementation ---
+
+/**
+ * @see loader.h
+ */
+phStatus modules_load(const char* directory_path) {
+    uint64_t trace = startup_trace_begin();
+    uint64_t started = platform_monotonic_ns();
+    logger_log_fmt(LOG_LEVEL_INFO, "LOADER", "Scanning for modules in: %s", directory_path);
+
+    // Setup the core context to be passed to modules
+    g_core_context.log = logger_log; // The old function pointer remains for modules
+    g_core_context.log_fmt = logger_log_fmt; // Expose the new formatted logger
+    g_core_context.log_enabled = logger_is_enabled; // Lets modules skip filtered messages
+    // A copy, as a module may keep it past any read section; modules hand it
+    // back through free_config_value.
+    g_core_context.get_config_value = config_get_value;
+    g_core_context.free_config_value = free_config_value;
+    g_core_context.get_config_view = config_get_view;
+    g_core_context.config_generation = config_generation;
+    g_core_context.config_read_begin = config_read_begin;
+    g_core_context.config_read_end = config_read_end;
+    g_core_context.config_get_int = config_get_int;
+    g_core_context.config_get_bool = config_get_bool;
+    g_core_context.config_get_duration_ms = config_get_duration_ms;
+    g_core_context.config_get_list = config_get_list;
+    g_core_context.submit_task = executor_submit;
+    g_core_context.worker_count = executor_thread_count;
+    // g_core_context.print_ui will be set once the TUI is initialized.
+
+    ModuleCandidate* candidates = NULL;
+    size_t count = 0;
+    phStatus status = discover_modules(directory_path, &candidates, &count);
+    if (status != ph_SUCCESS) {
+        startup_trace_end("modules", "modules_load", trace);
+        return status;
+    }
+    size_t* jobs = (size_t*)malloc((count + 1) * sizeof(size_t));
+    if (!jobs) {
+        logger_log(LOG_LEVEL_FATAL, "LOADER", "Failed to allocate memory for module loading.");
+        free_candidates(candidates, count);
+        return ph_ERROR_GENERAL;
+    }
+    unsigned threads = loader_thread_count();
+    bool lazy = true;
+    config_get_bool(LOADER_LAZY_KEY, &lazy);
+
+    // Files unchanged since they were last scanned are known from the
+    // manifest; the others are opened, all at once, to learn what they are.
+    char* manifest_path = manifest_path_for(directory_path);
+    module_manifest_free(&g_manifest);
+    if (manifest_path) {
+        module_manifest_read(&g_manifest, manifest_path);
+    }
+    size_t scanned = 0;
+    for (size_t i = 0; i < count; ++i) {
+        ModuleCandidate* candidate = &candidates[i];
+        const ModuleManifestEntry* entry = NULL;
+        if (platform_file_stamp(candidate->file_path, &candidate->file_size, &candidate->file_mtime_ns)) {
+            entry = module_manifest_find(&g_manifest, candidate->file_path, candidate->file_size,
+                                         candidate->file_mtime_ns);
+        }
+        candidate->in_manifest = entry != NULL;
+        if (entry && lazy) {
+            candidate->info = &entry->info;
+            candidate->dependencies = entry->dependencies;
+            candidate->state = CANDIDATE_LISTED;
+        } else {
+            jobs[scanned++] = i;
         }
+    }
+    run_jobs(candidates, jobs, scanned, open_candidate, threads);
+    if (manifest_path) {
+        update_manifest(manifest_path, candidates, count);
+    }
+    free(manifest_path);
 
-        LoadedModule* new_module = malloc(sizeof(LoadedModule));
-        new_module->handle = handle;
-        new_module->file_path = strdup(full_path);
-        new_module->info = *info;
-        new_module->init_func = init_func;
-        new_module->exec_func = exec_func;
-        new_module->cleanup_func = cleanup_func;
+    size_t waves = lazy ? 0 : init_candidates(candidates, count, jobs, threads);
 
-        add_module_to_registry(new_module);
-        // SAFETIFY: Replaced snprintf + logger_log with a single safe call.
-        logger_log_fmt(LOG_LEVEL_INFO, "LOADER", "Successfully loaded module: %s (v%s)", info->name, info->version);
+    // Register in file name order, whatever order the inits finished in.
+    uint64_t init_total_ns = 0;
+    int registered = 0;
+    for (size_t i = 0; i < count; ++i) {
+        ModuleCandidate* candidate = &candidates[i];
+        if (candidate->state == CANDIDATE_FAILED || candidate->state == CANDIDATE_FOUND) {
+            continue;
+        }
+        init_total_ns += candidate->init_ns;
+        if (register_candidate(candidate) != ph_SUCCESS) {
+            continue;
+        }
+        if (candidate->state == CANDIDATE_READY) {
+            logger_log_fmt(LOG_LEVEL_INFO, "LOADER", "Successfully loaded module: %s (v%s), initialized in %.1f ms",
+                           candidate->info->name, candidate->info->version, candidate->init_ns / 1e6);
+        } else {
+            logger_log_fmt(LOG_LEVEL_DEBUG, "LOADER", "Found module: %s (v%s)",
+                           candidate->info->name, candidate->info->version);
+        }
+        registered++;
+    }
+    if (lazy) {
+        logger_log_fmt(LOG_LEVEL_INFO, "LOADER",
+                       "Found %d of %zu modules in %.1f ms (%zu opened to scan them, the others known from the manifest)",
+                       registered, count, (platform_monotonic_ns() - started) / 1e6, scanned);
+    } else {
+        logger_log_fmt(LOG_LEVEL_INFO, "LOADER",
+                       "Loaded %d of %zu modules in %.1f ms (%.1f ms of initialization, %zu waves on up to %u threads)",
+                       registered, count, (platform_monotonic_ns() - started) / 1e6, init_total_ns / 1e6, waves, threads);
     }
-    closedir(d);
-#endif
 
+    free(jobs);
+    free_candidates(candidates, count);
+    startup_trace_end("modules", "modules_load", trace);
     return ph_SUCCESS;
 }
 
@@ -226,16 +851,13 @@ phStatus modules_load(const char* directory_path) {
  * @see loader.h
  */
 const LoadedModule* modules_find_handler(const char* command) {
-    for (int i = 0; i < g_module_count; ++i) {
-        const char** cmd_ptr = g_loaded_modules[i]->info.commands;
-        while (cmd_ptr && *cmd_ptr) {
-            if (strcmp(*cmd_ptr, command) == 0) {
-                return g_loaded_modules[i];
-            }
-            cmd_ptr++;
-        }
+    const CommandHandler* handler = command_index_find(command);
+    if (!handler || handler->kind != COMMAND_HANDLER_NATIVE) {
+        return NULL;
     }
-    return NULL;
+    // The index refers to the registry's modules, which the loader owns.
+    LoadedModule* module = (LoadedModule*)handler->module;
+    return activate_module(module) ? module : NULL;
 }
 
 /**
@@ -253,19 +875,21 @@ const LoadedModule** modules_get_all(int* count) {
  */
 void modules_cleanup(void) {
     logger_log(LOG_LEVEL_INFO, "LOADER", "Cleaning up all loaded modules.");
+    command_index_remove_kind(COMMAND_HANDLER_NATIVE);
+    // Queued tasks may run module code, so they finish before any module
+    // is torn down.
+    executor_shutdown();
     for (int i = 0; i < g_module_count; ++i) {
         LoadedModule* module = g_loaded_modules[i];
         if (module) {
             // Call the module's own cleanup function first
-            if (module->cleanup_func) {
+            if (module->state == MODULE_INITIALIZED && module->cleanup_func) {
                 module->cleanup_func();
             }
             // Unload the library
-#ifdef PLATFORM_WINDOWS
-            FreeLibrary(module->handle);
-#else
-            dlclose(module->handle);
-#endif
+            if (module->handle) {
+                library_close(module->handle);
+            }
             // Free the container struct
             free_loaded_module(module);
         }
@@ -274,4 +898,5 @@ void modules_cleanup(void) {
     g_loaded_modules = NULL;
     g_module_count = 0;
     g_module_capacity = 0;
-}
\ No newline at end of file
+    module_manifest_free(&g_manifest);
+}
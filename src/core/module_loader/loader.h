@@ -22,13 +22,27 @@
 extern "C" {
 #endif
 
+/**
+ * @enum LoadedModuleState
+ * @brief How far a module has been loaded. Modules are initialized on first
+ *        use, so most of them are never opened in a given run.
+ */
+typedef enum {
+    MODULE_LISTED,          // Known from the module manifest; not opened yet.
+    MODULE_OPENED,          // Library opened, not initialized yet.
+    MODULE_INITIALIZING,    // Being initialized, with its dependencies.
+    MODULE_INITIALIZED,     // Ready to execute commands.
+    MODULE_FAILED           // Failed to open or initialize; not retried.
+} LoadedModuleState;
+
 /**
  * @struct LoadedModule
- * @brief Represents a module that has been successfully loaded into memory.
+ * @brief Represents a module known to the loader.
  *
- * This structure holds all necessary information about a loaded module,
- * including its metadata, a handle to the dynamic library, and pointers to its
- * core functions as defined by the ph_core_api.h contract.
+ * This structure holds all necessary information about a module, including
+ * its metadata, a handle to the dynamic library, and pointers to its core
+ * functions as defined by the ph_core_api.h contract. The handle and the
+ * function pointers are NULL until the module is opened.
  */
 typedef struct {
     void* handle;                   // Opaque handle to the loaded library (from dlopen/LoadLibrary)
@@ -37,16 +51,34 @@ typedef struct {
     PFN_module_init init_func;      // Pointer to the module's init function
     PFN_module_exec exec_func;      // Pointer to the module's exec function
     PFN_module_cleanup cleanup_func;// Pointer to the module's cleanup function
+    const char** dependencies;      // Modules to initialize first (NULL-terminated), or NULL
+    LoadedModuleState state;
 } LoadedModule;
 
 /**
- * @brief Scans a directory, loads all valid modules, and initializes them.
+ * @brief Scans a directory and registers all valid modules.
  *
  * This is the main entry point for the loader. It iterates through files in the
- * specified directory, attempting to load any with the correct shared library
- * extension (.so/.dll). For each successfully loaded library, it resolves the
- * required API functions (`module_get_info`, `module_init`, etc.), calls the
- * module's init function, and stores it in an internal registry.
+ * specified directory, considering any with the correct shared library
+ * extension (.so/.dll), and stores each valid module in an internal registry,
+ * with its commands in the command index.
+ *
+ * What a module is and which commands it handles is read from the module
+ * manifest (see module_manifest.h) when the module's file has not changed
+ * since it was last scanned. Other files are opened to resolve the required
+ * API functions (`module_get_info`, `module_init`, etc.), and the manifest
+ * is then updated. Modules are not initialized here: `modules_find_handler`
+ * opens and initializes a module the first time one of its commands is
+ * looked up, so startup does not grow with the number of modules installed.
+ *
+ * Setting the `modules.lazy_init` configuration key to false restores
+ * loading and initializing every module here. They are then opened and
+ * initialized on up to one thread per processor (the `modules.init_threads`
+ * key overrides the number; 1 loads them one at a time).
+ *
+ * Either way, a module is initialized only after the modules it names in
+ * `module_get_dependencies`, and the registry lists the modules in file
+ * name order.
  *
  * @param directory_path The path to the directory containing the modules.
  * @return ph_SUCCESS on success, or an error code if a critical failure
@@ -57,20 +89,27 @@ phStatus modules_load(const char* directory_path);
 /**
  * @brief Finds the module responsible for handling a given command.
  *
- * This function searches the internal registry of loaded modules to find one
- * that has registered the specified command in its metadata.
+ * This function looks the command up in the command index (see
+ * command_index.h), which holds every command of every loaded module, so
+ * the cost does not grow with the number of modules. If two modules list
+ * the same command, the one loaded first handles it.
+ *
+ * The handler is opened and initialized, after its dependencies, if it has
+ * not been yet, so its functions can be called at once.
  *
  * @param command The command string to search for (e.g., "SND", "rls").
  * @return A read-only pointer to the `LoadedModule` struct for the handler,
- *         or NULL if no module handles the command.
+ *         or NULL if no module handles the command or the handler failed
+ *         to initialize.
  */
 const LoadedModule* modules_find_handler(const char* command);
 
 /**
- * @brief Retrieves a list of all successfully loaded modules.
+ * @brief Retrieves a list of all valid modules.
  *
  * This is useful for UI components that need to display information about
- * what functionality is available.
+ * what functionality is available. The modules' metadata is always there,
+ * but they may not be initialized yet (see `LoadedModule.state`).
  *
  * @param[out] count A pointer to an integer that will be filled with the number
  *                   of loaded modules.
@@ -83,8 +122,9 @@ const LoadedModule** modules_get_all(int* count);
 /**
  * @brief Unloads all modules and frees associated resources.
  *
- * This function iterates through all loaded modules, calls their respective
- * `module_cleanup` function, and then unloads the shared library from memory.
+ * This function iterates through all modules, calls the `module_cleanup`
+ * function of those initialized, and then unloads the shared libraries
+ * opened from memory.
  * It must be called at application shutdown to ensure a clean exit.
  */
 void modules_cleanup(void);
@@ -0,0 +1,333 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * module_manifest.c - Reading and writing the module manifest.
+ *
+ * See module_manifest.h for the layout. The manifest is small, a few
+ * hundred bytes per module, so it is read into memory once rather than kept
+ * mapped: the loader holds on to it for the whole run, and a mapped file
+ * could not be replaced on Windows meanwhile. The checksum is the
+ * configuration table's hash, as for configuration images.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "module_manifest.h"
+#include "config/config_table.h" // For config_table_hash
+#include "platform/platform.h"   // For mapping and replacing files
+#include <stdlib.h>
+#include <string.h>
+
+// --- Internal Helpers ---
+
+#define MANIFEST_MAGIC 0x4D4D4850u // "PHMM" read as a little-endian word.
+#define MANIFEST_VERSION 1
+#define NO_STRING UINT32_MAX
+
+/**
+ * @brief The first bytes of a manifest. All offsets are from the file start.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t checksum;          // Of every byte after the header.
+    uint64_t total_size;        // Size of the manifest.
+    uint32_t count;             // Records stored.
+    uint32_t reserved;          // 0.
+    uint64_t records_offset;    // ManifestRecord per module, sorted by path.
+    uint64_t arena_offset;
+    uint64_t arena_size;
+} ManifestHeader;
+
+/**
+ * @brief One module. Strings are arena offsets, NO_STRING for NULL; a list
+ *        is `*_count` consecutive strings from its offset.
+ */
+typedef struct {
+    uint64_t file_size;
+    int64_t file_mtime_ns;
+    uint32_t file_path;
+    uint32_t name;
+    uint32_t version;
+    uint32_t description;
+    uint32_t commands;
+    uint32_t command_count;
+    uint32_t dependencies;
+    uint32_t dependency_count;
+} ManifestRecord;
+
+/**
+ * @brief Checks that `count` items of `size` bytes at `offset` lie within
+ * a manifest of `total` bytes, without overflowing.
+ */
+static int section_fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t total) {
+    return offset <= total && count <= (total - offset) / size;
+}
+
+/**
+ * @brief Resolves a string offset of a manifest being read.
+ * @return 0, or -1 if the string does not end within the arena.
+ */
+static int read_string(const ModuleManifest* manifest, size_t arena_size, uint32_t offset, const char** string) {
+    if (offset == NO_STRING) {
+        *string = NULL;
+        return 0;
+    }
+    if (offset >= arena_size || !memchr(manifest->arena + offset, '\0', arena_size - offset)) {
+        return -1;
+    }
+    *string = manifest->arena + offset;
+    return 0;
+}
+
+/**
+ * @brief Resolves a list of a manifest being read into a NULL-terminated
+ * array taken from `manifest->lists` at `*next`.
+ * @return 0, or -1 if a string of the list does not end within the arena.
+ */
+static int read_list(ModuleManifest* manifest, size_t arena_size, uint32_t offset, uint32_t count,
+                     size_t* next, const char*** list) {
+    *list = NULL;
+    if (count == 0) {
+        return 0;
+    }
+    const char** items = &manifest->lists[*next];
+    for (uint32_t i = 0; i < count; ++i) {
+        if (offset == NO_STRING || read_string(manifest, arena_size, offset, &items[i]) != 0) {
+            return -1;
+        }
+        size_t length = strlen(items[i]) + 1;
+        if (length > NO_STRING - (uint64_t)offset) {
+            return -1;
+        }
+        offset += (uint32_t)length;
+    }
+    items[count] = NULL;
+    *next += count + 1;
+    *list = items;
+    return 0;
+}
+
+/**
+ * @brief Copies the records and strings of a validated manifest mapping.
+ * @return 0, or -1 if a record is invalid or memory runs out.
+ */
+static int read_records(ModuleManifest* manifest, const ManifestHeader* header, const char* data) {
+    const ManifestRecord* records = (const ManifestRecord*)(data + header->records_offset);
+    size_t arena_size = (size_t)header->arena_size;
+
+    // Every listed string takes at least one byte, so no list can be longer
+    // than the arena; this also keeps the sum below from overflowing.
+    uint64_t list_slots = 0;
+    for (uint32_t i = 0; i < header->count; ++i) {
+        if (records[i].command_count > arena_size || records[i].dependency_count > arena_size) {
+            return -1;
+        }
+        list_slots += (uint64_t)records[i].command_count + records[i].dependency_count + 2;
+    }
+    if (list_slots > SIZE_MAX / sizeof(const char*)) {
+        return -1;
+    }
+
+    manifest->arena = (char*)malloc(arena_size + 1);
+    manifest->entries = (ModuleManifestEntry*)calloc(header->count + 1, sizeof(ModuleManifestEntry));
+    manifest->lists = (const char**)malloc((size_t)(list_slots + 1) * sizeof(const char*));
+    if (!manifest->arena || !manifest->entries || !manifest->lists) {
+        return -1;
+    }
+    memcpy(manifest->arena, data + header->arena_offset, arena_size);
+    manifest->arena[arena_size] = '\0';
+
+    size_t next_list = 0;
+    for (uint32_t i = 0; i < header->count; ++i) {
+        const ManifestRecord* record = &records[i];
+        ModuleManifestEntry* entry = &manifest->entries[i];
+        entry->file_size = record->file_size;
+        entry->file_mtime_ns = record->file_mtime_ns;
+        if (read_string(manifest, arena_size, record->file_path, &entry->file_path) != 0 ||
+            read_string(manifest, arena_size, record->name, &entry->info.name) != 0 ||
+            read_string(manifest, arena_size, record->version, &entry->info.version) != 0 ||
+            read_string(manifest, arena_size, record->description, &entry->info.description) != 0 ||
+            read_list(manifest, arena_size, record->commands, record->command_count, &next_list,
+                      &entry->info.commands) != 0 ||
+            read_list(manifest, arena_size, record->dependencies, record->dependency_count, &next_list,
+                      &entry->dependencies) != 0 ||
+            !entry->file_path || !entry->info.name) {
+            return -1;
+        }
+        // Lookups are binary searches.
+        if (i > 0 && strcmp(manifest->entries[i - 1].file_path, entry->file_path) >= 0) {
+            return -1;
+        }
+    }
+    manifest->count = header->count;
+    return 0;
+}
+
+static uint64_t string_size(const char* string) {
+    return string ? strlen(string) + 1 : 0;
+}
+
+static uint64_t list_size(const char* const* list, uint32_t* count) {
+    uint64_t size = 0;
+    *count = 0;
+    for (; list && *list; ++list) {
+        size += strlen(*list) + 1;
+        (*count)++;
+    }
+    return size;
+}
+
+/**
+ * @brief Appends a string to the arena being written.
+ * @return Its offset, or NO_STRING for NULL.
+ */
+static uint32_t put_string(char* arena, uint32_t* cursor, const char* string) {
+    if (!string) {
+        return NO_STRING;
+    }
+    uint32_t offset = *cursor;
+    size_t size = strlen(string) + 1;
+    memcpy(arena + offset, string, size);
+    *cursor += (uint32_t)size;
+    return offset;
+}
+
+/**
+ * @brief Appends a list's strings to the arena being written.
+ * @return The offset of the first, or NO_STRING for an empty list.
+ */
+static uint32_t put_list(char* arena, uint32_t* cursor, const char* const* list) {
+    uint32_t offset = list && *list ? *cursor : NO_STRING;
+    for (; list && *list; ++list) {
+        put_string(arena, cursor, *list);
+    }
+    return offset;
+}
+
+// --- Public API Implementation ---
+
+/**
+ * @see module_manifest.h
+ */
+int module_manifest_enabled(void) {
+    const char* setting = getenv(MODULE_MANIFEST_ENV);
+    return !setting || strcmp(setting, "0") != 0;
+}
+
+/**
+ * @see module_manifest.h
+ */
+int module_manifest_read(ModuleManifest* manifest, const char* path) {
+    memset(manifest, 0, sizeof(*manifest));
+    platform_mapped_file file;
+    if (!platform_map_file(path, &file)) {
+        return -1;
+    }
+
+    const char* data = file.data;
+    uint64_t size = file.size;
+    const ManifestHeader* header = (const ManifestHeader*)data;
+    int result = -1;
+    if (size >= sizeof(ManifestHeader) &&
+        header->magic == MANIFEST_MAGIC && header->version == MANIFEST_VERSION &&
+        header->total_size == size && header->records_offset % 8 == 0 &&
+        section_fits(header->records_offset, header->count, sizeof(ManifestRecord), size) &&
+        section_fits(header->arena_offset, header->arena_size, 1, size) &&
+        header->arena_size < NO_STRING &&
+        header->checksum == config_table_hash(data + sizeof(ManifestHeader),
+                                              (size_t)(size - sizeof(ManifestHeader)))) {
+        result = read_records(manifest, header, data);
+    }
+    platform_unmap_file(&file);
+    if (result != 0) {
+        module_manifest_free(manifest);
+    }
+    return result;
+}
+
+/**
+ * @see module_manifest.h
+ */
+const ModuleManifestEntry* module_manifest_find(const ModuleManifest* manifest, const char* file_path,
+                                                uint64_t file_size, int64_t file_mtime_ns) {
+    size_t low = 0;
+    size_t high = manifest->count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        const ModuleManifestEntry* entry = &manifest->entries[middle];
+        int order = strcmp(entry->file_path, file_path);
+        if (order == 0) {
+            return entry->file_size == file_size && entry->file_mtime_ns == file_mtime_ns ? entry : NULL;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @see module_manifest.h
+ */
+int module_manifest_write(const char* path, const ModuleManifestEntry* entries, size_t count) {
+    uint64_t arena_size = 0;
+    uint32_t list_count;
+    for (size_t i = 0; i < count; ++i) {
+        const ModuleManifestEntry* entry = &entries[i];
+        arena_size += string_size(entry->file_path) + string_size(entry->info.name) +
+                      string_size(entry->info.version) + string_size(entry->info.description) +
+                      list_size(entry->info.commands, &list_count) + list_size(entry->dependencies, &list_count);
+    }
+    if (count >= UINT32_MAX || arena_size >= NO_STRING) {
+        return -1;
+    }
+
+    ManifestHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MANIFEST_MAGIC;
+    header.version = MANIFEST_VERSION;
+    header.count = (uint32_t)count;
+    header.records_offset = sizeof(ManifestHeader);
+    header.arena_offset = header.records_offset + count * sizeof(ManifestRecord);
+    header.arena_size = arena_size;
+    header.total_size = header.arena_offset + arena_size;
+
+    char* image = (char*)calloc(1, (size_t)header.total_size);
+    if (!image) {
+        return -1;
+    }
+    ManifestRecord* records = (ManifestRecord*)(image + header.records_offset);
+    char* arena = image + header.arena_offset;
+    uint32_t cursor = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const ModuleManifestEntry* entry = &entries[i];
+        ManifestRecord* record = &records[i];
+        record->file_size = entry->file_size;
+        record->file_mtime_ns = entry->file_mtime_ns;
+        record->file_path = put_string(arena, &cursor, entry->file_path);
+        record->name = put_string(arena, &cursor, entry->info.name);
+        record->version = put_string(arena, &cursor, entry->info.version);
+        record->description = put_string(arena, &cursor, entry->info.description);
+        list_size(entry->info.commands, &record->command_count);
+        record->commands = put_list(arena, &cursor, entry->info.commands);
+        list_size(entry->dependencies, &record->dependency_count);
+        record->dependencies = put_list(arena, &cursor, entry->dependencies);
+    }
+    header.checksum = config_table_hash(image + sizeof(ManifestHeader),
+                                        (size_t)(header.total_size - sizeof(ManifestHeader)));
+    memcpy(image, &header, sizeof(header));
+
+    int result = platform_write_file_atomic(path, image, (size_t)header.total_size) ? 0 : -1;
+    free(image);
+    return result;
+}
+
+/**
+ * @see module_manifest.h
+ */
+void module_manifest_free(ModuleManifest* manifest) {
+    free(manifest->entries);
+    free(manifest->arena);
+    free((void*)manifest->lists);
+    memset(manifest, 0, sizeof(*manifest));
+}
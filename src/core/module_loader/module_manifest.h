@@ -0,0 +1,100 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * module_manifest.h - Cached metadata of the modules of a directory.
+ *
+ * Learning which commands a module handles means opening its library and
+ * calling `module_get_info`, and every module must be known before a
+ * command can be dispatched. To avoid opening every library on every run,
+ * the loader records what it learned in a manifest in the modules
+ * directory (`modules.phm`): for each module file, its path and size/mtime
+ * stamp, its `phModuleInfo` and its dependencies. On later runs, a module
+ * whose file still has the recorded stamp is known from the manifest alone,
+ * and its library is opened only when one of its commands runs.
+ *
+ * The manifest is a binary file: a header with a magic number, a format
+ * version and a checksum of everything else, one fixed-size record per
+ * module, sorted by path, and a string arena. Records refer to strings by
+ * offset; a list (of commands or dependencies) is a run of consecutive
+ * strings. A manifest that fails validation is ignored, as if absent, and
+ * it is written through a temporary file and a rename, so a concurrent
+ * reader sees either the old or the new one.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef MODULE_MANIFEST_H
+#define MODULE_MANIFEST_H
+
+#include "../../ipc/include/ph_core_api.h" // For phModuleInfo
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The manifest's file name, in the modules directory.
+#define MODULE_MANIFEST_FILE "modules.phm"
+// Set to "0" to neither read nor write the manifest.
+#define MODULE_MANIFEST_ENV "PH_MODULE_MANIFEST"
+
+/**
+ * @struct ModuleManifestEntry
+ * @brief What is known of one module file.
+ */
+typedef struct {
+    const char* file_path;
+    uint64_t file_size;             // The file's stamp when it was scanned.
+    int64_t file_mtime_ns;
+    phModuleInfo info;
+    const char** dependencies;      // NULL-terminated, or NULL for none.
+} ModuleManifestEntry;
+
+/**
+ * @struct ModuleManifest
+ * @brief A manifest read into memory. Its entries own no memory of their
+ *        own; everything is freed with the manifest.
+ */
+typedef struct {
+    ModuleManifestEntry* entries;   // Sorted by file path.
+    size_t count;
+    char* arena;                    // The strings.
+    const char** lists;             // The command and dependency arrays.
+} ModuleManifest;
+
+/**
+ * @brief Returns whether the manifest is enabled, i.e. MODULE_MANIFEST_ENV
+ * is not "0".
+ */
+int module_manifest_enabled(void);
+
+/**
+ * @brief Reads and validates a manifest.
+ * @param[out] manifest Receives the manifest; empty on failure.
+ * @return 0 on success, -1 if the file is missing, invalid or memory runs out.
+ */
+int module_manifest_read(ModuleManifest* manifest, const char* path);
+
+/**
+ * @brief Looks a module file up.
+ * @return Its entry if the manifest holds one with this exact stamp, or NULL
+ *         if the file must be scanned.
+ */
+const ModuleManifestEntry* module_manifest_find(const ModuleManifest* manifest, const char* file_path,
+                                                uint64_t file_size, int64_t file_mtime_ns);
+
+/**
+ * @brief Writes a manifest of the given entries, which must be sorted by
+ * file path and have a non-NULL path and name.
+ * @return 0 on success, -1 on failure.
+ */
+int module_manifest_write(const char* path, const ModuleManifestEntry* entries, size_t count);
+
+/**
+ * @brief Frees a manifest read by `module_manifest_read` and empties it.
+ */
+void module_manifest_free(ModuleManifest* manifest);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // MODULE_MANIFEST_H
@@ -11,9 +11,15 @@
  * - Initializing the console for proper rendering (e.g., enabling ANSI
  *   escape codes on Windows).
  * - Clearing the terminal screen.
- * - Retrieving environment-specific paths (e.g., user's home directory).
+ * - Retrieving environment-specific paths (e.g., user's home directory, the
+ *   system-wide configuration directory) and the process environment.
  * - Abstracting file system path separators.
  * - Providing the correct file extension for shared libraries (.dll vs .so).
+ * - A statically initializable mutex, and joinable threads.
+ * - A monotonic clock and the number of processors.
+ * - Read-only memory mapping of whole files, file size/mtime stamps, and
+ *   replacing a file atomically.
+ * - Watching a file for changes.
  *
  * SPDX-License-Identifier: Apache-2.0 */
 
@@ -22,6 +28,10 @@
 
 #include <stddef.h> // For size_t
 #include <stdbool.h> // For bool type
+#include <stdint.h> // For fixed-width integers
+#ifndef _WIN32
+#include <pthread.h> // For platform_mutex_t and platform_thread_t
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,6 +49,113 @@ extern "C" {
 #endif
 
 
+/**
+ * @brief A mutual exclusion lock.
+ *
+ * Initialize it with PLATFORM_MUTEX_INIT. One that lives for the whole run
+ * needs no destruction; destroy one in memory that is freed earlier with
+ * `platform_mutex_destroy`. It is a POSIX mutex or a Windows slim
+ * reader/writer lock used exclusively.
+ */
+#ifdef PLATFORM_WINDOWS
+    typedef struct { void* ptr; } platform_mutex_t; // Layout of SRWLOCK
+    #define PLATFORM_MUTEX_INIT {0}
+#else
+    typedef pthread_mutex_t platform_mutex_t;
+    #define PLATFORM_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#endif
+
+/**
+ * @brief Acquires a mutex, waiting as long as necessary.
+ */
+void platform_mutex_lock(platform_mutex_t* mutex);
+
+/**
+ * @brief Releases a mutex held by the calling thread.
+ */
+void platform_mutex_unlock(platform_mutex_t* mutex);
+
+/**
+ * @brief Releases the resources of an unlocked mutex no thread waits for.
+ */
+void platform_mutex_destroy(platform_mutex_t* mutex);
+
+/**
+ * @brief A condition variable, used with a platform_mutex_t.
+ *
+ * Initialize it with PLATFORM_COND_INIT. As for a mutex, destroy one in
+ * memory that is freed before the end of the run, with
+ * `platform_cond_destroy`. It is a POSIX condition variable or a Windows
+ * CONDITION_VARIABLE.
+ */
+#ifdef PLATFORM_WINDOWS
+    typedef struct { void* ptr; } platform_cond_t; // Layout of CONDITION_VARIABLE
+    #define PLATFORM_COND_INIT {0}
+#else
+    typedef pthread_cond_t platform_cond_t;
+    #define PLATFORM_COND_INIT PTHREAD_COND_INITIALIZER
+#endif
+
+/**
+ * @brief Releases `mutex`, waits until `cond` is signaled or the timeout
+ * expires, and acquires `mutex` again.
+ *
+ * Wakeups may be spurious: callers re-check their condition in a loop.
+ *
+ * @param timeout_ms The longest wait, or a negative value to wait as long as
+ *                   necessary.
+ * @return false if the timeout expired, true otherwise.
+ */
+bool platform_cond_wait(platform_cond_t* cond, platform_mutex_t* mutex, int timeout_ms);
+
+/**
+ * @brief Wakes every thread waiting on `cond`.
+ */
+void platform_cond_broadcast(platform_cond_t* cond);
+
+/**
+ * @brief Releases the resources of a condition variable no thread waits on.
+ */
+void platform_cond_destroy(platform_cond_t* cond);
+
+/**
+ * @brief A thread started by `platform_thread_create`.
+ */
+#ifdef PLATFORM_WINDOWS
+    typedef void* platform_thread_t; // A thread HANDLE
+#else
+    typedef pthread_t platform_thread_t;
+#endif
+
+/**
+ * @brief The entry point of a thread.
+ */
+typedef void (*platform_thread_fn)(void* arg);
+
+/**
+ * @brief Starts a thread running `entry(arg)`.
+ *
+ * @param[out] thread Receives the thread. It must be joined exactly once
+ *                    with `platform_thread_join`.
+ * @return true on success, false if the thread could not be created.
+ */
+bool platform_thread_create(platform_thread_t* thread, platform_thread_fn entry, void* arg);
+
+/**
+ * @brief Waits for a thread to return and releases it.
+ */
+void platform_thread_join(platform_thread_t thread);
+
+/**
+ * @brief Returns a monotonic time in nanoseconds, for measuring intervals.
+ */
+uint64_t platform_monotonic_ns(void);
+
+/**
+ * @brief Returns the number of processors available, at least 1.
+ */
+unsigned platform_cpu_count(void);
+
 /**
  * @brief Performs one-time global initialization for the platform.
  *
@@ -83,6 +200,138 @@ void platform_clear_screen(void);
  */
 bool platform_get_home_dir(char* buffer, size_t buffer_size);
 
+/**
+ * @brief Retrieves the directory holding system-wide configuration.
+ *
+ * This is `/etc` on POSIX systems and %ProgramData% on Windows.
+ *
+ * @param buffer A pointer to the character buffer where the path will be stored.
+ * @param buffer_size The total size of the `buffer`.
+ * @return true if the path was successfully retrieved and fits in the buffer,
+ *         false otherwise.
+ */
+bool platform_get_system_config_dir(char* buffer, size_t buffer_size);
+
+/**
+ * @brief Returns the process environment as a NULL-terminated array of
+ * `NAME=value` strings. It must not be modified, and is only valid until
+ * the environment is next changed.
+ */
+char** platform_get_environment(void);
+
+/**
+ * @struct platform_mapped_file
+ * @brief A file mapped read-only into memory by `platform_map_file`.
+ */
+typedef struct {
+    const char* data;   // The file's contents; NULL if the file is empty.
+    size_t size;        // The file's size in bytes.
+} platform_mapped_file;
+
+/**
+ * @brief Maps a whole file into memory, read-only.
+ *
+ * The contents are paged in on demand, so reading a large file costs no
+ * copy into a user buffer. The mapping does not include a terminating NUL.
+ *
+ * @param path The path of the file to map.
+ * @param[out] file Receives the mapping. Release it with `platform_unmap_file`.
+ * @return true on success, false if the file cannot be opened or mapped.
+ */
+bool platform_map_file(const char* path, platform_mapped_file* file);
+
+/**
+ * @brief Releases a mapping made by `platform_map_file` and zeroes `file`.
+ */
+void platform_unmap_file(platform_mapped_file* file);
+
+/**
+ * @brief Retrieves the size and last modification time of a file.
+ *
+ * Together they identify a version of the file cheaply, without reading it.
+ *
+ * @param path The path of the file.
+ * @param[out] size Receives the size in bytes.
+ * @param[out] mtime_ns Receives the modification time in nanoseconds, on a
+ *                      platform-defined epoch. Only compare it for equality.
+ * @return true on success, false if the file does not exist or is not a
+ *         regular file.
+ */
+bool platform_file_stamp(const char* path, uint64_t* size, int64_t* mtime_ns);
+
+/**
+ * @brief Returns the absolute form of a path, so that two spellings of the
+ *        same file compare equal.
+ *
+ * Symbolic links, `.` and `..` are resolved on POSIX (`realpath`), which
+ * requires the file to exist; Windows (`GetFullPathName`) resolves `.` and
+ * `..` against the current directory.
+ *
+ * @return The path, which the caller frees, or NULL on failure.
+ */
+char* platform_full_path(const char* path);
+
+/**
+ * @brief Replaces a file's contents atomically.
+ *
+ * The data is written to a temporary file next to `path`, which is then
+ * renamed over it, so a concurrent reader sees either the old or the new
+ * contents, never a partial write.
+ *
+ * @return true on success, false if the file cannot be written (the old
+ *         contents, if any, are then left in place).
+ */
+bool platform_write_file_atomic(const char* path, const void* data, size_t size);
+
+/**
+ * @brief Creates a directory and any missing parents, like `mkdir -p`.
+ *
+ * Directories are created readable only by the current user on POSIX.
+ *
+ * @return true if the directory exists afterwards, false otherwise.
+ */
+bool platform_make_dirs(const char* path);
+
+/**
+ * @brief A watch on one file, opened by `platform_watch_open`.
+ *
+ * The watch is placed on the file's directory and filtered by name, so it
+ * survives the file being deleted and recreated, or replaced by a rename as
+ * most editors save. It uses inotify on Linux and directory change
+ * notifications on Windows; elsewhere it polls the file's stamp.
+ */
+typedef struct platform_file_watch platform_file_watch;
+
+/**
+ * @brief Starts watching a file. The file need not exist yet, its directory must.
+ * @return The watch, or NULL on failure. Close it with `platform_watch_close`.
+ */
+platform_file_watch* platform_watch_open(const char* path);
+
+/**
+ * @brief Waits until the watched file may have changed.
+ *
+ * Reports are a hint: one change may be reported several times, in
+ * particular while the file is being written, so callers should compare
+ * stamps (`platform_file_stamp`) before acting on them.
+ *
+ * @param timeout_ms The longest time to wait, or -1 to wait indefinitely.
+ * @return 1 if the file may have changed, 0 on timeout or once the watch is
+ *         interrupted, -1 if the watch failed (e.g. its directory was removed).
+ */
+int platform_watch_wait(platform_file_watch* watch, int timeout_ms);
+
+/**
+ * @brief Makes the current and every later `platform_watch_wait` on the watch
+ * return 0 at once. May be called from any thread.
+ */
+void platform_watch_interrupt(platform_file_watch* watch);
+
+/**
+ * @brief Stops watching and frees the watch. No thread may still be waiting on it.
+ */
+void platform_watch_close(platform_file_watch* watch);
+
 
 #ifdef __cplusplus
 } // extern "C"
@@ -23,6 +23,98 @@
 #include <stdio.h>
 #include <stdlib.h> // For getenv
 #include <string.h> // For strncpy
+#include <fcntl.h>    // For open
+#include <unistd.h>   // For close
+#include <sys/mman.h> // For mmap
+#include <sys/stat.h> // For fstat
+#include <errno.h>
+#include <poll.h>     // For waiting on file watches
+#include <time.h>     // For watch deadlines
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+extern char** environ;
+
+// Without inotify, a file watch polls the file's stamp this often.
+#define PLATFORM_WATCH_POLL_MS 500
+
+/**
+ * @brief The entry point and argument of a thread being started.
+ */
+typedef struct {
+    platform_thread_fn entry;
+    void* arg;
+} thread_start;
+
+struct platform_file_watch {
+    int interrupt_pipe[2];  // Readable once the watch is interrupted.
+#ifdef __linux__
+    int inotify_fd;
+    char* name;             // The file's name within the watched directory.
+#else
+    char* path;
+    uint64_t size;          // The file's last stamp; see file_exists.
+    int64_t mtime_ns;
+    bool file_exists;
+#endif
+};
+
+// --- Internal Helpers ---
+
+static void* thread_trampoline(void* arg) {
+    thread_start start = *(thread_start*)arg;
+    free(arg);
+    start.entry(start.arg);
+    return NULL;
+}
+
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Returns the milliseconds left until `deadline`, or -1 (forever) if
+ * there is no deadline.
+ */
+static int remaining_ms(int64_t deadline) {
+    if (deadline < 0) {
+        return -1;
+    }
+    int64_t left = deadline - monotonic_ms();
+    return left > 0 ? (int)left : 0;
+}
+
+#ifdef __linux__
+/**
+ * @brief Drains the pending inotify events.
+ * @return 1 if one concerns the watched file, 0 if none does, -1 if the
+ *         watch on the directory is gone.
+ */
+static int read_watch_events(platform_file_watch* watch) {
+    // Aligned as inotify requires of its records.
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int result = 0;
+    ssize_t length;
+    while ((length = read(watch->inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + length;) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+                return -1;
+            }
+            // On overflow events were lost; assume the file was among them.
+            if ((event->mask & IN_Q_OVERFLOW) ||
+                (event->len > 0 && strcmp(event->name, watch->name) == 0)) {
+                result = 1;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return result;
+}
+#endif
 
 // --- Interface Implementation ---
 
@@ -88,4 +180,363 @@ bool platform_get_home_dir(char* buffer, size_t buffer_size) {
     return strlen(home_dir) < buffer_size;
 }
 
+/**
+ * @see platform.h
+ */
+bool platform_get_system_config_dir(char* buffer, size_t buffer_size) {
+    if (buffer == NULL || buffer_size < sizeof("/etc")) {
+        return false;
+    }
+    memcpy(buffer, "/etc", sizeof("/etc"));
+    return true;
+}
+
+/**
+ * @see platform.h
+ */
+char** platform_get_environment(void) {
+    return environ;
+}
+
+/**
+ * @see platform.h
+ */
+void platform_mutex_lock(platform_mutex_t* mutex) {
+    pthread_mutex_lock(mutex);
+}
+
+/**
+ * @see platform.h
+ */
+void platform_mutex_unlock(platform_mutex_t* mutex) {
+    pthread_mutex_unlock(mutex);
+}
+
+/**
+ * @see platform.h
+ */
+void platform_mutex_destroy(platform_mutex_t* mutex) {
+    pthread_mutex_destroy(mutex);
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_cond_wait(platform_cond_t* cond, platform_mutex_t* mutex, int timeout_ms) {
+    if (timeout_ms < 0) {
+        pthread_cond_wait(cond, mutex);
+        return true;
+    }
+    // PTHREAD_COND_INITIALIZER waits against the realtime clock.
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait(cond, mutex, &deadline) != ETIMEDOUT;
+}
+
+/**
+ * @see platform.h
+ */
+void platform_cond_broadcast(platform_cond_t* cond) {
+    pthread_cond_broadcast(cond);
+}
+
+/**
+ * @see platform.h
+ */
+void platform_cond_destroy(platform_cond_t* cond) {
+    pthread_cond_destroy(cond);
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_thread_create(platform_thread_t* thread, platform_thread_fn entry, void* arg) {
+    thread_start* start = (thread_start*)malloc(sizeof(thread_start));
+    if (!start) {
+        return false;
+    }
+    start->entry = entry;
+    start->arg = arg;
+    if (pthread_create(thread, NULL, thread_trampoline, start) != 0) {
+        free(start);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @see platform.h
+ */
+void platform_thread_join(platform_thread_t thread) {
+    pthread_join(thread, NULL);
+}
+
+/**
+ * @see platform.h
+ */
+uint64_t platform_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @see platform.h
+ */
+unsigned platform_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned)count : 1;
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_map_file(const char* path, platform_mapped_file* file) {
+    memset(file, 0, sizeof(*file));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return false;
+    }
+    if (info.st_size > 0) {
+        void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        // The file is read once, front to back.
+        madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+        file->data = (const char*)data;
+        file->size = (size_t)info.st_size;
+    }
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+    return true;
+}
+
+/**
+ * @see platform.h
+ */
+void platform_unmap_file(platform_mapped_file* file) {
+    if (file->data) {
+        munmap((void*)file->data, file->size);
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_file_stamp(const char* path, uint64_t* size, int64_t* mtime_ns) {
+    struct stat info;
+    if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+    *size = (uint64_t)info.st_size;
+#ifdef __APPLE__
+    *mtime_ns = (int64_t)info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    *mtime_ns = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+/**
+ * @see platform.h
+ */
+char* platform_full_path(const char* path) {
+    return realpath(path, NULL);
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_write_file_atomic(const char* path, const void* data, size_t size) {
+    size_t path_length = strlen(path);
+    char* temp_path = (char*)malloc(path_length + 32);
+    if (!temp_path) {
+        return false;
+    }
+    snprintf(temp_path, path_length + 32, "%s.%d.tmp", path, (int)getpid());
+
+    FILE* file = fopen(temp_path, "wb");
+    if (!file) {
+        free(temp_path);
+        return false;
+    }
+    bool ok = fwrite(data, 1, size, file) == size;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temp_path, path) != 0) {
+        remove(temp_path);
+        free(temp_path);
+        return false;
+    }
+    free(temp_path);
+    return true;
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_make_dirs(const char* path) {
+    size_t length = strlen(path);
+    char* partial = length > 0 ? (char*)malloc(length + 1) : NULL;
+    if (!partial) {
+        return false;
+    }
+    memcpy(partial, path, length + 1);
+    // Create each ancestor in turn; the first separator is the root.
+    for (char* cursor = partial + 1; ; ++cursor) {
+        if (*cursor != '/' && *cursor != '\0') {
+            continue;
+        }
+        char separator = *cursor;
+        *cursor = '\0';
+        if (mkdir(partial, 0700) != 0 && errno != EEXIST) {
+            free(partial);
+            return false;
+        }
+        if (separator == '\0') {
+            break;
+        }
+        *cursor = separator;
+    }
+    free(partial);
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+/**
+ * @see platform.h
+ */
+platform_file_watch* platform_watch_open(const char* path) {
+    platform_file_watch* watch = (platform_file_watch*)calloc(1, sizeof(platform_file_watch));
+    if (!watch) {
+        return NULL;
+    }
+    if (pipe(watch->interrupt_pipe) != 0) {
+        free(watch);
+        return NULL;
+    }
+    fcntl(watch->interrupt_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(watch->interrupt_pipe[1], F_SETFD, FD_CLOEXEC);
+
+#ifdef __linux__
+    // Watch the directory: editors that save by renaming a new file over the
+    // old one would otherwise leave the watch on a deleted inode.
+    const char* slash = strrchr(path, '/');
+    char* directory = slash ? strndup(path, slash == path ? 1 : (size_t)(slash - path)) : strdup(".");
+    watch->name = strdup(slash ? slash + 1 : path);
+    watch->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    bool watching = directory && watch->name && watch->name[0] != '\0' && watch->inotify_fd >= 0 &&
+                    inotify_add_watch(watch->inotify_fd, directory,
+                                      IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE |
+                                      IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF) >= 0;
+    free(directory);
+    if (!watching) {
+        platform_watch_close(watch);
+        return NULL;
+    }
+#else
+    watch->path = strdup(path);
+    if (!watch->path) {
+        platform_watch_close(watch);
+        return NULL;
+    }
+    watch->file_exists = platform_file_stamp(path, &watch->size, &watch->mtime_ns);
+#endif
+    return watch;
+}
+
+/**
+ * @see platform.h
+ */
+int platform_watch_wait(platform_file_watch* watch, int timeout_ms) {
+    int64_t deadline = timeout_ms < 0 ? -1 : monotonic_ms() + timeout_ms;
+    for (;;) {
+        struct pollfd fds[2];
+        fds[0].fd = watch->interrupt_pipe[0];
+        fds[0].events = POLLIN;
+#ifdef __linux__
+        fds[1].fd = watch->inotify_fd;
+        fds[1].events = POLLIN;
+        int ready = poll(fds, 2, remaining_ms(deadline));
+#else
+        int wait_ms = remaining_ms(deadline);
+        if (wait_ms < 0 || wait_ms > PLATFORM_WATCH_POLL_MS) wait_ms = PLATFORM_WATCH_POLL_MS;
+        int ready = poll(fds, 1, wait_ms);
+#endif
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            return 0;
+        }
+#ifdef __linux__
+        if (ready > 0) {
+            int changed = read_watch_events(watch);
+            if (changed != 0) {
+                return changed;
+            }
+        }
+#else
+        uint64_t size = 0;
+        int64_t mtime_ns = 0;
+        bool exists = platform_file_stamp(watch->path, &size, &mtime_ns);
+        if (exists != watch->file_exists || (exists && (size != watch->size || mtime_ns != watch->mtime_ns))) {
+            watch->file_exists = exists;
+            watch->size = size;
+            watch->mtime_ns = mtime_ns;
+            return 1;
+        }
+#endif
+        if (remaining_ms(deadline) == 0) {
+            return 0;
+        }
+    }
+}
+
+/**
+ * @see platform.h
+ */
+void platform_watch_interrupt(platform_file_watch* watch) {
+    // The byte is never read, so the pipe stays readable from now on.
+    ssize_t written;
+    do {
+        written = write(watch->interrupt_pipe[1], "", 1);
+    } while (written < 0 && errno == EINTR);
+}
+
+/**
+ * @see platform.h
+ */
+void platform_watch_close(platform_file_watch* watch) {
+    if (!watch) {
+        return;
+    }
+    close(watch->interrupt_pipe[0]);
+    close(watch->interrupt_pipe[1]);
+#ifdef __linux__
+    if (watch->inotify_fd >= 0) {
+        close(watch->inotify_fd);
+    }
+    free(watch->name);
+#else
+    free(watch->path);
+#endif
+    free(watch);
+}
+
 #endif // !_WIN32
\ No newline at end of file
@@ -24,6 +24,7 @@
 #include <windows.h>
 #include <stdio.h>
 #include <stdlib.h> // For getenv_s
+#include <string.h> // For memset
 
 // --- Module-level static variables ---
 
@@ -35,6 +36,32 @@ static HANDLE hConsole = NULL;
 // This is good practice to avoid interfering with the user's shell state.
 static DWORD dwOriginalOutMode = 0;
 
+/**
+ * @brief The entry point and argument of a thread being started.
+ */
+typedef struct {
+    platform_thread_fn entry;
+    void* arg;
+} thread_start;
+
+struct platform_file_watch {
+    HANDLE change;      // Directory change notification.
+    HANDLE interrupt;   // Manual-reset event, set once interrupted.
+    char* path;
+    uint64_t size;      // The file's last stamp; see file_exists.
+    int64_t mtime_ns;
+    bool file_exists;
+};
+
+// --- Internal Helpers ---
+
+static DWORD WINAPI thread_trampoline(LPVOID arg) {
+    thread_start start = *(thread_start*)arg;
+    free(arg);
+    start.entry(start.arg);
+    return 0;
+}
+
 // --- Interface Implementation ---
 
 /**
@@ -114,4 +141,354 @@ bool platform_get_home_dir(char* buffer, size_t buffer_size) {
     return true;
 }
 
-#endif // _WIN32
\ No newline at end of file
+/**
+ * @see platform.h
+ */
+bool platform_get_system_config_dir(char* buffer, size_t buffer_size) {
+    if (buffer == NULL || buffer_size == 0) {
+        return false;
+    }
+
+    size_t required_size;
+    errno_t err = getenv_s(&required_size, buffer, buffer_size, "ProgramData");
+    return err == 0 && required_size != 0;
+}
+
+/**
+ * @see platform.h
+ */
+char** platform_get_environment(void) {
+    return _environ;
+}
+
+/**
+ * @see platform.h
+ */
+void platform_mutex_lock(platform_mutex_t* mutex) {
+    AcquireSRWLockExclusive((PSRWLOCK)mutex);
+}
+
+/**
+ * @see platform.h
+ */
+void platform_mutex_unlock(platform_mutex_t* mutex) {
+    ReleaseSRWLockExclusive((PSRWLOCK)mutex);
+}
+
+/**
+ * @see platform.h
+ */
+void platform_mutex_destroy(platform_mutex_t* mutex) {
+    (void)mutex; // A slim reader/writer lock holds no resources.
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_cond_wait(platform_cond_t* cond, platform_mutex_t* mutex, int timeout_ms) {
+    DWORD wait = timeout_ms < 0 ? INFINITE : (DWORD)timeout_ms;
+    if (SleepConditionVariableSRW((PCONDITION_VARIABLE)cond, (PSRWLOCK)mutex, wait, 0)) {
+        return true;
+    }
+    return GetLastError() != ERROR_TIMEOUT;
+}
+
+/**
+ * @see platform.h
+ */
+void platform_cond_broadcast(platform_cond_t* cond) {
+    WakeAllConditionVariable((PCONDITION_VARIABLE)cond);
+}
+
+/**
+ * @see platform.h
+ */
+void platform_cond_destroy(platform_cond_t* cond) {
+    (void)cond; // A condition variable holds no resources.
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_thread_create(platform_thread_t* thread, platform_thread_fn entry, void* arg) {
+    thread_start* start = (thread_start*)malloc(sizeof(thread_start));
+    if (!start) {
+        return false;
+    }
+    start->entry = entry;
+    start->arg = arg;
+    HANDLE handle = CreateThread(NULL, 0, thread_trampoline, start, 0, NULL);
+    if (!handle) {
+        free(start);
+        return false;
+    }
+    *thread = handle;
+    return true;
+}
+
+/**
+ * @see platform.h
+ */
+void platform_thread_join(platform_thread_t thread) {
+    WaitForSingleObject((HANDLE)thread, INFINITE);
+    CloseHandle((HANDLE)thread);
+}
+
+/**
+ * @see platform.h
+ */
+uint64_t platform_monotonic_ns(void) {
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency); // Fixed at boot; racing writers agree.
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    uint64_t ticks = (uint64_t)counter.QuadPart;
+    uint64_t rate = (uint64_t)frequency.QuadPart;
+    return ticks / rate * 1000000000u + ticks % rate * 1000000000u / rate;
+}
+
+/**
+ * @see platform.h
+ */
+unsigned platform_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (unsigned)info.dwNumberOfProcessors : 1;
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_map_file(const char* path, platform_mapped_file* file) {
+    memset(file, 0, sizeof(*file));
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || (unsigned long long)size.QuadPart > (size_t)-1) {
+        CloseHandle(handle);
+        return false;
+    }
+    if (size.QuadPart > 0) {
+        // CreateFileMapping rejects empty files, so they are left unmapped.
+        HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        if (!data) {
+            CloseHandle(handle);
+            return false;
+        }
+        file->data = (const char*)data;
+        file->size = (size_t)size.QuadPart;
+    }
+    // The view keeps the file and the mapping open; no handle is needed to read it.
+    CloseHandle(handle);
+    return true;
+}
+
+/**
+ * @see platform.h
+ */
+void platform_unmap_file(platform_mapped_file* file) {
+    if (file->data) {
+        UnmapViewOfFile(file->data);
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_file_stamp(const char* path, uint64_t* size, int64_t* mtime_ns) {
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info) ||
+        (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        return false;
+    }
+    *size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    // FILETIME counts 100 ns intervals since 1601.
+    uint64_t ticks = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+    *mtime_ns = (int64_t)(ticks * 100);
+    return true;
+}
+
+/**
+ * @see platform.h
+ */
+char* platform_full_path(const char* path) {
+    DWORD length = GetFullPathNameA(path, 0, NULL, NULL);
+    char* full_path = length > 0 ? (char*)malloc(length) : NULL;
+    if (full_path) {
+        DWORD written = GetFullPathNameA(path, length, full_path, NULL);
+        if (written == 0 || written >= length) {
+            free(full_path);
+            full_path = NULL;
+        }
+    }
+    return full_path;
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_write_file_atomic(const char* path, const void* data, size_t size) {
+    size_t path_length = strlen(path);
+    char* temp_path = (char*)malloc(path_length + 32);
+    if (!temp_path) {
+        return false;
+    }
+    snprintf(temp_path, path_length + 32, "%s.%lu.tmp", path, (unsigned long)GetCurrentProcessId());
+
+    FILE* file = fopen(temp_path, "wb");
+    if (!file) {
+        free(temp_path);
+        return false;
+    }
+    bool ok = fwrite(data, 1, size, file) == size;
+    ok = fclose(file) == 0 && ok;
+    // Unlike rename(), MoveFileEx can replace an existing file.
+    if (!ok || !MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING)) {
+        remove(temp_path);
+        free(temp_path);
+        return false;
+    }
+    free(temp_path);
+    return true;
+}
+
+/**
+ * @see platform.h
+ */
+bool platform_make_dirs(const char* path) {
+    size_t length = strlen(path);
+    char* partial = length > 0 ? (char*)malloc(length + 1) : NULL;
+    if (!partial) {
+        return false;
+    }
+    memcpy(partial, path, length + 1);
+    // Create each ancestor in turn, skipping a drive ("C:") or the root.
+    for (char* cursor = partial + 1; ; ++cursor) {
+        if (*cursor != '\\' && *cursor != '/' && *cursor != '\0') {
+            continue;
+        }
+        if (*cursor != '\0' && cursor[-1] == ':') {
+            continue;
+        }
+        char separator = *cursor;
+        *cursor = '\0';
+        if (!CreateDirectoryA(partial, NULL) && GetLastError() != ERROR_ALREADY_EXISTS) {
+            free(partial);
+            return false;
+        }
+        if (separator == '\0') {
+            break;
+        }
+        *cursor = separator;
+    }
+    free(partial);
+    DWORD attributes = GetFileAttributesA(path);
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+/**
+ * @see platform.h
+ */
+platform_file_watch* platform_watch_open(const char* path) {
+    platform_file_watch* watch = (platform_file_watch*)calloc(1, sizeof(platform_file_watch));
+    if (!watch) {
+        return NULL;
+    }
+    watch->change = INVALID_HANDLE_VALUE;
+    watch->path = _strdup(path);
+    watch->interrupt = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+    // Notifications cover the whole directory; the stamp tells whether
+    // they concern the file.
+    char directory[MAX_PATH];
+    const char* separator = watch->path ? strrchr(watch->path, '\\') : NULL;
+    const char* slash = watch->path ? strrchr(watch->path, '/') : NULL;
+    if (slash > separator) separator = slash;
+    if (separator && (size_t)(separator - watch->path) < sizeof(directory)) {
+        size_t length = separator == watch->path ? 1 : (size_t)(separator - watch->path);
+        memcpy(directory, watch->path, length);
+        directory[length] = '\0';
+    } else {
+        strcpy(directory, ".");
+    }
+    if (watch->path && watch->interrupt) {
+        watch->change = FindFirstChangeNotificationA(directory, FALSE,
+                                                     FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE |
+                                                     FILE_NOTIFY_CHANGE_LAST_WRITE);
+    }
+    if (watch->change == INVALID_HANDLE_VALUE) {
+        platform_watch_close(watch);
+        return NULL;
+    }
+    watch->file_exists = platform_file_stamp(watch->path, &watch->size, &watch->mtime_ns);
+    return watch;
+}
+
+/**
+ * @see platform.h
+ */
+int platform_watch_wait(platform_file_watch* watch, int timeout_ms) {
+    ULONGLONG deadline = timeout_ms < 0 ? 0 : GetTickCount64() + (ULONGLONG)timeout_ms;
+    for (;;) {
+        DWORD wait_ms = INFINITE;
+        if (timeout_ms >= 0) {
+            ULONGLONG now = GetTickCount64();
+            wait_ms = now < deadline ? (DWORD)(deadline - now) : 0;
+        }
+        HANDLE handles[2] = { watch->interrupt, watch->change };
+        DWORD result = WaitForMultipleObjects(2, handles, FALSE, wait_ms);
+        if (result == WAIT_OBJECT_0 || result == WAIT_TIMEOUT) {
+            return 0;
+        }
+        if (result != WAIT_OBJECT_0 + 1 || !FindNextChangeNotification(watch->change)) {
+            return -1;
+        }
+
+        uint64_t size = 0;
+        int64_t mtime_ns = 0;
+        bool exists = platform_file_stamp(watch->path, &size, &mtime_ns);
+        if (exists != watch->file_exists || (exists && (size != watch->size || mtime_ns != watch->mtime_ns))) {
+            watch->file_exists = exists;
+            watch->size = size;
+            watch->mtime_ns = mtime_ns;
+            return 1;
+        }
+    }
+}
+
+/**
+ * @see platform.h
+ */
+void platform_watch_interrupt(platform_file_watch* watch) {
+    SetEvent(watch->interrupt);
+}
+
+/**
+ * @see platform.h
+ */
+void platform_watch_close(platform_file_watch* watch) {
+    if (!watch) {
+        return;
+    }
+    if (watch->change != INVALID_HANDLE_VALUE) {
+        FindCloseChangeNotification(watch->change);
+    }
+    if (watch->interrupt) {
+        CloseHandle(watch->interrupt);
+    }
+    free(watch->path);
+    free(watch);
+}
+
+#endif // _WIN32
@@ -16,10 +16,14 @@
  * SPDX-License-Identifier: Apache-2.0 */
 
 #include "lua_bridge.h"
+#include "lua_bytecode_cache.h"
 #include "libs/liblogger/Logger.hpp"
+#include "libs/liblogger/StartupTrace.hpp"
 #include "platform/platform.h"
 #include "cli/cli_parser.h"
+#include "module_loader/command_index.h"
 #include "core/config/config_manager.h"
+#include "core/config/config_table.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -44,6 +48,7 @@ static lua_State* g_lua_state = NULL;
 typedef struct {
     char* command_name;
     char* lua_function_name;
+    int function_ref;       // The function, pinned in the Lua registry
     char* description;
     char* usage;
 } lua_command_entry_t;
@@ -52,10 +57,16 @@ static lua_command_entry_t* g_lua_commands = NULL;
 static size_t g_lua_command_count = 0;
 static size_t g_lua_command_capacity = 0;
 
+// A function registered for a hook. The name is kept for messages.
+typedef struct {
+    char* name;
+    int ref;                // The function, pinned in the Lua registry
+} lua_hook_function_t;
+
 // Hook registry for event-driven plugin execution
 typedef struct {
     char* hook_name;
-    char** function_names;
+    lua_hook_function_t* functions;
     size_t function_count;
     size_t function_capacity;
 } lua_hook_registry_t;
@@ -64,6 +75,16 @@ static lua_hook_registry_t* g_hook_registry = NULL;
 static size_t g_hook_count = 0;
 static size_t g_hook_capacity = 0;
 
+// The hook run with the keys of configuration changes.
+#define CONFIG_CHANGED_HOOK "config-changed"
+
+// Configuration changes wait here, as a set of keys with empty values, for
+// lua_bridge_dispatch_config_changes: they may be made on any thread, while
+// the Lua state may only be used by the thread that owns it.
+static ConfigTable g_pending_config_changes;
+static platform_mutex_t g_pending_config_lock = PLATFORM_MUTEX_INIT;
+static int g_config_subscription = -1;
+
 // --- Internal Helper Functions ---
 
 /**
@@ -97,15 +118,51 @@ static bool grow_array(void** ptr, size_t current_size, size_t* current_capacity
 }
 
 /**
- * @brief Finds a Lua command by name in the registry.
+ * @brief Finds a Lua command by name, through the command index.
  *
  * @param command_name The command name to search for
  * @return Pointer to the command entry, or NULL if not found
  */
 static lua_command_entry_t* find_lua_command(const char* command_name) {
-    for (size_t i = 0; i < g_lua_command_count; i++) {
-        if (strcmp(g_lua_commands[i].command_name, command_name) == 0) {
-            return &g_lua_commands[i];
+    const CommandHandler* handler = command_index_find(command_name);
+    if (!handler || handler->kind != COMMAND_HANDLER_LUA) {
+        return NULL;
+    }
+    return &g_lua_commands[handler->lua_command];
+}
+
+/**
+ * @brief Pins the function stored in a global in the Lua registry.
+ *
+ * Dispatch then fetches it with `lua_rawgeti` on the reference instead of
+ * hashing its name and looking it up in `_G` on every call. The function
+ * registered is the one the global holds now; redefining the global later
+ * does not change it.
+ *
+ * @param L The Lua state.
+ * @param function_name The name of the global holding the function.
+ * @return The reference, or LUA_NOREF if the global is not a function.
+ */
+static int pin_global_function(lua_State* L, const char* function_name) {
+    lua_getglobal(L, function_name);
+    if (!lua_isfunction(L, -1)) {
+        lua_pop(L, 1);
+        return LUA_NOREF;
+    }
+    return luaL_ref(L, LUA_REGISTRYINDEX); // Pops the function
+}
+
+/**
+ * @brief Finds a hook registry entry.
+ *
+ * @param hook_name The name of the hook
+ * @return Pointer to the hook registry entry, or NULL if nothing was ever
+ *         registered for it
+ */
+static lua_hook_registry_t* find_hook(const char* hook_name) {
+    for (size_t i = 0; i < g_hook_count; i++) {
+        if (strcmp(g_hook_registry[i].hook_name, hook_name) == 0) {
+            return &g_hook_registry[i];
         }
     }
     return NULL;
@@ -119,10 +176,9 @@ static lua_command_entry_t* find_lua_command(const char* command_name) {
  */
 static lua_hook_registry_t* find_or_create_hook(const char* hook_name) {
     // First, try to find existing hook
-    for (size_t i = 0; i < g_hook_count; i++) {
-        if (strcmp(g_hook_registry[i].hook_name, hook_name) == 0) {
-            return &g_hook_registry[i];
-        }
+    lua_hook_registry_t* existing = find_hook(hook_name);
+    if (existing) {
+        return existing;
     }
     
     // Create new hook entry
@@ -133,15 +189,46 @@ static lua_hook_registry_t* find_or_create_hook(const char* hook_name) {
     
     lua_hook_registry_t* hook = &g_hook_registry[g_hook_count++];
     hook->hook_name = strdup(hook_name);
-    hook->function_names = NULL;
+    hook->functions = NULL;
     hook->function_count = 0;
     hook->function_capacity = 0;
     
     return hook;
 }
 
+/**
+ * @brief Loads and runs a plugin, from cached bytecode when it is current.
+ *
+ * @param path The plugin's source file.
+ * @param cache_dir The bytecode cache directory, or NULL to compile the source.
+ * @return LUA_OK, or an error code with the error message pushed.
+ */
+static int run_plugin(const char* path, const char* cache_dir) {
+    int status = lua_bytecode_cache_load(g_lua_state, cache_dir, path);
+    if (status != LUA_OK) {
+        return status;
+    }
+    return lua_pcall(g_lua_state, 0, 0, 0);
+}
+
 // --- Enhanced C Functions Exposed to Lua ---
 
+/**
+ * @brief Queues changed configuration keys for the "config-changed" hook.
+ * Subscribed with config_subscribe; runs on the thread making the change.
+ */
+static void queue_config_changes(const char* const* keys, size_t count, void* user_data) {
+    (void)user_data;
+    platform_mutex_lock(&g_pending_config_lock);
+    for (size_t i = 0; i < count; ++i) {
+        if (config_table_set(&g_pending_config_changes, keys[i], strlen(keys[i]), "", 0) != 0) {
+            logger_log(LOG_LEVEL_ERROR, "LUA_BRIDGE", "Failed to queue a configuration change for Lua hooks.");
+            break;
+        }
+    }
+    platform_mutex_unlock(&g_pending_config_lock);
+}
+
 /**
  * @brief Enhanced Lua binding for the core logging function.
  *
@@ -236,7 +323,11 @@ static int l_ph_run_command(lua_State* L) {
 /**
  * @brief Lua binding for configuration value retrieval.
  *
- * Exposes `config_get_value` to Lua scripts.
+ * Exposes `config_get_view` to Lua scripts. The value is copied into a
+ * buffer on the C stack inside a read section, which keeps the view valid
+ * even if another thread changes the configuration meanwhile, and pushed
+ * once the section has ended: a memory error raised by Lua would jump past
+ * `config_read_end` and pin the thread's reader slot for good.
  * Lua usage: `local value = ph.config_get("user.name")`
  *
  * @param L The Lua state.
@@ -244,16 +335,33 @@ static int l_ph_run_command(lua_State* L) {
  */
 static int l_ph_config_get(lua_State* L) {
     const char* key = luaL_checkstring(L, 1);
-    
-    char* value = config_get_value(key);
-    if (value) {
-        lua_pushstring(L, value);
-        free(value);
-    } else {
-        lua_pushnil(L);
+    char stack_buffer[256];
+    char* buffer = stack_buffer;
+    size_t capacity = sizeof(stack_buffer);
+
+    for (;;) {
+        size_t length = 0;
+        config_read_begin();
+        const char* value = config_get_view(key, &length);
+        bool found = value != NULL;
+        bool fits = !found || length <= capacity;
+        if (found && fits) {
+            memcpy(buffer, value, length);
+        }
+        config_read_end();
+
+        if (fits) {
+            if (found) {
+                lua_pushlstring(L, buffer, length);
+            } else {
+                lua_pushnil(L);
+            }
+            return 1;
+        }
+        // A long value: make room outside the section, then read it again.
+        capacity = length;
+        buffer = (char*)lua_newuserdatauv(L, capacity, 0);
     }
-    
-    return 1;
 }
 
 /**
@@ -275,10 +383,154 @@ static int l_ph_config_set(lua_State* L) {
     return 1;
 }
 
+/**
+ * @brief Lua binding for the configuration generation.
+ *
+ * Exposes `config_generation` so scripts can cache values read with
+ * `ph.config_get` and re-read them only when the number changes.
+ * Lua usage: `if ph.config_generation() ~= cached_generation then ... end`
+ *
+ * @param L The Lua state.
+ * @return The number of return values pushed onto the stack (1 - integer).
+ */
+static int l_ph_config_generation(lua_State* L) {
+    lua_pushinteger(L, (lua_Integer)config_generation());
+    return 1;
+}
+
+/**
+ * @brief Lua binding for integer configuration values.
+ *
+ * Exposes `config_get_int`; the value is read from the classification made
+ * when it was stored, so nothing is parsed. When the key is not set or its
+ * value is not an integer, the optional second argument is returned instead
+ * (nil if absent); the other typed getters below do the same.
+ * Lua usage: `local retries = ph.config_get_int("net.retries", 3)`
+ *
+ * @param L The Lua state.
+ * @return The number of return values pushed onto the stack (1 - integer, or the default).
+ */
+static int l_ph_config_get_int(lua_State* L) {
+    const char* key = luaL_checkstring(L, 1);
+    int64_t value = 0;
+    if (config_get_int(key, &value) == ph_SUCCESS) {
+        lua_pushinteger(L, (lua_Integer)value);
+    } else {
+        lua_settop(L, 2); // The default, or nil.
+    }
+    return 1;
+}
+
+/**
+ * @brief Lua binding for boolean configuration values.
+ *
+ * Exposes `config_get_bool`, which accepts true/false, yes/no, on/off and 1/0.
+ * Lua usage: `if ph.config_get_bool("ph.workflow.auto-sync", true) then ... end`
+ *
+ * @param L The Lua state.
+ * @return The number of return values pushed onto the stack (1 - boolean, or the default).
+ */
+static int l_ph_config_get_bool(lua_State* L) {
+    const char* key = luaL_checkstring(L, 1);
+    bool value = false;
+    if (config_get_bool(key, &value) == ph_SUCCESS) {
+        lua_pushboolean(L, value ? 1 : 0);
+    } else {
+        lua_settop(L, 2); // The default, or nil.
+    }
+    return 1;
+}
+
+/**
+ * @brief Lua binding for duration configuration values, in milliseconds.
+ *
+ * Exposes `config_get_duration_ms`, which accepts `1500`, `30s`, `1h30m`...
+ * Lua usage: `local timeout = ph.config_get_duration_ms("net.timeout", 5000)`
+ *
+ * @param L The Lua state.
+ * @return The number of return values pushed onto the stack (1 - integer, or the default).
+ */
+static int l_ph_config_get_duration_ms(lua_State* L) {
+    const char* key = luaL_checkstring(L, 1);
+    int64_t value = 0;
+    if (config_get_duration_ms(key, &value) == ph_SUCCESS) {
+        lua_pushinteger(L, (lua_Integer)value);
+    } else {
+        lua_settop(L, 2); // The default, or nil.
+    }
+    return 1;
+}
+
+/**
+ * @brief Lua binding for comma-separated configuration lists.
+ *
+ * Exposes `config_get_list`: the items are trimmed and empty ones skipped.
+ * As in l_ph_config_get, they are copied out inside a read section, and the
+ * table is built once it has ended.
+ * Lua usage: `for _, remote in ipairs(ph.config_get_list("sync.remotes", {})) do ... end`
+ *
+ * @param L The Lua state.
+ * @return The number of return values pushed onto the stack (1 - table, or the default).
+ */
+static int l_ph_config_get_list(lua_State* L) {
+    const char* key = luaL_checkstring(L, 1);
+    ConfigListItem stack_items[32];
+    char stack_text[1024];
+    ConfigListItem* items = stack_items;
+    char* text = stack_text;
+    size_t capacity = sizeof(stack_items) / sizeof(stack_items[0]);
+    size_t text_capacity = sizeof(stack_text);
+
+    for (;;) {
+        config_read_begin();
+        bool found = config_get_view(key, NULL) != NULL;
+        size_t count = found ? config_get_list(key, items, capacity) : 0;
+        size_t text_size = 0;
+        for (size_t i = 0; i < count && i < capacity; ++i) {
+            text_size += items[i].length;
+        }
+        bool fits = count <= capacity && text_size <= text_capacity;
+        if (fits) {
+            // Repoint the items at the copy, which outlives the section.
+            size_t offset = 0;
+            for (size_t i = 0; i < count; ++i) {
+                memcpy(text + offset, items[i].data, items[i].length);
+                items[i].data = text + offset;
+                offset += items[i].length;
+            }
+        }
+        config_read_end();
+
+        if (!found) {
+            lua_settop(L, 2); // The default, or nil.
+            return 1;
+        }
+        if (fits) {
+            lua_createtable(L, (int)count, 0);
+            for (size_t i = 0; i < count; ++i) {
+                lua_pushlstring(L, items[i].data, items[i].length);
+                lua_rawseti(L, -2, (lua_Integer)i + 1);
+            }
+            return 1;
+        }
+        // A long list: make room outside the section, collected with the
+        // table, then read it again.
+        if (count > capacity) {
+            capacity = count;
+            items = (ConfigListItem*)lua_newuserdatauv(L, capacity * sizeof(ConfigListItem), 0);
+        }
+        if (text_size > text_capacity) {
+            text_capacity = text_size;
+            text = (char*)lua_newuserdatauv(L, text_capacity, 0);
+        }
+    }
+}
+
 /**
  * @brief Lua binding for dynamic command registration.
  *
- * Allows Lua scripts to register new commands with the CLI parser.
+ * Allows Lua scripts to register new commands with the CLI parser. The
+ * function the global holds now is pinned and called from then on.
  * Lua usage: `ph.register_command("mycommand", "my_lua_function", "Description", "Usage")`
  *
  * @param L The Lua state.
@@ -295,34 +547,41 @@ static int l_ph_register_command(lua_State* L) {
     const char* description = n_args >= 3 ? luaL_checkstring(L, 3) : "User-defined command";
     const char* usage = n_args >= 4 ? luaL_checkstring(L, 4) : command_name;
     
-    // Check if command already exists
-    if (find_lua_command(command_name)) {
+    // Check if command already exists, as a Lua or a native command
+    if (command_index_find(command_name)) {
         logger_log_fmt(LOG_LEVEL_WARN, "LUA_BRIDGE", "Command '%s' already registered, ignoring duplicate", command_name);
         lua_pushboolean(L, 0);
         return 1;
     }
     
-    // Verify the Lua function exists
-    lua_getglobal(L, lua_function);
-    if (!lua_isfunction(L, -1)) {
-        lua_pop(L, 1);
+    // Verify the Lua function exists, and pin it
+    int function_ref = pin_global_function(L, lua_function);
+    if (function_ref == LUA_NOREF) {
         logger_log_fmt(LOG_LEVEL_ERROR, "LUA_BRIDGE", "Lua function '%s' not found for command '%s'", lua_function, command_name);
         lua_pushboolean(L, 0);
         return 1;
     }
-    lua_pop(L, 1);
     
     // Grow command array if needed
     if (!grow_array((void**)&g_lua_commands, g_lua_command_count, &g_lua_command_capacity, 
                    sizeof(lua_command_entry_t), g_lua_command_count + 1)) {
+        luaL_unref(L, LUA_REGISTRYINDEX, function_ref);
         lua_pushboolean(L, 0);
         return 1;
     }
     
-    // Register the command
+    // Register the command, and index it so it is found in one probe
+    CommandHandler handler = {COMMAND_HANDLER_LUA, NULL, g_lua_command_count};
+    if (command_index_add(command_name, &handler) != ph_SUCCESS) {
+        logger_log_fmt(LOG_LEVEL_ERROR, "LUA_BRIDGE", "Failed to index command '%s'", command_name);
+        luaL_unref(L, LUA_REGISTRYINDEX, function_ref);
+        lua_pushboolean(L, 0);
+        return 1;
+    }
     lua_command_entry_t* entry = &g_lua_commands[g_lua_command_count++];
     entry->command_name = strdup(command_name);
     entry->lua_function_name = strdup(lua_function);
+    entry->function_ref = function_ref;
     entry->description = strdup(description);
     entry->usage = strdup(usage);
     
@@ -335,6 +594,7 @@ static int l_ph_register_command(lua_State* L) {
  * @brief Lua binding for hook registration.
  *
  * Allows Lua scripts to register functions to be called on specific hooks.
+ * The function the global holds now is pinned and called from then on.
  * Lua usage: `ph.register_hook("pre-commit", "my_pre_commit_function")`
  *
  * @param L The Lua state.
@@ -344,32 +604,34 @@ static int l_ph_register_hook(lua_State* L) {
     const char* hook_name = luaL_checkstring(L, 1);
     const char* function_name = luaL_checkstring(L, 2);
     
-    // Verify the Lua function exists
-    lua_getglobal(L, function_name);
-    if (!lua_isfunction(L, -1)) {
-        lua_pop(L, 1);
+    // Verify the Lua function exists, and pin it
+    int function_ref = pin_global_function(L, function_name);
+    if (function_ref == LUA_NOREF) {
         logger_log_fmt(LOG_LEVEL_ERROR, "LUA_BRIDGE", "Lua function '%s' not found for hook '%s'", function_name, hook_name);
         lua_pushboolean(L, 0);
         return 1;
     }
-    lua_pop(L, 1);
     
     // Find or create hook registry
     lua_hook_registry_t* hook = find_or_create_hook(hook_name);
     if (!hook) {
+        luaL_unref(L, LUA_REGISTRYINDEX, function_ref);
         lua_pushboolean(L, 0);
         return 1;
     }
     
     // Grow function array if needed
-    if (!grow_array((void**)&hook->function_names, hook->function_count, &hook->function_capacity,
-                   sizeof(char*), hook->function_count + 1)) {
+    if (!grow_array((void**)&hook->functions, hook->function_count, &hook->function_capacity,
+                   sizeof(lua_hook_function_t), hook->function_count + 1)) {
+        luaL_unref(L, LUA_REGISTRYINDEX, function_ref);
         lua_pushboolean(L, 0);
         return 1;
     }
     
     // Register the function
-    hook->function_names[hook->function_count++] = strdup(function_name);
+    lua_hook_function_t* function = &hook->functions[hook->function_count++];
+    function->name = strdup(function_name);
+    function->ref = function_ref;
     
     logger_log_fmt(LOG_LEVEL_DEBUG, "LUA_BRIDGE", "Registered function '%s' for hook '%s'", function_name, hook_name);
     lua_pushboolean(L, 1);
@@ -428,6 +690,11 @@ static const struct luaL_Reg ph_lib[] = {
     // Configuration management
     {"config_get", l_ph_config_get},
     {"config_set", l_ph_config_set},
+    {"config_generation", l_ph_config_generation},
+    {"config_get_int", l_ph_config_get_int},
+    {"config_get_bool", l_ph_config_get_bool},
+    {"config_get_duration_ms", l_ph_config_get_duration_ms},
+    {"config_get_list", l_ph_config_get_list},
     
     // Dynamic registration
     {"register_command", l_ph_register_command},
@@ -450,11 +717,13 @@ phStatus lua_bridge_init(void) {
         logger_log(LOG_LEVEL_WARN, "LUA_BRIDGE", "Lua bridge already initialized.");
         return ph_SUCCESS;
     }
+    uint64_t trace = startup_trace_begin();
 
     // 1. Create Lua state and load standard libraries
     g_lua_state = luaL_newstate();
     if (!g_lua_state) {
         logger_log(LOG_LEVEL_FATAL, "LUA_BRIDGE", "Failed to create Lua state.");
+        startup_trace_end("lua", "lua_bridge_init", trace);
         return ph_ERROR_INIT_FAILED;
     }
     luaL_openlibs(g_lua_state);
@@ -469,8 +738,14 @@ phStatus lua_bridge_init(void) {
     lua_setfield(g_lua_state, -2, "version");
     lua_pop(g_lua_state, 1);
 
-    // 4. Scan and load all scripts from the "plugins" directory
+    // 4. Scan and load all scripts from the "plugins" directory, skipping
+    //    the compiler for those whose bytecode is cached
     const char* plugin_dir = "plugins";
+    char cache_dir_buffer[1024];
+    const char* cache_dir = lua_bytecode_cache_enabled() &&
+                            lua_bytecode_cache_default_dir(cache_dir_buffer, sizeof(cache_dir_buffer))
+                                ? cache_dir_buffer
+                                : NULL;
 
 #ifdef PLATFORM_WINDOWS
     char search_path[MAX_PATH];
@@ -481,7 +756,10 @@ phStatus lua_bridge_init(void) {
         do {
             char full_path[MAX_PATH];
             snprintf(full_path, sizeof(full_path), "%s\\%s", plugin_dir, fd.cFileName);
-            if (luaL_dofile(g_lua_state, full_path) != LUA_OK) {
+            uint64_t plugin_trace = startup_trace_begin();
+            int loaded = run_plugin(full_path, cache_dir);
+            startup_trace_end("plugin", full_path, plugin_trace);
+            if (loaded != LUA_OK) {
                 logger_log_fmt(LOG_LEVEL_ERROR, "LUA_BRIDGE", "Failed to load plugin '%s': %s", 
                               full_path, lua_tostring(g_lua_state, -1));
                 lua_pop(g_lua_state, 1); // Pop error message from stack
@@ -499,7 +777,10 @@ phStatus lua_bridge_init(void) {
             if (strstr(dir->d_name, ".lua")) {
                 char full_path[1024];
                 snprintf(full_path, sizeof(full_path), "%s/%s", plugin_dir, dir->d_name);
-                if (luaL_dofile(g_lua_state, full_path) != LUA_OK) {
+                uint64_t plugin_trace = startup_trace_begin();
+                int loaded = run_plugin(full_path, cache_dir);
+                startup_trace_end("plugin", full_path, plugin_trace);
+                if (loaded != LUA_OK) {
                     logger_log_fmt(LOG_LEVEL_ERROR, "LUA_BRIDGE", "Failed to load plugin '%s': %s", 
                                   full_path, lua_tostring(g_lua_state, -1));
                     lua_pop(g_lua_state, 1); // Pop error message
@@ -512,8 +793,12 @@ phStatus lua_bridge_init(void) {
     }
 #endif
 
+    // 5. Forward configuration changes to the "config-changed" hook
+    g_config_subscription = config_subscribe(queue_config_changes, NULL);
+
     logger_log_fmt(LOG_LEVEL_INFO, "LUA_BRIDGE", "Lua scripting engine initialized with %zu registered commands", 
                   g_lua_command_count);
+    startup_trace_end("lua", "lua_bridge_init", trace);
     return ph_SUCCESS;
 }
 
@@ -526,14 +811,8 @@ phStatus lua_bridge_execute_command(const char* command_name, int argc, const ch
     lua_command_entry_t* cmd = find_lua_command(command_name);
     if (!cmd) return ph_ERROR_NOT_FOUND;
     
-    // Get the Lua function
-    lua_getglobal(g_lua_state, cmd->lua_function_name);
-    if (!lua_isfunction(g_lua_state, -1)) {
-        lua_pop(g_lua_state, 1);
-        logger_log_fmt(LOG_LEVEL_ERROR, "LUA_BRIDGE", "Command function '%s' is no longer valid", 
-                      cmd->lua_function_name);
-        return ph_ERROR_EXEC_FAILED;
-    }
+    // Get the Lua function, pinned when the command was registered
+    lua_rawgeti(g_lua_state, LUA_REGISTRYINDEX, cmd->function_ref);
     
     // Push arguments onto the stack
     for (int i = 0; i < argc; ++i) {
@@ -567,14 +846,7 @@ phStatus lua_bridge_run_hook(const char* hook_name, int argc, const char** argv)
     if (!g_lua_state) return ph_ERROR_GENERAL;
     
     // Find the hook registry
-    lua_hook_registry_t* hook = NULL;
-    for (size_t i = 0; i < g_hook_count; i++) {
-        if (strcmp(g_hook_registry[i].hook_name, hook_name) == 0) {
-            hook = &g_hook_registry[i];
-            break;
-        }
-    }
-    
+    lua_hook_registry_t* hook = find_hook(hook_name);
     if (!hook || hook->function_count == 0) {
         return ph_ERROR_NOT_FOUND; // No functions registered for this hook
     }
@@ -582,14 +854,7 @@ phStatus lua_bridge_run_hook(const char* hook_name, int argc, const char** argv)
     // Execute all functions registered for this hook
     phStatus overall_result = ph_SUCCESS;
     for (size_t i = 0; i < hook->function_count; i++) {
-        lua_getglobal(g_lua_state, hook->function_names[i]);
-        
-        if (!lua_isfunction(g_lua_state, -1)) {
-            lua_pop(g_lua_state, 1);
-            logger_log_fmt(LOG_LEVEL_WARN, "LUA_BRIDGE", "Hook function '%s' is no longer valid", 
-                          hook->function_names[i]);
-            continue;
-        }
+        lua_rawgeti(g_lua_state, LUA_REGISTRYINDEX, hook->functions[i].ref);
         
         // Push arguments onto the stack
         for (int j = 0; j < argc; ++j) {
@@ -599,7 +864,7 @@ phStatus lua_bridge_run_hook(const char* hook_name, int argc, const char** argv)
         // Call the function
         if (lua_pcall(g_lua_state, argc, 0, 0) != LUA_OK) {
             logger_log_fmt(LOG_LEVEL_ERROR, "LUA_BRIDGE", "Error running hook '%s' function '%s': %s", 
-                          hook_name, hook->function_names[i], lua_tostring(g_lua_state, -1));
+                          hook_name, hook->functions[i].name, lua_tostring(g_lua_state, -1));
             lua_pop(g_lua_state, 1); // Pop error message
             overall_result = ph_ERROR_EXEC_FAILED;
         }
@@ -608,6 +873,54 @@ phStatus lua_bridge_run_hook(const char* hook_name, int argc, const char** argv)
     return overall_result;
 }
 
+/**
+ * @see lua_bridge.h
+ */
+phStatus lua_bridge_dispatch_config_changes(void) {
+    if (!g_lua_state) return ph_ERROR_GENERAL;
+
+    // Take the pending set as a whole, so the lock is not held while Lua runs.
+    ConfigTable changes;
+    platform_mutex_lock(&g_pending_config_lock);
+    changes = g_pending_config_changes;
+    config_table_init(&g_pending_config_changes);
+    platform_mutex_unlock(&g_pending_config_lock);
+    if (changes.count == 0) {
+        config_table_destroy(&changes);
+        return ph_SUCCESS;
+    }
+
+    lua_hook_registry_t* hook = find_hook(CONFIG_CHANGED_HOOK);
+
+    // The keys are passed as one array, whatever their number.
+    phStatus overall_result = ph_SUCCESS;
+    if (hook && hook->function_count > 0) {
+        lua_createtable(g_lua_state, (int)changes.count, 0);
+        size_t cursor = 0;
+        lua_Integer index = 1;
+        const ConfigEntry* entry;
+        while ((entry = config_table_next(&changes, &cursor)) != NULL) {
+            lua_pushlstring(g_lua_state, config_table_key(&changes, entry), entry->key_length);
+            lua_rawseti(g_lua_state, -2, index++);
+        }
+
+        for (size_t i = 0; i < hook->function_count; i++) {
+            lua_rawgeti(g_lua_state, LUA_REGISTRYINDEX, hook->functions[i].ref);
+            lua_pushvalue(g_lua_state, -2); // The keys
+            if (lua_pcall(g_lua_state, 1, 0, 0) != LUA_OK) {
+                logger_log_fmt(LOG_LEVEL_ERROR, "LUA_BRIDGE", "Error running hook '%s' function '%s': %s",
+                              CONFIG_CHANGED_HOOK, hook->functions[i].name, lua_tostring(g_lua_state, -1));
+                lua_pop(g_lua_state, 1); // Pop error message
+                overall_result = ph_ERROR_EXEC_FAILED;
+            }
+        }
+        lua_pop(g_lua_state, 1); // Pop the keys
+    }
+
+    config_table_destroy(&changes);
+    return overall_result;
+}
+
 /**
  * @see lua_bridge.h
  */
@@ -669,12 +982,21 @@ void lua_bridge_free_command_names_list(const char** names_list) {
  * @see lua_bridge.h
  */
 void lua_bridge_cleanup(void) {
+    // Once this returns, no change is queued any more.
+    config_unsubscribe(g_config_subscription);
+    g_config_subscription = -1;
+    platform_mutex_lock(&g_pending_config_lock);
+    config_table_destroy(&g_pending_config_changes);
+    platform_mutex_unlock(&g_pending_config_lock);
+
+    // Closing the state also releases the functions pinned in its registry.
     if (g_lua_state) {
         lua_close(g_lua_state);
         g_lua_state = NULL;
     }
     
     // Clean up command registry
+    command_index_remove_kind(COMMAND_HANDLER_LUA);
     for (size_t i = 0; i < g_lua_command_count; i++) {
         free(g_lua_commands[i].command_name);
         free(g_lua_commands[i].lua_function_name);
@@ -690,9 +1012,9 @@ void lua_bridge_cleanup(void) {
     for (size_t i = 0; i < g_hook_count; i++) {
         free(g_hook_registry[i].hook_name);
         for (size_t j = 0; j < g_hook_registry[i].function_count; j++) {
-            free(g_hook_registry[i].function_names[j]);
+            free(g_hook_registry[i].functions[j].name);
         }
-        free(g_hook_registry[i].function_names);
+        free(g_hook_registry[i].functions);
     }
     free(g_hook_registry);
     g_hook_registry = NULL;
@@ -43,6 +43,9 @@ phStatus lua_bridge_execute_command(const char* command_name, int argc, const ch
 /**
  * @brief Runs all Lua functions registered for a specific lifecycle hook.
  *
+ * Functions are called as they were when registered: they are pinned by
+ * reference, so redefining their globals afterwards does not affect hooks.
+ *
  * @param hook_name The name of the hook to run (e.g., "pre-commit").
  * @param argc The number of arguments to pass to the hook functions.
  * @param argv The argument vector.
@@ -51,6 +54,22 @@ phStatus lua_bridge_execute_command(const char* command_name, int argc, const ch
  */
 phStatus lua_bridge_run_hook(const char* hook_name, int argc, const char** argv);
 
+/**
+ * @brief Runs the "config-changed" hook for the configuration changes made
+ * since the last call.
+ *
+ * The bridge subscribes to configuration changes when it is initialized.
+ * They may be made on any thread, such as the watcher thread of
+ * `config_watch_start`, but the Lua state belongs to the thread that
+ * initialized it, so changes are queued and delivered by this function,
+ * which that thread calls from its loop. Each function registered for the
+ * hook receives a single argument: an array of the keys that changed.
+ *
+ * @return ph_SUCCESS if nothing changed or every hook function succeeded,
+ * ph_ERROR_EXEC_FAILED if any of them fails.
+ */
+phStatus lua_bridge_dispatch_config_changes(void);
+
 /**
  * @brief Checks if a command is registered by the Lua bridge.
  *
@@ -0,0 +1,255 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * lua_bytecode_cache.c - Reading and writing cached Lua bytecode.
+ *
+ * See lua_bytecode_cache.h for the layout. A cache file is mapped only for
+ * the duration of the load: `luaL_loadbufferx` builds the function from the
+ * bytes and keeps no reference to them. Loading is restricted to binary
+ * chunks, so a cache file can never be mistaken for source. The checksum is
+ * the configuration table's hash, as for the module manifest.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "lua_bytecode_cache.h"
+#include "config/config_table.h"     // For config_table_hash
+#include "platform/platform.h"       // For mapping, stamping and replacing files
+#include "libs/liblogger/Logger.hpp" // For reporting cache writes that fail
+#include <lauxlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Internal Helpers ---
+
+#define LUAC_CACHE_MAGIC 0x434C4850u // "PHLC" read as a little-endian word.
+#define LUAC_CACHE_VERSION 1
+#define LUAC_CACHE_SUFFIX ".luac"
+
+#ifdef LUA_VERSION_RELEASE_NUM
+#define LUAC_CACHE_LUA_RELEASE LUA_VERSION_RELEASE_NUM
+#else
+#define LUAC_CACHE_LUA_RELEASE 0
+#endif
+
+/**
+ * @brief The first bytes of a cache file. The plugin's absolute path
+ *        follows it, without a terminating NUL, then the bytecode.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t lua_version;       // LUA_VERSION_NUM of the writer.
+    uint32_t lua_release;       // LUA_VERSION_RELEASE_NUM of the writer.
+    uint64_t checksum;          // Of every byte after the header.
+    uint64_t source_size;       // The plugin's stamp when it was compiled.
+    int64_t source_mtime_ns;
+    uint32_t path_length;
+    uint32_t reserved;          // 0.
+    uint64_t bytecode_size;
+} LuacCacheHeader;
+
+// The bytecode being dumped, after room for the header and the path.
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} DumpBuffer;
+
+/**
+ * @brief Returns the path of a plugin's cache file, named after the hash of
+ *        the plugin's absolute path, or NULL if memory runs out. The caller
+ *        frees it.
+ */
+static char* cache_path_for(const char* cache_dir, const char* full_path) {
+    char name[sizeof("0123456789abcdef" LUAC_CACHE_SUFFIX)];
+    snprintf(name, sizeof(name), "%016llx" LUAC_CACHE_SUFFIX,
+             (unsigned long long)config_table_hash(full_path, strlen(full_path)));
+    size_t length = strlen(cache_dir) + sizeof(name) + 1;
+    char* cache_path = (char*)malloc(length);
+    if (cache_path) {
+#ifdef PLATFORM_WINDOWS
+        snprintf(cache_path, length, "%s\\%s", cache_dir, name);
+#else
+        snprintf(cache_path, length, "%s/%s", cache_dir, name);
+#endif
+    }
+    return cache_path;
+}
+
+/**
+ * @brief Returns the chunk name `luaL_loadfile` gives a file, "@path", or
+ *        NULL if memory runs out. The caller frees it.
+ */
+static char* chunk_name_for(const char* path) {
+    size_t length = strlen(path) + 2;
+    char* name = (char*)malloc(length);
+    if (name) {
+        snprintf(name, length, "@%s", path);
+    }
+    return name;
+}
+
+/**
+ * @brief Loads a plugin's bytecode from its cache file if the file is
+ *        current and intact, and was written for the plugin at `full_path`.
+ *        The chunk is named after `path`, as given by the caller.
+ * @return true with the chunk pushed, or false with the stack unchanged.
+ */
+static bool load_cached(lua_State* L, const char* cache_path, const char* full_path, const char* path,
+                        uint64_t source_size, int64_t source_mtime_ns) {
+    platform_mapped_file file;
+    if (!platform_map_file(cache_path, &file)) {
+        return false;
+    }
+    LuacCacheHeader header;
+    size_t path_length = strlen(full_path);
+    bool current = file.size >= sizeof(header);
+    if (current) {
+        memcpy(&header, file.data, sizeof(header));
+        current = header.magic == LUAC_CACHE_MAGIC && header.version == LUAC_CACHE_VERSION &&
+                  header.lua_version == LUA_VERSION_NUM && header.lua_release == LUAC_CACHE_LUA_RELEASE &&
+                  header.source_size == source_size && header.source_mtime_ns == source_mtime_ns &&
+                  header.path_length == path_length &&
+                  file.size - sizeof(header) >= path_length &&
+                  header.bytecode_size == file.size - sizeof(header) - path_length &&
+                  memcmp(file.data + sizeof(header), full_path, path_length) == 0 &&
+                  header.checksum == config_table_hash(file.data + sizeof(header), file.size - sizeof(header));
+    }
+
+    char* chunk_name = current ? chunk_name_for(path) : NULL;
+    bool loaded = false;
+    if (chunk_name) {
+        const char* bytecode = file.data + sizeof(header) + path_length;
+        if (luaL_loadbufferx(L, bytecode, (size_t)header.bytecode_size, chunk_name, "b") == LUA_OK) {
+            loaded = true;
+        } else {
+            // Written by a build whose bytecode format differs after all.
+            lua_pop(L, 1);
+        }
+    }
+    free(chunk_name);
+    platform_unmap_file(&file);
+    return loaded;
+}
+
+/**
+ * @brief A lua_Writer appending to a DumpBuffer.
+ */
+static int dump_writer(lua_State* L, const void* data, size_t size, void* user_data) {
+    (void)L;
+    DumpBuffer* buffer = (DumpBuffer*)user_data;
+    if (size > buffer->capacity - buffer->size) {
+        size_t capacity = buffer->capacity * 2;
+        while (capacity - buffer->size < size) {
+            capacity *= 2;
+        }
+        char* grown = (char*)realloc(buffer->data, capacity);
+        if (!grown) {
+            return 1;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    return 0;
+}
+
+/**
+ * @brief Saves the bytecode of the chunk on top of the stack, which is
+ *        left in place, to the cache file of the plugin at `full_path`.
+ */
+static void store_cached(lua_State* L, const char* cache_dir, const char* cache_path, const char* full_path,
+                         uint64_t source_size, int64_t source_mtime_ns) {
+    size_t path_length = strlen(full_path);
+    DumpBuffer buffer;
+    buffer.capacity = 4096;
+    while (buffer.capacity < sizeof(LuacCacheHeader) + path_length) {
+        buffer.capacity *= 2;
+    }
+    buffer.data = (char*)malloc(buffer.capacity);
+    if (!buffer.data) {
+        return;
+    }
+    buffer.size = sizeof(LuacCacheHeader) + path_length;
+    memcpy(buffer.data + sizeof(LuacCacheHeader), full_path, path_length);
+
+    if (lua_dump(L, dump_writer, &buffer, 0) == 0) {
+        LuacCacheHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = LUAC_CACHE_MAGIC;
+        header.version = LUAC_CACHE_VERSION;
+        header.lua_version = LUA_VERSION_NUM;
+        header.lua_release = LUAC_CACHE_LUA_RELEASE;
+        header.source_size = source_size;
+        header.source_mtime_ns = source_mtime_ns;
+        header.path_length = (uint32_t)path_length;
+        header.bytecode_size = buffer.size - sizeof(header) - path_length;
+        header.checksum = config_table_hash(buffer.data + sizeof(header), buffer.size - sizeof(header));
+        memcpy(buffer.data, &header, sizeof(header));
+
+        if (!platform_make_dirs(cache_dir) || !platform_write_file_atomic(cache_path, buffer.data, buffer.size)) {
+            logger_log_fmt(LOG_LEVEL_DEBUG, "LUA_CACHE", "Could not cache the bytecode of '%s' in '%s'",
+                           full_path, cache_dir);
+        }
+    }
+    free(buffer.data);
+}
+
+// --- Public API Implementation ---
+
+/**
+ * @see lua_bytecode_cache.h
+ */
+bool lua_bytecode_cache_enabled(void) {
+    const char* setting = getenv(LUA_BYTECODE_CACHE_ENV);
+    return !setting || strcmp(setting, "0") != 0;
+}
+
+/**
+ * @see lua_bytecode_cache.h
+ */
+bool lua_bytecode_cache_default_dir(char* buffer, size_t buffer_size) {
+    if (!platform_get_home_dir(buffer, buffer_size)) {
+        return false;
+    }
+    size_t length = strlen(buffer);
+#ifdef PLATFORM_WINDOWS
+    int written = snprintf(buffer + length, buffer_size - length, "\\.cache\\ph\\luac");
+#else
+    int written = snprintf(buffer + length, buffer_size - length, "/.cache/ph/luac");
+#endif
+    return written > 0 && (size_t)written < buffer_size - length;
+}
+
+/**
+ * @see lua_bytecode_cache.h
+ */
+int lua_bytecode_cache_load(lua_State* L, const char* cache_dir, const char* path) {
+    uint64_t source_size = 0;
+    int64_t source_mtime_ns = 0;
+    char* full_path = NULL;
+    char* cache_path = NULL;
+    // Plugins are usually given relative to the working directory, so the
+    // cache is keyed on the absolute path: the same relative path run from
+    // another directory names another file.
+    // The stamp is taken before compiling: if the source changes meanwhile,
+    // the bytecode saved is recorded with the older stamp and will not match.
+    if (cache_dir && platform_file_stamp(path, &source_size, &source_mtime_ns) &&
+        (full_path = platform_full_path(path)) != NULL) {
+        cache_path = cache_path_for(cache_dir, full_path);
+        if (cache_path && load_cached(L, cache_path, full_path, path, source_size, source_mtime_ns)) {
+            free(cache_path);
+            free(full_path);
+            return LUA_OK;
+        }
+    }
+
+    int status = luaL_loadfile(L, path);
+    if (status == LUA_OK && cache_path) {
+        store_cached(L, cache_dir, cache_path, full_path, source_size, source_mtime_ns);
+    }
+    free(cache_path);
+    free(full_path);
+    return status;
+}
@@ -0,0 +1,65 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+ * lua_bytecode_cache.h - Compiled Lua plugins, cached on disk.
+ *
+ * Every plugin used to be lexed and compiled on every start. The bridge now
+ * loads plugins through this cache instead: the first load compiles the
+ * source and saves its bytecode (`lua_dump`) in the cache directory
+ * (`~/.cache/ph/luac/` by default); later loads map the saved file and hand
+ * the bytecode to `luaL_loadbufferx`, skipping the compiler.
+ *
+ * A cache file is named after a hash of the plugin's absolute path and
+ * holds a header with a magic number, a format version, the Lua version that
+ * wrote it, a checksum of everything else, the absolute path and its size/mtime
+ * stamp, followed by the bytecode. It is used only if all of them match; a
+ * stale or damaged file is ignored and replaced, through a temporary file
+ * and a rename, after the source is compiled again. Debug information is
+ * kept, so error messages and tracebacks name the plugin's source as before.
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef LUA_BYTECODE_CACHE_H
+#define LUA_BYTECODE_CACHE_H
+
+#include <lua.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Set to "0" to neither read nor write cached bytecode.
+#define LUA_BYTECODE_CACHE_ENV "PH_LUA_CACHE"
+
+/**
+ * @brief Returns whether the cache is enabled, i.e. LUA_BYTECODE_CACHE_ENV
+ *        is not "0".
+ */
+bool lua_bytecode_cache_enabled(void);
+
+/**
+ * @brief Retrieves the default cache directory, `.cache/ph/luac` in the
+ *        user's home directory. It is not created here.
+ * @return true if the path was retrieved and fits in the buffer.
+ */
+bool lua_bytecode_cache_default_dir(char* buffer, size_t buffer_size);
+
+/**
+ * @brief Loads a Lua file as `luaL_loadfile` does, from cached bytecode if
+ *        it is current, and caches the bytecode otherwise.
+ *
+ * @param L The Lua state.
+ * @param cache_dir The cache directory, created if missing; NULL to load
+ *                  the source without the cache.
+ * @param path The Lua source file.
+ * @return LUA_OK with the chunk pushed as a function, or an error code
+ *         with the error message pushed, as `luaL_loadfile`. Failing to
+ *         write the cache is not an error.
+ */
+int lua_bytecode_cache_load(lua_State* L, const char* cache_dir, const char* path);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LUA_BYTECODE_CACHE_H
@@ -22,6 +22,7 @@
 #include <limits.h>
 #include <stdbool.h>
 #include "libs/liblogger/Logger.hpp"
+#include "libs/liblogger/StartupTrace.hpp"
 
 // --- Private Helper Structures and Functions ---
 
@@ -296,6 +297,10 @@ bool tui_prompt_user(const char* prompt, char* buffer, size_t buffer_size) {
 
 void tui_show_main_menu(void) {
     for (;;) {
+        /* Let plugins react to configuration reloaded while the user was busy. */
+        lua_bridge_dispatch_config_changes();
+
+        uint64_t trace = startup_trace_begin();
         size_t item_count = 0;
         MenuItem* menu_items = gather_all_commands(&item_count);
 
@@ -304,6 +309,9 @@ void tui_show_main_menu(void) {
         }
 
         display_menu(menu_items, item_count);
+        /* Startup ends once the first menu is on screen. */
+        startup_trace_end("tui", "main_menu", trace);
+        startup_trace_finish();
 
         /* Prompt the user */
         char input_buffer[64];
@@ -15,7 +15,8 @@
  * 3. It calls `module_init`, passing a context object with pointers to core
  *    functions. This context includes a simple logger and a new, buffer-safe
  *    formatted logger (`log_fmt`), allowing modules to perform setup and logging
- *    securely and efficiently.
+ *    securely and efficiently. Modules are initialized concurrently, each after
+ *    the modules it names in the optional `module_get_dependencies`.
  * 4. When a user command matches one supported by the module, the core calls
  *    `module_exec` with the relevant arguments.
  * 5. Before the application exits, it calls `module_cleanup` for graceful
@@ -28,6 +29,7 @@
 
 #include <stdint.h> // For fixed-width integer types like int32_t
 #include <stddef.h> // For size_t
+#include <stdbool.h> // For the typed configuration getters
 
 /* Use C linkage for all symbols in this header. This is crucial for ensuring
  * that function names are not mangled by C++ compilers and are directly
@@ -79,6 +81,24 @@ typedef struct {
 } phModuleInfo;
 
 
+/**
+ * @struct phConfigListItem
+ * @brief One item of a comma-separated configuration list. It points into
+ *        the configuration store, like a view, and is not null-terminated.
+ */
+typedef struct {
+    const char* data;
+    size_t length;
+} phConfigListItem;
+
+
+/**
+ * @brief A task submitted to the core's worker pool. It receives the `arg`
+ *        it was submitted with.
+ */
+typedef void (*phTaskFn)(void* arg);
+
+
 /**
  * @struct phCoreContext
  * @brief A context object passed from the core to the modules during init.
@@ -113,8 +133,9 @@ typedef struct {
     /**
      * @brief A function pointer to the core's configuration manager.
      * @param key The configuration key to retrieve.
-     * @return The value as a string, or NULL if not found. The module
-     *         should NOT free this string.
+     * @return A copy of the value, or NULL if not found. The copy stays
+     *         valid whatever the core does to its configuration; release it
+     *         with `free_config_value`, not the module's own `free`.
      */
     char* (*get_config_value)(const char* key);
 
@@ -124,6 +145,107 @@ typedef struct {
      */
     void (*print_ui)(const char* text);
 
+    /**
+     * @brief A function pointer to the core's level filter.
+     *
+     * Lets a module find out whether a record would be logged before it
+     * spends time building the message. The answer follows the `log.level`
+     * and `log.level.<MODULE>` configuration keys.
+     *
+     * @param level The severity level of the prospective message.
+     * @param module_name The name the module logs under.
+     * @return Non-zero if the message would be logged, 0 if it is filtered.
+     */
+    int (*log_enabled)(phLogLevel level, const char* module_name);
+
+    /**
+     * @brief A function pointer to the core's borrowed configuration lookup.
+     *
+     * Returns a pointer into the core's configuration store instead of a
+     * copy, so modules can read settings in hot paths without allocating.
+     * The module must NOT free it, and it remains valid only while
+     * `config_generation` returns the value it returned when the view was
+     * taken; a module may cache views keyed by that number. A module that
+     * reads from a thread of its own should hold the view inside a
+     * `config_read_begin`/`config_read_end` section.
+     *
+     * @param key The configuration key to retrieve.
+     * @param[out] length Receives the value's length in bytes. May be NULL.
+     * @return The null-terminated value, or NULL if the key is not set.
+     */
+    const char* (*get_config_view)(const char* key, size_t* length);
+
+    /**
+     * @brief A function pointer returning the configuration generation,
+     *        which changes whenever any configuration value changes.
+     */
+    uint64_t (*config_generation)(void);
+
+    /**
+     * @brief Function pointers entering and leaving a configuration read
+     *        section, during which views stay valid even if the core
+     *        changes the configuration concurrently. Sections nest and
+     *        never block; keep them short.
+     */
+    void (*config_read_begin)(void);
+    void (*config_read_end)(void);
+
+    /**
+     * @brief Function pointers reading a configuration value as an integer,
+     *        a boolean (`true`/`false`, `yes`/`no`, `on`/`off`, `1`/`0`) or
+     *        a duration in milliseconds (`1500`, `30s`, `1h30m`, ...).
+     *
+     * Values are classified once when the core stores them, so these cost
+     * a lookup and no parsing.
+     *
+     * @param key The configuration key to retrieve.
+     * @param[out] value Receives the value; untouched unless ph_SUCCESS.
+     * @return ph_SUCCESS, ph_ERROR_NOT_FOUND if the key is not set, or
+     *         ph_ERROR_INVALID_ARGS if the value is not of that type.
+     */
+    phStatus (*config_get_int)(const char* key, int64_t* value);
+    phStatus (*config_get_bool)(const char* key, bool* value);
+    phStatus (*config_get_duration_ms)(const char* key, int64_t* value);
+
+    /**
+     * @brief A function pointer splitting a configuration value into a
+     *        comma-separated list, trimming items and skipping empty ones.
+     *        The items have the lifetime of a `get_config_view` view.
+     *
+     * @param key The configuration key to retrieve.
+     * @param[out] items Receives up to `max_items` items.
+     * @param max_items The capacity of `items`.
+     * @return The number of items in the list (possibly more than
+     *         `max_items`), or 0 if the key is not set.
+     */
+    size_t (*config_get_list)(const char* key, phConfigListItem* items, size_t max_items);
+
+    /**
+     * @brief A function pointer queueing a task on the core's worker pool,
+     *        which all modules share instead of starting threads of their
+     *        own. Meant for blocking I/O and CPU-bound work; the task runs
+     *        on a core thread and must not wait for a task submitted after
+     *        it. Tasks still queued run before the module is unloaded.
+     *
+     * @param task The function to run. It owns `arg`.
+     * @param arg The argument passed to `task`.
+     * @return ph_SUCCESS, or an error if the task could not be queued, in
+     *         which case it will not run.
+     */
+    phStatus (*submit_task)(phTaskFn task, void* arg);
+
+    /**
+     * @brief A function pointer returning the number of threads in the
+     *        worker pool, so a module can size its batches to it.
+     */
+    unsigned (*worker_count)(void);
+
+    /**
+     * @brief A function pointer releasing a value returned by
+     *        `get_config_value`. Accepts NULL.
+     */
+    void (*free_config_value)(char* value);
+
 } phCoreContext;
 
 
@@ -174,6 +296,26 @@ typedef phStatus (*PFN_module_exec)(int argc, const char** argv);
 typedef void (*PFN_module_cleanup)(void);
 
 
+// --- OPTIONAL MODULE EXPORTED FUNCTIONS ---
+
+/**
+ * @brief Lists the modules that must be initialized before this one.
+ *
+ * The core initializes modules concurrently, on several threads, so a module
+ * whose `module_init` relies on another module having been initialized
+ * exports `module_get_dependencies`. The core calls it after
+ * `module_get_info` and runs `module_init` only once every module named
+ * has initialized successfully; if one is missing or fails, this module is
+ * skipped. Modules that do not export it depend on nothing. Like
+ * `module_get_info`, the result must stay valid for the lifetime of the
+ * application.
+ *
+ * @return A NULL-terminated array of module names (`phModuleInfo.name`),
+ *         or NULL for none.
+ */
+typedef const char** (*PFN_module_get_dependencies)(void);
+
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,520 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: BinaryLogFormat.cpp
+ *
+ * [
+ * This file implements the binary log codec declared in BinaryLogFormat.hpp.
+ *
+ * Both directions are driven by the same printf conversion parser, so the
+ * encoder (running inside the application) and the renderer (running in
+ * ph-logcat, possibly on another machine) agree on how many arguments a
+ * format consumes and how each one is represented. The renderer rebuilds a
+ * single-conversion format for every argument and hands it to `snprintf`, so
+ * flags, width and precision produce exactly the text the text sink would
+ * have written.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "BinaryLogFormat.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+enum class LengthModifier { NONE, HH, H, L, LL, J, Z, T, BIG_L };
+
+/**
+ * @struct FormatSpec
+ * @brief One conversion of a printf format string.
+ */
+struct FormatSpec {
+    const char* start;        // The '%' character.
+    const char* length_start; // End of flags, width and precision.
+    const char* end;          // One past the conversion character.
+    LengthModifier length;
+    char conversion;          // '\0' if the format ends inside the conversion.
+    bool width_star;
+    bool precision_star;
+    long precision;           // Literal precision, or -1 if absent or '*'.
+};
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+/**
+ * @brief Finds the next conversion at or after `p`.
+ * @return false if the rest of the string is plain text.
+ */
+bool next_spec(const char* p, FormatSpec& spec) {
+    const char* c = strchr(p, '%');
+    if (!c) {
+        return false;
+    }
+    spec = FormatSpec{};
+    spec.start = c;
+    spec.precision = -1;
+    ++c;
+
+    while (*c == '-' || *c == '+' || *c == ' ' || *c == '#' || *c == '0' || *c == '\'') {
+        ++c;
+    }
+    if (*c == '*') {
+        spec.width_star = true;
+        ++c;
+    } else {
+        while (is_digit(*c)) ++c;
+    }
+    if (*c == '.') {
+        ++c;
+        if (*c == '*') {
+            spec.precision_star = true;
+            ++c;
+        } else {
+            long value = 0;
+            while (is_digit(*c)) {
+                value = value * 10 + (*c - '0');
+                ++c;
+            }
+            spec.precision = value;
+        }
+    }
+
+    spec.length_start = c;
+    switch (*c) {
+        case 'h':
+            if (c[1] == 'h') { spec.length = LengthModifier::HH; c += 2; }
+            else             { spec.length = LengthModifier::H;  c += 1; }
+            break;
+        case 'l':
+            if (c[1] == 'l') { spec.length = LengthModifier::LL; c += 2; }
+            else             { spec.length = LengthModifier::L;  c += 1; }
+            break;
+        case 'j': spec.length = LengthModifier::J;     ++c; break;
+        case 'z': spec.length = LengthModifier::Z;     ++c; break;
+        case 't': spec.length = LengthModifier::T;     ++c; break;
+        case 'L': spec.length = LengthModifier::BIG_L; ++c; break;
+        default: break;
+    }
+
+    spec.conversion = *c;
+    spec.end = *c ? c + 1 : c;
+    return true;
+}
+
+bool is_float_conversion(char c) {
+    return c == 'f' || c == 'F' || c == 'e' || c == 'E' ||
+           c == 'g' || c == 'G' || c == 'a' || c == 'A';
+}
+
+bool is_unsigned_conversion(char c) {
+    return c == 'u' || c == 'o' || c == 'x' || c == 'X';
+}
+
+void put_double(std::string& out, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+    }
+}
+
+bool get_double(const uint8_t*& cursor, const uint8_t* end, double& value) {
+    if (end - cursor < 8) {
+        return false;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) {
+        bits |= static_cast<uint64_t>(cursor[i]) << (8 * i);
+    }
+    cursor += 8;
+    memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+/**
+ * @brief Appends printf output of arbitrary length to a string.
+ */
+void append_printf(std::string& out, const char* format, ...) {
+    char stack_buffer[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(stack_buffer, sizeof(stack_buffer), format, args);
+    va_end(args);
+    if (len < 0) {
+        return;
+    }
+    if (static_cast<size_t>(len) < sizeof(stack_buffer)) {
+        out.append(stack_buffer, static_cast<size_t>(len));
+        return;
+    }
+    size_t offset = out.size();
+    out.resize(offset + static_cast<size_t>(len));
+    va_start(args, format);
+    vsnprintf(&out[offset], static_cast<size_t>(len) + 1, format, args);
+    va_end(args);
+}
+
+/**
+ * @brief Renders one value with the `*` arguments its conversion consumed.
+ */
+template <typename T>
+void append_piece(std::string& out, const char* spec, const int* stars, int star_count, T value) {
+    switch (star_count) {
+        case 0:  append_printf(out, spec, value); break;
+        case 1:  append_printf(out, spec, stars[0], value); break;
+        default: append_printf(out, spec, stars[0], stars[1], value); break;
+    }
+}
+
+} // namespace
+
+/**
+ * @see BinaryLogFormat.hpp
+ */
+void binlog_put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+/**
+ * @see BinaryLogFormat.hpp
+ */
+void binlog_put_svarint(std::string& out, int64_t value) {
+    binlog_put_varint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+/**
+ * @see BinaryLogFormat.hpp
+ */
+bool binlog_get_varint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        uint8_t byte = *cursor++;
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @see BinaryLogFormat.hpp
+ */
+bool binlog_get_svarint(const uint8_t*& cursor, const uint8_t* end, int64_t& value) {
+    uint64_t raw;
+    if (!binlog_get_varint(cursor, end, raw)) {
+        return false;
+    }
+    value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+}
+
+/**
+ * @see BinaryLogFormat.hpp
+ */
+void binlog_encode_args(std::string& out, const char* format, va_list args) {
+    va_list ap;
+    va_copy(ap, args);
+
+    FormatSpec spec;
+    const char* p = format;
+    bool keep_going = true;
+    while (keep_going && next_spec(p, spec)) {
+        p = spec.end;
+        if (spec.conversion == '%') {
+            continue;
+        }
+
+        long precision = spec.precision;
+        if (spec.width_star) {
+            binlog_put_svarint(out, va_arg(ap, int));
+        }
+        if (spec.precision_star) {
+            int value = va_arg(ap, int);
+            binlog_put_svarint(out, value);
+            precision = value; // A negative precision means "none", as in printf.
+        }
+
+        char c = spec.conversion;
+        if (c == 'd' || c == 'i') {
+            int64_t value;
+            switch (spec.length) {
+                case LengthModifier::HH: value = static_cast<signed char>(va_arg(ap, int)); break;
+                case LengthModifier::H:  value = static_cast<short>(va_arg(ap, int)); break;
+                case LengthModifier::L:  value = va_arg(ap, long); break;
+                case LengthModifier::LL: value = va_arg(ap, long long); break;
+                case LengthModifier::J:  value = va_arg(ap, intmax_t); break;
+                case LengthModifier::Z:
+                case LengthModifier::T:  value = va_arg(ap, ptrdiff_t); break;
+                default:                 value = va_arg(ap, int); break;
+            }
+            binlog_put_svarint(out, value);
+        } else if (is_unsigned_conversion(c)) {
+            uint64_t value;
+            switch (spec.length) {
+                case LengthModifier::HH: value = static_cast<unsigned char>(va_arg(ap, unsigned int)); break;
+                case LengthModifier::H:  value = static_cast<unsigned short>(va_arg(ap, unsigned int)); break;
+                case LengthModifier::L:  value = va_arg(ap, unsigned long); break;
+                case LengthModifier::LL: value = va_arg(ap, unsigned long long); break;
+                case LengthModifier::J:  value = va_arg(ap, uintmax_t); break;
+                case LengthModifier::Z:  value = va_arg(ap, size_t); break;
+                case LengthModifier::T:  value = static_cast<uint64_t>(va_arg(ap, ptrdiff_t)); break;
+                default:                 value = va_arg(ap, unsigned int); break;
+            }
+            binlog_put_varint(out, value);
+        } else if (is_float_conversion(c)) {
+            double value = spec.length == LengthModifier::BIG_L
+                               ? static_cast<double>(va_arg(ap, long double))
+                               : va_arg(ap, double);
+            put_double(out, value);
+        } else if (c == 'c' && spec.length == LengthModifier::NONE) {
+            binlog_put_varint(out, static_cast<unsigned char>(va_arg(ap, int)));
+        } else if (c == 's' && spec.length == LengthModifier::NONE) {
+            const char* value = va_arg(ap, const char*);
+            if (!value) {
+                value = "(null)";
+            }
+            size_t len = precision >= 0 ? strnlen(value, static_cast<size_t>(precision))
+                                        : strlen(value);
+            binlog_put_varint(out, len);
+            out.append(value, len);
+        } else if (c == 'p') {
+            binlog_put_varint(out, reinterpret_cast<uintptr_t>(va_arg(ap, void*)));
+        } else if (c == 'n') {
+            (void)va_arg(ap, void*); // Nothing is written back; the slot is just skipped.
+        } else {
+            keep_going = false; // Wide characters, positional arguments, typos...
+        }
+    }
+
+    va_end(ap);
+}
+
+/**
+ * @see BinaryLogFormat.hpp
+ */
+void binlog_render(std::string& out, const char* format, const uint8_t* args, size_t args_length) {
+    const uint8_t* cursor = args;
+    const uint8_t* end = args + args_length;
+
+    FormatSpec spec;
+    const char* p = format;
+    while (next_spec(p, spec)) {
+        out.append(p, static_cast<size_t>(spec.start - p));
+        p = spec.start;
+        if (spec.conversion == '%') {
+            out.push_back('%');
+            p = spec.end;
+            continue;
+        }
+
+        // Rebuild the conversion with a length modifier matching the decoded type.
+        char spec_text[64];
+        size_t prefix_length = static_cast<size_t>(spec.length_start - spec.start);
+        if (prefix_length + 4 > sizeof(spec_text)) {
+            break;
+        }
+        memcpy(spec_text, spec.start, prefix_length);
+        char* tail = spec_text + prefix_length;
+
+        int stars[2];
+        int star_count = 0;
+        bool ok = true;
+        for (bool star : {spec.width_star, spec.precision_star}) {
+            int64_t value;
+            if (star) {
+                if (!binlog_get_svarint(cursor, end, value)) {
+                    ok = false;
+                    break;
+                }
+                stars[star_count++] = static_cast<int>(value);
+            }
+        }
+        if (!ok) {
+            break;
+        }
+
+        char c = spec.conversion;
+        if (c == 'd' || c == 'i') {
+            int64_t value;
+            if (!binlog_get_svarint(cursor, end, value)) break;
+            tail[0] = 'l'; tail[1] = 'l'; tail[2] = c; tail[3] = '\0';
+            append_piece(out, spec_text, stars, star_count, static_cast<long long>(value));
+        } else if (is_unsigned_conversion(c)) {
+            uint64_t value;
+            if (!binlog_get_varint(cursor, end, value)) break;
+            tail[0] = 'l'; tail[1] = 'l'; tail[2] = c; tail[3] = '\0';
+            append_piece(out, spec_text, stars, star_count, static_cast<unsigned long long>(value));
+        } else if (is_float_conversion(c)) {
+            double value;
+            if (!get_double(cursor, end, value)) break;
+            tail[0] = c; tail[1] = '\0';
+            append_piece(out, spec_text, stars, star_count, value);
+        } else if (c == 'c' && spec.length == LengthModifier::NONE) {
+            uint64_t value;
+            if (!binlog_get_varint(cursor, end, value)) break;
+            tail[0] = 'c'; tail[1] = '\0';
+            append_piece(out, spec_text, stars, star_count, static_cast<int>(value));
+        } else if (c == 's' && spec.length == LengthModifier::NONE) {
+            uint64_t len;
+            if (!binlog_get_varint(cursor, end, len) ||
+                len > static_cast<uint64_t>(end - cursor)) break;
+            std::string value(reinterpret_cast<const char*>(cursor), static_cast<size_t>(len));
+            cursor += len;
+            tail[0] = 's'; tail[1] = '\0';
+            append_piece(out, spec_text, stars, star_count, value.c_str());
+        } else if (c == 'p') {
+            uint64_t value;
+            if (!binlog_get_varint(cursor, end, value)) break;
+            tail[0] = 'p'; tail[1] = '\0';
+            append_piece(out, spec_text, stars, star_count,
+                         reinterpret_cast<void*>(static_cast<uintptr_t>(value)));
+        } else if (c != 'n') {
+            break;
+        }
+        p = spec.end;
+    }
+
+    // Plain text after the last conversion, or everything the encoder gave up on.
+    out.append(p);
+}
+
+/**
+ * @see BinaryLogFormat.hpp
+ */
+bool BinaryLogFilter::matches(const BinaryLogEvent& event) const {
+    if (event.level < min_level || event.time_us < since_us || event.time_us >= until_us) {
+        return false;
+    }
+    if (modules.empty()) {
+        return true;
+    }
+    for (const std::string& module : modules) {
+        if (module == event.module) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @see BinaryLogFormat.hpp
+ */
+bool BinaryLogReader::open(const uint8_t* data, size_t size, std::string& error) {
+    BinaryLogHeader header;
+    if (size < sizeof(header)) {
+        error = "file is too small to be a binary log segment";
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, BINARY_LOG_MAGIC, sizeof(header.magic)) != 0) {
+        error = "not a binary log segment (bad magic)";
+        return false;
+    }
+    if (header.version != BINARY_LOG_VERSION) {
+        error = "unsupported binary log version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.header_size < sizeof(header) || header.header_size > size) {
+        error = "corrupt segment header";
+        return false;
+    }
+
+    m_cursor = data + header.header_size;
+    m_end = data + size;
+    m_time_us = header.base_time_us;
+    m_error.clear();
+    m_modules.clear();
+    m_formats.assign(1, "%s"); // BINARY_LOG_MESSAGE_FORMAT_ID is implicit.
+    return true;
+}
+
+/**
+ * @see BinaryLogFormat.hpp
+ */
+bool BinaryLogReader::next(BinaryLogEvent& event) {
+    while (m_cursor < m_end) {
+        uint8_t tag = *m_cursor++;
+        switch (tag) {
+            case BINARY_LOG_TAG_END:
+                m_cursor = m_end;
+                return false;
+
+            case BINARY_LOG_TAG_MODULE_DEF:
+                if (!read_definition(m_modules)) return false;
+                break;
+
+            case BINARY_LOG_TAG_FORMAT_DEF:
+                if (!read_definition(m_formats)) return false;
+                break;
+
+            case BINARY_LOG_TAG_EVENT: {
+                int64_t delta;
+                uint64_t module_id, format_id, args_length;
+                if (!binlog_get_svarint(m_cursor, m_end, delta) || m_cursor >= m_end) {
+                    return fail("truncated event");
+                }
+                uint8_t level = *m_cursor++;
+                if (!binlog_get_varint(m_cursor, m_end, module_id) ||
+                    !binlog_get_varint(m_cursor, m_end, format_id) ||
+                    !binlog_get_varint(m_cursor, m_end, args_length) ||
+                    args_length > static_cast<uint64_t>(m_end - m_cursor)) {
+                    return fail("truncated event");
+                }
+                if (module_id >= m_modules.size() || format_id >= m_formats.size()) {
+                    return fail("event references an undefined module or format");
+                }
+
+                m_time_us += delta;
+                event.time_us = m_time_us;
+                event.level = static_cast<phLogLevel>(level);
+                event.module = m_modules[module_id].c_str();
+                event.format = m_formats[format_id].c_str();
+                event.args = m_cursor;
+                event.args_length = static_cast<size_t>(args_length);
+                m_cursor += args_length;
+                return true;
+            }
+
+            default:
+                return fail("unknown entry tag");
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Reads a MODULE_DEF or FORMAT_DEF body into `table`.
+ */
+bool BinaryLogReader::read_definition(std::vector<std::string>& table) {
+    uint64_t id, length;
+    if (!binlog_get_varint(m_cursor, m_end, id) ||
+        !binlog_get_varint(m_cursor, m_end, length) ||
+        length > static_cast<uint64_t>(m_end - m_cursor) ||
+        id > table.size() + (1u << 20)) {
+        return fail("truncated or corrupt definition");
+    }
+    if (id >= table.size()) {
+        table.resize(static_cast<size_t>(id) + 1);
+    }
+    table[id].assign(reinterpret_cast<const char*>(m_cursor), static_cast<size_t>(length));
+    m_cursor += length;
+    return true;
+}
+
+/**
+ * @brief Records a decoding error and stops the iteration.
+ */
+bool BinaryLogReader::fail(const char* reason) {
+    m_error = reason;
+    m_cursor = m_end;
+    return false;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: BinaryLogFormat.hpp
+ *
+ * [
+ * This header defines the on-disk format of binary log segments and the
+ * codec shared by the writer (BinaryLogSink) and the offline decoder
+ * (ph-logcat).
+ *
+ * Instead of formatting a message, the binary sink stores the raw printf
+ * arguments next to an interned id of the format string. Text is produced
+ * only when somebody actually reads the log, which moves the formatting cost
+ * off the hot path and shrinks records to a few bytes for typical messages.
+ *
+ * Segment layout:
+ *   - A fixed 32-byte header (`BinaryLogHeader`) with the magic, the format
+ *     version and the segment's base time in microseconds since the epoch.
+ *   - A sequence of entries, each introduced by a one-byte tag:
+ *       MODULE_DEF  varint id, varint length, name bytes
+ *       FORMAT_DEF  varint id, varint length, format bytes
+ *       EVENT       zigzag varint timestamp delta (us, from the previous
+ *                   event or the base time), level byte, varint module id,
+ *                   varint format id, varint argument length, argument bytes
+ *   - A zero tag (or the end of the file) terminates the segment. Segments
+ *     are preallocated and zero-filled, so a segment cut short by a crash
+ *     still decodes up to its last complete entry.
+ *
+ * Definitions are repeated in every segment that uses them, so each segment
+ * decodes on its own.
+ *
+ * Argument encoding follows the conversions of the format string: integers
+ * are (zigzag) varints, floating point values are 8-byte little-endian
+ * doubles, strings are a varint length followed by the bytes (already
+ * clipped to the conversion's precision), pointers are varints, and `%n` is
+ * skipped.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BINARY_LOG_FORMAT_HPP
+#define BINARY_LOG_FORMAT_HPP
+
+#include "../../ipc/include/ph_core_api.h"
+
+#include <cstdarg>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define BINARY_LOG_MAGIC "PHBLOG01"
+#define BINARY_LOG_VERSION 1
+#define BINARY_LOG_EXTENSION ".phlog"
+
+// Format id reserved for pre-formatted messages; its format is "%s".
+#define BINARY_LOG_MESSAGE_FORMAT_ID 0
+
+/**
+ * @enum BinaryLogTag
+ * @brief The first byte of every entry in a segment.
+ */
+enum BinaryLogTag : uint8_t {
+    BINARY_LOG_TAG_END = 0,
+    BINARY_LOG_TAG_MODULE_DEF = 1,
+    BINARY_LOG_TAG_FORMAT_DEF = 2,
+    BINARY_LOG_TAG_EVENT = 3
+};
+
+/**
+ * @struct BinaryLogHeader
+ * @brief The fixed header at offset 0 of every segment (little-endian).
+ */
+struct BinaryLogHeader {
+    char magic[8];          // BINARY_LOG_MAGIC, not null-terminated.
+    uint32_t version;       // BINARY_LOG_VERSION.
+    uint32_t header_size;   // sizeof(BinaryLogHeader); entries start here.
+    int64_t base_time_us;   // Segment base time, microseconds since the epoch.
+    uint64_t sequence;      // Segment number within the log.
+};
+
+// --- Varint helpers ---
+
+/**
+ * @brief Appends an unsigned LEB128 varint.
+ */
+void binlog_put_varint(std::string& out, uint64_t value);
+
+/**
+ * @brief Appends a signed value as a zigzag-encoded varint.
+ */
+void binlog_put_svarint(std::string& out, int64_t value);
+
+/**
+ * @brief Reads an unsigned varint.
+ * @param cursor In/out read position; advanced past the varint.
+ * @param end One past the last readable byte.
+ * @param[out] value The decoded value.
+ * @return false if the input ends before the varint does.
+ */
+bool binlog_get_varint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value);
+
+/**
+ * @brief Reads a zigzag-encoded signed varint.
+ */
+bool binlog_get_svarint(const uint8_t*& cursor, const uint8_t* end, int64_t& value);
+
+// --- Argument codec ---
+
+/**
+ * @brief Serializes the arguments of a printf-style call.
+ *
+ * Walks `format` and consumes one argument per conversion (plus one per `*`
+ * width or precision), appending their binary encoding to `out`. Encoding
+ * stops at the first conversion it does not understand; the decoder stops at
+ * the same place and prints the rest of the format verbatim.
+ *
+ * @param out The buffer to append to.
+ * @param format The printf-style format string.
+ * @param args The arguments. The caller's va_list is left untouched.
+ */
+void binlog_encode_args(std::string& out, const char* format, va_list args);
+
+/**
+ * @brief Renders a format string with arguments encoded by `binlog_encode_args`.
+ * @param out The buffer receiving the text.
+ * @param format The format string the arguments were encoded against.
+ * @param args The encoded argument bytes.
+ * @param args_length The number of argument bytes.
+ */
+void binlog_render(std::string& out, const char* format, const uint8_t* args, size_t args_length);
+
+// --- Segment reader ---
+
+/**
+ * @struct BinaryLogEvent
+ * @brief A decoded EVENT entry, as produced by BinaryLogReader.
+ */
+struct BinaryLogEvent {
+    int64_t time_us;        // Absolute time, microseconds since the epoch.
+    phLogLevel level;
+    const char* module;     // Interned module name (owned by the reader).
+    const char* format;     // Interned format string (owned by the reader).
+    const uint8_t* args;    // Encoded arguments, inside the segment buffer.
+    size_t args_length;
+};
+
+/**
+ * @struct BinaryLogFilter
+ * @brief A selection of events, as ph-logcat's command line options make it.
+ */
+struct BinaryLogFilter {
+    phLogLevel min_level = LOG_LEVEL_DEBUG;
+    std::vector<std::string> modules; // Empty means every module.
+    int64_t since_us = INT64_MIN;     // Inclusive.
+    int64_t until_us = INT64_MAX;     // Exclusive.
+
+    /**
+     * @brief Returns whether `event` is at or above `min_level`, inside
+     *        [since_us, until_us) and, if `modules` is not empty, of one of
+     *        them.
+     */
+    bool matches(const BinaryLogEvent& event) const;
+};
+
+/**
+ * @class BinaryLogReader
+ * @brief Iterates over the events of one segment held in memory.
+ */
+class BinaryLogReader {
+public:
+    /**
+     * @brief Validates the header and prepares to iterate.
+     * @param data The segment bytes. They must outlive the reader.
+     * @param size The number of bytes.
+     * @param error Receives a description when the segment is rejected.
+     * @return true if the segment header is valid.
+     */
+    bool open(const uint8_t* data, size_t size, std::string& error);
+
+    /**
+     * @brief Decodes the next event, absorbing definitions on the way.
+     * @return true if an event was produced, false at the end of the segment
+     *         or on a truncated/corrupt entry (see `error`).
+     */
+    bool next(BinaryLogEvent& event);
+
+    const std::string& error() const { return m_error; }
+
+private:
+    bool read_definition(std::vector<std::string>& table);
+    bool fail(const char* reason);
+
+    const uint8_t* m_cursor = nullptr;
+    const uint8_t* m_end = nullptr;
+    int64_t m_time_us = 0;
+    std::string m_error;
+    std::vector<std::string> m_modules; // Interned module names, indexed by id.
+    std::vector<std::string> m_formats; // Interned format strings, indexed by id.
+};
+
+#endif // BINARY_LOG_FORMAT_HPP
@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: BinaryLogSink.cpp
+ *
+ * [
+ * This file implements the memory-mapped binary log sink declared in
+ * BinaryLogSink.hpp.
+ *
+ * Arguments are serialized by the calling thread into a thread-local buffer
+ * before the sink lock is taken; under the lock the sink only resolves the
+ * interned ids, assembles the entry and copies it into the mapping. Segment
+ * rotation is the only place that performs system calls.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "BinaryLogSink.hpp"
+#include "BinaryLogFormat.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Upper bound of segment numbers probed when looking for a free file name.
+#define BINARY_LOG_MAX_SEQUENCE 1000000
+
+/**
+ * @brief Converts a timestamp to microseconds since the epoch.
+ */
+static int64_t to_micros(std::chrono::system_clock::time_point timestamp) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               timestamp.time_since_epoch()).count();
+}
+
+// Encoded arguments of the event being written by this thread.
+static thread_local std::string t_event_args;
+
+BinaryLogSink::~BinaryLogSink() {
+    close();
+}
+
+/**
+ * @see BinaryLogSink.hpp
+ */
+bool BinaryLogSink::open(const std::string& path_prefix, size_t segment_size, std::string& error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_base != nullptr) {
+        return true; // Already open.
+    }
+
+    m_prefix = path_prefix;
+    m_segment_size = segment_size ? std::max(segment_size, static_cast<size_t>(BINARY_LOG_MIN_SEGMENT_SIZE))
+                                  : static_cast<size_t>(BINARY_LOG_DEFAULT_SEGMENT_SIZE);
+    m_sequence = 0;
+    m_format_texts.assign(1, "%s"); // BINARY_LOG_MESSAGE_FORMAT_ID, never written out.
+    m_format_stamp.assign(1, 0);
+    return open_segment(error);
+}
+
+/**
+ * @see BinaryLogSink.hpp
+ */
+void BinaryLogSink::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    close_segment();
+}
+
+/**
+ * @see BinaryLogSink.hpp
+ */
+void BinaryLogSink::flush() {
+#ifndef _WIN32
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_base != nullptr) {
+        msync(m_base, m_used, MS_ASYNC);
+    }
+#endif
+}
+
+/**
+ * @see BinaryLogSink.hpp
+ */
+void BinaryLogSink::write_formatted(std::chrono::system_clock::time_point timestamp, phLogLevel level,
+                                    const char* module_name, const char* format, va_list args) {
+    t_event_args.clear();
+    binlog_encode_args(t_event_args, format, args);
+    append_event(timestamp, level, module_name, format, t_event_args);
+}
+
+/**
+ * @see BinaryLogSink.hpp
+ */
+void BinaryLogSink::write_message(std::chrono::system_clock::time_point timestamp, phLogLevel level,
+                                  const char* module_name, const char* message, size_t length) {
+    // The message is the single "%s" argument of the reserved format.
+    t_event_args.clear();
+    binlog_put_varint(t_event_args, length);
+    t_event_args.append(message, length);
+    append_event(timestamp, level, module_name, nullptr, t_event_args);
+}
+
+/**
+ * @brief Appends one event, rotating the segment if it does not fit.
+ * @param format The event's format string, or nullptr for a pre-formatted
+ *               message whose text is the only argument.
+ */
+void BinaryLogSink::append_event(std::chrono::system_clock::time_point timestamp, phLogLevel level,
+                                 const char* module_name, const char* format, const std::string& args) {
+    const int64_t time_us = to_micros(timestamp);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_base == nullptr) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint32_t module_id = intern_module(module_name);
+    uint32_t format_id = BINARY_LOG_MESSAGE_FORMAT_ID;
+    const std::string* payload = &args;
+    std::string fallback;
+    if (format != nullptr && !intern_format(format, format_id)) {
+        // Too many distinct formats: store this one as plain text instead.
+        std::string text;
+        binlog_render(text, format, reinterpret_cast<const uint8_t*>(args.data()), args.size());
+        binlog_put_varint(fallback, text.size());
+        fallback.append(text);
+        payload = &fallback;
+    }
+
+    build_entry(time_us, level, module_id, format_id, *payload);
+    if (m_used + m_entry.size() > m_segment_size) {
+        close_segment();
+        std::string error;
+        if (!open_segment(error)) {
+            std::cerr << "ERROR: Binary log sink disabled: " << error << std::endl;
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // Definitions must be repeated in the new segment.
+        build_entry(time_us, level, module_id, format_id, *payload);
+        if (m_used + m_entry.size() > m_segment_size) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed); // Larger than a whole segment.
+            return;
+        }
+    }
+
+    memcpy(m_base + m_used, m_entry.data(), m_entry.size());
+    m_used += m_entry.size();
+    m_last_time_us = time_us;
+    m_module_stamp[module_id] = m_segment_stamp;
+    m_format_stamp[format_id] = m_segment_stamp;
+}
+
+/**
+ * @see BinaryLogSink.hpp
+ */
+void BinaryLogSink::build_entry(int64_t time_us, phLogLevel level, uint32_t module_id,
+                                uint32_t format_id, const std::string& args) {
+    m_entry.clear();
+    if (m_module_stamp[module_id] != m_segment_stamp) {
+        const std::string& name = *m_module_names[module_id];
+        m_entry.push_back(static_cast<char>(BINARY_LOG_TAG_MODULE_DEF));
+        binlog_put_varint(m_entry, module_id);
+        binlog_put_varint(m_entry, name.size());
+        m_entry.append(name);
+    }
+    if (format_id != BINARY_LOG_MESSAGE_FORMAT_ID && m_format_stamp[format_id] != m_segment_stamp) {
+        const std::string& text = m_format_texts[format_id];
+        m_entry.push_back(static_cast<char>(BINARY_LOG_TAG_FORMAT_DEF));
+        binlog_put_varint(m_entry, format_id);
+        binlog_put_varint(m_entry, text.size());
+        m_entry.append(text);
+    }
+
+    m_entry.push_back(static_cast<char>(BINARY_LOG_TAG_EVENT));
+    binlog_put_svarint(m_entry, time_us - m_last_time_us);
+    m_entry.push_back(static_cast<char>(level));
+    binlog_put_varint(m_entry, module_id);
+    binlog_put_varint(m_entry, format_id);
+    binlog_put_varint(m_entry, args.size());
+    m_entry.append(args);
+}
+
+/**
+ * @brief Returns the id of a module name, assigning one on first use.
+ */
+uint32_t BinaryLogSink::intern_module(const char* module_name) {
+    auto it = m_module_ids.find(module_name);
+    if (it != m_module_ids.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(m_module_names.size());
+    it = m_module_ids.emplace(module_name, id).first;
+    m_module_names.push_back(&it->first); // Map nodes never move.
+    m_module_stamp.push_back(0);
+    return id;
+}
+
+/**
+ * @brief Returns the id of a format string, assigning one on first use.
+ *
+ * The lookup is by address; the stored text is compared to make sure the
+ * address still holds the same format.
+ */
+bool BinaryLogSink::intern_format(const char* format, uint32_t& id) {
+    auto it = m_format_ids.find(format);
+    if (it != m_format_ids.end() && m_format_texts[it->second] == format) {
+        id = it->second;
+        return true;
+    }
+    if (m_format_texts.size() >= BINARY_LOG_MAX_FORMATS) {
+        return false;
+    }
+    id = static_cast<uint32_t>(m_format_texts.size());
+    m_format_texts.emplace_back(format);
+    m_format_stamp.push_back(0);
+    m_format_ids[format] = id;
+    return true;
+}
+
+/**
+ * @brief Creates, sizes and maps the next free segment file.
+ */
+bool BinaryLogSink::open_segment(std::string& error) {
+#ifdef _WIN32
+    error = "the binary log sink is not supported on this platform";
+    return false;
+#else
+    std::string path;
+    int fd = -1;
+    for (; m_sequence < BINARY_LOG_MAX_SEQUENCE; ++m_sequence) {
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), ".%06llu" BINARY_LOG_EXTENSION,
+                 static_cast<unsigned long long>(m_sequence));
+        path = m_prefix + suffix;
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd >= 0 || errno != EEXIST) {
+            break;
+        }
+    }
+    if (fd < 0) {
+        error = "could not create segment " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(m_segment_size)) == 0) {
+        base = mmap(nullptr, m_segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (base == MAP_FAILED) {
+        error = "could not map segment " + path + ": " + strerror(errno);
+        ::close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+
+    BinaryLogHeader header = {};
+    memcpy(header.magic, BINARY_LOG_MAGIC, sizeof(header.magic));
+    header.version = BINARY_LOG_VERSION;
+    header.header_size = sizeof(header);
+    header.base_time_us = to_micros(std::chrono::system_clock::now());
+    header.sequence = m_sequence;
+
+    m_fd = fd;
+    m_base = static_cast<uint8_t*>(base);
+    memcpy(m_base, &header, sizeof(header));
+    m_used = sizeof(header);
+    m_last_time_us = header.base_time_us;
+    ++m_sequence;
+    ++m_segment_stamp;
+    return true;
+#endif
+}
+
+/**
+ * @brief Unmaps the current segment and trims the file to its used length.
+ */
+void BinaryLogSink::close_segment() {
+#ifndef _WIN32
+    if (m_base == nullptr) {
+        return;
+    }
+    munmap(m_base, m_segment_size);
+    m_base = nullptr;
+    // On failure the zero padding stays behind, which readers treat as the end.
+    if (ftruncate(m_fd, static_cast<off_t>(m_used)) != 0) {
+        std::cerr << "WARNING: Could not trim binary log segment: " << strerror(errno) << std::endl;
+    }
+    ::close(m_fd);
+    m_fd = -1;
+#endif
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: BinaryLogSink.hpp
+ *
+ * [
+ * This header declares the binary log sink: the writer side of the format
+ * described in BinaryLogFormat.hpp.
+ *
+ * Segments are files named `<prefix>.NNNNNN.phlog`. Each one is created at
+ * its full size, mapped into memory with `mmap`, and filled by plain memory
+ * copies; when the next entry does not fit, the segment is trimmed to the
+ * bytes actually used and a new one is started. Appending a record is
+ * therefore a handful of varint writes and a `memcpy` under a short lock,
+ * with no system call, and the page cache persists the data even if the
+ * process dies without closing the sink.
+ *
+ * Module names and format strings are interned: each distinct value gets a
+ * small integer id, and its text is written once per segment, right before
+ * the first event that uses it. Format strings are keyed by address (call
+ * sites pass literals), with a string comparison guarding against an address
+ * being reused for a different format.
+ *
+ * The sink is only available on POSIX systems; `open` fails elsewhere.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BINARY_LOG_SINK_HPP
+#define BINARY_LOG_SINK_HPP
+
+#include "../../ipc/include/ph_core_api.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define BINARY_LOG_DEFAULT_SEGMENT_SIZE (16u * 1024u * 1024u)
+#define BINARY_LOG_MIN_SEGMENT_SIZE (64u * 1024u)
+// Distinct format strings interned before the sink falls back to storing
+// pre-formatted text (protects against formats built at runtime).
+#define BINARY_LOG_MAX_FORMATS 4096
+
+class BinaryLogSink {
+public:
+    BinaryLogSink() = default;
+    ~BinaryLogSink();
+
+    BinaryLogSink(const BinaryLogSink&) = delete;
+    void operator=(const BinaryLogSink&) = delete;
+
+    /**
+     * @brief Creates the first segment.
+     * @param path_prefix Segment files are named `<path_prefix>.NNNNNN.phlog`.
+     *                    Existing segments are never overwritten; the lowest
+     *                    free number is used.
+     * @param segment_size Size of each segment in bytes (0 = default).
+     * @param error Receives a description on failure.
+     * @return true on success.
+     */
+    bool open(const std::string& path_prefix, size_t segment_size, std::string& error);
+
+    /**
+     * @brief Trims and closes the current segment. Further writes are ignored.
+     */
+    void close();
+
+    /**
+     * @brief Records a printf-style event without formatting it.
+     */
+    void write_formatted(std::chrono::system_clock::time_point timestamp, phLogLevel level,
+                         const char* module_name, const char* format, va_list args);
+
+    /**
+     * @brief Records an already formatted message.
+     */
+    void write_message(std::chrono::system_clock::time_point timestamp, phLogLevel level,
+                       const char* module_name, const char* message, size_t length);
+
+    /**
+     * @brief Schedules write-back of the mapped segment (`msync(MS_ASYNC)`).
+     */
+    void flush();
+
+    /**
+     * @brief Returns how many events were discarded (oversized or no segment).
+     */
+    uint64_t dropped_count() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    void append_event(std::chrono::system_clock::time_point timestamp, phLogLevel level,
+                      const char* module_name, const char* format, const std::string& args);
+
+    /**
+     * @brief Serializes missing definitions and the event into `m_entry`.
+     * Requires `m_mutex`.
+     */
+    void build_entry(int64_t time_us, phLogLevel level, uint32_t module_id,
+                     uint32_t format_id, const std::string& args);
+
+    uint32_t intern_module(const char* module_name);
+    // Returns false if the format table is full.
+    bool intern_format(const char* format, uint32_t& id);
+
+    bool open_segment(std::string& error);
+    void close_segment();
+
+    std::mutex m_mutex;
+    std::string m_prefix;
+    size_t m_segment_size = 0;
+    uint64_t m_sequence = 0;      // Number of the current (or next) segment.
+    uint64_t m_segment_stamp = 0; // Increments per segment; see m_*_stamp below.
+    int m_fd = -1;
+    uint8_t* m_base = nullptr;    // Mapping of the current segment.
+    size_t m_used = 0;            // Bytes written to the current segment.
+    int64_t m_last_time_us = 0;   // Base for the next timestamp delta.
+    std::atomic<uint64_t> m_dropped{0};
+    std::string m_entry;          // Scratch buffer for one entry, reused.
+
+    // Interning tables. `*_stamp[id]` is the value of m_segment_stamp when
+    // the definition was last written, so each segment gets its own copy.
+    std::map<std::string, uint32_t, std::less<>> m_module_ids;
+    std::vector<const std::string*> m_module_names;
+    std::vector<uint64_t> m_module_stamp;
+    std::unordered_map<const char*, uint32_t> m_format_ids;
+    std::vector<std::string> m_format_texts;
+    std::vector<uint64_t> m_format_stamp;
+};
+
+#endif // BINARY_LOG_SINK_HPP
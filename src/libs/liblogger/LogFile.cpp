@@ -0,0 +1,496 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: LogFile.cpp
+ *
+ * [
+ * This file implements the rotating text log file and its background
+ * compressor, declared in LogFile.hpp.
+ *
+ * Compression shells out to the `gzip` and `zstd` command line tools rather
+ * than linking a compression library: they are present on every system the
+ * operator runs on, and running them in a child process keeps their CPU and
+ * memory cost out of the application entirely. Errors on the background
+ * thread are reported on stderr, because the thread must never wait for the
+ * logger's own mutex (the logger holds it while stopping the thread).
+ *
+ * On Windows an open file cannot be renamed, so rotation briefly closes the
+ * live file instead of swapping it with `dup2`, and compression is skipped.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "LogFile.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#define LOG_FILE_OPEN(path) _open((path), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE)
+#define LOG_FILE_WRITE _write
+#define LOG_FILE_CLOSE _close
+#define LOG_FILE_DUP2 _dup2
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define LOG_FILE_OPEN(path) ::open((path), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644)
+#define LOG_FILE_WRITE ::write
+#define LOG_FILE_CLOSE ::close
+extern char** environ;
+
+/**
+ * @brief `dup2` that keeps `fd` close-on-exec. A plain `dup2` clears the
+ * flag, and the descriptor would then leak into the compression tools.
+ * @return `fd`, or -1 with errno set.
+ */
+static int dup2_cloexec(int fresh, int fd) {
+#ifdef __linux__
+    return ::dup3(fresh, fd, O_CLOEXEC);
+#else
+    if (::dup2(fresh, fd) < 0) {
+        return -1;
+    }
+    return ::fcntl(fd, F_SETFD, FD_CLOEXEC) == 0 ? fd : -1;
+#endif
+}
+#define LOG_FILE_DUP2 dup2_cloexec
+#endif
+
+/**
+ * @brief Returns the current wall-clock time in microseconds since the epoch.
+ */
+static int64_t now_micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Builds `<path>.YYYYMMDD-HHMMSS` for the current local time.
+ */
+static std::string rotated_name(const std::string& path) {
+    time_t now = time(nullptr);
+    struct tm timeinfo;
+#ifdef _WIN32
+    localtime_s(&timeinfo, &now);
+#else
+    localtime_r(&now, &timeinfo);
+#endif
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), ".%Y%m%d-%H%M%S", &timeinfo);
+    return path + stamp;
+}
+
+/**
+ * @brief Tells whether a rotated file, or a compressed copy of it, exists.
+ */
+static bool rotated_name_taken(const std::string& name) {
+    std::error_code ec;
+    return std::filesystem::exists(name, ec) || std::filesystem::exists(name + ".gz", ec) ||
+           std::filesystem::exists(name + ".zst", ec);
+}
+
+// --- LogCompressor ---
+
+LogCompressor::~LogCompressor() {
+    stop();
+}
+
+/**
+ * @see LogFile.hpp
+ */
+void LogCompressor::submit(const std::string& rotated_path, const std::string& live_path,
+                           phLoggerCompression compression, uint32_t keep) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping) {
+        return;
+    }
+    m_jobs.push_back(Job{rotated_path, live_path, compression, keep});
+    if (!m_thread.joinable()) {
+        try {
+            m_thread = std::thread(&LogCompressor::run, this);
+        } catch (const std::system_error&) {
+            std::cerr << "WARNING: Could not start the log compressor; rotated logs stay uncompressed." << std::endl;
+            m_jobs.clear();
+            return;
+        }
+    }
+    m_cv.notify_one();
+}
+
+/**
+ * @see LogFile.hpp
+ */
+void LogCompressor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+/**
+ * @brief Runs one compression tool and waits for it.
+ * @return true if the tool exited successfully.
+ */
+static bool run_compressor(phLoggerCompression compression, const std::string& path) {
+#ifdef _WIN32
+    (void)compression;
+    (void)path;
+    return false;
+#else
+    // Both tools replace `path` with `path.gz` / `path.zst` on success.
+    std::vector<const char*> argv;
+    if (compression == LOGGER_COMPRESS_GZIP) {
+        argv = {"gzip", "-f", "--", path.c_str(), nullptr};
+    } else {
+        argv = {"zstd", "-q", "-f", "--rm", "--", path.c_str(), nullptr};
+    }
+    pid_t pid;
+    if (posix_spawnp(&pid, argv[0], nullptr, nullptr, const_cast<char* const*>(argv.data()), environ) != 0) {
+        return false;
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+/**
+ * @brief Returns a rotated file name without its compression extension.
+ */
+static std::string strip_compression_extension(const std::string& name) {
+    for (const char* extension : {".gz", ".zst"}) {
+        size_t len = strlen(extension);
+        if (name.size() > len && name.compare(name.size() - len, len, extension) == 0) {
+            return name.substr(0, name.size() - len);
+        }
+    }
+    return name;
+}
+
+/**
+ * @brief Deletes the oldest rotated files of `live_path` beyond `keep`.
+ *
+ * Rotated names embed a sortable timestamp (plus a zero-padded counter for
+ * rotations within the same second), so once the compression extension is
+ * ignored, lexical order is age order.
+ */
+static void prune_rotated(const std::string& live_path, uint32_t keep) {
+    namespace fs = std::filesystem;
+    fs::path live(live_path);
+    fs::path dir = live.has_parent_path() ? live.parent_path() : fs::path(".");
+    std::string prefix = live.filename().string() + ".";
+
+    std::vector<std::pair<std::string, fs::path>> rotated;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string name = it->path().filename().string();
+        // Only `<name>.YYYYMMDD-...`: other files sharing the prefix are left alone.
+        if (name.size() > prefix.size() + 8 && name.compare(0, prefix.size(), prefix) == 0 &&
+            std::all_of(name.begin() + static_cast<long>(prefix.size()),
+                        name.begin() + static_cast<long>(prefix.size()) + 8,
+                        [](char c) { return c >= '0' && c <= '9'; })) {
+            rotated.emplace_back(strip_compression_extension(name), it->path());
+        }
+    }
+    if (rotated.size() <= keep) {
+        return;
+    }
+    std::sort(rotated.begin(), rotated.end());
+    for (size_t i = 0; i < rotated.size() - keep; ++i) {
+        fs::remove(rotated[i].second, ec);
+    }
+}
+
+/**
+ * @brief Body of the compressor thread.
+ */
+void LogCompressor::run() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            // Jobs queued before `stop` still run, so no rotated file is
+            // left uncompressed or beyond the retention limit.
+            if (m_jobs.empty()) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        if (job.compression != LOGGER_COMPRESS_NONE && !run_compressor(job.compression, job.rotated_path)) {
+            std::cerr << "WARNING: Could not compress rotated log " << job.rotated_path << std::endl;
+        }
+        prune_rotated(job.live_path, job.keep ? job.keep : LOGGER_DEFAULT_ROTATE_KEEP);
+    }
+}
+
+// --- LogFile ---
+
+LogFile::~LogFile() {
+    close();
+}
+
+/**
+ * @see LogFile.hpp
+ */
+bool LogFile::open(const std::string& path) {
+    if (m_fd >= 0) {
+        return true;
+    }
+    int fd = LOG_FILE_OPEN(path.c_str());
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    m_size = fstat(fd, &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+    m_fd = fd;
+    m_path = path;
+    schedule_next_rotation(now_micros());
+    return true;
+}
+
+/**
+ * @see LogFile.hpp
+ */
+void LogFile::close() {
+    if (m_fd >= 0) {
+        commit();
+        LOG_FILE_CLOSE(m_fd);
+        m_fd = -1;
+    }
+    m_compressor.stop();
+}
+
+/**
+ * @see LogFile.hpp
+ */
+void LogFile::write(const char* data, size_t length) {
+    commit();
+    if (m_fd < 0) {
+        return;
+    }
+    // Written straight from the caller's buffer: the async writer's batches
+    // are already large, and copying them into chunks would only cost time.
+    size_t done = 0;
+    while (done < length) {
+#ifdef _WIN32
+        int n = LOG_FILE_WRITE(m_fd, data + done, static_cast<unsigned>(length - done));
+#else
+        ssize_t n = LOG_FILE_WRITE(m_fd, data + done, length - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (n < 0) {
+            break; // Disk full or similar: drop the rest rather than spin.
+        }
+        done += static_cast<size_t>(n);
+    }
+    m_size += done;
+    rotate_if_due();
+}
+
+/**
+ * @see LogFile.hpp
+ */
+void LogFile::append(const char* data, size_t length) {
+    if (m_fd < 0) {
+        return;
+    }
+    // Start a new chunk when the current one would overflow. A record larger
+    // than a chunk gets a chunk of its own, which simply grows.
+    if (m_active_chunks == 0 ||
+        (!m_chunks[m_active_chunks - 1].empty() &&
+         m_chunks[m_active_chunks - 1].size() + length > LOG_FILE_CHUNK_SIZE)) {
+        if (m_active_chunks == LOG_FILE_MAX_CHUNKS) {
+            commit();
+        }
+        if (m_active_chunks == m_chunks.size()) {
+            m_chunks.emplace_back();
+            m_chunks.back().reserve(LOG_FILE_CHUNK_SIZE);
+        }
+        ++m_active_chunks;
+    }
+    m_chunks[m_active_chunks - 1].append(data, length);
+    m_pending_bytes += length;
+}
+
+/**
+ * @brief Writes every pending chunk, retrying after partial writes.
+ * @return The number of bytes that reached the file.
+ */
+size_t LogFile::write_chunks() {
+    size_t written = 0;
+#ifdef _WIN32
+    for (size_t i = 0; i < m_active_chunks; ++i) {
+        const std::string& chunk = m_chunks[i];
+        size_t done = 0;
+        while (done < chunk.size()) {
+            int n = LOG_FILE_WRITE(m_fd, chunk.data() + done, static_cast<unsigned>(chunk.size() - done));
+            if (n < 0) {
+                return written + done; // Disk full or similar: drop the rest rather than spin.
+            }
+            done += static_cast<size_t>(n);
+        }
+        written += done;
+    }
+#else
+    struct iovec iov[LOG_FILE_MAX_CHUNKS];
+    size_t count = m_active_chunks;
+    for (size_t i = 0; i < count; ++i) {
+        iov[i].iov_base = const_cast<char*>(m_chunks[i].data());
+        iov[i].iov_len = m_chunks[i].size();
+    }
+    size_t first = 0;
+    while (first < count) {
+        ssize_t n = ::writev(m_fd, iov + first, static_cast<int>(count - first));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break; // Disk full or similar: drop the rest rather than spin.
+        }
+        written += static_cast<size_t>(n);
+        // Skip the fully written buffers and trim the partially written one.
+        size_t remaining = static_cast<size_t>(n);
+        while (first < count && remaining >= iov[first].iov_len) {
+            remaining -= iov[first].iov_len;
+            ++first;
+        }
+        if (first < count) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + remaining;
+            iov[first].iov_len -= remaining;
+        }
+    }
+#endif
+    return written;
+}
+
+/**
+ * @see LogFile.hpp
+ */
+void LogFile::commit() {
+    if (m_pending_bytes == 0 || m_fd < 0) {
+        return;
+    }
+    m_size += write_chunks();
+    for (size_t i = 0; i < m_active_chunks; ++i) {
+        m_chunks[i].clear(); // Keeps the capacity for the next batch.
+    }
+    m_active_chunks = 0;
+    m_pending_bytes = 0;
+    rotate_if_due();
+}
+
+/**
+ * @brief Rotates the file if it reached its size limit or its interval ended.
+ */
+void LogFile::rotate_if_due() {
+    if (m_rotation_failed) {
+        return;
+    }
+    if ((m_rotation.max_bytes != 0 && m_size >= m_rotation.max_bytes) ||
+        (m_next_rotation_us != INT64_MAX && m_size > 0 && now_micros() >= m_next_rotation_us)) {
+        rotate();
+    }
+}
+
+/**
+ * @see LogFile.hpp
+ */
+void LogFile::set_rotation(const phLoggerRotation& rotation) {
+    m_rotation = rotation;
+    m_rotation_failed = false;
+    schedule_next_rotation(now_micros());
+}
+
+/**
+ * @brief Aligns interval rotation to multiples of the interval since the
+ * epoch, so that e.g. an hourly policy rotates on the hour (UTC).
+ */
+void LogFile::schedule_next_rotation(int64_t now_us) {
+    if (m_rotation.interval_seconds == 0) {
+        m_next_rotation_us = INT64_MAX;
+        return;
+    }
+    int64_t interval_us = static_cast<int64_t>(m_rotation.interval_seconds) * 1000000;
+    m_next_rotation_us = (now_us / interval_us + 1) * interval_us;
+}
+
+/**
+ * @see LogFile.hpp
+ */
+void LogFile::rotate() {
+    std::string target = rotated_name(m_path);
+    for (int n = 1; rotated_name_taken(target); ++n) {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), "-%03d", n); // Several rotations within one second.
+        target = rotated_name(m_path) + suffix;
+    }
+
+#ifdef _WIN32
+    LOG_FILE_CLOSE(m_fd);
+    bool renamed = std::rename(m_path.c_str(), target.c_str()) == 0;
+    int fresh = LOG_FILE_OPEN(m_path.c_str());
+    if (fresh >= 0 && fresh != m_fd) {
+        LOG_FILE_DUP2(fresh, m_fd);
+        LOG_FILE_CLOSE(fresh);
+    }
+    if (fresh < 0) {
+        m_fd = -1;
+    }
+#else
+    bool renamed = std::rename(m_path.c_str(), target.c_str()) == 0;
+    if (renamed) {
+        int fresh = LOG_FILE_OPEN(m_path.c_str());
+        if (fresh >= 0 && LOG_FILE_DUP2(fresh, m_fd) >= 0) {
+            // The atomic swap: m_fd now refers to the new file.
+            LOG_FILE_CLOSE(fresh);
+        } else {
+            int error = errno;
+            if (fresh >= 0) {
+                LOG_FILE_CLOSE(fresh);
+            }
+            // Keep writing to the renamed file rather than losing records.
+            std::cerr << "WARNING: Could not reopen log file " << m_path << ": " << strerror(error) << std::endl;
+            renamed = false;
+        }
+    }
+#endif
+
+    if (!renamed) {
+        std::cerr << "WARNING: Log rotation of " << m_path << " failed; rotation disabled." << std::endl;
+        m_rotation_failed = true;
+        return;
+    }
+
+    m_size = 0;
+    schedule_next_rotation(now_micros());
+    m_compressor.submit(target, m_path, m_rotation.compression, m_rotation.keep);
+}
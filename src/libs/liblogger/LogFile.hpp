@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: LogFile.hpp
+ *
+ * [
+ * This header declares the text log file used by the Logger: an append-only
+ * file descriptor that rotates itself by size and by wall-clock interval.
+ *
+ * Rotation renames the live file to `<path>.YYYYMMDD-HHMMSS`, opens a fresh
+ * file at `<path>` and installs it over the active descriptor with `dup2`.
+ * The descriptor number never changes, so the swap is atomic for anyone
+ * writing to it: a write lands either in the old file or in the new one,
+ * never in a closed descriptor.
+ *
+ * Rotated files are handed to a background thread, which compresses them
+ * with the system `gzip` or `zstd` tools and removes the oldest ones beyond
+ * the retention limit. The thread that triggered the rotation never waits
+ * for either.
+ *
+ * Group commit:
+ * Lines can be appended without being written. They accumulate in a few
+ * reusable fixed-size chunks and reach the file with a single `writev` when
+ * the owner commits, so a burst of records costs one system call instead of
+ * one per line. Deciding *when* to commit is left to the Logger.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LOG_FILE_HPP
+#define LOG_FILE_HPP
+
+#include "Logger.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Rotated files kept when phLoggerRotation::keep is 0.
+#define LOGGER_DEFAULT_ROTATE_KEEP 7
+// Size of one group-commit chunk, and the most chunks a single writev takes.
+#define LOG_FILE_CHUNK_SIZE (16 * 1024)
+#define LOG_FILE_MAX_CHUNKS 16
+
+/**
+ * @class LogCompressor
+ * @brief Background worker that compresses and prunes rotated log files.
+ *
+ * The thread starts with the first job and lives until `stop`.
+ */
+class LogCompressor {
+public:
+    LogCompressor() = default;
+    ~LogCompressor();
+
+    LogCompressor(const LogCompressor&) = delete;
+    void operator=(const LogCompressor&) = delete;
+
+    /**
+     * @brief Queues a rotated file.
+     * @param rotated_path The file to compress (if requested) and retain.
+     * @param live_path The live log path; rotated files share its name.
+     * @param compression The compressor to run.
+     * @param keep How many rotated files to keep.
+     */
+    void submit(const std::string& rotated_path, const std::string& live_path,
+                phLoggerCompression compression, uint32_t keep);
+
+    /**
+     * @brief Runs the jobs still queued, then stops the thread. Jobs
+     * submitted afterwards are ignored.
+     */
+    void stop();
+
+private:
+    struct Job {
+        std::string rotated_path;
+        std::string live_path;
+        phLoggerCompression compression;
+        uint32_t keep;
+    };
+
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_jobs;
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+/**
+ * @class LogFile
+ * @brief The rotating text log file.
+ *
+ * Not thread-safe: the Logger serializes every call with its mutex.
+ */
+class LogFile {
+public:
+    LogFile() = default;
+    ~LogFile();
+
+    LogFile(const LogFile&) = delete;
+    void operator=(const LogFile&) = delete;
+
+    /**
+     * @brief Opens (or creates) the file in append mode.
+     * @return true on success.
+     */
+    bool open(const std::string& path);
+
+    bool is_open() const { return m_fd >= 0; }
+
+    /**
+     * @brief Closes the file and stops the background compressor.
+     */
+    void close();
+
+    /**
+     * @brief Writes the whole buffer right away, after anything pending,
+     * without copying it.
+     */
+    void write(const char* data, size_t length);
+
+    /**
+     * @brief Buffers data for the next `commit`. Commits on its own only if
+     * every chunk is in use.
+     */
+    void append(const char* data, size_t length);
+
+    /**
+     * @brief Writes all buffered data with one `writev`, then rotates the
+     * file if it is due.
+     */
+    void commit();
+
+    /**
+     * @brief Returns the number of appended bytes not yet committed.
+     */
+    size_t pending_bytes() const { return m_pending_bytes; }
+
+    /**
+     * @brief Replaces the rotation policy. A zeroed policy disables rotation.
+     */
+    void set_rotation(const phLoggerRotation& rotation);
+
+    const phLoggerRotation& rotation() const { return m_rotation; }
+
+private:
+    /**
+     * @brief Computes the next interval boundary after `now_us`.
+     */
+    void schedule_next_rotation(int64_t now_us);
+
+    /**
+     * @brief Moves the live file aside and continues in a fresh one.
+     */
+    void rotate();
+
+    size_t write_chunks();
+    void rotate_if_due();
+
+    int m_fd = -1;
+    std::string m_path;
+    uint64_t m_size = 0;                 // Bytes in the live file.
+    phLoggerRotation m_rotation = {};
+    int64_t m_next_rotation_us = INT64_MAX;
+    bool m_rotation_failed = false;      // Reported once, then rotation stops.
+    LogCompressor m_compressor;
+
+    // Group-commit buffers. Chunks keep their capacity between commits.
+    std::vector<std::string> m_chunks;
+    size_t m_active_chunks = 0;          // Chunks holding pending data.
+    size_t m_pending_bytes = 0;
+};
+
+#endif // LOG_FILE_HPP
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: LogFormat.cpp
+ *
+ * [
+ * This file implements the allocation-free formatting primitives declared in
+ * LogFormat.hpp. The timestamp is assembled digit by digit into a cached
+ * buffer: the date and time of day are recomputed only when the second
+ * changes, and every other call patches the three millisecond digits in
+ * place. Line assembly is a sequence of `append` calls into a buffer whose
+ * capacity the caller keeps between records.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "LogFormat.hpp"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+// Initial capacity of a message scratch buffer; most log lines fit in it.
+#define LOG_SCRATCH_INITIAL_CAPACITY 256
+
+/**
+ * @brief Writes `value` as exactly `width` decimal digits, zero-padded.
+ */
+static void write_digits(char* dst, int value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        dst[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+/**
+ * @see LogFormat.hpp
+ */
+const char* TimestampFormatter::format(std::chrono::system_clock::time_point timestamp) {
+    int64_t total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           timestamp.time_since_epoch()).count();
+    int64_t second = total_ms / 1000;
+    int millis = static_cast<int>(total_ms % 1000);
+    if (millis < 0) { // Timestamps before the epoch round toward zero.
+        millis += 1000;
+        second -= 1;
+    }
+
+    if (second != m_cached_second) {
+        time_t time_t_sec = static_cast<time_t>(second);
+        struct tm timeinfo;
+#ifdef _WIN32
+        localtime_s(&timeinfo, &time_t_sec); // Windows-specific safe version
+#else
+        localtime_r(&time_t_sec, &timeinfo); // POSIX-specific safe version
+#endif
+        // "YYYY-MM-DD HH:MM:SS.mmm"
+        write_digits(m_text, timeinfo.tm_year + 1900, 4);
+        m_text[4] = '-';
+        write_digits(m_text + 5, timeinfo.tm_mon + 1, 2);
+        m_text[7] = '-';
+        write_digits(m_text + 8, timeinfo.tm_mday, 2);
+        m_text[10] = ' ';
+        write_digits(m_text + 11, timeinfo.tm_hour, 2);
+        m_text[13] = ':';
+        write_digits(m_text + 14, timeinfo.tm_min, 2);
+        m_text[16] = ':';
+        write_digits(m_text + 17, timeinfo.tm_sec, 2);
+        m_text[19] = '.';
+        m_text[LOG_TIMESTAMP_LENGTH] = '\0';
+        m_cached_second = second;
+    }
+
+    write_digits(m_text + 20, millis, 3);
+    return m_text;
+}
+
+/**
+ * @see LogFormat.hpp
+ */
+const char* log_level_name(phLogLevel level) {
+    switch (level) {
+        case LOG_LEVEL_DEBUG: return "DEBUG";
+        case LOG_LEVEL_INFO:  return "INFO ";
+        case LOG_LEVEL_WARN:  return "WARN ";
+        case LOG_LEVEL_ERROR: return "ERROR";
+        case LOG_LEVEL_FATAL: return "FATAL";
+        default:              return "UNKWN";
+    }
+}
+
+/**
+ * @see LogFormat.hpp
+ */
+void log_format_line(std::string& out, std::chrono::system_clock::time_point timestamp,
+                     phLogLevel level, const char* module_name,
+                     const char* message, size_t message_length) {
+    // Trivially destructible, so the thread_local costs no TLS destructor.
+    static thread_local TimestampFormatter t_formatter;
+
+    out.push_back('[');
+    out.append(t_formatter.format(timestamp), LOG_TIMESTAMP_LENGTH);
+    out.append("] [", 3);
+    out.append(log_level_name(level), 5);
+    out.append("] [", 3);
+    out.append(module_name, strlen(module_name));
+    out.append("] ", 2);
+    out.append(message, message_length);
+    out.push_back('\n');
+}
+
+/**
+ * @see LogFormat.hpp
+ */
+int log_vformat(std::string& scratch, const char* format, va_list args) {
+    if (scratch.capacity() < LOG_SCRATCH_INITIAL_CAPACITY) {
+        scratch.reserve(LOG_SCRATCH_INITIAL_CAPACITY);
+    }
+    // Expose the whole capacity so a single pass can use all of it.
+    scratch.resize(scratch.capacity());
+
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int len = vsnprintf(&scratch[0], scratch.size() + 1, format, args_copy);
+    va_end(args_copy);
+
+    if (len < 0) {
+        scratch.clear();
+        return -1;
+    }
+    if (static_cast<size_t>(len) > scratch.size()) {
+        // Rare path: grow once to the exact size and format again.
+        scratch.resize(static_cast<size_t>(len));
+        va_copy(args_copy, args);
+        vsnprintf(&scratch[0], scratch.size() + 1, format, args_copy);
+        va_end(args_copy);
+    } else {
+        scratch.resize(static_cast<size_t>(len));
+    }
+    return len;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: LogFormat.hpp
+ *
+ * [
+ * This header declares the text formatting primitives shared by every log
+ * sink. They turn a record (timestamp, level, module, message) into the
+ * canonical line layout:
+ *
+ *     [YYYY-MM-DD HH:MM:SS.mmm] [LEVEL] [module] message
+ *
+ * The functions are written for the logging hot path: they append into
+ * caller-owned buffers that keep their capacity between calls, and the
+ * timestamp formatter is hand-rolled instead of going through `strftime` or
+ * `std::put_time`. It caches the text of the current second per thread and
+ * only rewrites the millisecond digits while the second does not change, so
+ * the expensive `localtime` conversion runs at most once per second per
+ * thread. In the steady state no function in this file allocates.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LOG_FORMAT_HPP
+#define LOG_FORMAT_HPP
+
+#include "../../ipc/include/ph_core_api.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <string>
+
+// Length of "YYYY-MM-DD HH:MM:SS.mmm" without the terminating null byte.
+#define LOG_TIMESTAMP_LENGTH 23
+
+/**
+ * @class TimestampFormatter
+ * @brief Formats wall-clock timestamps, caching the text of the last second.
+ *
+ * Instances are cheap, trivially destructible and not thread-safe; the
+ * logger keeps one per thread.
+ */
+class TimestampFormatter {
+public:
+    /**
+     * @brief Formats a timestamp in local time.
+     * @param timestamp The point in time to format.
+     * @return A pointer to LOG_TIMESTAMP_LENGTH characters (null-terminated),
+     *         valid until the next call on the same formatter.
+     */
+    const char* format(std::chrono::system_clock::time_point timestamp);
+
+private:
+    int64_t m_cached_second = INT64_MIN;      // Epoch second held in m_text.
+    char m_text[LOG_TIMESTAMP_LENGTH + 1] = {}; // Formatted second + ".mmm".
+};
+
+/**
+ * @brief Returns the fixed-width (five character) name of a level.
+ */
+const char* log_level_name(phLogLevel level);
+
+/**
+ * @brief Appends a complete log line, including the trailing newline.
+ *
+ * Uses the calling thread's TimestampFormatter.
+ *
+ * @param out The buffer to append to. Its capacity is reused across calls.
+ * @param timestamp When the record was produced.
+ * @param level The record's severity.
+ * @param module_name The null-terminated module name.
+ * @param message The message bytes (not necessarily null-terminated).
+ * @param message_length The number of message bytes.
+ */
+void log_format_line(std::string& out, std::chrono::system_clock::time_point timestamp,
+                     phLogLevel level, const char* module_name,
+                     const char* message, size_t message_length);
+
+/**
+ * @brief Formats a printf-style message into a reusable buffer.
+ *
+ * The buffer is used at its current capacity, so the message is formatted
+ * in a single `vsnprintf` pass unless it does not fit; only then does the
+ * buffer grow and the format run a second time. Buffers therefore stop
+ * allocating once they have seen the largest message of the workload.
+ *
+ * @param scratch The buffer receiving the message. On return its size is
+ *                the message length.
+ * @param format The printf-style format string.
+ * @param args The arguments. The caller's va_list is left untouched.
+ * @return The message length, or -1 on a formatting error.
+ */
+int log_vformat(std::string& scratch, const char* format, va_list args);
+
+#endif // LOG_FORMAT_HPP
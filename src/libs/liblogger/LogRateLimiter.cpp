@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: LogRateLimiter.cpp
+ *
+ * [
+ * This file implements the lock-free call-site rate limiter declared in
+ * LogRateLimiter.hpp.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "LogRateLimiter.hpp"
+#include <cstring>
+
+/**
+ * @brief Hashes a call site: FNV-1a over the module name, mixed with the
+ * format address by the splitmix64 finalizer. Never returns 0.
+ */
+static uint64_t call_site_key(const char* module_name, const char* format) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* p = module_name; *p != '\0'; ++p) {
+        hash = (hash ^ static_cast<unsigned char>(*p)) * 1099511628211ull;
+    }
+    hash ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(format));
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return hash != 0 ? hash : 1;
+}
+
+/**
+ * @see LogRateLimiter.hpp
+ */
+void LogRateLimiter::configure(uint32_t per_second, uint32_t burst) {
+    if (burst == 0) {
+        burst = 1;
+    }
+    int64_t interval = per_second ? (1000000 + per_second - 1) / per_second : 0;
+    m_per_second.store(per_second, std::memory_order_relaxed);
+    m_burst.store(burst, std::memory_order_relaxed);
+    m_tolerance_us.store(interval * (burst - 1), std::memory_order_relaxed);
+    m_interval_us.store(interval, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Copies `text` into `out`, clipping it to `size - 1` bytes.
+ */
+static void copy_clipped(char* out, size_t size, const char* text) {
+    size_t length = strnlen(text, size - 1);
+    memcpy(out, text, length);
+    out[length] = '\0';
+}
+
+/**
+ * @brief Finds the bucket of a call site, claiming a free slot on first use.
+ * The claiming thread records the call site's description.
+ * @return The slot, or nullptr if the probe window is full.
+ */
+LogRateLimiter::Slot* LogRateLimiter::find_slot(uint64_t key, const char* module_name, const char* format) {
+    size_t index = static_cast<size_t>(key) & (LOG_RATE_LIMITER_SLOTS - 1);
+    for (int probe = 0; probe < LOG_RATE_LIMITER_MAX_PROBE; ++probe) {
+        Slot& slot = m_slots[(index + probe) & (LOG_RATE_LIMITER_SLOTS - 1)];
+        uint64_t current = slot.key.load(std::memory_order_acquire);
+        if (current == key) {
+            return &slot;
+        }
+        if (current == 0) {
+            // Claim it; if another thread won, it may have claimed it for us.
+            if (slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                copy_clipped(slot.module_name, sizeof(slot.module_name), module_name);
+                copy_clipped(slot.format, sizeof(slot.format), format);
+                slot.described.store(true, std::memory_order_release);
+                return &slot;
+            }
+            if (current == key) {
+                return &slot;
+            }
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @see LogRateLimiter.hpp
+ */
+bool LogRateLimiter::admit(int level, const char* module_name, const char* format, int64_t now_us,
+                           uint64_t& report) {
+    report = 0;
+    int64_t interval = m_interval_us.load(std::memory_order_relaxed);
+    if (interval == 0) {
+        return true;
+    }
+    Slot* slot = find_slot(call_site_key(module_name, format), module_name, format);
+    if (slot == nullptr) {
+        return true; // Untracked call site: never suppress.
+    }
+
+    int64_t tolerance = m_tolerance_us.load(std::memory_order_relaxed);
+    int64_t arrival = slot->arrival_us.load(std::memory_order_relaxed);
+    bool admitted = false;
+    for (;;) {
+        int64_t base = arrival > now_us ? arrival : now_us;
+        if (base - now_us > tolerance) {
+            break; // Bucket empty.
+        }
+        if (slot->arrival_us.compare_exchange_weak(arrival, base + interval, std::memory_order_relaxed)) {
+            admitted = true;
+            break;
+        }
+    }
+
+    if (!admitted) {
+        slot->level.store(level, std::memory_order_relaxed);
+    }
+    if (!admitted && slot->suppressed.fetch_add(1, std::memory_order_relaxed) == 0) {
+        // First suppression since the last summary: start the report clock.
+        slot->next_report_us.store(now_us + LOG_RATE_LIMITER_REPORT_US, std::memory_order_relaxed);
+        return false;
+    }
+    // At most one summary per interval, whether or not this record passes.
+    if (slot->suppressed.load(std::memory_order_relaxed) != 0) {
+        int64_t next_report = slot->next_report_us.load(std::memory_order_relaxed);
+        if (now_us >= next_report &&
+            slot->next_report_us.compare_exchange_strong(next_report, now_us + LOG_RATE_LIMITER_REPORT_US,
+                                                         std::memory_order_relaxed)) {
+            report = slot->suppressed.exchange(0, std::memory_order_relaxed);
+        }
+    }
+    return admitted;
+}
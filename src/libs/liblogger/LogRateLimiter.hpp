@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: LogRateLimiter.hpp
+ *
+ * [
+ * This header declares the per-call-site rate limiter of the logger.
+ *
+ * A call site is identified by its module name and the address of its format
+ * string, which is a literal in practice. Each call site owns a token bucket
+ * kept as a single "theoretical arrival time" (the GCRA formulation): a
+ * record is admitted if the bucket would not overflow, and admitting it
+ * pushes the arrival time forward by one emission interval. That makes the
+ * whole check one compare-and-swap, with no lock and no timer.
+ *
+ * Buckets live in a fixed-size, open-addressed hash table. Slots are claimed
+ * with a compare-and-swap on the key and never released: the number of call
+ * sites in a program is bounded, and a call site that does not find a slot
+ * is simply not limited.
+ *
+ * Suppressed records are counted per bucket. The count is handed back to the
+ * caller, which logs a "N similar messages suppressed" summary, at most once
+ * per report interval: a storm costs one summary per second however long it
+ * lasts. The tail of a storm is reported the next time the call site logs
+ * after the interval or, if it goes quiet, when the logger is flushed or
+ * cleaned up (`collect_reports`), so a storm's last summary is never lost.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LOG_RATE_LIMITER_HPP
+#define LOG_RATE_LIMITER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Number of buckets, i.e. distinct call sites that can be limited.
+#define LOG_RATE_LIMITER_SLOTS 1024
+// Slots probed before a call site is considered untracked.
+#define LOG_RATE_LIMITER_MAX_PROBE 16
+// Minimum time between two summaries of a call site that stays suppressed.
+#define LOG_RATE_LIMITER_REPORT_US 1000000
+// Bytes of the module name and format string kept to describe a call site
+// in summaries reported after it went quiet. Longer text is clipped.
+#define LOG_RATE_LIMITER_MODULE_MAX 32
+#define LOG_RATE_LIMITER_FORMAT_MAX 96
+
+class LogRateLimiter {
+public:
+    LogRateLimiter() = default;
+
+    LogRateLimiter(const LogRateLimiter&) = delete;
+    void operator=(const LogRateLimiter&) = delete;
+
+    /**
+     * @brief Sets the sustained rate and the burst allowed per call site.
+     * @param per_second Records per second (0 disables limiting).
+     * @param burst Records admitted back to back (0 is treated as 1).
+     */
+    void configure(uint32_t per_second, uint32_t burst);
+
+    uint32_t per_second() const { return m_per_second.load(std::memory_order_relaxed); }
+    uint32_t burst() const { return m_burst.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Tells whether limiting is on. One relaxed load.
+     */
+    bool enabled() const { return m_interval_us.load(std::memory_order_relaxed) != 0; }
+
+    /**
+     * @brief Decides whether a record from a call site may be logged.
+     * @param level The record's level, kept for `collect_reports`.
+     * @param module_name The record's module.
+     * @param format The record's format string; its address is the key.
+     * @param now_us The current time on a monotonic clock, in microseconds.
+     * @param[out] report Receives the number of suppressed records to report
+     *                    now, or 0 if no summary is due.
+     * @return true if the record should be logged.
+     */
+    bool admit(int level, const char* module_name, const char* format, int64_t now_us, uint64_t& report);
+
+    /**
+     * @brief Hands out every summary still owed, without waiting for the
+     * report interval or for the call site to log again.
+     * @param visit A callable invoked as `visit(level, module_name, format,
+     *              count)` for each call site with suppressed records. The
+     *              strings are copies and may be clipped.
+     */
+    template <typename Visit>
+    void collect_reports(Visit&& visit) {
+        for (Slot& slot : m_slots) {
+            if (!slot.described.load(std::memory_order_acquire) ||
+                slot.suppressed.load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            uint64_t count = slot.suppressed.exchange(0, std::memory_order_relaxed);
+            if (count != 0) {
+                visit(slot.level.load(std::memory_order_relaxed), slot.module_name, slot.format, count);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key{0};           // 0 = free.
+        std::atomic<int64_t> arrival_us{0};     // Theoretical arrival time of the next record.
+        std::atomic<uint64_t> suppressed{0};    // Records suppressed since the last summary.
+        std::atomic<int64_t> next_report_us{0}; // Earliest summary while suppressed.
+        std::atomic<int> level{0};              // Level of the last suppressed record.
+        // Written once by the thread that claims the slot, then published.
+        std::atomic<bool> described{false};
+        char module_name[LOG_RATE_LIMITER_MODULE_MAX];
+        char format[LOG_RATE_LIMITER_FORMAT_MAX];
+    };
+
+    Slot* find_slot(uint64_t key, const char* module_name, const char* format);
+
+    Slot m_slots[LOG_RATE_LIMITER_SLOTS];
+    std::atomic<int64_t> m_interval_us{0};   // Time per record (0 = disabled).
+    std::atomic<int64_t> m_tolerance_us{0};  // How far ahead the arrival time may run.
+    std::atomic<uint32_t> m_per_second{0};
+    std::atomic<uint32_t> m_burst{0};
+};
+
+#endif // LOG_RATE_LIMITER_HPP
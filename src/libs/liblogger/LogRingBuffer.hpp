@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: LogRingBuffer.hpp
+ *
+ * [
+ * This header defines the bounded, lock-free queue that backs the asynchronous
+ * logging mode. It is an implementation of Dmitry Vyukov's bounded MPMC queue:
+ * every cell carries a sequence number that tells producers and consumers
+ * whether the cell is free, filled, or still being written, so neither side
+ * ever takes a lock.
+ *
+ * The logger uses it as a multi-producer / single-consumer ring: any thread
+ * calling `logger_log*` is a producer and the background writer thread is the
+ * only regular consumer. The algorithm tolerates additional consumers, which
+ * is what makes the "drop oldest" overflow policy safe: a producer facing a
+ * full ring can evict the oldest record by consuming it itself.
+ *
+ * Records are filled in place through a callback, so producers format their
+ * message directly into the ring cell and no intermediate buffer is needed.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LOG_RING_BUFFER_HPP
+#define LOG_RING_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Size used to keep the producer and consumer cursors on separate cache lines.
+#define LOG_RING_CACHE_LINE 64
+
+template <typename T>
+class LogRingBuffer {
+public:
+    /**
+     * @brief Creates a ring with room for `capacity` records.
+     * @param capacity The number of cells. It is rounded up to a power of two
+     *                 so that indices can be masked instead of divided.
+     */
+    explicit LogRingBuffer(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        m_mask = rounded - 1;
+        m_cells.reset(new Cell[rounded]);
+        for (size_t i = 0; i < rounded; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_enqueue_pos.store(0, std::memory_order_relaxed);
+        m_dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    LogRingBuffer(const LogRingBuffer&) = delete;
+    void operator=(const LogRingBuffer&) = delete;
+
+    /**
+     * @brief Claims a free cell and fills it in place.
+     * @param fill A callable invoked as `fill(T&)` on the claimed cell.
+     * @return true if the record was enqueued, false if the ring is full.
+     */
+    template <typename Fill>
+    bool try_emplace(Fill&& fill) {
+        Cell* cell;
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // The consumer has not released this cell yet: full.
+            } else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        fill(cell->data);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest record and hands it to a visitor.
+     * @param visit A callable invoked as `visit(T&)` before the cell is recycled.
+     * @return true if a record was consumed, false if the ring is empty.
+     */
+    template <typename Visit>
+    bool try_consume(Visit&& visit) {
+        Cell* cell;
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Nothing published at this position yet: empty.
+            } else {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        visit(cell->data);
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Cheap, approximate emptiness check used by the writer thread.
+     */
+    bool empty() const {
+        return m_dequeue_pos.load(std::memory_order_acquire) ==
+               m_enqueue_pos.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Returns how many cells producers have claimed so far. Every
+     * record enqueued before the call sits at a position below the result.
+     */
+    size_t enqueue_position() const { return m_enqueue_pos.load(std::memory_order_seq_cst); }
+
+    /**
+     * @brief Returns how many records have been consumed so far.
+     */
+    size_t dequeue_position() const { return m_dequeue_pos.load(std::memory_order_seq_cst); }
+
+    size_t capacity() const { return m_mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask = 0;
+    alignas(LOG_RING_CACHE_LINE) std::atomic<size_t> m_enqueue_pos;
+    alignas(LOG_RING_CACHE_LINE) std::atomic<size_t> m_dequeue_pos;
+};
+
+#endif // LOG_RING_BUFFER_HPP
@@ -6,9 +6,9 @@
  * [
  * This file implements the singleton Logger class and its C-compatible wrapper
  * functions. It handles the low-level details of file I/O, message formatting,
- * and thread synchronization. This version includes a new formatted logging
- * function, `logger_log_fmt`, which dynamically allocates memory to prevent
- * buffer overflow vulnerabilities.
+ * and thread synchronization. This version includes a formatted logging
+ * function, `logger_log_fmt`, which formats with bounds checking into a
+ * reusable buffer, preventing buffer overflows without allocating per call.
  *
  * The use of `std::lock_guard` makes the `log` method inherently thread-safe,
  * preventing interleaved or corrupted log entries when multiple modules write
@@ -26,18 +26,51 @@
  * lock and then call this internal, non-locking implementation, ensuring the
  * mutex is never acquired twice by the same thread and thus preventing the
  * deadlock.
+ *
+ * Asynchronous Mode:
+ * When initialized with `LOGGER_MODE_ASYNC`, the public `log` methods do not
+ * take `m_mutex` at all. They claim a cell in the lock-free ring buffer,
+ * format the message into it and wake the writer thread only if it is
+ * parked. The writer drains the ring in batches, formats every record into a
+ * reusable buffer and issues one write and one flush per batch. Records lost
+ * to the overflow policy are counted and reported in the log itself.
  * ]
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #include "Logger.hpp"
+#include "LogRingBuffer.hpp"
+#include "LogFormat.hpp"
+#include "BinaryLogSink.hpp"
+#include "LogFile.hpp"
+#include "LogRateLimiter.hpp"
+#include "StartupTrace.hpp"
 #include <iostream>
 #include <chrono>
-#include <ctime>
-#include <iomanip> // For std::put_time
 #include <cstdarg> // For va_list, va_start, va_end
-#include <vector>  // For std::vector as a safe dynamic buffer
+#include <cstdio>  // For vsnprintf
+#include <cstring> // For memcpy, strnlen
+#include <algorithm>
+#include <system_error>
+#include <cctype>  // For toupper in logger_parse_level
+#include <climits> // For INT_MAX
+
+// Upper bound of records written per batch by the background writer.
+#define LOGGER_WRITER_BATCH_MAX 512
+// How long the idle writer sleeps before re-checking the ring on its own.
+#define LOGGER_WRITER_IDLE_MS 50
+// How long `flush` waits for the writer, so a writer stuck on a full or
+// hung disk cannot hang every caller of logger_flush with it.
+#define LOGGER_FLUSH_TIMEOUT_MS 10000
+// Level of a module override that was removed. Entries are never freed, as
+// readers scan the table without a lock; this one sorts above every real
+// level, so it never lowers the floor.
+#define LOGGER_MODULE_LEVEL_CLEARED INT_MAX
+// Group commit: pending lines are written once they reach this many bytes,
+// or this long after the first of them was logged, whichever comes first.
+#define LOGGER_GROUP_COMMIT_BYTES (64 * 1024)
+#define LOGGER_GROUP_COMMIT_DEADLINE_MS 5
 
 // --- C++ Class Implementation ---
 
@@ -53,6 +86,12 @@ Logger& Logger::get_instance() {
     return instance;
 }
 
+/**
+ * @brief Creates the logger with a log file that `init` will open.
+ */
+Logger::Logger() : m_log_file(new LogFile()), m_rate_limiter(new LogRateLimiter()) {
+}
+
 /**
  * @brief Destructor closes the file stream automatically due to RAII.
  *
@@ -61,13 +100,27 @@ Logger& Logger::get_instance() {
  * shutdown message is logged.
  */
 Logger::~Logger() {
-    if (m_log_file.is_open()) {
+    // Drain and stop the background writer before the final message, so that
+    // no queued record is lost and nothing races with the file close.
+    shutdown_async();
+    stop_committer();
+
+    if (m_log_file->is_open()) {
         // We acquire the lock one last time to ensure the final message is
         // written safely, without interleaving with other potential last-
         // minute log calls from other threads.
         std::lock_guard<std::mutex> lock(m_mutex);
-        log_impl(LOG_LEVEL_INFO, "LOGGER", "Logging system shutting down.");
-        m_log_file.close();
+        // Not through `log_impl`: this runs during static destruction, after
+        // the main thread's thread_local buffers have been destroyed.
+        static const char kShutdown[] = "Logging system shutting down.";
+        std::string line;
+        log_format_line(line, std::chrono::system_clock::now(), LOG_LEVEL_INFO, "LOGGER",
+                        kShutdown, sizeof(kShutdown) - 1);
+        write_line(LOG_LEVEL_INFO, line.data(), line.size());
+        m_log_file->close();
+    }
+    if (m_binary_sink_owner) {
+        m_binary_sink_owner->close();
     }
 }
 
@@ -81,14 +134,28 @@ Logger::~Logger() {
  * This avoids the deadlock that occurred in the previous version.
  */
 bool Logger::init(const std::string& filename) {
+    phLoggerOptions options = {};
+    options.mode = LOGGER_MODE_SYNC;
+    return init(filename, options);
+}
+
+/**
+ * @brief Initializes the logger and, in asynchronous mode, starts the writer.
+ * @param filename The path to the log file.
+ * @param options The mode and queue settings.
+ * @return true on success, false on failure.
+ *
+ * If the writer thread cannot be created, the logger stays usable in
+ * synchronous mode and reports the problem in the log.
+ */
+bool Logger::init(const std::string& filename, const phLoggerOptions& options) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    if (m_log_file.is_open()) {
+    if (m_log_file->is_open()) {
         return true; // Already initialized
     }
 
-    m_log_file.open(filename, std::ios::out | std::ios::app);
-    if (!m_log_file.is_open()) {
+    if (!m_log_file->open(filename)) {
         // Use std::cerr for critical errors when the logger itself fails.
         std::cerr << "FATAL: Could not open log file: " << filename << std::endl;
         return false;
@@ -97,103 +164,693 @@ bool Logger::init(const std::string& filename) {
     // Call the internal implementation directly to avoid re-locking the mutex.
     // This is the core of the deadlock fix.
     log_impl(LOG_LEVEL_INFO, "LOGGER", "Logging system initialized.");
+    m_log_file->set_rotation(options.rotation);
+    m_rate_limiter->configure(options.rate_limit.per_second, options.rate_limit.burst);
+
+    unsigned sinks = options.sinks ? options.sinks : static_cast<unsigned>(LOGGER_SINK_TEXT);
+    if (sinks & LOGGER_SINK_BINARY) {
+        // If this fails the text sink stays on, so no record is lost silently.
+        open_binary_sink(options.binary_path_prefix ? options.binary_path_prefix : filename,
+                         options.binary_segment_size, (sinks & LOGGER_SINK_TEXT) != 0);
+    }
+
+    if (options.mode == LOGGER_MODE_ASYNC) {
+        size_t capacity = options.queue_capacity ? options.queue_capacity : LOGGER_DEFAULT_QUEUE_CAPACITY;
+        m_overflow_policy = options.overflow_policy;
+        m_ring.reset(new LogRingBuffer<LogRecord>(capacity));
+        m_flushed_position.store(0, std::memory_order_relaxed);
+        m_writer_running.store(true, std::memory_order_release);
+        try {
+            m_writer = std::thread(&Logger::writer_loop, this);
+            m_async_active.store(true, std::memory_order_seq_cst);
+            log_impl(LOG_LEVEL_INFO, "LOGGER", "Asynchronous logging enabled.");
+        } catch (const std::system_error&) {
+            m_writer_running.store(false, std::memory_order_release);
+            m_ring.reset();
+            log_impl(LOG_LEVEL_ERROR, "LOGGER", "Could not start the async log writer. Falling back to synchronous mode.");
+        }
+    }
+
+    // The async writer already writes in batches; the committer only serves
+    // the synchronous path.
+    if (!m_async_active.load(std::memory_order_relaxed) && options.commit_policy == LOGGER_COMMIT_GROUP) {
+        try {
+            m_committer_running = true;
+            m_committer = std::thread(&Logger::commit_loop, this);
+        } catch (const std::system_error&) {
+            m_committer_running = false; // Every line is then written immediately.
+        }
+    }
     return true;
 }
 
 /**
- * @brief Converts a phLogLevel enum to its human-readable string representation.
- * @param level The log level enum.
- * @return A constant C-string representing the log level.
+ * @brief Stops the asynchronous writer after every queued record is written.
+ *
+ * Producers are first diverted to the synchronous path, then the function
+ * waits for in-flight producers to finish their enqueue so that no record
+ * lands in the ring after the final drain.
+ */
+void Logger::shutdown_async() {
+    if (!m_async_active.exchange(false, std::memory_order_seq_cst)) {
+        return;
+    }
+    while (m_producers_inflight.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_writer_running.store(false, std::memory_order_release);
+    }
+    m_wake_cv.notify_one();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+
+    // The writer exits only once the ring is empty, but drain again in case a
+    // record was published while it was shutting down.
+    std::string batch;
+    while (drain_batch(batch) > 0) {
+    }
+}
+
+/**
+ * @see Logger.hpp
+ */
+uint64_t Logger::dropped_count() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+/**
+ * @see Logger.hpp
  */
-static const char* level_to_string(phLogLevel level) {
-    switch (level) {
-        case LOG_LEVEL_DEBUG: return "DEBUG";
-        case LOG_LEVEL_INFO:  return "INFO ";
-        case LOG_LEVEL_WARN:  return "WARN ";
-        case LOG_LEVEL_ERROR: return "ERROR";
-        case LOG_LEVEL_FATAL: return "FATAL";
-        default:              return "UNKWN";
+bool Logger::enable_binary_sink(const std::string& path_prefix, size_t segment_size, bool keep_text) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return open_binary_sink(path_prefix, segment_size, keep_text);
+}
+
+/**
+ * @see Logger.hpp
+ */
+void Logger::set_rotation(const phLoggerRotation& rotation) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_log_file->set_rotation(rotation);
+}
+
+/**
+ * @see Logger.hpp
+ */
+phLoggerRotation Logger::get_rotation() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_log_file->rotation();
+}
+
+/**
+ * @see Logger.hpp
+ */
+void Logger::set_rate_limit(const phLoggerRateLimit& limit) {
+    m_rate_limiter->configure(limit.per_second, limit.burst);
+}
+
+/**
+ * @see Logger.hpp
+ */
+phLoggerRateLimit Logger::get_rate_limit() const {
+    phLoggerRateLimit limit = {};
+    limit.per_second = m_rate_limiter->per_second();
+    limit.burst = m_rate_limiter->burst();
+    return limit;
+}
+
+/**
+ * @brief Creates and publishes the binary sink. Requires `m_mutex`.
+ *
+ * The sink is published only after its first segment exists, so producers
+ * that observe the pointer can write to it right away.
+ */
+bool Logger::open_binary_sink(const std::string& path_prefix, size_t segment_size, bool keep_text) {
+    if (m_binary_sink_owner) {
+        return true;
     }
+    std::unique_ptr<BinaryLogSink> sink(new BinaryLogSink());
+    std::string error;
+    if (!sink->open(path_prefix, segment_size, error)) {
+        std::string notice = "Could not enable the binary log sink: " + error;
+        log_impl(LOG_LEVEL_ERROR, "LOGGER", notice.data(), notice.size());
+        return false;
+    }
+    m_binary_sink_owner = std::move(sink);
+    m_binary_sink.store(m_binary_sink_owner.get(), std::memory_order_release);
+    m_text_sink.store(keep_text, std::memory_order_relaxed);
+    log_impl(LOG_LEVEL_INFO, "LOGGER", keep_text ? "Binary log sink enabled alongside the text log."
+                                                 : "Binary log sink enabled; records no longer go to this file.");
+    return true;
 }
 
 /**
  * @brief The internal, non-locking implementation of the log function.
  *
  * This method is the core of the logging logic. It formats the timestamp,
- * log level, and message and writes them to the file stream. It assumes
- * that a mutex lock has already been acquired by the calling function.
+ * log level, and message into the calling thread's line buffer and writes
+ * the line to the file stream. It assumes that a mutex lock has already been
+ * acquired by the calling function.
+ *
+ * The line buffer is thread-local and keeps its capacity, and the timestamp
+ * comes from the cached formatter in LogFormat.cpp, so no allocation happens
+ * here once the buffer has grown to the longest line seen.
  */
-void Logger::log_impl(phLogLevel level, const std::string& module_name, const std::string& message) {
-    if (!m_log_file.is_open()) {
-        std::cerr << "LOGGER NOT INITIALIZED: [" << module_name << "] " << message << std::endl;
+void Logger::log_impl(phLogLevel level, const char* module_name, const char* message, size_t length) {
+    if (!m_log_file->is_open()) {
+        std::cerr << "LOGGER NOT INITIALIZED: [" << module_name << "] ";
+        std::cerr.write(message, static_cast<std::streamsize>(length)) << std::endl;
         return;
     }
 
-    // Get the current time with high precision.
-    auto now = std::chrono::system_clock::now();
-    auto time_t_now = std::chrono::system_clock::to_time_t(now);
+    static thread_local std::string t_line;
+    t_line.clear();
+    log_format_line(t_line, std::chrono::system_clock::now(), level, module_name, message, length);
+
+    write_line(level, t_line.data(), t_line.size());
+}
+
+/**
+ * @brief Convenience overload of `log_impl` for null-terminated messages.
+ */
+void Logger::log_impl(phLogLevel level, const char* module_name, const char* message) {
+    log_impl(level, module_name, message, strlen(message));
+}
+
+/**
+ * @brief Hands a formatted line to the file, applying the commit policy.
+ *
+ * With group commit the line is only buffered. The buffer is written when it
+ * reaches LOGGER_GROUP_COMMIT_BYTES, immediately for ERROR and FATAL records
+ * (so the lines explaining a crash are on disk before it happens), and
+ * otherwise by the committer thread once the deadline of the oldest pending
+ * line expires. Without a committer every line is written at once.
+ */
+void Logger::write_line(phLogLevel level, const char* line, size_t length) {
+    bool was_idle = m_log_file->pending_bytes() == 0;
+    m_log_file->append(line, length);
+    if (!m_committer_running || level >= LOG_LEVEL_ERROR ||
+        m_log_file->pending_bytes() >= LOGGER_GROUP_COMMIT_BYTES) {
+        m_log_file->commit();
+    } else if (was_idle) {
+        m_commit_deadline = std::chrono::steady_clock::now() +
+                            std::chrono::milliseconds(LOGGER_GROUP_COMMIT_DEADLINE_MS);
+        m_commit_cv.notify_one();
+    }
+}
+
+/**
+ * @brief Body of the committer thread: writes pending lines whose deadline
+ * has passed. It waits on `m_mutex` itself, so loggers run while it sleeps.
+ */
+void Logger::commit_loop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_committer_running) {
+        if (m_log_file->pending_bytes() == 0) {
+            m_commit_cv.wait(lock);
+        } else if (std::chrono::steady_clock::now() >= m_commit_deadline) {
+            m_log_file->commit();
+        } else {
+            m_commit_cv.wait_until(lock, m_commit_deadline);
+        }
+    }
+    m_log_file->commit();
+}
+
+/**
+ * @brief Stops the committer thread, which writes what is still pending.
+ * Later lines are written immediately.
+ */
+void Logger::stop_committer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_committer_running) {
+            return;
+        }
+        m_committer_running = false;
+    }
+    m_commit_cv.notify_one();
+    if (m_committer.joinable()) {
+        m_committer.join();
+    }
+}
+
+/**
+ * @see Logger.hpp
+ */
+void Logger::flush() {
+    // Call sites that went quiet during a storm still owe their last summary.
+    m_rate_limiter->collect_reports([this](int level, const char* module_name, const char* format, uint64_t count) {
+        report_suppressed(static_cast<phLogLevel>(level), module_name, format, count);
+    });
+    if (m_async_active.load(std::memory_order_seq_cst)) {
+        // Wait until the writer has consumed past the last position claimed
+        // now. Records logged later by other threads do not hold us up.
+        size_t target = m_ring->enqueue_position();
+        auto written = [this, target] {
+            return static_cast<intptr_t>(m_flushed_position.load(std::memory_order_seq_cst) - target) >= 0;
+        };
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(LOGGER_FLUSH_TIMEOUT_MS);
+        m_flush_waiters.fetch_add(1, std::memory_order_seq_cst);
+        m_flush_requested.fetch_add(1, std::memory_order_seq_cst);
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_wake_cv.notify_one();
+        while (!written() && m_async_active.load(std::memory_order_seq_cst)) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                break;
+            }
+            // Re-check periodically: shutdown stops the writer without a notification.
+            m_flush_cv.wait_until(lock, std::min(deadline, now + std::chrono::milliseconds(LOGGER_WRITER_IDLE_MS)));
+        }
+        m_flush_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_log_file->commit();
+    }
+    BinaryLogSink* binary = m_binary_sink.load(std::memory_order_acquire);
+    if (binary != nullptr) {
+        binary->flush();
+    }
+}
+
+
+/**
+ * @brief Looks up the per-module override for records at or above the floor.
+ *
+ * The override table is small and append-only, so a linear scan of the
+ * published entries is both lock-free and cheaper than hashing.
+ */
+bool Logger::is_enabled_slow(phLogLevel level, const char* module_name) const {
+    int threshold = m_min_level.load(std::memory_order_relaxed);
+    if (module_name != nullptr) {
+        int count = m_module_level_count.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i) {
+            if (strncmp(m_module_levels[i].name, module_name, LOGGER_RECORD_MODULE_MAX) == 0) {
+                int module_level = m_module_levels[i].level.load(std::memory_order_relaxed);
+                if (module_level != LOGGER_MODULE_LEVEL_CLEARED) {
+                    threshold = module_level;
+                }
+                break;
+            }
+        }
+    }
+    return static_cast<int>(level) >= threshold;
+}
+
+/**
+ * @see Logger.hpp
+ *
+ * The summary carries the record's level and module, so it passes the same
+ * filter, and quotes the format string to identify the call site.
+ */
+bool Logger::admit_call_site(phLogLevel level, const char* module_name, const char* format) {
+    int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch()).count();
+    uint64_t suppressed = 0;
+    bool admitted = m_rate_limiter->admit(level, module_name, format, now_us, suppressed);
+    if (suppressed != 0) {
+        report_suppressed(level, module_name, format, suppressed);
+    }
+    return admitted;
+}
+
+/**
+ * @brief Logs a "N similar messages suppressed" summary for a call site.
+ */
+void Logger::report_suppressed(phLogLevel level, const char* module_name, const char* format, uint64_t count) {
+    char summary[LOGGER_RECORD_MESSAGE_MAX];
+    int len = snprintf(summary, sizeof(summary), "%llu similar messages suppressed: \"%s\"",
+                       static_cast<unsigned long long>(count), format);
+    if (len > 0) {
+        write_message(level, module_name, summary, std::min(static_cast<size_t>(len), sizeof(summary) - 1));
+    }
+}
+
+/**
+ * @brief Recomputes the floor: the lowest threshold among the global level
+ * and every module override.
+ */
+void Logger::update_level_floor() {
+    int floor = m_min_level.load(std::memory_order_relaxed);
+    int count = m_module_level_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        int module_level = m_module_levels[i].level.load(std::memory_order_relaxed);
+        if (module_level < floor) {
+            floor = module_level;
+        }
+    }
+    m_level_floor.store(floor, std::memory_order_relaxed);
+}
+
+/**
+ * @see Logger.hpp
+ */
+void Logger::set_level(phLogLevel level) {
+    std::lock_guard<std::mutex> lock(m_filter_mutex);
+    m_min_level.store(static_cast<int>(level), std::memory_order_relaxed);
+    update_level_floor();
+}
+
+/**
+ * @see Logger.hpp
+ */
+phLogLevel Logger::get_level() const {
+    return static_cast<phLogLevel>(m_min_level.load(std::memory_order_relaxed));
+}
+
+/**
+ * @see Logger.hpp
+ */
+bool Logger::set_module_level(const std::string& module_name, phLogLevel level) {
+    std::lock_guard<std::mutex> lock(m_filter_mutex);
+    int count = m_module_level_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (strncmp(m_module_levels[i].name, module_name.c_str(), LOGGER_RECORD_MODULE_MAX) == 0) {
+            m_module_levels[i].level.store(static_cast<int>(level), std::memory_order_relaxed);
+            update_level_floor();
+            return true;
+        }
+    }
+    if (count >= LOGGER_MAX_MODULE_LEVELS) {
+        return false;
+    }
+
+    // Fill the entry completely before publishing it through the count.
+    ModuleLevel& entry = m_module_levels[count];
+    size_t len = std::min(module_name.size(), static_cast<size_t>(LOGGER_RECORD_MODULE_MAX - 1));
+    memcpy(entry.name, module_name.data(), len);
+    entry.name[len] = '\0';
+    entry.level.store(static_cast<int>(level), std::memory_order_relaxed);
+    m_module_level_count.store(count + 1, std::memory_order_release);
+    update_level_floor();
+    return true;
+}
+
+/**
+ * @see Logger.hpp
+ */
+void Logger::clear_module_level(const std::string& module_name) {
+    std::lock_guard<std::mutex> lock(m_filter_mutex);
+    int count = m_module_level_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (strncmp(m_module_levels[i].name, module_name.c_str(), LOGGER_RECORD_MODULE_MAX) == 0) {
+            m_module_levels[i].level.store(LOGGER_MODULE_LEVEL_CLEARED, std::memory_order_relaxed);
+            update_level_floor();
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Copies a module name into a record, truncating it if necessary.
+ */
+static void copy_module_name(LogRecord& record, const char* module_name) {
+    size_t len = strnlen(module_name, LOGGER_RECORD_MODULE_MAX - 1);
+    memcpy(record.module, module_name, len);
+    record.module[len] = '\0';
+}
+
+/**
+ * @brief Marks a record whose message did not fit in the fixed-size slot.
+ */
+static void mark_truncated(LogRecord& record) {
+    record.length = LOGGER_RECORD_MESSAGE_MAX - 1;
+    memcpy(record.message + record.length - 3, "...", 3);
+    record.message[record.length] = '\0';
+}
+
+/**
+ * @brief Registers the calling thread as an async producer.
+ * @return true if the record must be queued, false if the caller should use
+ *         the synchronous path instead. On true, `leave_async` must follow.
+ */
+bool Logger::enter_async() {
+    m_producers_inflight.fetch_add(1, std::memory_order_seq_cst);
+    if (m_async_active.load(std::memory_order_seq_cst)) {
+        return true;
+    }
+    m_producers_inflight.fetch_sub(1, std::memory_order_release);
+    return false;
+}
+
+void Logger::leave_async() {
+    m_producers_inflight.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief Queues a record, applying the overflow policy when the ring is full.
+ */
+template <typename Fill>
+void Logger::enqueue(phLogLevel level, const char* module_name, Fill&& fill) {
+    const auto now = std::chrono::system_clock::now();
+    auto emplace = [&](LogRecord& record) {
+        record.timestamp = now;
+        record.level = level;
+        copy_module_name(record, module_name);
+        fill(record);
+    };
+
+    while (!m_ring->try_emplace(emplace)) {
+        if (m_overflow_policy == LOGGER_OVERFLOW_DROP_NEWEST) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (m_overflow_policy == LOGGER_OVERFLOW_DROP_OLDEST) {
+            if (m_ring->try_consume([](LogRecord&) {})) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+        // LOGGER_OVERFLOW_BLOCK: make sure the writer is awake and back off.
+        m_wake_cv.notify_one();
+        std::this_thread::yield();
+    }
+
+    // Pairs with the seq_cst store of `m_writer_sleeping` in `writer_loop`:
+    // either the writer sees our record before parking, or we see it parked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_writer_sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_wake_cv.notify_one();
+    }
+}
+
+/**
+ * @brief Formats and writes every queued record (up to a batch limit).
+ *
+ * The whole batch is written with a single call and flushed once, which is
+ * where the asynchronous mode gets most of its throughput.
+ */
+size_t Logger::drain_batch(std::string& batch) {
+    batch.clear();
+    size_t count = 0;
+    while (count < LOGGER_WRITER_BATCH_MAX &&
+           m_ring->try_consume([&batch](LogRecord& record) {
+               log_format_line(batch, record.timestamp, record.level, record.module,
+                               record.message, record.length);
+           })) {
+        ++count;
+    }
+
+    if (count > 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_log_file->write(batch.data(), batch.size());
+    }
+    return count;
+}
+
+/**
+ * @brief Background writer: drains the ring until asked to stop.
+ *
+ * When the ring is empty the writer parks on a condition variable with a
+ * timeout. Producers only signal it when it is actually parked, so the
+ * common case costs them nothing beyond the enqueue itself.
+ */
+void Logger::writer_loop() {
+    std::string batch;
+    // Room for a full batch of maximum-length lines (the timestamp, level and
+    // separators fit in the extra 64 bytes), so the buffer never grows.
+    batch.reserve(LOGGER_WRITER_BATCH_MAX *
+                  (LOGGER_RECORD_MODULE_MAX + LOGGER_RECORD_MESSAGE_MAX + 64));
+    uint64_t reported_drops = 0;
+
+    for (;;) {
+        uint64_t flush_requests = m_flush_requested.load(std::memory_order_seq_cst);
+        size_t written = drain_batch(batch);
+
+        uint64_t drops = m_dropped.load(std::memory_order_relaxed);
+        if (drops != reported_drops) {
+            char notice[96];
+            int len = snprintf(notice, sizeof(notice), "%llu log record(s) dropped: async queue full.",
+                               static_cast<unsigned long long>(drops - reported_drops));
+            std::lock_guard<std::mutex> lock(m_mutex);
+            log_impl(LOG_LEVEL_WARN, "LOGGER", notice, static_cast<size_t>(len));
+            reported_drops = drops;
+        }
 
-    // Format the timestamp (e.g., "YYYY-MM-DD HH:MM:SS").
-    // We use platform-specific thread-safe functions for converting the time.
-    struct tm timeinfo;
-#ifdef _WIN32
-    localtime_s(&timeinfo, &time_t_now); // Windows-specific safe version
-#else
-    localtime_r(&time_t_now, &timeinfo); // POSIX-specific safe version
-#endif
+        // Everything below the consumer position is now either in the batch
+        // just written or was dropped by a producer, so the flush callers
+        // waiting for it can go, even if the ring refilled meanwhile.
+        complete_flush(m_ring->dequeue_position());
+        if (written > 0) {
+            continue;
+        }
+        if (!m_writer_running.load(std::memory_order_acquire)) {
+            if (m_ring->empty()) {
+                break;
+            }
+            continue;
+        }
 
-    // Write the complete, formatted log entry to the file.
-    m_log_file << "[" << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S") << "] "
-               << "[" << level_to_string(level) << "] "
-               << "[" << module_name << "] "
-               << message << std::endl;
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_writer_sleeping.store(true, std::memory_order_seq_cst);
+        if (m_ring->empty() && m_writer_running.load(std::memory_order_acquire) &&
+            m_flush_requested.load(std::memory_order_seq_cst) == flush_requests) {
+            m_wake_cv.wait_for(lock, std::chrono::milliseconds(LOGGER_WRITER_IDLE_MS));
+        }
+        m_writer_sleeping.store(false, std::memory_order_relaxed);
+    }
+    complete_flush(m_ring->dequeue_position());
 }
 
+/**
+ * @brief Publishes the writer's progress for `flush`. The lock is only taken
+ * when a caller is waiting. Only called by the writer thread.
+ */
+void Logger::complete_flush(size_t position) {
+    // Pairs with `flush`, which registers as a waiter before checking the
+    // position: either it sees the new position or we see it waiting.
+    m_flushed_position.store(position, std::memory_order_seq_cst);
+    if (m_flush_waiters.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+    }
+    m_flush_cv.notify_all();
+}
 
 /**
  * @brief Public-facing log method for simple, pre-formatted messages.
  *
- * This function is the primary entry point for C++ code. It acquires the
- * mutex lock, ensuring exclusive access to the log file, and then calls
- * the internal implementation `log_impl` to perform the actual write.
+ * This function is the primary entry point for C++ code. It forwards to the
+ * C-string overload, which does the filtering and the actual write.
  */
 void Logger::log(phLogLevel level, const std::string& module_name, const std::string& message) {
+    write_message(level, module_name.c_str(), message.data(), message.size());
+}
+
+/**
+ * @brief Allocation-free variant of `log` for C strings.
+ */
+void Logger::log(phLogLevel level, const char* module_name, const char* message) {
+    write_message(level, module_name, message, strlen(message));
+}
+
+/**
+ * @brief Routes a finished message to the async ring or to the file.
+ *
+ * In synchronous mode it acquires the mutex lock, ensuring exclusive access
+ * to the log file, and then calls `log_impl` to perform the actual write.
+ */
+void Logger::write_message(phLogLevel level, const char* module_name, const char* message, size_t length) {
+    if (!is_enabled(level, module_name)) {
+        return;
+    }
+    BinaryLogSink* binary = m_binary_sink.load(std::memory_order_acquire);
+    if (binary != nullptr) {
+        binary->write_message(std::chrono::system_clock::now(), level, module_name, message, length);
+        if (!m_text_sink.load(std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    if (enter_async()) {
+        enqueue(level, module_name, [message, length](LogRecord& record) {
+            if (length >= LOGGER_RECORD_MESSAGE_MAX) {
+                memcpy(record.message, message, LOGGER_RECORD_MESSAGE_MAX - 1);
+                mark_truncated(record);
+                return;
+            }
+            record.length = static_cast<uint32_t>(length);
+            memcpy(record.message, message, length);
+            record.message[record.length] = '\0';
+        });
+        leave_async();
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(m_mutex);
-    log_impl(level, module_name, message);
+    log_impl(level, module_name, message, length);
 }
 
 /**
  * @brief Public-facing log method for formatted messages using a va_list.
- *
- * This function safely handles printf-style formatted logging. It determines
- * the required buffer size, allocates it dynamically using `std::vector`,
- * formats the message, and then calls the main `log` function to handle
- * locking and writing. This two-step process ensures both buffer safety and
- * thread safety.
  */
 void Logger::log(phLogLevel level, const std::string& module_name, const char* format, va_list args) {
-    // 1. Create a copy of va_list because vsnprintf can invalidate it.
-    va_list args_copy;
-    va_copy(args_copy, args);
-    // Determine the required buffer size by performing a "dry run" format.
-    int len = vsnprintf(nullptr, 0, format, args_copy);
-    va_end(args_copy);
-
-    if (len < 0) {
+    log(level, module_name.c_str(), format, args);
+}
+
+/**
+ * @brief Formats a printf-style message without allocating.
+ *
+ * In asynchronous mode the message is formatted straight into the ring
+ * cell. In synchronous mode it is formatted, in a single `vsnprintf` pass,
+ * into a thread-local scratch buffer that keeps its capacity between calls;
+ * the buffer only grows (once) when a message longer than any before it
+ * arrives. The result is then written under the mutex like any other message.
+ */
+void Logger::log(phLogLevel level, const char* module_name, const char* format, va_list args) {
+    if (!is_enabled(level, module_name)) {
+        return;
+    }
+    if (level < LOG_LEVEL_FATAL && m_rate_limiter->enabled() &&
+        !admit_call_site(level, module_name, format)) {
+        return;
+    }
+    BinaryLogSink* binary = m_binary_sink.load(std::memory_order_acquire);
+    if (binary != nullptr) {
+        // The binary sink stores the arguments as they are; no formatting.
+        binary->write_formatted(std::chrono::system_clock::now(), level, module_name, format, args);
+        if (!m_text_sink.load(std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    if (enter_async()) {
+        enqueue(level, module_name, [format, &args](LogRecord& record) {
+            va_list args_copy;
+            va_copy(args_copy, args);
+            int len = vsnprintf(record.message, sizeof(record.message), format, args_copy);
+            va_end(args_copy);
+            if (len < 0) {
+                static const char kError[] = "An error occurred during log message formatting.";
+                record.level = LOG_LEVEL_ERROR;
+                record.length = sizeof(kError) - 1;
+                memcpy(record.message, kError, sizeof(kError));
+            } else if (static_cast<size_t>(len) >= sizeof(record.message)) {
+                mark_truncated(record);
+            } else {
+                record.length = static_cast<uint32_t>(len);
+            }
+        });
+        leave_async();
+        return;
+    }
+
+    static thread_local std::string t_message;
+    if (log_vformat(t_message, format, args) < 0) {
         // An encoding error occurred. Log a fallback message.
         log(LOG_LEVEL_ERROR, "LOGGER", "An error occurred during log message formatting.");
         return;
     }
 
-    // 2. Allocate a buffer of the exact size plus one for the null terminator.
-    std::vector<char> buffer(static_cast<size_t>(len) + 1);
-
-    // 3. Format the string into the buffer.
-    vsnprintf(buffer.data(), buffer.size(), format, args);
-
-    // 4. Pass the final formatted string to the original log function,
-    // which handles the mutex locking and file I/O.
-    log(level, module_name, std::string(buffer.data()));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    log_impl(level, module_name, t_message.data(), t_message.size());
 }
 
 
@@ -204,10 +861,93 @@ void Logger::log(phLogLevel level, const std::string& module_name, const char* f
  */
 int logger_init(const char* filename) {
     // This C-style function acts as a bridge to the C++ singleton.
-    if (Logger::get_instance().init(filename)) {
-        return 0; // Success
+    uint64_t trace = startup_trace_begin();
+    bool ok = Logger::get_instance().init(filename);
+    startup_trace_end("logger", "logger_init", trace);
+    return ok ? 0 : -1;
+}
+
+/**
+ * @see logger.hpp
+ */
+int logger_init_with_options(const char* filename, const phLoggerOptions* options) {
+    if (filename == nullptr) {
+        return -1;
+    }
+    phLoggerOptions defaults = {};
+    defaults.mode = LOGGER_MODE_SYNC;
+    uint64_t trace = startup_trace_begin();
+    bool ok = Logger::get_instance().init(filename, options ? *options : defaults);
+    startup_trace_end("logger", "logger_init", trace);
+    return ok ? 0 : -1;
+}
+
+/**
+ * @see logger.hpp
+ */
+uint64_t logger_get_dropped_count(void) {
+    return Logger::get_instance().dropped_count();
+}
+
+/**
+ * @see logger.hpp
+ */
+int logger_enable_binary_sink(const char* path_prefix, size_t segment_size, int keep_text) {
+    if (path_prefix == nullptr || *path_prefix == '\0') {
+        return -1;
+    }
+    return Logger::get_instance().enable_binary_sink(path_prefix, segment_size, keep_text != 0) ? 0 : -1;
+}
+
+/**
+ * @see logger.hpp
+ */
+void logger_flush(void) {
+    Logger::get_instance().flush();
+}
+
+/**
+ * @see logger.hpp
+ */
+int logger_set_rate_limit(const phLoggerRateLimit* limit) {
+    if (limit == nullptr) {
+        return -1;
     }
-    return -1; // Failure
+    Logger::get_instance().set_rate_limit(*limit);
+    return 0;
+}
+
+/**
+ * @see logger.hpp
+ */
+int logger_get_rate_limit(phLoggerRateLimit* limit) {
+    if (limit == nullptr) {
+        return -1;
+    }
+    *limit = Logger::get_instance().get_rate_limit();
+    return 0;
+}
+
+/**
+ * @see logger.hpp
+ */
+int logger_set_rotation(const phLoggerRotation* rotation) {
+    if (rotation == nullptr) {
+        return -1;
+    }
+    Logger::get_instance().set_rotation(*rotation);
+    return 0;
+}
+
+/**
+ * @see logger.hpp
+ */
+int logger_get_rotation(phLoggerRotation* rotation) {
+    if (rotation == nullptr) {
+        return -1;
+    }
+    *rotation = Logger::get_instance().get_rotation();
+    return 0;
 }
 
 /**
@@ -217,7 +957,12 @@ void logger_log(phLogLevel level, const char* module_name, const char* message)
     if (module_name == nullptr || message == nullptr) {
         return; // Basic null-pointer safety check.
     }
-    Logger::get_instance().log(level, module_name, message);
+    // Filter before measuring the message or touching the sinks.
+    Logger& logger = Logger::get_instance();
+    if (!logger.is_enabled(level, module_name)) {
+        return;
+    }
+    logger.log(level, module_name, message);
 }
 
 /**
@@ -227,14 +972,87 @@ void logger_log_fmt(phLogLevel level, const char* module_name, const char* forma
     if (module_name == nullptr || format == nullptr) {
         return;
     }
+    // Reject filtered records before touching the variadic arguments.
+    Logger& logger = Logger::get_instance();
+    if (!logger.is_enabled(level, module_name)) {
+        return;
+    }
 
     va_list args;
     va_start(args, format);
     // Delegate all the complex, safe formatting logic to the C++ class.
-    Logger::get_instance().log(level, module_name, format, args);
+    logger.log(level, module_name, format, args);
     va_end(args);
 }
 
+/**
+ * @see logger.hpp
+ */
+void logger_set_level(phLogLevel level) {
+    Logger::get_instance().set_level(level);
+}
+
+/**
+ * @see logger.hpp
+ */
+phLogLevel logger_get_level(void) {
+    return Logger::get_instance().get_level();
+}
+
+/**
+ * @see logger.hpp
+ */
+int logger_set_module_level(const char* module_name, phLogLevel level) {
+    if (module_name == nullptr || *module_name == '\0') {
+        return -1;
+    }
+    return Logger::get_instance().set_module_level(module_name, level) ? 0 : -1;
+}
+
+/**
+ * @see logger.hpp
+ */
+int logger_clear_module_level(const char* module_name) {
+    if (module_name == nullptr || *module_name == '\0') {
+        return -1;
+    }
+    Logger::get_instance().clear_module_level(module_name);
+    return 0;
+}
+
+/**
+ * @see logger.hpp
+ */
+int logger_is_enabled(phLogLevel level, const char* module_name) {
+    return Logger::get_instance().is_enabled(level, module_name) ? 1 : 0;
+}
+
+/**
+ * @see logger.hpp
+ */
+int logger_parse_level(const char* text, phLogLevel* level) {
+    if (text == nullptr || level == nullptr) {
+        return -1;
+    }
+    char upper[16];
+    size_t i = 0;
+    for (; text[i] != '\0'; ++i) {
+        if (i + 1 >= sizeof(upper)) {
+            return -1;
+        }
+        upper[i] = static_cast<char>(toupper(static_cast<unsigned char>(text[i])));
+    }
+    upper[i] = '\0';
+
+    if (strcmp(upper, "DEBUG") == 0) *level = LOG_LEVEL_DEBUG;
+    else if (strcmp(upper, "INFO") == 0) *level = LOG_LEVEL_INFO;
+    else if (strcmp(upper, "WARN") == 0 || strcmp(upper, "WARNING") == 0) *level = LOG_LEVEL_WARN;
+    else if (strcmp(upper, "ERROR") == 0) *level = LOG_LEVEL_ERROR;
+    else if (strcmp(upper, "FATAL") == 0) *level = LOG_LEVEL_FATAL;
+    else return -1;
+    return 0;
+}
+
 /**
  * @see logger.hpp
  */
@@ -243,4 +1061,9 @@ void logger_cleanup() {
     // at program exit, which handles file closing. This C function is kept
     // for API consistency and can be used for explicit cleanup if needed.
     logger_log(LOG_LEVEL_INFO, "MAIN", "Application cleanup requested.");
+    // A boot sequence that never marked its end still gets its trace.
+    startup_trace_finish();
+    // Make sure every queued record reaches the file before the caller exits.
+    Logger::get_instance().shutdown_async();
+    Logger::get_instance().flush();
 }
\ No newline at end of file
@@ -27,6 +27,52 @@
  * concerns prevents recursive locking attempts and resolves the deadlock that
  * occurred when `init` (already holding the lock) called the public `log`
  * method (which tried to re-acquire the same lock).
+ *
+ * Asynchronous Mode:
+ * The logger can optionally run in an asynchronous mode, selected through
+ * `logger_init_with_options`. In that mode producers never touch the file or
+ * the mutex: they format their message straight into a fixed-size record of
+ * a lock-free ring buffer (see LogRingBuffer.hpp) and return. A single
+ * background thread drains the ring, formats timestamps and writes the
+ * records to disk in batches, flushing once per batch instead of once per
+ * line. When the ring is full, a configurable overflow policy decides whether
+ * producers wait, discard their own record, or evict the oldest one; every
+ * discarded record is counted.
+ *
+ * Level Filtering:
+ * Every entry point first checks the record's level against a runtime
+ * threshold, before any formatting or allocation happens. The threshold is a
+ * global minimum level plus optional per-module overrides. A single atomic
+ * "floor" (the lowest level any module can currently emit) lets the common
+ * case, a filtered DEBUG message, be rejected with one relaxed load; the
+ * per-module table is consulted only for records at or above that floor.
+ *
+ * Sinks:
+ * Records can go to the text log, to memory-mapped binary segments (see
+ * BinaryLogSink.hpp), or both. The binary sink skips formatting entirely and
+ * stores the format string id and raw arguments; the `ph-logcat` tool
+ * renders them later. It is written by the producing thread in both modes.
+ *
+ * Rotation:
+ * The text log file rotates by size and/or wall-clock interval (see
+ * LogFile.hpp). The swap to the new file is a single `dup2`, and rotated
+ * files are compressed and pruned on a background thread.
+ *
+ * Group Commit:
+ * In synchronous mode lines are no longer written one system call at a
+ * time. They are buffered and written together with a single `writev` once
+ * 64 KiB are pending or 5 ms after the first of them was logged, whichever
+ * comes first; ERROR and FATAL lines are written immediately, together with
+ * everything before them. `logger_flush` forces pending lines out. The
+ * per-line behaviour remains available as LOGGER_COMMIT_PER_RECORD.
+ *
+ * Rate Limiting:
+ * Formatted records can be rate limited per call site, i.e. per module name
+ * and format string (see LogRateLimiter.hpp). A call site that exceeds its
+ * budget is silenced before its message is formatted, and the number of
+ * records it lost is logged periodically as "N similar messages suppressed";
+ * what is still unreported is logged by `logger_flush` and `logger_cleanup`.
+ * FATAL records are never limited.
  * ]
  *
  * SPDX-License-Identifier: Apache-2.0
@@ -39,15 +85,140 @@
 // This demonstrates how even C++ modules adhere to the core contracts.
 #include "../../ipc/include/ph_core_api.h"
 
+/*
+ * Logger configuration types. They are plain C so that the C core can fill
+ * them in before calling `logger_init_with_options`.
+ */
+
+/**
+ * @enum phLoggerMode
+ * @brief Selects how log records reach the log file.
+ */
+typedef enum {
+    LOGGER_MODE_SYNC,   /**< The calling thread formats and writes each record itself. */
+    LOGGER_MODE_ASYNC   /**< Records are queued and written by a background thread. */
+} phLoggerMode;
+
+/**
+ * @enum phLoggerOverflowPolicy
+ * @brief Decides what happens when the asynchronous queue is full.
+ */
+typedef enum {
+    LOGGER_OVERFLOW_BLOCK,       /**< The producer waits until the writer frees a slot. */
+    LOGGER_OVERFLOW_DROP_NEWEST, /**< The record being logged is discarded. */
+    LOGGER_OVERFLOW_DROP_OLDEST  /**< The oldest queued record is evicted to make room. */
+} phLoggerOverflowPolicy;
+
+/**
+ * @enum phLoggerSink
+ * @brief Destinations a record can be written to. Combine with `|`.
+ */
+typedef enum {
+    LOGGER_SINK_TEXT = 1 << 0,  /**< Human-readable lines in the log file. */
+    LOGGER_SINK_BINARY = 1 << 1 /**< Compact binary segments, decoded by ph-logcat. */
+} phLoggerSink;
+
+/**
+ * @enum phLoggerCompression
+ * @brief How rotated log files are compressed.
+ */
+typedef enum {
+    LOGGER_COMPRESS_NONE, /**< Rotated files are kept as plain text. */
+    LOGGER_COMPRESS_GZIP, /**< Compressed with the system `gzip` (`.gz`). */
+    LOGGER_COMPRESS_ZSTD  /**< Compressed with the system `zstd` (`.zst`). */
+} phLoggerCompression;
+
+/**
+ * @struct phLoggerRotation
+ * @brief When the text log file is rotated and what happens to old files.
+ *
+ * A zero-initialized struct disables rotation. Rotated files are named
+ * `<log file>.YYYYMMDD-HHMMSS` and compressed on a background thread.
+ */
+typedef struct {
+    uint64_t max_bytes;              /**< Rotate once the file reaches this size (0 = no limit). */
+    uint32_t interval_seconds;       /**< Rotate every this many seconds, on UTC boundaries (0 = never). */
+    uint32_t keep;                   /**< Rotated files kept on disk (0 = default). */
+    phLoggerCompression compression; /**< Compression applied to rotated files. */
+} phLoggerRotation;
+
+/**
+ * @enum phLoggerCommitPolicy
+ * @brief When synchronously logged lines are written to the text log.
+ */
+typedef enum {
+    LOGGER_COMMIT_GROUP,     /**< Lines are batched and written together (see above). */
+    LOGGER_COMMIT_PER_RECORD /**< Every line is written by its own system call. */
+} phLoggerCommitPolicy;
+
+/**
+ * @struct phLoggerRateLimit
+ * @brief How many formatted records each call site may log.
+ *
+ * A call site is a (module name, format string) pair. A zero-initialized
+ * struct disables rate limiting.
+ */
+typedef struct {
+    uint32_t per_second; /**< Sustained records per second per call site (0 = unlimited). */
+    uint32_t burst;      /**< Records a call site may log back to back (0 = 1). */
+} phLoggerRateLimit;
+
+/**
+ * @struct phLoggerOptions
+ * @brief Options accepted by `logger_init_with_options`.
+ *
+ * A zero-initialized struct selects the synchronous mode and the text sink
+ * only, which matches the behaviour of plain `logger_init`.
+ */
+typedef struct {
+    phLoggerMode mode;                      /**< Sync or async operation. */
+    size_t queue_capacity;                  /**< Async ring size in records (0 = default). */
+    phLoggerOverflowPolicy overflow_policy; /**< Behaviour when the ring is full. */
+    unsigned sinks;                         /**< phLoggerSink mask (0 = text only). */
+    const char* binary_path_prefix;         /**< Binary segment prefix (NULL = the log file name). */
+    size_t binary_segment_size;             /**< Bytes per binary segment (0 = default). */
+    phLoggerRotation rotation;              /**< Text log rotation (zeroed = disabled). */
+    phLoggerCommitPolicy commit_policy;     /**< Sync-mode write batching (0 = group commit). */
+    phLoggerRateLimit rate_limit;           /**< Per-call-site limit (zeroed = disabled). */
+} phLoggerOptions;
+
 #ifdef __cplusplus
 
 #include <string>
-#include <fstream>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
 #include <cstdarg> // For va_list in the C++ implementation
 
 // The C++ Logger class. This is not directly visible to C code.
+// Capacity limits of a queued record. Longer module names or messages are
+// truncated when they go through the asynchronous path.
+#define LOGGER_RECORD_MODULE_MAX 32
+#define LOGGER_RECORD_MESSAGE_MAX 440
+#define LOGGER_DEFAULT_QUEUE_CAPACITY 4096
+// Maximum number of modules that can carry their own minimum level.
+#define LOGGER_MAX_MODULE_LEVELS 32
+
+template <typename T> class LogRingBuffer;
+class BinaryLogSink;
+class LogFile;
+class LogRateLimiter;
+
+/**
+ * @struct LogRecord
+ * @brief A fixed-size log entry as stored in the asynchronous ring buffer.
+ */
+struct LogRecord {
+    std::chrono::system_clock::time_point timestamp;
+    phLogLevel level;
+    uint32_t length;
+    char module[LOGGER_RECORD_MODULE_MAX];
+    char message[LOGGER_RECORD_MESSAGE_MAX];
+};
+
 class Logger {
 public:
     /**
@@ -63,6 +234,110 @@ public:
      */
     bool init(const std::string& filename);
 
+    /**
+     * @brief Configures the logger with explicit options.
+     * @param filename The path to the log file.
+     * @param options The operating mode and queue settings.
+     * @return true on success, false if the file could not be opened or the
+     *         background writer could not be started.
+     */
+    bool init(const std::string& filename, const phLoggerOptions& options);
+
+    /**
+     * @brief Stops the background writer, if any, after draining its queue.
+     *
+     * Subsequent log calls fall back to the synchronous path, so it is safe
+     * to keep logging after shutdown.
+     */
+    void shutdown_async();
+
+    /**
+     * @brief Writes every record logged before the call to its sinks.
+     *
+     * In asynchronous mode this waits until the writer has written every
+     * record queued before the call, not for the queue to be empty, so it
+     * returns while other threads keep logging. It gives up after
+     * LOGGER_FLUSH_TIMEOUT_MS. Suppression summaries still owed by the rate
+     * limiter are logged first. The binary sink is only asked to schedule
+     * write-back.
+     */
+    void flush();
+
+    /**
+     * @brief Returns how many records were discarded by the overflow policy.
+     */
+    uint64_t dropped_count() const;
+
+    /**
+     * @brief Starts writing records to binary segments.
+     * @param path_prefix Segment files are named `<path_prefix>.NNNNNN.phlog`.
+     * @param segment_size Bytes per segment (0 = default).
+     * @param keep_text Whether records should still go to the text log too.
+     * @return true on success. On failure the sinks are left unchanged.
+     */
+    bool enable_binary_sink(const std::string& path_prefix, size_t segment_size, bool keep_text);
+
+    /**
+     * @brief Replaces the rotation policy of the text log file.
+     */
+    void set_rotation(const phLoggerRotation& rotation);
+
+    /**
+     * @brief Returns the current rotation policy of the text log file.
+     */
+    phLoggerRotation get_rotation();
+
+    /**
+     * @brief Replaces the per-call-site rate limit of formatted records.
+     */
+    void set_rate_limit(const phLoggerRateLimit& limit);
+
+    /**
+     * @brief Returns the current per-call-site rate limit.
+     */
+    phLoggerRateLimit get_rate_limit() const;
+
+    /**
+     * @brief Tells whether a record would be written.
+     *
+     * This is inline on purpose: records below the current floor are
+     * rejected with a single relaxed atomic load, without a function call.
+     *
+     * @param level The severity level of the record.
+     * @param module_name The module emitting the record (may be NULL).
+     * @return true if the record passes the level filter.
+     */
+    bool is_enabled(phLogLevel level, const char* module_name) const {
+        if (static_cast<int>(level) < m_level_floor.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        return is_enabled_slow(level, module_name);
+    }
+
+    /**
+     * @brief Sets the global minimum level.
+     */
+    void set_level(phLogLevel level);
+
+    /**
+     * @brief Returns the global minimum level.
+     */
+    phLogLevel get_level() const;
+
+    /**
+     * @brief Sets a minimum level for one module, overriding the global one.
+     * @param module_name The module name as passed to the log functions.
+     * @param level The module's minimum level.
+     * @return true on success, false if the override table is full.
+     */
+    bool set_module_level(const std::string& module_name, phLogLevel level);
+
+    /**
+     * @brief Removes a module's override; the module follows the global
+     * level again.
+     */
+    void clear_module_level(const std::string& module_name);
+
     /**
      * @brief Writes a pre-formatted message to the log file. This is the main
      * public entry point for logging. It acquires a lock and calls the
@@ -73,6 +348,12 @@ public:
      */
     void log(phLogLevel level, const std::string& module_name, const std::string& message);
 
+    /**
+     * @brief Overload for C strings. Unlike the std::string version it never
+     * allocates, which is why the C wrappers use it.
+     */
+    void log(phLogLevel level, const char* module_name, const char* message);
+
     /**
      * @brief Writes a message to the log file using a va_list.
      * This is the core implementation for formatted logging.
@@ -83,13 +364,18 @@ public:
      */
     void log(phLogLevel level, const std::string& module_name, const char* format, va_list args);
 
+    /**
+     * @brief Overload of the formatted `log` for a C-string module name.
+     */
+    void log(phLogLevel level, const char* module_name, const char* format, va_list args);
+
     // Delete copy constructor and assignment operator to enforce singleton property.
     Logger(const Logger&) = delete;
     void operator=(const Logger&) = delete;
 
 private:
     // Private constructor to prevent direct instantiation.
-    Logger() = default;
+    Logger();
     // Private destructor to be managed internally.
     ~Logger();
 
@@ -103,12 +389,146 @@ private:
      * @param level The severity level of the message.
      * @param module_name The name of the module originating the log entry.
      * @param message The log message content to write.
+     * @param length The number of bytes in `message`.
+     */
+    void log_impl(phLogLevel level, const char* module_name, const char* message, size_t length);
+    void log_impl(phLogLevel level, const char* module_name, const char* message);
+
+    /**
+     * @brief Filters a finished message and hands it to the async ring or,
+     * under the mutex, to `log_impl`.
+     */
+    void write_message(phLogLevel level, const char* module_name, const char* message, size_t length);
+
+    /**
+     * @brief Creates and publishes the binary sink. Requires `m_mutex`.
+     */
+    bool open_binary_sink(const std::string& path_prefix, size_t segment_size, bool keep_text);
+
+    /**
+     * @brief Per-module part of `is_enabled`, reached only for records at or
+     * above the floor.
+     */
+    bool is_enabled_slow(phLogLevel level, const char* module_name) const;
+
+    /**
+     * @brief Applies the rate limit to a formatted record's call site and
+     * logs the suppression summary when one is due.
+     * @return true if the record should be logged.
+     */
+    bool admit_call_site(phLogLevel level, const char* module_name, const char* format);
+
+    /**
+     * @brief Logs the "N similar messages suppressed" summary of a call site.
+     */
+    void report_suppressed(phLogLevel level, const char* module_name, const char* format, uint64_t count);
+
+    /**
+     * @brief Recomputes `m_level_floor` after a level change. Requires
+     * `m_filter_mutex`.
      */
-    void log_impl(phLogLevel level, const std::string& module_name, const std::string& message);
+    void update_level_floor();
 
+    /**
+     * @brief Queues a record for the background writer.
+     *
+     * `fill` formats the message directly into the ring cell. The overflow
+     * policy is applied when the ring is full.
+     */
+    template <typename Fill>
+    void enqueue(phLogLevel level, const char* module_name, Fill&& fill);
+
+    /**
+     * @brief Announces an async producer; returns false if async mode is off.
+     */
+    bool enter_async();
 
-    std::ofstream m_log_file; // The output file stream.
-    std::mutex m_mutex;       // Mutex to ensure thread-safe writes.
+    /**
+     * @brief Ends a producer section opened by a successful `enter_async`.
+     */
+    void leave_async();
+
+    /**
+     * @brief Body of the background writer thread.
+     */
+    void writer_loop();
+
+    /**
+     * @brief Writes every record currently queued as a single batch.
+     * @param batch A reusable buffer holding the formatted batch.
+     * @return The number of records written.
+     */
+    size_t drain_batch(std::string& batch);
+
+    /**
+     * @brief Publishes that every record below ring position `position` is
+     * written (or was dropped) and wakes the `flush` callers waiting for it.
+     */
+    void complete_flush(size_t position);
+
+    /**
+     * @brief Buffers or writes one formatted line according to the commit
+     * policy. Requires `m_mutex`.
+     */
+    void write_line(phLogLevel level, const char* line, size_t length);
+
+    /**
+     * @brief Body of the group-commit thread.
+     */
+    void commit_loop();
+
+    /**
+     * @brief Stops the group-commit thread after it commits pending lines.
+     */
+    void stop_committer();
+
+
+    std::unique_ptr<LogFile> m_log_file; // The rotating output file.
+    std::unique_ptr<LogRateLimiter> m_rate_limiter; // Lock-free; never replaced.
+    std::mutex m_mutex;                  // Mutex to ensure thread-safe writes.
+
+    // --- Sink selection ---
+    // The binary sink is created once and lives as long as the logger. The
+    // text file stays open even when records bypass it, because the logger
+    // reports its own notices there.
+    std::unique_ptr<BinaryLogSink> m_binary_sink_owner;
+    std::atomic<BinaryLogSink*> m_binary_sink{nullptr};
+    std::atomic<bool> m_text_sink{true};
+
+    // --- Asynchronous mode state ---
+    std::unique_ptr<LogRingBuffer<LogRecord>> m_ring;  // Lock-free record queue.
+    phLoggerOverflowPolicy m_overflow_policy = LOGGER_OVERFLOW_BLOCK;
+    std::atomic<bool> m_async_active{false};   // True while producers may enqueue.
+    std::atomic<bool> m_writer_running{false}; // Cleared to ask the writer to exit.
+    std::atomic<bool> m_writer_sleeping{false};// Set while the writer waits for work.
+    std::atomic<uint64_t> m_dropped{0};        // Records lost to the overflow policy.
+    std::atomic<int> m_producers_inflight{0};  // Producers currently inside `enqueue`.
+    std::thread m_writer;
+    std::mutex m_wake_mutex;                   // Parks the idle writer and `flush` callers.
+    std::condition_variable m_wake_cv;
+    std::atomic<uint64_t> m_flush_requested{0}; // Bumped by `flush` so the writer does not park.
+    std::atomic<size_t> m_flushed_position{0};  // Ring position the writer has written up to.
+    std::atomic<int> m_flush_waiters{0};        // `flush` callers waiting on m_flush_cv.
+    std::condition_variable m_flush_cv;
+
+    // --- Group commit state (guarded by m_mutex) ---
+    bool m_committer_running = false;
+    std::chrono::steady_clock::time_point m_commit_deadline; // When pending lines are due.
+    std::condition_variable m_commit_cv;
+    std::thread m_committer;
+
+    // --- Level filter state ---
+    // A per-module override. Entries are appended and never removed, so
+    // readers can scan them without a lock; `level` may change at any time.
+    struct ModuleLevel {
+        char name[LOGGER_RECORD_MODULE_MAX];
+        std::atomic<int> level; // LOGGER_MODULE_LEVEL_CLEARED once removed.
+    };
+    std::atomic<int> m_level_floor{LOG_LEVEL_DEBUG}; // Lowest level any module may emit.
+    std::atomic<int> m_min_level{LOG_LEVEL_DEBUG};   // Global minimum level.
+    ModuleLevel m_module_levels[LOGGER_MAX_MODULE_LEVELS];
+    std::atomic<int> m_module_level_count{0};
+    std::mutex m_filter_mutex;                       // Serializes filter writers.
 };
 
 #endif // __cplusplus
@@ -135,6 +555,151 @@ extern "C" {
  */
 int logger_init(const char* filename);
 
+/**
+ * @brief Initializes the global logging system with explicit options.
+ *
+ * Behaves like `logger_init`, but lets the caller choose between synchronous
+ * and asynchronous operation. In asynchronous mode a background thread owns
+ * all file I/O and `options->overflow_policy` decides what happens when the
+ * queue is full.
+ *
+ * @param filename The path to the log file.
+ * @param options The logger options, or NULL for the synchronous defaults.
+ * @return 0 on success, -1 on failure.
+ */
+int logger_init_with_options(const char* filename, const phLoggerOptions* options);
+
+/**
+ * @brief Returns the number of log records discarded because the asynchronous
+ * queue was full.
+ *
+ * @return The total number of dropped records since initialization.
+ */
+uint64_t logger_get_dropped_count(void);
+
+/**
+ * @brief Starts writing records to binary log segments at runtime.
+ *
+ * Useful for high-volume sessions: records are stored with their raw
+ * arguments instead of formatted text, and `ph-logcat` turns the segments
+ * back into log lines. Has no effect if the binary sink is already active.
+ *
+ * @param path_prefix Segment files are named `<path_prefix>.NNNNNN.phlog`.
+ * @param segment_size Bytes per segment, or 0 for the default.
+ * @param keep_text Non-zero to keep writing text lines as well.
+ * @return 0 on success, -1 if the first segment could not be created.
+ */
+int logger_enable_binary_sink(const char* path_prefix, size_t segment_size, int keep_text);
+
+/**
+ * @brief Writes every record logged so far to the log file.
+ *
+ * Pending group-commit lines are written and, in asynchronous mode, the call
+ * waits until the background writer has written the records queued before it
+ * (records logged meanwhile by other threads are not waited for).
+ */
+void logger_flush(void);
+
+/**
+ * @brief Sets the per-call-site rate limit of formatted records.
+ *
+ * Applies to `logger_log_fmt` (and `phCoreContext.log_fmt`), whose format
+ * string identifies the call site together with the module name. Suppressed
+ * records are summarized in the log at most once per second per call site.
+ * `.ph.conf` exposes the same settings as `log.rate_limit` and
+ * `log.rate_limit.burst`.
+ *
+ * @param limit The new limit. A zeroed limit disables rate limiting.
+ * @return 0 on success, -1 if `limit` is NULL.
+ */
+int logger_set_rate_limit(const phLoggerRateLimit* limit);
+
+/**
+ * @brief Reads the current per-call-site rate limit.
+ *
+ * @param limit Receives the limit.
+ * @return 0 on success, -1 if `limit` is NULL.
+ */
+int logger_get_rate_limit(phLoggerRateLimit* limit);
+
+/**
+ * @brief Sets the rotation policy of the text log file.
+ *
+ * Takes effect for the next write. Passing a zeroed policy disables
+ * rotation. `.ph.conf` exposes the same settings as `log.rotate.*` keys.
+ *
+ * @param rotation The new policy.
+ * @return 0 on success, -1 if `rotation` is NULL.
+ */
+int logger_set_rotation(const phLoggerRotation* rotation);
+
+/**
+ * @brief Reads the current rotation policy of the text log file.
+ *
+ * @param rotation Receives the policy.
+ * @return 0 on success, -1 if `rotation` is NULL.
+ */
+int logger_get_rotation(phLoggerRotation* rotation);
+
+/**
+ * @brief Sets the global minimum level. Records below it are discarded
+ * before any formatting takes place.
+ *
+ * @param level The minimum level to log. Defaults to LOG_LEVEL_DEBUG.
+ */
+void logger_set_level(phLogLevel level);
+
+/**
+ * @brief Returns the current global minimum level.
+ */
+phLogLevel logger_get_level(void);
+
+/**
+ * @brief Overrides the minimum level for a single module.
+ *
+ * The override takes precedence over the global level for records whose
+ * `module_name` matches exactly, in both directions: it can silence a noisy
+ * module or enable DEBUG output for just one module.
+ *
+ * @param module_name The module name as passed to the log functions.
+ * @param level The minimum level for that module.
+ * @return 0 on success, -1 on invalid arguments or if the override table is full.
+ */
+int logger_set_module_level(const char* module_name, phLogLevel level);
+
+/**
+ * @brief Removes the minimum level override of a module, if it has one.
+ *
+ * The module's records are filtered by the global level again.
+ *
+ * @param module_name The module name as passed to the log functions.
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int logger_clear_module_level(const char* module_name);
+
+/**
+ * @brief Tells whether a record with the given level and module would be logged.
+ *
+ * Exposed to modules through `phCoreContext.log_enabled` so that they can skip
+ * building expensive messages that would be filtered anyway.
+ *
+ * @param level The severity level of the prospective record.
+ * @param module_name The name of the calling module.
+ * @return 1 if the record would be logged, 0 otherwise.
+ */
+int logger_is_enabled(phLogLevel level, const char* module_name);
+
+/**
+ * @brief Parses a level name ("DEBUG", "INFO", "WARN", "ERROR", "FATAL").
+ *
+ * The comparison is case-insensitive and "WARNING" is accepted as an alias.
+ *
+ * @param text The level name.
+ * @param[out] level Receives the parsed level on success.
+ * @return 0 on success, -1 if the text is not a known level.
+ */
+int logger_parse_level(const char* text, phLogLevel* level);
+
 /**
  * @brief Logs a simple, pre-formatted message through the global logger.
  *
@@ -150,9 +715,10 @@ void logger_log(phLogLevel level, const char* module_name, const char* message);
  * @brief Logs a formatted message safely, preventing buffer overflows.
  *
  * This function accepts a printf-style format string and a variable number of
- * arguments. It dynamically allocates the necessary memory for the final
- * log message, making it safe to use with inputs of unpredictable size, such
- * as file paths or network error messages.
+ * arguments. The message is formatted with bounds checking, straight into
+ * the async ring cell or into a reusable thread-local buffer, so it is safe
+ * to use with inputs of unpredictable size, such as file paths or network
+ * error messages, and does not allocate once the buffer has grown.
  *
  * This function is thread-safe.
  *
@@ -167,7 +733,8 @@ void logger_log_fmt(phLogLevel level, const char* module_name, const char* forma
  * @brief Cleans up the logging system.
  *
  * Must be called once at application shutdown to ensure the log file is
- * properly closed.
+ * properly closed. In asynchronous mode it also drains the queue and stops
+ * the background writer.
  */
 void logger_cleanup();
 
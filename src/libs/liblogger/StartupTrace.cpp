@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: StartupTrace.cpp
+ *
+ * [
+ * This file implements the startup tracer declared in StartupTrace.hpp.
+ *
+ * Spans are appended to a vector under a mutex: a boot records a few hundred
+ * of them at most, so the lock is never contended enough to matter, and
+ * nothing is recorded at all unless tracing is on. The trace state is
+ * created during static initialization, so times count from about when the
+ * process started.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "StartupTrace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Span {
+    std::string category;
+    std::string name;
+    uint64_t begin;
+    uint64_t end;
+    uint32_t thread;
+};
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool env_enabled() {
+    const char* setting = std::getenv(STARTUP_TRACE_ENV);
+    return setting && *setting && std::strcmp(setting, "0") != 0;
+}
+
+struct TraceState {
+    std::atomic<bool> active{env_enabled()};
+    const uint64_t origin = now_ns();
+    std::mutex mutex;
+    std::vector<Span> spans;
+};
+
+TraceState& trace_state() {
+    static TraceState state;
+    return state;
+}
+
+// Creates the state, and so takes the origin, before main runs.
+TraceState& g_trace_state_at_load = trace_state();
+
+std::atomic<uint32_t> g_next_thread{1};
+thread_local uint32_t t_thread = 0;
+
+uint32_t current_thread() {
+    if (t_thread == 0) {
+        t_thread = g_next_thread.fetch_add(1, std::memory_order_relaxed);
+    }
+    return t_thread;
+}
+
+double to_ms(uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+/**
+ * @brief Writes a string as a JSON string literal.
+ */
+void write_json_string(FILE* file, const std::string& text) {
+    std::fputc('"', file);
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+            std::fputc(c, file);
+        } else if (c < 0x20) {
+            std::fprintf(file, "\\u%04x", c);
+        } else {
+            std::fputc(c, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+/**
+ * @brief Writes the spans as Chrome trace "complete" events.
+ */
+bool write_trace(const char* path, const std::vector<Span>& spans, uint64_t origin) {
+    FILE* file = std::fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"ph\"}}", file);
+    for (const Span& span : spans) {
+        std::fputs(",\n{\"name\":", file);
+        write_json_string(file, span.name);
+        std::fputs(",\"cat\":", file);
+        write_json_string(file, span.category);
+        std::fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", span.thread,
+                     static_cast<double>(span.begin - origin) / 1e3,
+                     static_cast<double>(span.end - span.begin) / 1e3);
+    }
+    std::fputs("\n]}\n", file);
+    return std::fclose(file) == 0;
+}
+
+/**
+ * @brief Prints the spans in start order, each indented under the spans of
+ * its thread that enclose it, then the total time per category.
+ */
+void print_summary(const std::vector<Span>& spans, uint64_t origin, const char* path, bool written) {
+    std::fprintf(stderr, "Startup trace: %zu steps%s%s\n", spans.size(),
+                 written ? ", written to " : ", could not be written to ", path);
+    std::fprintf(stderr, "%10s %12s %7s  %-12s %s\n", "Start ms", "Duration ms", "Thread", "Category", "Step");
+
+    std::map<uint32_t, std::vector<uint64_t>> open_ends; // Per thread, ends of the enclosing spans.
+    std::map<std::string, std::pair<uint64_t, size_t>> totals;
+    for (const Span& span : spans) {
+        std::vector<uint64_t>& ends = open_ends[span.thread];
+        while (!ends.empty() && ends.back() <= span.begin) {
+            ends.pop_back();
+        }
+        std::fprintf(stderr, "%10.3f %12.3f %7u  %-12s %*s%s\n", to_ms(span.begin - origin),
+                     to_ms(span.end - span.begin), span.thread, span.category.c_str(),
+                     static_cast<int>(ends.size() * 2), "", span.name.c_str());
+        ends.push_back(span.end);
+        totals[span.category].first += span.end - span.begin;
+        totals[span.category].second++;
+    }
+
+    std::fprintf(stderr, "Total per category:\n");
+    for (const auto& total : totals) {
+        std::fprintf(stderr, "  %-12s %12.3f ms in %zu step%s\n", total.first.c_str(), to_ms(total.second.first),
+                     total.second.second, total.second.second == 1 ? "" : "s");
+    }
+}
+
+} // namespace
+
+// --- C-style Wrapper Implementation ---
+
+/**
+ * @see StartupTrace.hpp
+ */
+int startup_trace_enabled(void) {
+    return trace_state().active.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+/**
+ * @see StartupTrace.hpp
+ */
+uint64_t startup_trace_begin(void) {
+    return startup_trace_enabled() ? now_ns() : 0;
+}
+
+/**
+ * @see StartupTrace.hpp
+ */
+void startup_trace_end(const char* category, const char* name, uint64_t begin) {
+    if (begin == 0) {
+        return;
+    }
+    uint64_t end = now_ns();
+    TraceState& state = trace_state();
+    Span span{category ? category : "", name ? name : "", begin, end, current_thread()};
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.active.load(std::memory_order_relaxed)) {
+        state.spans.push_back(std::move(span));
+    }
+}
+
+/**
+ * @see StartupTrace.hpp
+ */
+int startup_trace_finish(void) {
+    TraceState& state = trace_state();
+    std::vector<Span> spans;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.active.exchange(false)) {
+            return 0;
+        }
+        spans.swap(state.spans);
+    }
+    // Spans are recorded as they end; list them as they began, enclosing
+    // spans first.
+    std::stable_sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) {
+        return a.begin != b.begin ? a.begin < b.begin : a.end > b.end;
+    });
+
+    const char* path = std::getenv(STARTUP_TRACE_FILE_ENV);
+    if (!path || !*path) {
+        path = STARTUP_TRACE_DEFAULT_FILE;
+    }
+    bool written = write_trace(path, spans, state.origin);
+    print_summary(spans, state.origin, path, written);
+    return written ? 0 : -1;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2025 Pedro Henrique / phkaiser13
+ *
+ * File: StartupTrace.hpp
+ *
+ * [
+ * This header declares the startup tracer: a record of how long each step of
+ * the boot sequence takes (the logger, the configuration, each module, each
+ * Lua plugin, the TUI), so that startup regressions show up as numbers
+ * rather than as a vague feeling that `ph` got slower.
+ *
+ * Tracing is off unless the PH_TRACE_STARTUP environment variable is set to
+ * a value other than "0". When it is off, `startup_trace_begin` returns 0
+ * and `startup_trace_end` returns at once, so the calls can stay in the boot
+ * path for good.
+ *
+ * Each traced step is a span: a category, a name, and begin and end times
+ * on a monotonic clock, with the thread it ran on (modules are opened on
+ * several). `startup_trace_finish` ends the trace once startup is over and
+ * writes:
+ * - A Chrome trace-event JSON file ("X" complete events, in microseconds
+ *   since the process started), which chrome://tracing and Perfetto open
+ *   directly. Its path is PH_TRACE_STARTUP_FILE, or "ph-startup-trace.json".
+ * - A summary table on stderr: every span in start order, indented by
+ *   nesting, with its start time and duration, then the total per category.
+ *   CI can keep the table, or diff the JSON, to catch regressions.
+ *
+ * The tracer lives in the logger library because every component already
+ * links it, and so that `logger_init` itself can be traced.
+ * ]
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef STARTUP_TRACE_HPP
+#define STARTUP_TRACE_HPP
+
+#include <stdint.h>
+
+// Set to anything but "0" to trace startup.
+#define STARTUP_TRACE_ENV "PH_TRACE_STARTUP"
+// Where the trace is written.
+#define STARTUP_TRACE_FILE_ENV "PH_TRACE_STARTUP_FILE"
+#define STARTUP_TRACE_DEFAULT_FILE "ph-startup-trace.json"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Returns whether startup is being traced: PH_TRACE_STARTUP is set
+ * and `startup_trace_finish` has not been called yet.
+ */
+int startup_trace_enabled(void);
+
+/**
+ * @brief Starts a span.
+ * @return The span's begin time, to pass to `startup_trace_end`, or 0 if
+ *         startup is not being traced.
+ */
+uint64_t startup_trace_begin(void);
+
+/**
+ * @brief Ends a span started by `startup_trace_begin` and records it. Does
+ * nothing if `begin` is 0. Thread-safe.
+ *
+ * @param category The kind of step ("config", "module", "plugin", ...).
+ * @param name What the step worked on. Both strings are copied.
+ */
+void startup_trace_end(const char* category, const char* name, uint64_t begin);
+
+/**
+ * @brief Ends the trace, writes the JSON file and prints the summary table.
+ *
+ * Spans ended afterwards are not recorded. Calling it again, or when startup
+ * is not being traced, does nothing. `logger_cleanup` calls it, so a trace is
+ * written even if the boot sequence never marks its end.
+ *
+ * @return 0 on success or if there is nothing to write, -1 if the file
+ *         cannot be written.
+ */
+int startup_trace_finish(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // STARTUP_TRACE_HPP
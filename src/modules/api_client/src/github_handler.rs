@@ -15,7 +15,7 @@
 use serde::Deserialize;
 
 // Use our internal logging wrapper from the parent module (lib.rs).
-use crate::{log_to_core, LogLevel};
+use crate::{log_enabled, log_to_core, LogLevel};
 
 // --- Generic API Provider Contracts ---
 
@@ -71,7 +71,9 @@ impl ApiProvider for GitHubHandler {
     /// Performs the API call to GitHub and maps the response to our generic RepoInfo struct.
     async fn fetch_repo_info(&self, user: &str, repo: &str) -> Result<RepoInfo, Box<dyn std::error::Error>> {
         let url = format!("{}/{}/{}", GITHUB_API_ENDPOINT, user, repo);
-        log_to_core(LogLevel::Debug, &format!("Querying GitHub API: {}", url));
+        if log_enabled(LogLevel::Debug) {
+            log_to_core(LogLevel::Debug, &format!("Querying GitHub API: {}", url));
+        }
 
         let response = self.client
             .get(&url)
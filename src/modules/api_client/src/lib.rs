@@ -45,11 +45,21 @@ pub enum LogLevel {
 
 // The function pointer type for the logger provided by the C core.
 type LogFn = extern "C" fn(LogLevel, *const c_char, *const c_char);
+// The core's level filter: tells whether a message would be logged at all.
+type LogEnabledFn = extern "C" fn(LogLevel, *const c_char) -> c_int;
+// Placeholder for context callbacks this module never calls.
+type UnusedFn = extern "C" fn();
 
 #[repr(C)]
 #[derive(Clone, Copy)]
 pub struct CoreContext {
     log: Option<LogFn>,
+    // `log_fmt`, `get_config_value` and `print_ui` are unused here, but must be
+    // declared so that `log_enabled` sits at the same offset as in C.
+    _log_fmt: Option<UnusedFn>,
+    _get_config_value: Option<UnusedFn>,
+    _print_ui: Option<UnusedFn>,
+    log_enabled: Option<LogEnabledFn>,
 }
 
 #[repr(C)]
@@ -83,14 +93,29 @@ static CORE_CONTEXT: Mutex<Option<CoreContext>> = Mutex::new(None);
 
 // --- Logging Helper ---
 
+// The name this module logs under, as a C string.
+const LOG_MODULE_NAME: &[u8] = b"API_CLIENT_RUST\0";
+
+/// Asks the core whether a message at `level` would be logged, so callers can
+/// skip building messages (e.g. with `format!`) that would be filtered.
+pub(crate) fn log_enabled(level: LogLevel) -> bool {
+    let context_guard = CORE_CONTEXT.lock().unwrap();
+    match *context_guard {
+        Some(CoreContext { log_enabled: Some(enabled_fn), .. }) => {
+            enabled_fn(level, LOG_MODULE_NAME.as_ptr() as *const c_char) != 0
+        }
+        // Without a filter callback we cannot know; assume the message is wanted.
+        _ => true,
+    }
+}
+
 /// A safe Rust wrapper around the C logging function pointer.
 fn log_to_core(level: LogLevel, message: &str) {
     let context_guard = CORE_CONTEXT.lock().unwrap();
     if let Some(context) = *context_guard {
         if let Some(log_fn) = context.log {
-            let module_name = CString::new("API_CLIENT_RUST").unwrap();
             let msg = CString::new(message).unwrap();
-            log_fn(level, module_name.as_ptr(), msg.as_ptr());
+            log_fn(level, LOG_MODULE_NAME.as_ptr() as *const c_char, msg.as_ptr());
         }
     }
 }
@@ -165,7 +190,9 @@ pub extern "C" fn module_exec(argc: c_int, argv: *const *const c_char) -> Status
 
     let command = &args[0];
     let command_args = &args[1..];
-    log_to_core(LogLevel::Debug, &format!("Dispatching command: {}", command));
+    if log_enabled(LogLevel::Debug) {
+        log_to_core(LogLevel::Debug, &format!("Dispatching command: {}", command));
+    }
 
     let result = RUNTIME.block_on(async {
         match command.as_str() {
@@ -4,9 +4,11 @@
 * k8s_preview module. It uses the `serde` crate to deserialize a JSON string,
 * received from the C core via FFI, into strongly-typed Rust structs. This
 * ensures that the input is validated at the boundary, preventing invalid
-* data from propagating into the business logic.
+* data from propagating into the business logic. The same structs can also be
+* read from a binary payload (see `payload.rs`), which needs no parsing.
 * SPDX-License-Identifier: Apache-2.0 */
 
+use crate::payload::{Payload, PayloadError};
 use serde::Deserialize;
 
 /// Represents the possible actions that can be performed by this module.
@@ -46,4 +48,41 @@ pub struct PreviewConfig {
     /// An optional path to a kubeconfig file. If `None`, the client will attempt
     /// to use in-cluster configuration or the default user configuration.
     pub kubeconfig_path: Option<String>,
-}
\ No newline at end of file
+}
+
+// Field ids of `PH_SCHEMA_PREVIEW` payloads, as in `rust_ffi.h`.
+const FIELD_ACTION: u16 = 1;
+const FIELD_PR_NUMBER: u16 = 2;
+const FIELD_GIT_REPO_URL: u16 = 3;
+const FIELD_COMMIT_SHA: u16 = 4;
+const FIELD_KUBECONFIG_PATH: u16 = 5;
+
+impl PreviewConfig {
+    /// Builds the configuration from a `PH_SCHEMA_PREVIEW` payload, the
+    /// binary equivalent of the JSON object.
+    pub fn from_payload(payload: &Payload) -> Result<Self, PayloadError> {
+        let action = match payload.get_u64(FIELD_ACTION)? {
+            Some(0) => Action::Create,
+            Some(1) => Action::Destroy,
+            Some(_) => return Err(PayloadError::InvalidField(FIELD_ACTION)),
+            None => return Err(PayloadError::Missing("action")),
+        };
+        let pr_number = payload
+            .get_u64(FIELD_PR_NUMBER)?
+            .ok_or(PayloadError::Missing("pr_number"))?;
+        Ok(PreviewConfig {
+            action,
+            pr_number: u32::try_from(pr_number)
+                .map_err(|_| PayloadError::InvalidField(FIELD_PR_NUMBER))?,
+            git_repo_url: payload
+                .get_str(FIELD_GIT_REPO_URL)?
+                .ok_or(PayloadError::Missing("git_repo_url"))?
+                .to_owned(),
+            commit_sha: payload
+                .get_str(FIELD_COMMIT_SHA)?
+                .ok_or(PayloadError::Missing("commit_sha"))?
+                .to_owned(),
+            kubeconfig_path: payload.get_str(FIELD_KUBECONFIG_PATH)?.map(str::to_owned),
+        })
+    }
+}
@@ -5,16 +5,26 @@
 * the C core to invoke the Rust logic. Its primary responsibility is to safely
 * handle data from C, set up the asynchronous Tokio runtime, orchestrate the
 * module's business logic, and report a status code back to the caller.
+* Requests arrive either as JSON (`run_preview`) or as a binary payload that
+* is read in place (`invoke_buffer`, the second generation of the FFI ABI),
+* optionally with a cancel token the core can set while the action runs
+* (`invoke_cancellable`).
 * SPDX-License-Identifier: Apache-2.0 */
 
 // Public modules that define the library's structure.
 pub mod actions;
 pub mod config;
 pub mod kube_client;
+pub mod payload;
 
 use config::{Action, PreviewConfig};
+use payload::{Payload, PhBuffer, PhCancelToken, SCHEMA_PREVIEW, STATUS_CANCELLED};
 use std::ffi::{c_char, CStr};
 use std::panic;
+use std::time::Duration;
+
+// How often a cancellable call checks its cancel token.
+const CANCEL_POLL_INTERVAL: Duration = Duration::from_millis(50);
 
 /// The main entry point for the C core.
 ///
@@ -63,38 +73,74 @@ pub extern "C" fn run_preview(config_json: *const c_char) -> i32 {
             }
         };
 
-        // 3. Create a Tokio runtime to execute our async logic.
-        let runtime = match tokio::runtime::Builder::new_multi_thread()
-            .enable_all()
-            .build()
+        execute(config, None)
+    });
+
+    match result {
+        Ok(status_code) => status_code,
+        Err(_) => {
+            eprintln!("[k8s_preview_module] Error: A panic occurred. This is a critical bug.");
+            -5 // Panic
+        }
+    }
+}
+
+/// The JSON entry point under the name the C core's FFI registry resolves
+/// (`RUST_FUNCTION_NAME` in `rust_ffi.c`); the registry only loads libraries
+/// that export it.
+#[no_mangle]
+pub extern "C" fn invoke(config_json: *const c_char) -> i32 {
+    run_preview(config_json)
+}
+
+/// The binary payload entry point for the C core.
+///
+/// Same as `run_preview`, but the configuration is a `PH_SCHEMA_PREVIEW`
+/// payload, read in place instead of parsed from JSON.
+///
+/// # Safety
+/// `payload` must point to a valid `ph_buffer` whose bytes remain valid for
+/// the duration of this function call. The buffer is borrowed: the C core
+/// keeps ownership of it and frees it after the call.
+///
+/// # Returns
+/// The codes of `run_preview`, with `-3` meaning an invalid payload.
+#[no_mangle]
+pub extern "C" fn invoke_buffer(payload: *const PhBuffer) -> i32 {
+    invoke_cancellable(payload, std::ptr::null())
+}
+
+/// The cancellable binary payload entry point, used by `ffi_call_async`.
+///
+/// Same as `invoke_buffer`, but the action is abandoned at its next await
+/// point once the core sets `cancel`.
+///
+/// # Safety
+/// As for `invoke_buffer`. `cancel` may be null; otherwise it must remain
+/// valid for the duration of this function call.
+///
+/// # Returns
+/// The codes of `invoke_buffer`, or `PH_STATUS_CANCELLED` (-125) if the call
+/// was cancelled before the action completed.
+#[no_mangle]
+pub extern "C" fn invoke_cancellable(payload: *const PhBuffer, cancel: *const PhCancelToken) -> i32 {
+    let result = panic::catch_unwind(|| {
+        if payload.is_null() {
+            eprintln!("[k8s_preview_module] Error: Received a null pointer for the payload.");
+            return -1;
+        }
+
+        let config = match unsafe { Payload::from_buffer(&*payload, SCHEMA_PREVIEW) }
+            .and_then(|payload| PreviewConfig::from_payload(&payload))
         {
-            Ok(rt) => rt,
+            Ok(c) => c,
             Err(e) => {
-                eprintln!("[k8s_preview_module] Error: Failed to build Tokio runtime: {}", e);
-                return -4;
+                eprintln!("[k8s_preview_module] Error: Invalid payload: {}", e);
+                return -3;
             }
         };
 
-        // 4. Execute the business logic within the async runtime.
-        let execution_result = runtime.block_on(async {
-            match config.action {
-                Action::Create => actions::handle_create_action(&config).await,
-                Action::Destroy => actions::handle_destroy_action(&config).await,
-            }
-        });
-
-        // 5. Report the final status.
-        match execution_result {
-            Ok(_) => {
-                println!("[k8s_preview_module] Action completed successfully.");
-                0 // Success
-            }
-            Err(e) => {
-                // Using `anyhow`'s chain, we can print the full error context.
-                eprintln!("[k8s_preview_module] Error during execution: {:?}", e);
-                -4 // Runtime error
-            }
-        }
+        execute(config, unsafe { cancel.as_ref() })
     });
 
     match result {
@@ -104,4 +150,62 @@ pub extern "C" fn run_preview(config_json: *const c_char) -> i32 {
             -5 // Panic
         }
     }
-}
\ No newline at end of file
+}
+
+/// Runs the requested action, whichever entry point the configuration came
+/// through, and returns the status code to report.
+fn execute(config: PreviewConfig, cancel: Option<&PhCancelToken>) -> i32 {
+    // 3. Create a Tokio runtime to execute our async logic.
+    let runtime = match tokio::runtime::Builder::new_multi_thread()
+        .enable_all()
+        .build()
+    {
+        Ok(rt) => rt,
+        Err(e) => {
+            eprintln!("[k8s_preview_module] Error: Failed to build Tokio runtime: {}", e);
+            return -4;
+        }
+    };
+
+    // 4. Execute the business logic within the async runtime, racing it
+    // against the cancel token if there is one.
+    let execution_result = runtime.block_on(async {
+        let action = async {
+            match config.action {
+                Action::Create => actions::handle_create_action(&config).await,
+                Action::Destroy => actions::handle_destroy_action(&config).await,
+            }
+        };
+        match cancel {
+            None => action.await.map(Some),
+            Some(token) => tokio::select! {
+                result = action => result.map(Some),
+                _ = wait_for_cancel(token) => Ok(None),
+            },
+        }
+    });
+
+    // 5. Report the final status.
+    match execution_result {
+        Ok(None) => {
+            eprintln!("[k8s_preview_module] Action cancelled.");
+            STATUS_CANCELLED
+        }
+        Ok(Some(_)) => {
+            println!("[k8s_preview_module] Action completed successfully.");
+            0 // Success
+        }
+        Err(e) => {
+            // Using `anyhow`'s chain, we can print the full error context.
+            eprintln!("[k8s_preview_module] Error during execution: {:?}", e);
+            -4 // Runtime error
+        }
+    }
+}
+
+/// Completes once the core has cancelled the call.
+async fn wait_for_cancel(token: &PhCancelToken) {
+    while !token.is_cancelled() {
+        tokio::time::sleep(CANCEL_POLL_INTERVAL).await;
+    }
+}
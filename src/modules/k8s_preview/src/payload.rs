@@ -0,0 +1,215 @@
+/* Copyright (C) 2025 Pedro Henrique / phkaiser13
+* File: src/modules/k8s_preview/src/payload.rs
+* This file implements the Rust side of the binary payload ABI declared in
+* `src/core/ffi/rust_ffi.h`. A payload is a flat, length-prefixed buffer made
+* of a header, a table of fixed-size field records and a string area. It is
+* read in place: fields are decoded from the borrowed bytes on demand and
+* strings are returned as `&str` slices of the buffer, so nothing is parsed
+* or copied up front. Every offset is bounds-checked, so a malformed payload
+* is reported as an error rather than read out of bounds.
+* SPDX-License-Identifier: Apache-2.0 */
+
+use std::ffi::c_void;
+use std::fmt;
+use std::sync::atomic::{AtomicI32, Ordering};
+
+/// `PH_PAYLOAD_MAGIC`: "PHPL" read as a little-endian word.
+pub const PAYLOAD_MAGIC: u32 = 0x4C50_4850;
+/// `PH_PAYLOAD_VERSION`.
+pub const PAYLOAD_VERSION: u16 = 1;
+/// `PH_SCHEMA_PREVIEW`.
+pub const SCHEMA_PREVIEW: u16 = 1;
+
+const FIELD_U64: u16 = 1;
+const FIELD_STRING: u16 = 2;
+
+/// `sizeof(ph_payload_header)` and `sizeof(ph_payload_field)`.
+const HEADER_SIZE: usize = 24;
+const FIELD_SIZE: usize = 16;
+
+/// Mirrors `ph_buffer`. The C side keeps ownership of the bytes for the
+/// duration of the call.
+#[repr(C)]
+pub struct PhBuffer {
+    pub data: *const u8,
+    pub size: usize,
+    pub free_fn: Option<unsafe extern "C" fn(owner: *mut c_void)>,
+    pub owner: *mut c_void,
+}
+
+/// `PH_STATUS_CANCELLED`: returned once a cancelled call has stopped.
+pub const STATUS_CANCELLED: i32 = -125;
+
+/// Mirrors `ph_cancel_token`. The C core sets `cancelled` to 1 to ask the
+/// module to stop.
+#[repr(C)]
+pub struct PhCancelToken {
+    pub cancelled: AtomicI32,
+}
+
+impl PhCancelToken {
+    pub fn is_cancelled(&self) -> bool {
+        self.cancelled.load(Ordering::Acquire) != 0
+    }
+}
+
+/// Why a payload was rejected.
+#[derive(Debug, PartialEq)]
+pub enum PayloadError {
+    /// The header is missing, or its magic or sizes do not match the buffer.
+    Malformed,
+    /// The payload was made for another ABI version.
+    Version(u16),
+    /// The payload is meant for another module.
+    Schema(u16),
+    /// A field has an unexpected type, or points outside the string area.
+    InvalidField(u16),
+    /// A string field is not valid UTF-8.
+    Utf8(u16),
+    /// A required field is absent.
+    Missing(&'static str),
+}
+
+impl fmt::Display for PayloadError {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            PayloadError::Malformed => write!(f, "malformed payload"),
+            PayloadError::Version(v) => write!(f, "unsupported payload version {}", v),
+            PayloadError::Schema(s) => write!(f, "unexpected payload schema {}", s),
+            PayloadError::InvalidField(id) => write!(f, "invalid field {}", id),
+            PayloadError::Utf8(id) => write!(f, "field {} is not valid UTF-8", id),
+            PayloadError::Missing(name) => write!(f, "missing field '{}'", name),
+        }
+    }
+}
+
+impl std::error::Error for PayloadError {}
+
+/// One record of the field table.
+#[derive(Clone, Copy, Debug)]
+pub struct Field {
+    pub id: u16,
+    pub kind: u16,
+    pub index: u32,
+    pub value: u64,
+}
+
+/// A validated payload, borrowing the caller's buffer.
+pub struct Payload<'a> {
+    fields: &'a [u8],
+    strings: &'a [u8],
+}
+
+fn read_u16(bytes: &[u8], at: usize) -> u16 {
+    u16::from_ne_bytes([bytes[at], bytes[at + 1]])
+}
+
+fn read_u32(bytes: &[u8], at: usize) -> u32 {
+    let mut word = [0u8; 4];
+    word.copy_from_slice(&bytes[at..at + 4]);
+    u32::from_ne_bytes(word)
+}
+
+fn read_u64(bytes: &[u8], at: usize) -> u64 {
+    let mut word = [0u8; 8];
+    word.copy_from_slice(&bytes[at..at + 8]);
+    u64::from_ne_bytes(word)
+}
+
+impl<'a> Payload<'a> {
+    /// Borrows the bytes of a `ph_buffer`.
+    ///
+    /// # Safety
+    /// `buffer` must point to a valid `PhBuffer` whose `data` holds `size`
+    /// readable bytes for the lifetime `'a`.
+    pub unsafe fn from_buffer(buffer: &'a PhBuffer, schema: u16) -> Result<Self, PayloadError> {
+        if buffer.data.is_null() {
+            return Err(PayloadError::Malformed);
+        }
+        Self::parse(std::slice::from_raw_parts(buffer.data, buffer.size), schema)
+    }
+
+    /// Validates the header of a payload meant for `schema`.
+    pub fn parse(bytes: &'a [u8], schema: u16) -> Result<Self, PayloadError> {
+        if bytes.len() < HEADER_SIZE || read_u32(bytes, 0) != PAYLOAD_MAGIC {
+            return Err(PayloadError::Malformed);
+        }
+        let version = read_u16(bytes, 4);
+        if version != PAYLOAD_VERSION {
+            return Err(PayloadError::Version(version));
+        }
+        let payload_schema = read_u16(bytes, 6);
+        if payload_schema != schema {
+            return Err(PayloadError::Schema(payload_schema));
+        }
+        let size = read_u32(bytes, 8) as usize;
+        let field_count = read_u32(bytes, 12) as usize;
+        let strings_offset = read_u32(bytes, 16) as usize;
+        let strings_size = read_u32(bytes, 20) as usize;
+        let fields_end = field_count
+            .checked_mul(FIELD_SIZE)
+            .and_then(|table| table.checked_add(HEADER_SIZE))
+            .ok_or(PayloadError::Malformed)?;
+        let strings_end = strings_offset
+            .checked_add(strings_size)
+            .ok_or(PayloadError::Malformed)?;
+        if size != bytes.len() || fields_end > strings_offset || strings_end > size {
+            return Err(PayloadError::Malformed);
+        }
+        Ok(Payload {
+            fields: &bytes[HEADER_SIZE..fields_end],
+            strings: &bytes[strings_offset..strings_end],
+        })
+    }
+
+    /// Iterates over the field table, in the order the caller wrote it.
+    pub fn fields(&self) -> impl Iterator<Item = Field> + 'a {
+        let table = self.fields;
+        table.chunks_exact(FIELD_SIZE).map(|record| Field {
+            id: read_u16(record, 0),
+            kind: read_u16(record, 2),
+            index: read_u32(record, 4),
+            value: read_u64(record, 8),
+        })
+    }
+
+    fn first(&self, id: u16) -> Option<Field> {
+        self.fields().find(|field| field.id == id)
+    }
+
+    /// Reads an integer field.
+    pub fn u64_value(&self, field: Field) -> Result<u64, PayloadError> {
+        if field.kind != FIELD_U64 {
+            return Err(PayloadError::InvalidField(field.id));
+        }
+        Ok(field.value)
+    }
+
+    /// Reads a string field, as a slice of the payload.
+    pub fn str_value(&self, field: Field) -> Result<&'a str, PayloadError> {
+        if field.kind != FIELD_STRING {
+            return Err(PayloadError::InvalidField(field.id));
+        }
+        let offset = (field.value & 0xFFFF_FFFF) as usize;
+        let length = (field.value >> 32) as usize;
+        let bytes = offset
+            .checked_add(length)
+            .and_then(|end| self.strings.get(offset..end))
+            .ok_or(PayloadError::InvalidField(field.id))?;
+        std::str::from_utf8(bytes).map_err(|_| PayloadError::Utf8(field.id))
+    }
+
+    /// Reads the first integer field with this id, if any.
+    pub fn get_u64(&self, id: u16) -> Result<Option<u64>, PayloadError> {
+        self.first(id)
+            .map(|field| self.u64_value(field))
+            .transpose()
+    }
+
+    /// Reads the first string field with this id, if any.
+    pub fn get_str(&self, id: u16) -> Result<Option<&'a str>, PayloadError> {
+        self.first(id)
+            .map(|field| self.str_value(field))
+            .transpose()
+    }
+}
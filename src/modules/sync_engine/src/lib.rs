@@ -13,14 +13,21 @@
 * but dangerous, as a task attempting a re-entrant call to the module would
 * self-deadlock.
 *
+* The runtime is a current-thread one: it drives the async code on the thread
+* that calls `module_exec` and starts no threads. Blocking work (libgit2
+* fetches, graph walks) goes to the core's shared worker pool through
+* `run_on_core_pool`, so the module no longer adds a pool of its own to the
+* process.
+*
 * SPDX-License-Identifier: Apache-2.0 */
 
-use libc::{c_char, c_int};
+use libc::{c_char, c_int, c_void};
 use std::ffi::{CStr, CString};
 use std::sync::Mutex;
 
 use lazy_static::lazy_static;
-use tokio::runtime::Runtime;
+use tokio::runtime::{Builder, Runtime};
+use tokio::sync::oneshot;
 
 // The internal module containing the actual synchronization logic.
 mod sync;
@@ -47,9 +54,31 @@ pub enum phLogLevel {
 // Function pointer type for the core logger callback.
 type LogFn = extern "C" fn(phLogLevel, *const c_char, *const c_char);
 
+// Function pointer types for the core worker pool.
+type TaskFn = extern "C" fn(arg: *mut c_void);
+type SubmitTaskFn = extern "C" fn(task: TaskFn, arg: *mut c_void) -> c_int;
+
+// A callback this module does not use. Declared so that the fields after it
+// sit at the offsets the C struct gives them.
+type UnusedFn = unsafe extern "C" fn();
+
 #[repr(C)]
 pub struct phCoreContext {
     log: Option<LogFn>,
+    log_fmt: Option<UnusedFn>,
+    get_config_value: Option<UnusedFn>,
+    print_ui: Option<UnusedFn>,
+    log_enabled: Option<UnusedFn>,
+    get_config_view: Option<UnusedFn>,
+    config_generation: Option<UnusedFn>,
+    config_read_begin: Option<UnusedFn>,
+    config_read_end: Option<UnusedFn>,
+    config_get_int: Option<UnusedFn>,
+    config_get_bool: Option<UnusedFn>,
+    config_get_duration_ms: Option<UnusedFn>,
+    config_get_list: Option<UnusedFn>,
+    submit_task: Option<SubmitTaskFn>,
+    worker_count: Option<extern "C" fn() -> u32>,
 }
 
 // --- Global State Management ---
@@ -59,7 +88,11 @@ lazy_static! {
     // CRITICAL: It is NOT wrapped in a Mutex. `tokio::runtime::Runtime` is thread-safe.
     // Wrapping it in a Mutex creates a risk of deadlocks if an async task ever
     // needs to call back into a function that also tries to lock the runtime.
-    static ref RUNTIME: Runtime = Runtime::new().expect("Failed to create Tokio runtime");
+    // It runs on the calling thread; blocking work goes to the core's pool.
+    static ref RUNTIME: Runtime = Builder::new_current_thread()
+        .enable_all()
+        .build()
+        .expect("Failed to create Tokio runtime");
 
     // The core context is stored globally to allow logging from anywhere.
     // A Mutex is necessary here because it's written to once during initialization.
@@ -81,6 +114,50 @@ fn log_to_core(level: phLogLevel, message: &str) {
     }
 }
 
+// --- Core Worker Pool ---
+
+type Job = Box<dyn FnOnce() + Send>;
+
+/// Runs a job handed to the core's pool by `run_on_core_pool`.
+extern "C" fn run_job(arg: *mut c_void) {
+    let job = unsafe { Box::from_raw(arg as *mut Job) };
+    // A panic must not unwind into the core's thread. The job's result
+    // sender is dropped with it, which the waiting side reports as an error.
+    let _ = std::panic::catch_unwind(std::panic::AssertUnwindSafe(move || job()));
+}
+
+/// Runs blocking work on the core's shared worker pool and waits for its
+/// result without blocking the runtime. Falls back to running the work in
+/// place when the core has no pool to offer or refuses the task.
+pub(crate) async fn run_on_core_pool<F, T>(work: F) -> Result<T, String>
+where
+    F: FnOnce() -> T + Send + 'static,
+    T: Send + 'static,
+{
+    let (sender, receiver) = oneshot::channel();
+    let job: Box<Job> = Box::new(Box::new(move || {
+        let _ = sender.send(work());
+    }));
+
+    let submit = CORE_CONTEXT
+        .lock()
+        .ok()
+        .and_then(|guard| guard.as_ref().and_then(|context| context.submit_task));
+    let arg = Box::into_raw(job) as *mut c_void;
+    let queued = match submit {
+        Some(submit_task) => submit_task(run_job, arg) == phStatus::Success as c_int,
+        None => false,
+    };
+    if !queued {
+        // The core did not take ownership of the job.
+        run_job(arg);
+    }
+
+    receiver
+        .await
+        .map_err(|_| "A task on the core worker pool panicked.".to_string())
+}
+
 // --- Module Metadata ---
 
 #[repr(C)]
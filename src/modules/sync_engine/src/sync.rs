@@ -11,6 +11,9 @@
  * to the Git object database, allowing for sophisticated analysis that would
  * be impossible by just wrapping the `git` CLI.
  *
+ * Fetches block on the network, so they run on the core's worker pool, both
+ * repositories at once.
+ *
  * SPDX-License-Identifier: Apache-2.0 */
 
 use git2::{Oid, Repository};
@@ -33,6 +36,10 @@ struct SyncState {
 // --- 2. The Sync Engine ---
 // Encapsulates all resources and state required for a sync operation.
 struct SyncEngine {
+    // The paths the repositories were opened from, for reopening them on the
+    // core's worker threads (a `Repository` cannot be shared across threads).
+    source_path: String,
+    target_path: String,
     // The source repository for the synchronization.
     source_repo: Repository,
     // The target repository for the synchronization.
@@ -66,6 +73,8 @@ impl SyncEngine {
         };
 
         Ok(SyncEngine {
+            source_path: source_path.to_string(),
+            target_path: target_path.to_string(),
             source_repo,
             target_repo,
             state_path,
@@ -85,8 +94,10 @@ impl SyncEngine {
         println!("Starting synchronization...");
 
         // Phase 1: Fetch updates from all remotes to ensure we have the latest data.
-        self.fetch_repo("source", &self.source_repo).await?;
-        self.fetch_repo("target", &self.target_repo).await?;
+        tokio::try_join!(
+            Self::fetch_repo("source", &self.source_path),
+            Self::fetch_repo("target", &self.target_path)
+        )?;
 
         // Phase 2: Analyze divergence by finding heads and the sync base.
         let source_head = self
@@ -148,13 +159,19 @@ impl SyncEngine {
     }
 
     /// Helper to fetch updates for a given repository from its "origin" remote.
-    async fn fetch_repo(&self, name: &str, repo: &Repository) -> SyncResult<()> {
+    /// The fetch runs on the core's worker pool, on a handle of its own.
+    async fn fetch_repo(name: &str, path: &str) -> SyncResult<()> {
         println!("Fetching updates for {} repository...", name);
-        let mut remote = repo.find_remote("origin")?;
-        // Fetch the 'main' branch. A more robust implementation might fetch all branches
-        // or use a configurable refspec.
-        remote.fetch(&["main"], None, None)?;
-        Ok(())
+        let path = path.to_string();
+        crate::run_on_core_pool(move || -> SyncResult<()> {
+            let repo = Repository::open(&path)?;
+            let mut remote = repo.find_remote("origin")?;
+            // Fetch the 'main' branch. A more robust implementation might fetch all branches
+            // or use a configurable refspec.
+            remote.fetch(&["main"], None, None)?;
+            Ok(())
+        })
+        .await?
     }
 
     /// Finds the common base for synchronization.
@@ -52,8 +52,7 @@ function smart_sync(...)
     end
     
     -- Check if auto-sync is enabled
-    local auto_sync = get_config("ph.workflow.auto-sync", "true")
-    if auto_sync ~= "true" then
+    if not ph.config_get_bool("ph.workflow.auto-sync", true) then
         ph.log("WARN", "Auto-sync disabled in configuration", "SMART_SYNC")
         return false
     end
@@ -93,8 +92,7 @@ function smart_sync(...)
     end
     
     -- Step 4: Push if auto-push is enabled
-    local auto_push = get_config("ph.workflow.auto-push", "false")
-    if auto_push == "true" then
+    if ph.config_get_bool("ph.workflow.auto-push", false) then
         if not ph.run_command("push", {"origin", branch}) then
             ph.log("WARN", "Failed to push changes", "SMART_SYNC")
             -- Don't fail the entire operation for push failures
@@ -208,8 +206,7 @@ function enhanced_status()
     ph.log("INFO", "Working directory: " .. pwd, "ENV_INFO")
     
     -- Check for configuration-driven custom status
-    local show_upstream = get_config("ph.status.show-upstream", "true")
-    if show_upstream == "true" then
+    if ph.config_get_bool("ph.status.show-upstream", true) then
         ph.run_command("status", {"--ahead-behind"})
     end
     
@@ -228,8 +225,7 @@ function pre_commit_validation()
     ph.log("INFO", "Running pre-commit validation", "HOOK")
     
     -- Check if validation is enabled
-    local enable_validation = get_config("ph.hooks.pre-commit.validation", "true")
-    if enable_validation ~= "true" then
+    if not ph.config_get_bool("ph.hooks.pre-commit.validation", true) then
         ph.log("DEBUG", "Pre-commit validation disabled", "HOOK")
         return
     end
@@ -238,8 +234,7 @@ function pre_commit_validation()
     local issues = {}
     
     -- Check for TODO/FIXME in staged files (simplified check)
-    local todo_check = get_config("ph.hooks.pre-commit.check-todos", "true")
-    if todo_check == "true" then
+    if ph.config_get_bool("ph.hooks.pre-commit.check-todos", true) then
         ph.log("DEBUG", "Checking for TODO/FIXME markers", "HOOK")
         -- In real implementation, would examine staged files
         -- For demo, we'll just log the check
@@ -261,8 +256,7 @@ end
 function post_commit_notification()
     ph.log("INFO", "Post-commit notification triggered", "HOOK")
     
-    local notify_enabled = get_config("ph.hooks.post-commit.notify", "false")
-    if notify_enabled ~= "true" then
+    if not ph.config_get_bool("ph.hooks.post-commit.notify", false) then
         return
     end
     
@@ -278,8 +272,7 @@ end
 
 -- Backup hook for important operations
 function backup_hook(operation)
-    local enable_backup = get_config("ph.backup.enabled", "false")
-    if enable_backup ~= "true" then
+    if not ph.config_get_bool("ph.backup.enabled", false) then
         return
     end
     
@@ -0,0 +1,149 @@
+// tests/benchmarks/bench_config_load.c
+// Benchmark for loading large configuration files.
+//
+// Generates a config file of the kind fleet tooling produces (comments,
+// blank lines, indented and CRLF-terminated pairs) at 1k, 100k and 1M
+// entries, and times config_load parsing the text, config_load mapping the
+// compiled image of a previous load, and the former parser, reproduced
+// below: fgets into a 1024-byte buffer, in-place trimming and one insert
+// per pair into a table that grows as it goes. It fails if config_load
+// misses a key or returns a wrong value either way.
+
+#include "config/config_manager.h"
+#include "config/config_table.h"
+#include "libs/liblogger/Logger.hpp"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_FILE "bench_config_load.conf"
+#define BENCH_IMAGE BENCH_FILE ".phc"
+
+// --- The former parser ---
+
+static char* legacy_trim(char* str) {
+    while (isspace((unsigned char)*str)) str++;
+    if (*str == 0) return str;
+    char* end = str + strlen(str) - 1;
+    while (end > str && isspace((unsigned char)*end)) end--;
+    *(end + 1) = '\0';
+    return str;
+}
+
+static size_t legacy_load(const char* filename, ConfigTable* table) {
+    FILE* file = fopen(filename, "r");
+    if (!file) return 0;
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        char* trimmed = legacy_trim(line);
+        if (strlen(trimmed) == 0 || trimmed[0] == '#') continue;
+        char* separator = strchr(trimmed, '=');
+        if (!separator) continue;
+        *separator = '\0';
+        char* key = legacy_trim(trimmed);
+        char* value = legacy_trim(separator + 1);
+        if (strlen(key) == 0) continue;
+        config_table_set(table, key, strlen(key), value, strlen(value));
+    }
+    fclose(file);
+    return table->count;
+}
+
+// --- Harness ---
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void key_name(char* buffer, size_t size, size_t i) {
+    snprintf(buffer, size, "fleet.cluster%zu.node%zu.setting_%zu", i % 64, i % 4093, i);
+}
+
+// Writes `count` entries; returns the file size.
+static size_t write_config(size_t count) {
+    FILE* f = fopen(BENCH_FILE, "wb");
+    char key[96];
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 50 == 0) fprintf(f, "# generated section %zu\n\n", i / 50);
+        key_name(key, sizeof(key), i);
+        fprintf(f, i % 3 == 0 ? "  %s = value-%zu-abcdefghijklmnop\r\n" : "%s=value-%zu-abcdefghijklmnop\n", key, i);
+    }
+    long size = ftell(f);
+    fclose(f);
+    return (size_t)size;
+}
+
+// Checks every value of the loaded configuration; returns the failures.
+static int verify(size_t count) {
+    char key[96];
+    char expected[64];
+    int failures = 0;
+    for (size_t i = 0; i < count; ++i) {
+        key_name(key, sizeof(key), i);
+        snprintf(expected, sizeof(expected), "value-%zu-abcdefghijklmnop", i);
+        const char* value = config_get_view(key, NULL);
+        failures += !value || strcmp(value, expected) != 0;
+    }
+    return failures;
+}
+
+static int run_size(size_t count) {
+    size_t bytes = write_config(count);
+    int failures = 0;
+    remove(BENCH_IMAGE);
+
+    // Parsing, without images.
+    setenv("PH_CONFIG_CACHE", "0", 1);
+    double start = now_ns();
+    config_load(BENCH_FILE);
+    double load_ns = now_ns() - start;
+    failures += verify(count);
+    config_cleanup();
+
+    // A first load compiles the image, the next one maps it.
+    setenv("PH_CONFIG_CACHE", "1", 1);
+    config_load(BENCH_FILE);
+    config_cleanup();
+    start = now_ns();
+    config_load(BENCH_FILE);
+    double image_ns = now_ns() - start;
+    failures += verify(count);
+    config_cleanup();
+
+    ConfigTable table;
+    config_table_init(&table);
+    start = now_ns();
+    size_t legacy_count = legacy_load(BENCH_FILE, &table);
+    double legacy_ns = now_ns() - start;
+    config_table_destroy(&table);
+    failures += legacy_count != count;
+
+    printf("%8zu entries %7.2f MiB  parse %8.2f ms (%6.1f MiB/s, former %8.2f ms)  image %7.3f ms\n",
+           count, bytes / 1048576.0, load_ns / 1e6, bytes / 1048576.0 / (load_ns / 1e9),
+           legacy_ns / 1e6, image_ns / 1e6);
+    return failures;
+}
+
+// Usage: bench_config_load [max_entries]
+int main(int argc, char** argv) {
+    size_t max_entries = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+    static const size_t sizes[] = {1000, 100000, 1000000};
+
+    // Keep per-load INFO lines out of the way.
+    logger_init("bench_config_load.log");
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]) && sizes[i] <= max_entries; ++i) {
+        failures += run_size(sizes[i]);
+    }
+    remove(BENCH_FILE);
+    remove(BENCH_IMAGE);
+    logger_cleanup();
+
+    printf(failures == 0 ? "PASS: every entry was loaded with its value\n"
+                         : "FAIL: entries were missing or had wrong values\n");
+    return failures == 0 ? 0 : 1;
+}
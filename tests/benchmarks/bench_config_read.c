@@ -0,0 +1,147 @@
+// tests/benchmarks/bench_config_read.c
+// Concurrent read benchmark for the configuration manager.
+//
+// Runs 1, 2, 4, ... reader threads (up to the number of online CPUs, or the
+// count given on the command line) that look settings up with
+// config_get_view inside read sections, while a writer thread keeps
+// replacing values. It reports lookups per second in total and per thread;
+// with lock-free reads the per-thread figure should stay flat as threads
+// are added, as long as each has a core of its own.
+//
+// Every value read must be one the writer could have stored for that key,
+// so torn or freed snapshots make it fail: it doubles as a stress test of
+// snapshot publication and reclamation.
+
+#include "config/config_manager.h"
+#include "libs/liblogger/Logger.hpp"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define KEY_COUNT 256
+#define MAX_READERS 64
+// Duration of each measurement.
+#define RUN_MS 300
+
+static char g_keys[KEY_COUNT][32];
+static atomic_int g_running;
+static atomic_int g_failures;
+
+typedef struct {
+    unsigned seed;
+    unsigned long long lookups;
+} ReaderState;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Values have the form "<key>=<counter>", so a reader can check that the
+// value it got belongs to the key it asked for.
+static int value_matches(const char* key, const char* value, size_t length) {
+    size_t key_length = strlen(key);
+    return length > key_length && strncmp(value, key, key_length) == 0 &&
+           value[key_length] == '=' && strlen(value) == length;
+}
+
+static void* reader_main(void* arg) {
+    ReaderState* state = (ReaderState*)arg;
+    unsigned long long lookups = 0;
+    unsigned seed = state->seed;
+    while (atomic_load_explicit(&g_running, memory_order_relaxed)) {
+        config_read_begin();
+        for (int i = 0; i < 64; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            const char* key = g_keys[(seed >> 8) % KEY_COUNT];
+            size_t length = 0;
+            const char* value = config_get_view(key, &length);
+            if (!value || !value_matches(key, value, length)) {
+                atomic_fetch_add(&g_failures, 1);
+            }
+        }
+        config_read_end();
+        lookups += 64;
+    }
+    state->lookups = lookups;
+    return NULL;
+}
+
+static void* writer_main(void* arg) {
+    (void)arg;
+    char value[64];
+    unsigned long counter = 0;
+    while (atomic_load_explicit(&g_running, memory_order_relaxed)) {
+        const char* key = g_keys[counter % KEY_COUNT];
+        snprintf(value, sizeof(value), "%s=%lu", key, counter++);
+        config_set_value(key, value);
+        usleep(100);
+    }
+    return NULL;
+}
+
+static void run_readers(int readers) {
+    pthread_t threads[MAX_READERS];
+    ReaderState states[MAX_READERS];
+    pthread_t writer;
+
+    atomic_store(&g_running, 1);
+    pthread_create(&writer, NULL, writer_main, NULL);
+    double start = now_ns();
+    for (int i = 0; i < readers; ++i) {
+        states[i].seed = 0x9E3779B9u * (unsigned)(i + 1);
+        states[i].lookups = 0;
+        pthread_create(&threads[i], NULL, reader_main, &states[i]);
+    }
+    usleep(RUN_MS * 1000);
+    atomic_store(&g_running, 0);
+
+    unsigned long long total = 0;
+    for (int i = 0; i < readers; ++i) {
+        pthread_join(threads[i], NULL);
+        total += states[i].lookups;
+    }
+    double seconds = (now_ns() - start) / 1e9;
+    pthread_join(writer, NULL);
+
+    printf("%3d readers  %10.2f M lookups/s  %8.2f M/s per reader\n", readers,
+           total / seconds / 1e6, total / seconds / 1e6 / readers);
+}
+
+// Usage: bench_config_read [max_readers]
+int main(int argc, char** argv) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_readers = argc > 1 ? atoi(argv[1]) : (int)(cpus > 1 ? cpus : 1);
+    if (max_readers < 1) max_readers = 1;
+    if (max_readers > MAX_READERS) max_readers = MAX_READERS;
+
+    logger_init("bench_config_read.log");
+    for (int i = 0; i < KEY_COUNT; ++i) {
+        char value[sizeof(g_keys[i]) + 16];
+        snprintf(g_keys[i], sizeof(g_keys[i]), "bench.section%d.key", i);
+        snprintf(value, sizeof(value), "%.31s=initial", g_keys[i]);
+        config_set_value(g_keys[i], value);
+    }
+
+    for (int readers = 1;; readers *= 2) {
+        if (readers > max_readers) readers = max_readers;
+        run_readers(readers);
+        if (readers == max_readers) break;
+    }
+
+    config_cleanup();
+    logger_cleanup();
+
+    int failures = atomic_load(&g_failures);
+    if (failures != 0) {
+        printf("FAIL: %d lookups returned a missing or foreign value\n", failures);
+        return 1;
+    }
+    printf("PASS: every lookup returned a value of its key\n");
+    return 0;
+}
@@ -0,0 +1,196 @@
+// tests/benchmarks/bench_config_table.c
+// Micro-benchmark for the configuration hash table.
+//
+// Compares the open-addressing ConfigTable with the separately chained,
+// 128-bucket table that config_manager.c used before (reproduced below),
+// at 100, 10k and 1M keys. It reports nanoseconds per insert and per
+// successful lookup, and fails if either table loses a key.
+//
+// The chained table's cost per operation grows with its size, so at large
+// sizes it is measured on a sample of operations performed at full size:
+// the table is prefilled without the duplicate check (the keys are unique,
+// so the result is the same) and only the last inserts are timed.
+
+#include "config/config_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LEGACY_TABLE_SIZE 128
+// Operations timed on the chained table at most, per measurement.
+#define LEGACY_SAMPLE 1000
+// Lookups made on small tables, so that their timing is stable.
+#define MIN_LOOKUPS 100000
+
+// --- The former chained table ---
+
+typedef struct LegacyNode {
+    char* key;
+    char* value;
+    struct LegacyNode* next;
+} LegacyNode;
+
+static LegacyNode* g_legacy[LEGACY_TABLE_SIZE];
+
+static unsigned long legacy_hash(const char* str) {
+    unsigned long hash = 5381;
+    int c;
+    while ((c = *str++)) {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return hash;
+}
+
+static void legacy_prepend(const char* key, const char* value) {
+    unsigned int index = legacy_hash(key) % LEGACY_TABLE_SIZE;
+    LegacyNode* node = (LegacyNode*)malloc(sizeof(LegacyNode));
+    node->key = strdup(key);
+    node->value = strdup(value);
+    node->next = g_legacy[index];
+    g_legacy[index] = node;
+}
+
+static void legacy_set(const char* key, const char* value) {
+    unsigned int index = legacy_hash(key) % LEGACY_TABLE_SIZE;
+    for (LegacyNode* node = g_legacy[index]; node; node = node->next) {
+        if (strcmp(node->key, key) == 0) {
+            free(node->value);
+            node->value = strdup(value);
+            return;
+        }
+    }
+    legacy_prepend(key, value);
+}
+
+static const char* legacy_get(const char* key) {
+    unsigned int index = legacy_hash(key) % LEGACY_TABLE_SIZE;
+    for (LegacyNode* node = g_legacy[index]; node; node = node->next) {
+        if (strcmp(node->key, key) == 0) {
+            return node->value;
+        }
+    }
+    return NULL;
+}
+
+static void legacy_clear(void) {
+    for (int i = 0; i < LEGACY_TABLE_SIZE; ++i) {
+        LegacyNode* node = g_legacy[i];
+        while (node) {
+            LegacyNode* next = node->next;
+            free(node->key);
+            free(node->value);
+            free(node);
+            node = next;
+        }
+        g_legacy[i] = NULL;
+    }
+}
+
+// --- Harness ---
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t g_rng = 0x2545F4914F6CDD1Dull;
+
+static uint64_t next_random(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return g_rng;
+}
+
+// Keys look like real settings: "<section>.<module>.key_<n>".
+static char** make_keys(size_t count) {
+    static const char* sections[] = {"log", "sync", "api", "modules", "ci", "k8s", "ui", "git"};
+    char** keys = (char**)malloc(count * sizeof(char*));
+    char buffer[64];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(buffer, sizeof(buffer), "%s.module%zu.key_%zu", sections[i % 8], i % 997, i);
+        keys[i] = strdup(buffer);
+    }
+    return keys;
+}
+
+// Returns `count` random key indices, the order in which lookups are made.
+static size_t* make_lookup_order(size_t keys, size_t count) {
+    size_t* order = (size_t*)malloc(count * sizeof(size_t));
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = (size_t)(next_random() % keys);
+    }
+    return order;
+}
+
+// Runs one size; returns 0 if both tables returned every value.
+static int run_size(size_t count) {
+    char** keys = make_keys(count);
+    size_t lookups = count < MIN_LOOKUPS ? MIN_LOOKUPS : count;
+    size_t* order = make_lookup_order(count, lookups);
+    int failures = 0;
+
+    // ConfigTable: every operation is timed.
+    ConfigTable table;
+    config_table_init(&table);
+    double start = now_ns();
+    for (size_t i = 0; i < count; ++i) {
+        config_table_set(&table, keys[i], strlen(keys[i]), keys[i], strlen(keys[i]));
+    }
+    double table_insert = (now_ns() - start) / count;
+    start = now_ns();
+    for (size_t i = 0; i < lookups; ++i) {
+        const char* key = keys[order[i]];
+        const ConfigEntry* entry = config_table_find(&table, key, strlen(key));
+        failures += !entry || strcmp(config_table_value(&table, entry), key) != 0;
+    }
+    double table_lookup = (now_ns() - start) / lookups;
+    config_table_destroy(&table);
+
+    // Chained table: sampled at full size.
+    size_t sample = count < LEGACY_SAMPLE ? count : LEGACY_SAMPLE;
+    size_t lookup_sample = count < LEGACY_SAMPLE ? lookups : LEGACY_SAMPLE;
+    for (size_t i = 0; i < count - sample; ++i) {
+        legacy_prepend(keys[i], keys[i]);
+    }
+    start = now_ns();
+    for (size_t i = count - sample; i < count; ++i) {
+        legacy_set(keys[i], keys[i]);
+    }
+    double legacy_insert = (now_ns() - start) / sample;
+    start = now_ns();
+    for (size_t i = 0; i < lookup_sample; ++i) {
+        const char* key = keys[order[i]];
+        const char* value = legacy_get(key);
+        failures += !value || strcmp(value, key) != 0;
+    }
+    double legacy_lookup = (now_ns() - start) / lookup_sample;
+    legacy_clear();
+
+    printf("%8zu keys  insert %8.1f ns (chained %10.1f)  lookup %8.1f ns (chained %10.1f)  %5.0fx faster lookups\n",
+           count, table_insert, legacy_insert, table_lookup, legacy_lookup, legacy_lookup / table_lookup);
+
+    for (size_t i = 0; i < count; ++i) {
+        free(keys[i]);
+    }
+    free(keys);
+    free(order);
+    return failures;
+}
+
+// Usage: bench_config_table [max_keys]
+int main(int argc, char** argv) {
+    size_t max_keys = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+    static const size_t sizes[] = {100, 10000, 1000000};
+
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]) && sizes[i] <= max_keys; ++i) {
+        failures += run_size(sizes[i]);
+    }
+
+    printf(failures == 0 ? "PASS: every key was found with its value\n"
+                         : "FAIL: lookups returned missing or wrong values\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+// tests/benchmarks/bench_executor.c
+// Modules with a worker pool each against the core's shared pool.
+//
+// Four modules each run a burst of short CPU-bound tasks. First every
+// module starts one thread per processor for its burst, as each Rust module
+// did with its own Tokio runtime; then all bursts go through
+// executor_submit. Reports the threads each approach started and the time
+// it took, then checks the thread count setting, submissions from a task
+// during shutdown, and restarting the pool after a shutdown.
+//
+// Every task marks its own slot, so a task run twice or never makes the
+// benchmark fail.
+
+#include "executor/executor.h"
+#include "config/config_manager.h"
+#include "platform/platform.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MODULES 4
+#define TASKS_PER_MODULE 256
+#define TASKS (MODULES * TASKS_PER_MODULE)
+#define SPIN_ITERATIONS 200000
+
+static atomic_int g_runs[TASKS];
+static atomic_uint g_sink;
+static int g_failures;
+
+// Counts tasks finished through the executor, for waiting on a burst.
+static platform_mutex_t g_done_lock = PLATFORM_MUTEX_INIT;
+static platform_cond_t g_done_cond = PLATFORM_COND_INIT;
+static int g_done;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void expect(int condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        g_failures++;
+    }
+}
+
+static void run_task(int task) {
+    unsigned hash = (unsigned)task;
+    for (int i = 0; i < SPIN_ITERATIONS; ++i) {
+        hash = hash * 2654435761u + (unsigned)i;
+    }
+    atomic_fetch_add(&g_sink, hash);
+    atomic_fetch_add(&g_runs[task], 1);
+}
+
+static void reset_runs(void) {
+    for (int i = 0; i < TASKS; ++i) {
+        atomic_store(&g_runs[i], 0);
+    }
+}
+
+static void expect_each_ran_once(const char* approach) {
+    for (int i = 0; i < TASKS; ++i) {
+        if (atomic_load(&g_runs[i]) != 1) {
+            printf("FAIL: %s ran task %d %d times\n", approach, i, atomic_load(&g_runs[i]));
+            g_failures++;
+            return;
+        }
+    }
+}
+
+// --- A pool per module ---
+
+typedef struct {
+    atomic_int next;
+    int first;
+} module_burst;
+
+static void module_worker(void* arg) {
+    module_burst* burst = arg;
+    int task;
+    while ((task = atomic_fetch_add(&burst->next, 1)) < TASKS_PER_MODULE) {
+        run_task(burst->first + task);
+    }
+}
+
+static double run_private_pools(unsigned threads_per_module) {
+    static module_burst bursts[MODULES];
+    platform_thread_t* threads = malloc(sizeof(platform_thread_t) * MODULES * threads_per_module);
+    unsigned started = 0;
+    double start = now_ms();
+    for (int m = 0; m < MODULES; ++m) {
+        atomic_store(&bursts[m].next, 0);
+        bursts[m].first = m * TASKS_PER_MODULE;
+        for (unsigned t = 0; t < threads_per_module; ++t) {
+            if (platform_thread_create(&threads[started], module_worker, &bursts[m])) {
+                started++;
+            }
+        }
+    }
+    for (unsigned i = 0; i < started; ++i) {
+        platform_thread_join(threads[i]);
+    }
+    double elapsed = now_ms() - start;
+    free(threads);
+    expect(started == MODULES * threads_per_module, "could not start every module thread");
+    return elapsed;
+}
+
+// --- The shared pool ---
+
+static void finish_task(void) {
+    platform_mutex_lock(&g_done_lock);
+    g_done++;
+    platform_cond_broadcast(&g_done_cond);
+    platform_mutex_unlock(&g_done_lock);
+}
+
+static void executor_task(void* arg) {
+    run_task((int)(intptr_t)arg);
+    finish_task();
+}
+
+static void wait_for_tasks(int count) {
+    platform_mutex_lock(&g_done_lock);
+    while (g_done < count) {
+        platform_cond_wait(&g_done_cond, &g_done_lock, -1);
+    }
+    g_done = 0;
+    platform_mutex_unlock(&g_done_lock);
+}
+
+static double run_shared_pool(void) {
+    double start = now_ms();
+    for (int i = 0; i < TASKS; ++i) {
+        if (executor_submit(executor_task, (void*)(intptr_t)i) != ph_SUCCESS) {
+            printf("FAIL: could not submit task %d\n", i);
+            g_failures++;
+            finish_task();
+        }
+    }
+    wait_for_tasks(TASKS);
+    return now_ms() - start;
+}
+
+// A task that submits the rest of its chain, to run while the pool stops.
+static void chained_task(void* arg) {
+    int task = (int)(intptr_t)arg;
+    run_task(task);
+    if (task + 1 < TASKS) {
+        expect(executor_submit(chained_task, (void*)(intptr_t)(task + 1)) == ph_SUCCESS,
+               "a task could not submit during shutdown");
+    }
+}
+
+int main(void) {
+    unsigned cpus = (unsigned)platform_cpu_count();
+    if (cpus < 1) cpus = 1;
+
+    reset_runs();
+    double private_ms = run_private_pools(cpus);
+    expect_each_ran_once("per-module pools");
+
+    reset_runs();
+    double shared_ms = run_shared_pool();
+    expect_each_ran_once("shared pool");
+    expect(executor_thread_count() == cpus, "the pool does not default to one thread per processor");
+
+    printf("%d modules x %d tasks, %u processors\n", MODULES, TASKS_PER_MODULE, cpus);
+    printf("pool per module  %4u threads %8.1f ms\n", MODULES * cpus, private_ms);
+    printf("shared pool      %4u threads %8.1f ms\n", executor_thread_count(), shared_ms);
+
+    // Tasks submitted by a task while the pool shuts down still run.
+    reset_runs();
+    expect(executor_submit(chained_task, (void*)(intptr_t)0) == ph_SUCCESS, "could not submit a chain");
+    executor_shutdown();
+    expect_each_ran_once("shutdown");
+
+    // The thread count is read when the pool starts again.
+    expect(config_set_value(EXECUTOR_THREADS_KEY, "3") == ph_SUCCESS, "could not set the thread count");
+    expect(executor_thread_count() == 3, "the thread count setting is ignored");
+    reset_runs();
+    run_shared_pool();
+    expect_each_ran_once("restarted pool");
+    expect(executor_thread_count() == 3, "the restarted pool has the wrong size");
+
+    expect(executor_submit(NULL, NULL) == ph_ERROR_INVALID_ARGS, "a NULL task was accepted");
+    executor_shutdown();
+    config_cleanup();
+
+    if (g_failures != 0) {
+        printf("FAIL: %d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("PASS: every task ran exactly once\n");
+    return 0;
+}
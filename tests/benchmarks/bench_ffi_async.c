@@ -0,0 +1,124 @@
+// tests/benchmarks/bench_ffi_async.c
+// Running long module calls concurrently with ffi_call_async.
+//
+// Each call stands for a long operation (ffi_bench_module works for the
+// requested time). Runs 8 calls of 100 ms one after another, as blocking
+// calls would, then all at once from a single thread, and then checks
+// polling, waiting with a timeout, completion callbacks and cancellation.
+//
+// Every call returns a value of its own, so a status delivered to the wrong
+// handle or callback makes the benchmark fail.
+
+#include "ffi/rust_ffi.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define CALLS 8
+#define CALL_MS 100
+
+static const char* g_library;
+static int g_failures;
+static atomic_int g_completions;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void expect(int condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        g_failures++;
+    }
+}
+
+static void on_complete(ffi_call* call, int status, void* user_data) {
+    (void)call;
+    if (status == *(const int*)user_data) {
+        atomic_fetch_add(&g_completions, 1);
+    }
+}
+
+// Starts a call working for `work_ms` that returns `result`.
+static ffi_call* start_call(uint64_t work_ms, int* result) {
+    ph_payload_builder builder;
+    ph_payload_init(&builder, 0);
+    ph_payload_add_u64(&builder, 1, 0, work_ms);
+    ph_payload_add_u64(&builder, 2, 0, (uint64_t)*result);
+    ph_buffer payload;
+    if (ph_payload_finish(&builder, &payload) != 0) {
+        return NULL;
+    }
+    return ffi_call_async(g_library, &payload, on_complete, result);
+}
+
+// Usage: bench_ffi_async <module library>
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <module library>\n", argv[0]);
+        return 2;
+    }
+    g_library = argv[1];
+    int results[CALLS];
+    ffi_call* calls[CALLS];
+
+    double start = now_ms();
+    for (int i = 0; i < CALLS; ++i) {
+        results[i] = 100 + i;
+        calls[i] = start_call(CALL_MS, &results[i]);
+        if (!calls[i]) {
+            printf("FAIL: could not start a call on %s\n", g_library);
+            return 1;
+        }
+        int status = -1;
+        expect(ffi_call_wait(calls[i], -1, &status) == 1 && status == results[i], "blocking wait");
+        ffi_call_release(calls[i]);
+    }
+    double serial_ms = now_ms() - start;
+
+    start = now_ms();
+    for (int i = 0; i < CALLS; ++i) {
+        calls[i] = start_call(CALL_MS, &results[i]);
+        expect(calls[i] != NULL, "start");
+    }
+    expect(ffi_call_poll(calls[0], NULL) == 0, "poll of a running call");
+    expect(ffi_call_wait(calls[0], 10, NULL) == 0, "wait timing out");
+    for (int i = 0; i < CALLS; ++i) {
+        int status = -1;
+        if (calls[i]) {
+            expect(ffi_call_wait(calls[i], 10000, &status) == 1 && status == results[i], "concurrent wait");
+            expect(ffi_call_poll(calls[i], &status) == 1, "poll of a finished call");
+            ffi_call_release(calls[i]);
+        }
+    }
+    double concurrent_ms = now_ms() - start;
+    expect(atomic_load(&g_completions) == 2 * CALLS, "one callback per call");
+
+    printf("%d calls of %d ms  one at a time %8.1f ms  concurrently %8.1f ms  %5.1fx\n", CALLS, CALL_MS,
+           serial_ms, concurrent_ms, serial_ms / concurrent_ms);
+
+    // A call of a minute must stop soon after it is cancelled.
+    int never = 1;
+    ffi_call* call = start_call(60000, &never);
+    if (call) {
+        expect(ffi_call_wait(call, 20, NULL) == 0, "long call still running");
+        start = now_ms();
+        ffi_call_cancel(call);
+        int status = 0;
+        expect(ffi_call_wait(call, 5000, &status) == 1 && status == PH_STATUS_CANCELLED, "cancellation");
+        printf("cancelled a running call in %.1f ms\n", now_ms() - start);
+        ffi_call_release(call);
+    }
+    expect(atomic_load(&g_completions) == 2 * CALLS, "no callback success for the cancelled call");
+
+    ffi_shutdown();
+    if (g_failures != 0) {
+        printf("FAIL: %d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("PASS: every call completed, or stopped when cancelled\n");
+    return 0;
+}
@@ -0,0 +1,136 @@
+// tests/benchmarks/bench_ffi_call.c
+// Per-call overhead of calling a Rust module through the FFI layer.
+//
+// Compares the former way of calling a module, loading the library,
+// resolving `invoke` and unloading the library on every call, with the
+// registry of rust_ffi.c, which loads each library once: calls through
+// ffi_call_module, which look the library up each time, and calls on a
+// reference acquired once. It then runs ffi_call_module from 1, 2, 4, ...
+// threads at once.
+//
+// The module returns the length of its argument, so a call that reaches the
+// wrong function or argument makes the benchmark fail.
+
+#include "ffi/rust_ffi.h"
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 64
+// Calls per measurement; loading per call is far slower, so it gets fewer.
+#define RELOAD_CALLS 2000
+#define REGISTRY_CALLS 2000000
+
+static const char* g_library;
+static const char g_json[] = "{\"namespace\":\"bench\",\"dry_run\":true}";
+static atomic_int g_failures;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void check(int status) {
+    if (status != (int)strlen(g_json)) {
+        atomic_fetch_add(&g_failures, 1);
+    }
+}
+
+// The former ffi_call_rust_module: a full load and unload per call.
+static int call_with_reload(const char* library_name, const char* json) {
+    void* handle = dlopen(library_name, RTLD_LAZY);
+    if (!handle) {
+        return -1;
+    }
+    int (*invoke)(const char*) = (int (*)(const char*))dlsym(handle, "invoke");
+    int status = invoke ? invoke(json) : -1;
+    dlclose(handle);
+    return status;
+}
+
+static void report(const char* name, int calls, double elapsed_ns) {
+    printf("%-28s %10.1f ns/call  %10.2f M calls/s\n", name, elapsed_ns / calls, calls / elapsed_ns * 1e3);
+}
+
+static void* caller_main(void* arg) {
+    int calls = *(const int*)arg;
+    for (int i = 0; i < calls; ++i) {
+        check(ffi_call_module(g_library, g_json));
+    }
+    return NULL;
+}
+
+static void run_callers(int threads) {
+    pthread_t callers[MAX_THREADS];
+    int calls = REGISTRY_CALLS / threads;
+    double start = now_ns();
+    for (int i = 0; i < threads; ++i) {
+        pthread_create(&callers[i], NULL, caller_main, &calls);
+    }
+    for (int i = 0; i < threads; ++i) {
+        pthread_join(callers[i], NULL);
+    }
+    double elapsed = now_ns() - start;
+    printf("%3d threads  %10.2f M calls/s  %8.1f ns/call per thread\n", threads,
+           (double)calls * threads / elapsed * 1e3, elapsed / calls);
+}
+
+// Usage: bench_ffi_call <module library> [max_threads]
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <module library> [max_threads]\n", argv[0]);
+        return 2;
+    }
+    g_library = argv[1];
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = argc > 2 ? atoi(argv[2]) : (int)(cpus > 1 ? cpus : 1);
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+    ffi_library* library = ffi_library_acquire(g_library);
+    if (!library) {
+        printf("FAIL: could not load %s\n", g_library);
+        return 1;
+    }
+
+    double start = now_ns();
+    for (int i = 0; i < RELOAD_CALLS; ++i) {
+        check(call_with_reload(g_library, g_json));
+    }
+    report("load per call (former)", RELOAD_CALLS, now_ns() - start);
+
+    start = now_ns();
+    for (int i = 0; i < REGISTRY_CALLS; ++i) {
+        check(ffi_call_module(g_library, g_json));
+    }
+    report("registry lookup per call", REGISTRY_CALLS, now_ns() - start);
+
+    start = now_ns();
+    for (int i = 0; i < REGISTRY_CALLS; ++i) {
+        check(ffi_library_invoke(library, g_json));
+    }
+    report("held reference", REGISTRY_CALLS, now_ns() - start);
+    ffi_library_release(library);
+
+    for (int threads = 1;; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        run_callers(threads);
+        if (threads == max_threads) break;
+    }
+
+    ffi_shutdown();
+
+    int failures = atomic_load(&g_failures);
+    if (failures != 0) {
+        printf("FAIL: %d calls returned a wrong status\n", failures);
+        return 1;
+    }
+    printf("PASS: every call reached the module with its argument\n");
+    return 0;
+}
@@ -0,0 +1,234 @@
+// tests/benchmarks/bench_ffi_payload.c
+// Cost of passing a request to a module as JSON against a binary payload.
+//
+// Builds multi-cluster requests of 10, 1k and 100k clusters, each cluster
+// with a kubeconfig path and a target, plus a few kilobytes of manifests.
+// Every call then does the whole round trip: the core encodes the request,
+// the module decodes it (ffi_payload_module parses JSON the way serde_json
+// does and reads payloads in place), and the core frees it.
+//
+// The module returns the number of clusters plus targets it found, so a
+// request lost or garbled by either path makes the benchmark fail.
+
+#include "ffi/rust_ffi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Clusters summed over the calls of one measurement.
+#define WORK_PER_MEASUREMENT 500000
+#define MANIFEST_DOCUMENTS 16
+
+typedef struct {
+    char** names;
+    char** kubeconfigs;
+    size_t count;
+    char* manifests;
+} cluster_request;
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} text_buffer;
+
+static int g_failures;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void append(text_buffer* text, const char* data, size_t size) {
+    if (text->size + size + 1 > text->capacity) {
+        size_t capacity = text->capacity ? text->capacity : 4096;
+        while (capacity < text->size + size + 1) capacity *= 2;
+        char* grown = realloc(text->data, capacity);
+        if (!grown) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+        text->data = grown;
+        text->capacity = capacity;
+    }
+    memcpy(text->data + text->size, data, size);
+    text->size += size;
+    text->data[text->size] = '\0';
+}
+
+static void append_text(text_buffer* text, const char* data) {
+    append(text, data, strlen(data));
+}
+
+// Appends a JSON string literal.
+static void append_json_string(text_buffer* text, const char* value) {
+    append(text, "\"", 1);
+    const char* run = value;
+    for (const char* c = value; *c; ++c) {
+        const char* escape = *c == '"' ? "\\\"" : *c == '\\' ? "\\\\" : *c == '\n' ? "\\n" : NULL;
+        if (escape) {
+            append(text, run, (size_t)(c - run));
+            append_text(text, escape);
+            run = c + 1;
+        }
+    }
+    append_text(text, run);
+    append(text, "\"", 1);
+}
+
+// The request as the core formats it for `invoke`.
+static char* encode_json(const cluster_request* request) {
+    text_buffer text = {0};
+    append_text(&text, "{\"cluster_configs\":{");
+    for (size_t i = 0; i < request->count; ++i) {
+        if (i) append(&text, ",", 1);
+        append_json_string(&text, request->names[i]);
+        append(&text, ":", 1);
+        append_json_string(&text, request->kubeconfigs[i]);
+    }
+    append_text(&text, "},\"targets\":[");
+    for (size_t i = 0; i < request->count; ++i) {
+        append_text(&text, i ? ",{\"name\":" : "{\"name\":");
+        append_json_string(&text, request->names[i]);
+        append(&text, "}", 1);
+    }
+    append_text(&text, "],\"action\":{\"type\":\"apply\",\"manifests\":");
+    append_json_string(&text, request->manifests);
+    append_text(&text, "}}");
+    return text.data;
+}
+
+// The request as the core builds it for `invoke_buffer`.
+static int encode_payload(const cluster_request* request, ph_buffer* payload) {
+    ph_payload_builder builder;
+    ph_payload_init(&builder, PH_SCHEMA_MULTI_CLUSTER);
+    for (size_t i = 0; i < request->count; ++i) {
+        ph_payload_add_string(&builder, PH_MULTI_CLUSTER_CLUSTER_NAME, (uint32_t)i, request->names[i]);
+        ph_payload_add_string(&builder, PH_MULTI_CLUSTER_KUBECONFIG, (uint32_t)i, request->kubeconfigs[i]);
+    }
+    for (size_t i = 0; i < request->count; ++i) {
+        ph_payload_add_string(&builder, PH_MULTI_CLUSTER_TARGET, (uint32_t)i, request->names[i]);
+    }
+    ph_payload_add_u64(&builder, PH_MULTI_CLUSTER_ACTION, 0, 0);
+    ph_payload_add_string(&builder, PH_MULTI_CLUSTER_MANIFESTS, 0, request->manifests);
+    return ph_payload_finish(&builder, payload);
+}
+
+static void make_request(cluster_request* request, size_t count) {
+    request->count = count;
+    request->names = malloc(count * sizeof(char*));
+    request->kubeconfigs = malloc(count * sizeof(char*));
+    char line[128];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(line, sizeof(line), "prod-eu-west-%06zu", i);
+        request->names[i] = strdup(line);
+        snprintf(line, sizeof(line), "/etc/ph/clusters/prod-eu-west-%06zu/kubeconfig.yaml", i);
+        request->kubeconfigs[i] = strdup(line);
+    }
+    text_buffer manifests = {0};
+    for (int i = 0; i < MANIFEST_DOCUMENTS; ++i) {
+        snprintf(line, sizeof(line), "---\napiVersion: v1\nkind: ConfigMap\nmetadata:\n  name: \"settings-%d\"\n", i);
+        append_text(&manifests, line);
+        append_text(&manifests, "data:\n  greeting: \"hello\"\n  path: \"C:\\\\ph\\\\data\"\n");
+    }
+    request->manifests = manifests.data;
+}
+
+static void free_request(cluster_request* request) {
+    for (size_t i = 0; i < request->count; ++i) {
+        free(request->names[i]);
+        free(request->kubeconfigs[i]);
+    }
+    free(request->names);
+    free(request->kubeconfigs);
+    free(request->manifests);
+}
+
+static void check(int status, int expected, const char* path, size_t clusters) {
+    if (status != expected) {
+        printf("FAIL: %s request of %zu clusters returned %d, expected %d\n", path, clusters, status, expected);
+        g_failures++;
+    }
+}
+
+static void run_size(ffi_library* library, size_t clusters) {
+    cluster_request request;
+    make_request(&request, clusters);
+    int expected = (int)(clusters * 2);
+    int calls = (int)(WORK_PER_MEASUREMENT / clusters);
+    if (calls < 5) calls = 5;
+
+    char* sample = encode_json(&request);
+    size_t json_size = strlen(sample);
+    free(sample);
+    double start = now_ns();
+    for (int i = 0; i < calls; ++i) {
+        char* json = encode_json(&request);
+        check(ffi_library_invoke(library, json), expected, "JSON", clusters);
+        free(json);
+    }
+    double json_ns = (now_ns() - start) / calls;
+
+    ph_buffer payload;
+    size_t payload_size = encode_payload(&request, &payload) == 0 ? payload.size : 0;
+    ph_buffer_free(&payload);
+    start = now_ns();
+    for (int i = 0; i < calls; ++i) {
+        if (encode_payload(&request, &payload) != 0) {
+            printf("FAIL: could not build a payload of %zu clusters\n", clusters);
+            g_failures++;
+            break;
+        }
+        check(ffi_library_invoke_buffer(library, &payload), expected, "payload", clusters);
+        ph_buffer_free(&payload);
+    }
+    double payload_ns = (now_ns() - start) / calls;
+
+    printf("%7zu clusters  JSON %10.1f us/call %9zu bytes  payload %10.1f us/call %9zu bytes  %5.1fx\n",
+           clusters, json_ns / 1e3, json_size, payload_ns / 1e3, payload_size, json_ns / payload_ns);
+    free_request(&request);
+}
+
+// Usage: bench_ffi_payload <payload module library>
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <payload module library>\n", argv[0]);
+        return 2;
+    }
+    ffi_library* library = ffi_library_acquire(argv[1]);
+    if (!library) {
+        printf("FAIL: could not load %s\n", argv[1]);
+        return 1;
+    }
+
+    static const size_t sizes[] = {10, 1000, 100000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        run_size(library, sizes[i]);
+    }
+
+    // A payload for another module, or a JSON request in its place, must be
+    // rejected rather than misread.
+    ph_payload_builder builder;
+    ph_payload_init(&builder, PH_SCHEMA_PREVIEW);
+    ph_payload_add_u64(&builder, PH_PREVIEW_PR_NUMBER, 0, 42);
+    ph_buffer payload;
+    if (ph_payload_finish(&builder, &payload) == 0) {
+        check(ffi_library_invoke_buffer(library, &payload), -1, "wrong-schema", 0);
+        ph_buffer_free(&payload);
+    }
+    const char json[] = "{\"cluster_configs\":{}}";
+    ph_buffer not_a_payload = {(const uint8_t*)json, sizeof(json), NULL, NULL};
+    check(ffi_library_invoke_buffer(library, &not_a_payload), -1, "non-payload", 0);
+
+    ffi_library_release(library);
+    ffi_shutdown();
+
+    if (g_failures != 0) {
+        printf("FAIL: %d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("PASS: both paths decoded every request\n");
+    return 0;
+}
@@ -0,0 +1,208 @@
+// tests/benchmarks/bench_lua_bytecode_cache.c
+// Loading a large plugin set from source against the bytecode cache.
+//
+// Copies the given plugin (src/plugins/example.lua) 64 times into a
+// temporary plugins directory, then loads the whole set three times, each
+// into a fresh Lua state with a stand-in `ph` table: from source, with an
+// empty cache (compiling and saving bytecode), and with a filled cache.
+// Each pass reports the time spent loading chunks apart from the time spent
+// running them; with the cache filled, loading should no longer dominate.
+//
+// The stand-in counts hook registrations, so a plugin that is not run, or
+// runs differently from cached bytecode, makes the benchmark fail. Also
+// checks that editing a plugin invalidates its cached bytecode.
+
+#include "scripting/lua_bytecode_cache.h"
+#include <lauxlib.h>
+#include <lualib.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PLUGIN_COPIES 64
+
+static int g_failures;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void expect(int condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        g_failures++;
+    }
+}
+
+static char* read_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = length >= 0 ? malloc((size_t)length + 1) : NULL;
+    if (data && fread(data, 1, (size_t)length, file) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    if (data) *size = (size_t)length;
+    return data;
+}
+
+static int write_file(const char* path, const char* data, size_t size, const char* mode) {
+    FILE* file = fopen(path, mode);
+    if (!file) return -1;
+    int ok = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok ? 0 : -1;
+}
+
+static int count_files(const char* directory) {
+    DIR* dir = opendir(directory);
+    if (!dir) return 0;
+    int count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') count++;
+    }
+    closedir(dir);
+    return count;
+}
+
+// Every `ph.*` function is a no-op returning true, except register_hook,
+// which counts its calls.
+static lua_State* new_session(void) {
+    lua_State* L = luaL_newstate();
+    if (!L) return NULL;
+    luaL_openlibs(L);
+    const char* stand_in =
+        "hooks = 0\n"
+        "ph = setmetatable({ register_hook = function() hooks = hooks + 1 return true end },\n"
+        "                  { __index = function() return function() return true end end })\n";
+    if (luaL_dostring(L, stand_in) != LUA_OK) {
+        lua_close(L);
+        return NULL;
+    }
+    return L;
+}
+
+static lua_Integer read_global(lua_State* L, const char* name) {
+    lua_getglobal(L, name);
+    lua_Integer value = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+    return value;
+}
+
+// Loads and runs every plugin, as the bridge does at startup.
+static lua_Integer load_plugins(const char* plugin_dir, const char* cache_dir, const char* label) {
+    lua_State* L = new_session();
+    if (!L) {
+        printf("FAIL: could not create a Lua state\n");
+        g_failures++;
+        return -1;
+    }
+    char path[1024];
+    double load_ms = 0;
+    double run_ms = 0;
+    for (int i = 0; i < PLUGIN_COPIES; ++i) {
+        snprintf(path, sizeof(path), "%s/plugin_%02d.lua", plugin_dir, i);
+        double start = now_ms();
+        int status = lua_bytecode_cache_load(L, cache_dir, path);
+        double loaded = now_ms();
+        if (status == LUA_OK) {
+            status = lua_pcall(L, 0, 0, 0);
+        }
+        run_ms += now_ms() - loaded;
+        load_ms += loaded - start;
+        if (status != LUA_OK) {
+            printf("FAIL: %s: %s\n", path, lua_tostring(L, -1));
+            g_failures++;
+            lua_pop(L, 1);
+        }
+    }
+    lua_Integer hooks = read_global(L, "hooks");
+    printf("%-14s load %8.2f ms  run %8.2f ms  load share %5.1f%%\n", label, load_ms, run_ms,
+           100.0 * load_ms / (load_ms + run_ms));
+    lua_close(L);
+    return hooks;
+}
+
+// Usage: bench_lua_bytecode_cache <plugin.lua>
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <plugin.lua>\n", argv[0]);
+        return 2;
+    }
+    size_t source_size = 0;
+    char* source = read_file(argv[1], &source_size);
+    if (!source) {
+        printf("FAIL: could not read %s\n", argv[1]);
+        return 1;
+    }
+
+    char root[] = "/tmp/ph_luac_bench_XXXXXX";
+    if (!mkdtemp(root)) {
+        printf("FAIL: could not create a temporary directory\n");
+        free(source);
+        return 1;
+    }
+    char plugin_dir[sizeof(root) + 16];
+    char cache_dir[sizeof(root) + 16];
+    snprintf(plugin_dir, sizeof(plugin_dir), "%s/plugins", root);
+    snprintf(cache_dir, sizeof(cache_dir), "%s/luac", root);
+    if (mkdir(plugin_dir, 0700) != 0) {
+        printf("FAIL: could not create %s\n", plugin_dir);
+        free(source);
+        return 1;
+    }
+    char path[1024];
+    for (int i = 0; i < PLUGIN_COPIES; ++i) {
+        snprintf(path, sizeof(path), "%s/plugin_%02d.lua", plugin_dir, i);
+        expect(write_file(path, source, source_size, "wb") == 0, "could not write a plugin");
+    }
+
+    printf("%d copies of %s, %zu bytes each\n", PLUGIN_COPIES, argv[1], source_size);
+    lua_Integer from_source = load_plugins(plugin_dir, NULL, "source");
+    lua_Integer cold = load_plugins(plugin_dir, cache_dir, "cache, empty");
+    expect(count_files(cache_dir) == PLUGIN_COPIES, "not every plugin was cached");
+    lua_Integer warm = load_plugins(plugin_dir, cache_dir, "cache, filled");
+    expect(from_source > 0, "the plugins registered no hook");
+    expect(cold == from_source && warm == from_source, "cached plugins ran differently");
+
+    // An edited plugin is compiled again, not served from the cache.
+    snprintf(path, sizeof(path), "%s/plugin_00.lua", plugin_dir);
+    const char edit[] = "\nph.register_hook(\"post-merge\", \"backup_hook\")\n";
+    expect(write_file(path, edit, sizeof(edit) - 1, "ab") == 0, "could not edit a plugin");
+    expect(load_plugins(plugin_dir, cache_dir, "one edited") == from_source + 1,
+           "an edited plugin was loaded from stale bytecode");
+
+    for (int i = 0; i < PLUGIN_COPIES; ++i) {
+        snprintf(path, sizeof(path), "%s/plugin_%02d.lua", plugin_dir, i);
+        remove(path);
+    }
+    DIR* dir = opendir(cache_dir);
+    struct dirent* entry;
+    while (dir && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", cache_dir, entry->d_name);
+        remove(path);
+    }
+    if (dir) closedir(dir);
+    rmdir(cache_dir);
+    rmdir(plugin_dir);
+    rmdir(root);
+    free(source);
+
+    if (g_failures != 0) {
+        printf("FAIL: %d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("PASS: every plugin ran the same from source and from cache\n");
+    return 0;
+}
@@ -0,0 +1,168 @@
+// tests/benchmarks/bench_lua_dispatch.c
+// Cost of dispatching a Lua hook by global name against a pinned reference.
+//
+// Loads a session that looks like one with a few plugins: a few hundred
+// globals, and 1 or 8 functions registered for "pre-commit". Each dispatch
+// then runs every function of the hook with two string arguments, either
+// looking each one up in `_G` by name and checking it is a function, as the
+// bridge used to, or fetching it from the registry with `lua_rawgeti` on the
+// reference taken at registration, as it does now.
+//
+// Every hook function counts its calls, so a dispatch that skips or repeats
+// a function makes the benchmark fail. Also checks that a pinned function
+// keeps being called after its global is redefined.
+
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define DISPATCHES 200000
+#define MAX_HOOK_FUNCTIONS 8
+#define OTHER_GLOBALS 500
+
+static int g_failures;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void expect(int condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        g_failures++;
+    }
+}
+
+static lua_Integer read_calls(lua_State* L) {
+    lua_getglobal(L, "calls");
+    lua_Integer calls = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+    lua_pushinteger(L, 0);
+    lua_setglobal(L, "calls");
+    return calls;
+}
+
+static int run_chunk(lua_State* L, const char* chunk) {
+    if (luaL_dostring(L, chunk) != LUA_OK) {
+        printf("FAIL: %s\n", lua_tostring(L, -1));
+        lua_pop(L, 1);
+        g_failures++;
+        return -1;
+    }
+    return 0;
+}
+
+// Defines the hook functions and the globals of the other plugins.
+static lua_State* make_session(void) {
+    lua_State* L = luaL_newstate();
+    if (!L) return NULL;
+    luaL_openlibs(L);
+    char chunk[256];
+    snprintf(chunk, sizeof(chunk),
+             "calls = 0\n"
+             "for i = 1, %d do\n"
+             "  _G['pre_commit_' .. i] = function(branch, message) calls = calls + 1 end\n"
+             "end\n"
+             "for i = 1, %d do _G['plugin_value_' .. i] = i end\n",
+             MAX_HOOK_FUNCTIONS, OTHER_GLOBALS);
+    if (run_chunk(L, chunk) != 0) {
+        lua_close(L);
+        return NULL;
+    }
+    return L;
+}
+
+static void push_arguments(lua_State* L) {
+    lua_pushstring(L, "main");
+    lua_pushstring(L, "Fix the cache eviction order");
+}
+
+static void dispatch_by_name(lua_State* L, char names[][32], int count) {
+    for (int i = 0; i < count; ++i) {
+        lua_getglobal(L, names[i]);
+        if (!lua_isfunction(L, -1)) {
+            lua_pop(L, 1);
+            continue;
+        }
+        push_arguments(L);
+        if (lua_pcall(L, 2, 0, 0) != LUA_OK) {
+            lua_pop(L, 1);
+        }
+    }
+}
+
+static void dispatch_by_reference(lua_State* L, const int* refs, int count) {
+    for (int i = 0; i < count; ++i) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, refs[i]);
+        push_arguments(L);
+        if (lua_pcall(L, 2, 0, 0) != LUA_OK) {
+            lua_pop(L, 1);
+        }
+    }
+}
+
+static void run_hook_size(lua_State* L, int count) {
+    char names[MAX_HOOK_FUNCTIONS][32];
+    int refs[MAX_HOOK_FUNCTIONS];
+    for (int i = 0; i < count; ++i) {
+        snprintf(names[i], sizeof(names[i]), "pre_commit_%d", i + 1);
+        lua_getglobal(L, names[i]);
+        refs[i] = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+    lua_Integer expected = (lua_Integer)DISPATCHES * count;
+
+    double start = now_ns();
+    for (int i = 0; i < DISPATCHES; ++i) {
+        dispatch_by_name(L, names, count);
+    }
+    double name_ns = (now_ns() - start) / DISPATCHES;
+    expect(read_calls(L) == expected, "dispatch by name lost or repeated calls");
+
+    start = now_ns();
+    for (int i = 0; i < DISPATCHES; ++i) {
+        dispatch_by_reference(L, refs, count);
+    }
+    double ref_ns = (now_ns() - start) / DISPATCHES;
+    expect(read_calls(L) == expected, "dispatch by reference lost or repeated calls");
+    expect(lua_gettop(L) == 0, "dispatch left values on the stack");
+
+    printf("pre-commit, %d function%s  by name %7.1f ns/dispatch  by reference %7.1f ns/dispatch  %4.2fx\n",
+           count, count == 1 ? " " : "s", name_ns, ref_ns, name_ns / ref_ns);
+
+    for (int i = 0; i < count; ++i) {
+        luaL_unref(L, LUA_REGISTRYINDEX, refs[i]);
+    }
+}
+
+int main(void) {
+    lua_State* L = make_session();
+    if (!L) {
+        printf("FAIL: could not create the Lua session\n");
+        return 1;
+    }
+
+    run_hook_size(L, 1);
+    run_hook_size(L, MAX_HOOK_FUNCTIONS);
+
+    // A pinned function is the one registered, whatever the global holds now.
+    lua_getglobal(L, "pre_commit_1");
+    int ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    if (run_chunk(L, "pre_commit_1 = nil") == 0) {
+        dispatch_by_reference(L, &ref, 1);
+        expect(read_calls(L) == 1, "a pinned function was lost with its global");
+    }
+    luaL_unref(L, LUA_REGISTRYINDEX, ref);
+    lua_close(L);
+
+    if (g_failures != 0) {
+        printf("FAIL: %d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("PASS: both paths ran every hook function once per dispatch\n");
+    return 0;
+}
@@ -0,0 +1,56 @@
+// tests/benchmarks/ffi_bench_module.c
+// A stand-in for a Rust FFI module, for bench_ffi_call and bench_ffi_async.
+//
+// It exports the `invoke` entry point of the FFI contract and returns the
+// length of the JSON it is given, so the benchmark can check that every
+// call reached it with the right argument.
+//
+// It also exports `invoke_cancellable`, which stands for a long operation:
+// it works for as many milliseconds as the payload's first integer field
+// says, checking its cancel token every millisecond, and returns the
+// payload's second integer field, or PH_STATUS_CANCELLED if it was stopped.
+
+#include "ffi/rust_ffi.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT __attribute__((visibility("default")))
+#endif
+
+EXPORT int invoke(const char* json_config) {
+    return json_config ? (int)strlen(json_config) : -1;
+}
+
+static void sleep_1ms(void) {
+#ifdef _WIN32
+    Sleep(1);
+#else
+    struct timespec step = {0, 1000000L};
+    nanosleep(&step, NULL);
+#endif
+}
+
+EXPORT int invoke_cancellable(const ph_buffer* payload, const ph_cancel_token* cancel) {
+    ph_payload_header header;
+    if (!payload || !cancel || payload->size < sizeof(header)) return -1;
+    memcpy(&header, payload->data, sizeof(header));
+    if (header.magic != PH_PAYLOAD_MAGIC || header.field_count < 2 ||
+        payload->size < sizeof(header) + 2 * sizeof(ph_payload_field)) {
+        return -1;
+    }
+    ph_payload_field fields[2];
+    memcpy(fields, payload->data + sizeof(header), sizeof(fields));
+
+    for (uint64_t elapsed = 0; elapsed < fields[0].value; ++elapsed) {
+        if (atomic_load_explicit(&cancel->cancelled, memory_order_acquire)) {
+            return PH_STATUS_CANCELLED;
+        }
+        sleep_1ms();
+    }
+    return (int)fields[1].value;
+}
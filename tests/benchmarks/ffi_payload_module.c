@@ -0,0 +1,281 @@
+// tests/benchmarks/ffi_payload_module.c
+// A stand-in for the multi_cluster_orchestrator Rust module, for
+// bench_ffi_payload.
+//
+// It exports both entry points of the FFI contract and does what a module
+// does with each before any business logic runs:
+// - `invoke` parses the JSON request into a tree of owned values, copying
+//   and unescaping every string, as serde_json does into the module's
+//   config structs.
+// - `invoke_buffer` validates a PH_SCHEMA_MULTI_CLUSTER payload and reads
+//   its fields in place, checking every string, as the Rust payload reader
+//   does.
+// Both return the number of clusters plus the number of targets, or -1 for
+// an invalid request, so the benchmark can check that they agree.
+
+#include "ffi/rust_ffi.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT __attribute__((visibility("default")))
+#endif
+
+// --- JSON ---
+
+typedef enum { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT } json_type;
+
+typedef struct json_value {
+    json_type type;
+    char* string;               // JSON_STRING.
+    double number;              // JSON_NUMBER, JSON_BOOL.
+    struct json_value* items;   // JSON_ARRAY elements, JSON_OBJECT values.
+    char** keys;                // JSON_OBJECT.
+    size_t count;
+} json_value;
+
+typedef struct {
+    const char* cursor;
+    int depth;
+} json_parser;
+
+static void json_free(json_value* value) {
+    for (size_t i = 0; i < value->count; ++i) {
+        json_free(&value->items[i]);
+        if (value->keys) {
+            free(value->keys[i]);
+        }
+    }
+    free(value->items);
+    free(value->keys);
+    free(value->string);
+}
+
+static void skip_space(json_parser* parser) {
+    while (*parser->cursor == ' ' || *parser->cursor == '\n' || *parser->cursor == '\r' ||
+           *parser->cursor == '\t') {
+        parser->cursor++;
+    }
+}
+
+static int parse_hex4(const char* text, unsigned* code) {
+    *code = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = text[i];
+        unsigned digit = c >= '0' && c <= '9' ? (unsigned)(c - '0')
+                       : c >= 'a' && c <= 'f' ? (unsigned)(c - 'a' + 10)
+                       : c >= 'A' && c <= 'F' ? (unsigned)(c - 'A' + 10) : 16;
+        if (digit == 16) return -1;
+        *code = *code * 16 + digit;
+    }
+    return 0;
+}
+
+// Parses a string into a new allocation. The cursor is on the opening quote.
+static char* parse_string(json_parser* parser) {
+    const char* start = ++parser->cursor;
+    size_t length = 0;
+    while (*parser->cursor != '"') {
+        if (*parser->cursor == '\0') return NULL;
+        parser->cursor += *parser->cursor == '\\' && parser->cursor[1] ? 2 : 1;
+        length++;
+    }
+    char* text = malloc(length * 3 + 1); // \uXXXX expands to at most 3 bytes.
+    if (!text) return NULL;
+    char* out = text;
+    for (const char* in = start; in < parser->cursor; ++in) {
+        if (*in != '\\') {
+            *out++ = *in;
+            continue;
+        }
+        switch (*++in) {
+        case 'n': *out++ = '\n'; break;
+        case 't': *out++ = '\t'; break;
+        case 'r': *out++ = '\r'; break;
+        case 'b': *out++ = '\b'; break;
+        case 'f': *out++ = '\f'; break;
+        case 'u': {
+            unsigned code;
+            if (parse_hex4(in + 1, &code) != 0) {
+                free(text);
+                return NULL;
+            }
+            in += 4;
+            if (code < 0x80) {
+                *out++ = (char)code;
+            } else if (code < 0x800) {
+                *out++ = (char)(0xC0 | code >> 6);
+                *out++ = (char)(0x80 | (code & 0x3F));
+            } else {
+                *out++ = (char)(0xE0 | code >> 12);
+                *out++ = (char)(0x80 | (code >> 6 & 0x3F));
+                *out++ = (char)(0x80 | (code & 0x3F));
+            }
+            break;
+        }
+        default: *out++ = *in; break;
+        }
+    }
+    *out = '\0';
+    parser->cursor++;
+    return text;
+}
+
+static int parse_value(json_parser* parser, json_value* value);
+
+// Parses the elements of an array, or the members of an object.
+static int parse_container(json_parser* parser, json_value* value, char close) {
+    size_t capacity = 0;
+    parser->cursor++;
+    skip_space(parser);
+    if (*parser->cursor == close) {
+        parser->cursor++;
+        return 0;
+    }
+    for (;;) {
+        if (value->count == capacity) {
+            capacity = capacity ? capacity * 2 : 4;
+            json_value* items = realloc(value->items, capacity * sizeof(json_value));
+            if (!items) return -1;
+            value->items = items;
+            if (close == '}') {
+                char** keys = realloc(value->keys, capacity * sizeof(char*));
+                if (!keys) return -1;
+                value->keys = keys;
+            }
+        }
+        json_value* item = &value->items[value->count];
+        memset(item, 0, sizeof(*item));
+        if (close == '}') {
+            skip_space(parser);
+            value->keys[value->count] = *parser->cursor == '"' ? parse_string(parser) : NULL;
+            value->count++;
+            if (!value->keys[value->count - 1]) return -1;
+            skip_space(parser);
+            if (*parser->cursor++ != ':') return -1;
+        } else {
+            value->count++;
+        }
+        if (parse_value(parser, item) != 0) return -1;
+        skip_space(parser);
+        if (*parser->cursor == ',') {
+            parser->cursor++;
+        } else if (*parser->cursor == close) {
+            parser->cursor++;
+            return 0;
+        } else {
+            return -1;
+        }
+    }
+}
+
+static int parse_value(json_parser* parser, json_value* value) {
+    skip_space(parser);
+    switch (*parser->cursor) {
+    case '{':
+    case '[':
+        if (++parser->depth > 64) return -1;
+        value->type = *parser->cursor == '{' ? JSON_OBJECT : JSON_ARRAY;
+        int status = parse_container(parser, value, *parser->cursor == '{' ? '}' : ']');
+        parser->depth--;
+        return status;
+    case '"':
+        value->type = JSON_STRING;
+        value->string = parse_string(parser);
+        return value->string ? 0 : -1;
+    case 't':
+    case 'f':
+    case 'n': {
+        const char* word = *parser->cursor == 't' ? "true" : *parser->cursor == 'f' ? "false" : "null";
+        size_t length = strlen(word);
+        if (strncmp(parser->cursor, word, length) != 0) return -1;
+        value->type = *word == 'n' ? JSON_NULL : JSON_BOOL;
+        value->number = *word == 't';
+        parser->cursor += length;
+        return 0;
+    }
+    default: {
+        char* end;
+        value->type = JSON_NUMBER;
+        value->number = strtod(parser->cursor, &end);
+        if (end == parser->cursor) return -1;
+        parser->cursor = end;
+        return 0;
+    }
+    }
+}
+
+static const json_value* json_member(const json_value* object, const char* key, json_type type) {
+    if (object->type != JSON_OBJECT) return NULL;
+    for (size_t i = 0; i < object->count; ++i) {
+        if (strcmp(object->keys[i], key) == 0) {
+            return object->items[i].type == type ? &object->items[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+static int read_json_request(const json_value* root) {
+    const json_value* clusters = json_member(root, "cluster_configs", JSON_OBJECT);
+    const json_value* targets = json_member(root, "targets", JSON_ARRAY);
+    const json_value* action = json_member(root, "action", JSON_OBJECT);
+    if (!clusters || !targets || !action || !json_member(action, "type", JSON_STRING)) return -1;
+    for (size_t i = 0; i < clusters->count; ++i) {
+        if (clusters->items[i].type != JSON_STRING) return -1;
+    }
+    for (size_t i = 0; i < targets->count; ++i) {
+        if (!json_member(&targets->items[i], "name", JSON_STRING)) return -1;
+    }
+    return (int)(clusters->count + targets->count);
+}
+
+EXPORT int invoke(const char* json_config) {
+    if (!json_config) return -1;
+    json_parser parser = {json_config, 0};
+    json_value root;
+    memset(&root, 0, sizeof(root));
+    int status = parse_value(&parser, &root) == 0 ? read_json_request(&root) : -1;
+    json_free(&root);
+    return status;
+}
+
+// --- Payload ---
+
+EXPORT int invoke_buffer(const ph_buffer* payload) {
+    if (!payload || !payload->data || payload->size < sizeof(ph_payload_header)) return -1;
+    ph_payload_header header;
+    memcpy(&header, payload->data, sizeof(header));
+    if (header.magic != PH_PAYLOAD_MAGIC || header.version != PH_PAYLOAD_VERSION ||
+        header.schema != PH_SCHEMA_MULTI_CLUSTER || header.size != payload->size ||
+        header.field_count > (header.size - sizeof(header)) / sizeof(ph_payload_field) ||
+        header.strings_offset < sizeof(header) + (size_t)header.field_count * sizeof(ph_payload_field) ||
+        header.strings_size > header.size - header.strings_offset) {
+        return -1;
+    }
+    const ph_payload_field* fields = (const ph_payload_field*)(payload->data + sizeof(header));
+    const char* strings = (const char*)payload->data + header.strings_offset;
+
+    int clusters = 0;
+    int targets = 0;
+    int has_action = 0;
+    for (uint32_t i = 0; i < header.field_count; ++i) {
+        const ph_payload_field* field = &fields[i];
+        if (field->type == PH_FIELD_STRING) {
+            uint64_t offset = field->value & UINT32_MAX;
+            uint64_t length = field->value >> 32;
+            // The checks of a UTF-8 string slice: in bounds, and scanned.
+            if (offset + length > header.strings_size || strnlen(strings + offset, length) != length) {
+                return -1;
+            }
+        }
+        switch (field->id) {
+        case PH_MULTI_CLUSTER_CLUSTER_NAME: clusters++; break;
+        case PH_MULTI_CLUSTER_TARGET: targets++; break;
+        case PH_MULTI_CLUSTER_ACTION: has_action = field->type == PH_FIELD_U64; break;
+        default: break;
+        }
+    }
+    return has_action ? clusters + targets : -1;
+}
@@ -0,0 +1,279 @@
+// tests/test_binary_log.cpp
+// Round trip through the binary log: events written by BinaryLogSink are
+// decoded with BinaryLogReader, rendered and filtered as ph-logcat does.
+
+#include "libs/liblogger/BinaryLogFormat.hpp"
+#include "libs/liblogger/BinaryLogSink.hpp"
+#include <cassert>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Base time of the events written by the tests, in microseconds.
+static const int64_t kBaseTimeUs = 1750000000LL * 1000000;
+
+struct DecodedEvent {
+    int64_t time_us;
+    phLogLevel level;
+    std::string module;
+    std::string message;
+};
+
+static std::chrono::system_clock::time_point at(int64_t offset_us) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::microseconds(kBaseTimeUs + offset_us)));
+}
+
+static void write_event(BinaryLogSink& sink, int64_t offset_us, phLogLevel level,
+                        const char* module_name, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    sink.write_formatted(at(offset_us), level, module_name, format, args);
+    va_end(args);
+}
+
+static std::string segment_path(const std::string& prefix, int number) {
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%06d" BINARY_LOG_EXTENSION, number);
+    return prefix + suffix;
+}
+
+static std::vector<uint8_t> read_segment(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    assert(file);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// Decodes the events of a segment that `filter` selects. Returns false if
+// the segment is rejected or ends in a corrupt entry.
+static bool decode_segment(const std::vector<uint8_t>& data, const BinaryLogFilter& filter,
+                           std::vector<DecodedEvent>& events) {
+    BinaryLogReader reader;
+    std::string error;
+    if (!reader.open(data.data(), data.size(), error)) {
+        return false;
+    }
+    BinaryLogEvent event;
+    while (reader.next(event)) {
+        if (!filter.matches(event)) {
+            continue;
+        }
+        DecodedEvent decoded;
+        decoded.time_us = event.time_us;
+        decoded.level = event.level;
+        decoded.module = event.module;
+        binlog_render(decoded.message, event.format, event.args, event.args_length);
+        events.push_back(decoded);
+    }
+    return reader.error().empty();
+}
+
+static void remove_segments(const std::string& prefix) {
+    for (int i = 0; i < 16; ++i) {
+        remove(segment_path(prefix, i).c_str());
+    }
+}
+
+void test_binary_log_round_trip() {
+    printf("Running test: test_binary_log_round_trip...\n");
+
+    const std::string prefix = "test_binlog_round_trip";
+    remove_segments(prefix);
+    BinaryLogSink sink;
+    std::string error;
+    assert(sink.open(prefix, 0, error));
+
+    write_event(sink, 0, LOG_LEVEL_INFO, "CORE", "started %d modules in %.3f s", 3, 0.25);
+    write_event(sink, 10, LOG_LEVEL_DEBUG, "SYNC", "fetching %s (%u/%u)", "origin", 1u, 2u);
+    write_event(sink, 20, LOG_LEVEL_WARN, "SYNC", "retry %lld of %ld, delta %d", -1LL, 300000000000L, -42);
+    write_event(sink, 30, LOG_LEVEL_ERROR, "CORE", "clipped '%.4s', padded '%-6s|', width %*d", "truncate",
+                "ab", 5, 7);
+    write_event(sink, 25, LOG_LEVEL_INFO, "LUA", "%%s is literal, 100%% %s", "done");
+    const char message[] = "pre-formatted, with %s and %d left alone";
+    sink.write_message(at(40), LOG_LEVEL_FATAL, "CORE", message, sizeof(message) - 1);
+    sink.close();
+
+    std::vector<DecodedEvent> events;
+    assert(decode_segment(read_segment(segment_path(prefix, 0)), BinaryLogFilter(), events));
+    assert(events.size() == 6);
+
+    const char* expected[] = {
+        "started 3 modules in 0.250 s",
+        "fetching origin (1/2)",
+        "retry -1 of 300000000000, delta -42",
+        "clipped 'trun', padded 'ab    |', width     7",
+        "%s is literal, 100% done",
+        "pre-formatted, with %s and %d left alone",
+    };
+    const int64_t offsets[] = {0, 10, 20, 30, 25, 40};
+    const phLogLevel levels[] = {LOG_LEVEL_INFO, LOG_LEVEL_DEBUG, LOG_LEVEL_WARN,
+                                 LOG_LEVEL_ERROR, LOG_LEVEL_INFO, LOG_LEVEL_FATAL};
+    const char* modules[] = {"CORE", "SYNC", "SYNC", "CORE", "LUA", "CORE"};
+    for (size_t i = 0; i < events.size(); ++i) {
+        assert(events[i].message == expected[i]);
+        assert(events[i].time_us == kBaseTimeUs + offsets[i]);
+        assert(events[i].level == levels[i]);
+        assert(events[i].module == modules[i]);
+    }
+    printf("  [PASS] Arguments, levels, modules and timestamps survive the round trip\n");
+
+    remove_segments(prefix);
+    printf("Test finished.\n\n");
+}
+
+void test_binary_log_filters() {
+    printf("Running test: test_binary_log_filters...\n");
+
+    const std::string prefix = "test_binlog_filters";
+    remove_segments(prefix);
+    BinaryLogSink sink;
+    std::string error;
+    assert(sink.open(prefix, 0, error));
+    const char* module_names[] = {"CORE", "SYNC", "LUA"};
+    const phLogLevel levels[] = {LOG_LEVEL_DEBUG, LOG_LEVEL_INFO, LOG_LEVEL_WARN, LOG_LEVEL_ERROR};
+    for (int i = 0; i < 120; ++i) {
+        write_event(sink, i * 1000, levels[i % 4], module_names[i % 3], "event %d", i);
+    }
+    sink.close();
+    std::vector<uint8_t> data = read_segment(segment_path(prefix, 0));
+
+    auto decode = [&data](const BinaryLogFilter& filter) {
+        std::vector<DecodedEvent> events;
+        assert(decode_segment(data, filter, events));
+        return events;
+    };
+
+    BinaryLogFilter by_level;
+    by_level.min_level = LOG_LEVEL_WARN;
+    std::vector<DecodedEvent> events = decode(by_level);
+    assert(events.size() == 60);
+    for (const DecodedEvent& event : events) {
+        assert(event.level >= LOG_LEVEL_WARN);
+    }
+    printf("  [PASS] Level filter keeps events at or above the level\n");
+
+    BinaryLogFilter by_module;
+    by_module.modules = {"SYNC", "LUA"};
+    events = decode(by_module);
+    assert(events.size() == 80);
+    for (const DecodedEvent& event : events) {
+        assert(event.module != "CORE");
+    }
+    printf("  [PASS] Module filter keeps only the listed modules\n");
+
+    BinaryLogFilter by_time;
+    by_time.since_us = kBaseTimeUs + 10 * 1000;
+    by_time.until_us = kBaseTimeUs + 20 * 1000;
+    events = decode(by_time);
+    assert(events.size() == 10);
+    assert(events.front().message == "event 10" && events.back().message == "event 19");
+    printf("  [PASS] Time range includes its start and excludes its end\n");
+
+    BinaryLogFilter combined;
+    combined.min_level = LOG_LEVEL_ERROR;
+    combined.modules = {"CORE"};
+    combined.since_us = kBaseTimeUs + 60 * 1000;
+    events = decode(combined);
+    // i % 4 == 3 and i % 3 == 0 for i >= 60: 63, 75, ..., 111.
+    assert(events.size() == 5);
+    assert(events.front().message == "event 63" && events.back().message == "event 111");
+    printf("  [PASS] Filters combine\n");
+
+    remove_segments(prefix);
+    printf("Test finished.\n\n");
+}
+
+void test_binary_log_segments() {
+    printf("Running test: test_binary_log_segments...\n");
+
+    const std::string prefix = "test_binlog_segments";
+    remove_segments(prefix);
+    BinaryLogSink sink;
+    std::string error;
+    assert(sink.open(prefix, BINARY_LOG_MIN_SEGMENT_SIZE, error));
+    const std::string padding(200, 'x');
+    const int count = 1000; // About 200 KiB, so several segments.
+    for (int i = 0; i < count; ++i) {
+        write_event(sink, i, LOG_LEVEL_INFO, i % 2 ? "SYNC" : "CORE", "event %d %s", i, padding.c_str());
+    }
+    sink.close();
+    assert(sink.dropped_count() == 0);
+
+    // Every segment decodes on its own, and together they hold every event
+    // once, in order.
+    int segments = 0;
+    int next = 0;
+    for (int number = 0; number < 16; ++number) {
+        std::ifstream exists(segment_path(prefix, number));
+        if (!exists) {
+            break;
+        }
+        std::vector<DecodedEvent> events;
+        assert(decode_segment(read_segment(segment_path(prefix, number)), BinaryLogFilter(), events));
+        assert(!events.empty());
+        for (const DecodedEvent& event : events) {
+            char expected[32];
+            snprintf(expected, sizeof(expected), "event %d ", next);
+            assert(event.message == expected + padding);
+            assert(event.time_us == kBaseTimeUs + next);
+            assert(event.module == (next % 2 ? "SYNC" : "CORE"));
+            next++;
+        }
+        segments++;
+    }
+    assert(segments >= 3);
+    assert(next == count);
+    printf("  [PASS] %d events over %d self-contained segments\n", count, segments);
+
+    remove_segments(prefix);
+    printf("Test finished.\n\n");
+}
+
+void test_binary_log_damaged_segment() {
+    printf("Running test: test_binary_log_damaged_segment...\n");
+
+    const std::string prefix = "test_binlog_damaged";
+    remove_segments(prefix);
+    BinaryLogSink sink;
+    std::string error;
+    assert(sink.open(prefix, 0, error));
+    for (int i = 0; i < 10; ++i) {
+        write_event(sink, i, LOG_LEVEL_INFO, "CORE", "event %d", i);
+    }
+    sink.close();
+    std::vector<uint8_t> data = read_segment(segment_path(prefix, 0));
+
+    // A segment cut inside its last event yields the complete events before
+    // it and reports the truncation.
+    std::vector<uint8_t> truncated(data.begin(), data.end() - 2);
+    std::vector<DecodedEvent> events;
+    assert(!decode_segment(truncated, BinaryLogFilter(), events));
+    assert(events.size() == 9);
+    printf("  [PASS] Truncated segment decodes up to its last complete event\n");
+
+    std::vector<uint8_t> bad_magic = data;
+    bad_magic[0] ^= 0xFF;
+    events.clear();
+    assert(!decode_segment(bad_magic, BinaryLogFilter(), events));
+    assert(events.empty());
+    printf("  [PASS] Segment with a bad magic is rejected\n");
+
+    remove_segments(prefix);
+    printf("Test finished.\n\n");
+}
+
+int main() {
+    test_binary_log_round_trip();
+    test_binary_log_filters();
+    test_binary_log_segments();
+    test_binary_log_damaged_segment();
+
+    printf("All binary log tests passed!\n");
+    return 0;
+}
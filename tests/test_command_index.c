@@ -0,0 +1,151 @@
+// tests/test_command_index.c
+// The command index: names sharing a home slot, growth, and removal by
+// handler kind with backward shift deletion, across the end of the slots.
+
+#include "module_loader/command_index.h"
+#include "config/config_table.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+// The index starts with 64 slots, so a name's home slot is the low six bits
+// of its hash while it holds at most 32 commands.
+#define TEST_INDEX_CAPACITY 64
+
+// Fills `names` with `count` distinct names whose home slot is `home`.
+static void find_names_with_home(size_t home, char names[][32], int count) {
+    int found = 0;
+    for (int i = 0; found < count; ++i) {
+        snprintf(names[found], sizeof(names[found]), "cmd-%d", i);
+        if ((config_table_hash(names[found], strlen(names[found])) & (TEST_INDEX_CAPACITY - 1)) == home) {
+            found++;
+        }
+    }
+}
+
+static CommandHandler test_handler(CommandHandlerKind kind, size_t tag) {
+    CommandHandler handler;
+    memset(&handler, 0, sizeof(handler));
+    handler.kind = kind;
+    handler.lua_command = tag; // Identifies the handler found.
+    return handler;
+}
+
+void test_command_index_collisions() {
+    printf("Running test: test_command_index_collisions...\n");
+
+    char names[8][32];
+    find_names_with_home(5, names, 8);
+    for (int i = 0; i < 8; ++i) {
+        CommandHandler handler = test_handler(COMMAND_HANDLER_LUA, (size_t)i);
+        assert(command_index_add(names[i], &handler) == ph_SUCCESS);
+    }
+    assert(command_index_count() == 8);
+    for (int i = 0; i < 8; ++i) {
+        const CommandHandler* found = command_index_find(names[i]);
+        assert(found != NULL && found->lua_command == (size_t)i);
+    }
+    char absent[1][32];
+    find_names_with_home(6, absent, 1);
+    assert(command_index_find(absent[0]) == NULL);
+    printf("  [PASS] Names sharing a home slot are all found\n");
+
+    CommandHandler duplicate = test_handler(COMMAND_HANDLER_NATIVE, 99);
+    assert(command_index_add(names[3], &duplicate) == ph_ERROR_INVALID_ARGS);
+    assert(command_index_find(names[3])->lua_command == 3);
+    assert(command_index_count() == 8);
+    printf("  [PASS] The first handler of a name keeps it\n");
+
+    // Enough commands to grow the index several times.
+    char name[32];
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(name, sizeof(name), "grown-%d", i);
+        CommandHandler handler = test_handler(COMMAND_HANDLER_NATIVE, (size_t)(100 + i));
+        assert(command_index_add(name, &handler) == ph_SUCCESS);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(name, sizeof(name), "grown-%d", i);
+        const CommandHandler* found = command_index_find(name);
+        assert(found != NULL && found->lua_command == (size_t)(100 + i));
+    }
+    for (int i = 0; i < 8; ++i) {
+        assert(command_index_find(names[i])->lua_command == (size_t)i);
+    }
+    printf("  [PASS] 1008 commands survive growth\n");
+
+    command_index_cleanup();
+    assert(command_index_count() == 0 && command_index_find(names[0]) == NULL);
+    printf("Test finished.\n\n");
+}
+
+void test_command_index_remove_kind() {
+    printf("Running test: test_command_index_remove_kind...\n");
+
+    // Names homed in the last slot and the first, so their probe sequences
+    // run across the end of the slot array.
+    char last[6][32];
+    char first[3][32];
+    find_names_with_home(TEST_INDEX_CAPACITY - 1, last, 6);
+    find_names_with_home(0, first, 3);
+    for (int i = 0; i < 6; ++i) {
+        CommandHandler handler = test_handler(i % 2 ? COMMAND_HANDLER_NATIVE : COMMAND_HANDLER_LUA, (size_t)i);
+        assert(command_index_add(last[i], &handler) == ph_SUCCESS);
+    }
+    for (int i = 0; i < 3; ++i) {
+        CommandHandler handler = test_handler(i % 2 ? COMMAND_HANDLER_LUA : COMMAND_HANDLER_NATIVE, (size_t)(10 + i));
+        assert(command_index_add(first[i], &handler) == ph_SUCCESS);
+    }
+
+    command_index_remove_kind(COMMAND_HANDLER_LUA);
+    assert(command_index_count() == 5);
+    for (int i = 0; i < 6; ++i) {
+        const CommandHandler* found = command_index_find(last[i]);
+        if (i % 2) {
+            assert(found != NULL && found->kind == COMMAND_HANDLER_NATIVE && found->lua_command == (size_t)i);
+        } else {
+            assert(found == NULL);
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        const CommandHandler* found = command_index_find(first[i]);
+        if (i % 2) {
+            assert(found == NULL);
+        } else {
+            assert(found != NULL && found->kind == COMMAND_HANDLER_NATIVE && found->lua_command == (size_t)(10 + i));
+        }
+    }
+    printf("  [PASS] Removal across the end of the slots keeps the other kind reachable\n");
+
+    // The removed names can be registered again, and the survivors removed.
+    for (int i = 0; i < 6; i += 2) {
+        CommandHandler handler = test_handler(COMMAND_HANDLER_LUA, (size_t)(20 + i));
+        assert(command_index_add(last[i], &handler) == ph_SUCCESS);
+    }
+    command_index_remove_kind(COMMAND_HANDLER_NATIVE);
+    assert(command_index_count() == 3);
+    for (int i = 0; i < 6; ++i) {
+        const CommandHandler* found = command_index_find(last[i]);
+        if (i % 2) {
+            assert(found == NULL);
+        } else {
+            assert(found != NULL && found->kind == COMMAND_HANDLER_LUA && found->lua_command == (size_t)(20 + i));
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        assert(command_index_find(first[i]) == NULL);
+    }
+    command_index_remove_kind(COMMAND_HANDLER_LUA);
+    assert(command_index_count() == 0 && command_index_find(last[0]) == NULL);
+    printf("  [PASS] Lookups stay correct over further additions and removals\n");
+
+    command_index_cleanup();
+    printf("Test finished.\n\n");
+}
+
+int main() {
+    test_command_index_collisions();
+    test_command_index_remove_kind();
+
+    printf("All command index tests passed!\n");
+    return 0;
+}
@@ -2,10 +2,33 @@
 // Simple test runner for the configuration manager.
 
 #include "config/config_manager.h"
+#include "config/config_cache.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "libs/liblogger/logger.hpp" // <-- FIX: Include the logger header
 #include <assert.h>
+#include <stdatomic.h>
+#ifdef _WIN32
+#include <windows.h> // For Sleep and listing rotated logs
+#else
+#include <dirent.h>  // For listing rotated logs
+#include <time.h>    // For nanosleep
+#endif
+#ifdef __linux__
+#include <fcntl.h>   // For checking the log descriptor's flags
+#include <limits.h>  // For PATH_MAX
+#include <unistd.h>  // For readlink
+#endif
+
+static void sleep_ms(int milliseconds) {
+#ifdef _WIN32
+    Sleep((DWORD)milliseconds);
+#else
+    struct timespec delay = {milliseconds / 1000, (long)(milliseconds % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+#endif
+}
 
 // Helper to create a temporary config file for testing.
 void create_test_config_file(const char* filename) {
@@ -51,6 +74,796 @@ void test_config_loading_and_retrieval() {
     // Cleanup
     config_cleanup();
     remove(test_filename);
+    remove("test_config.conf.phc");
+    printf("Test finished.\n\n");
+}
+
+void test_config_parsing_edge_cases() {
+    printf("Running test: test_config_parsing_edge_cases...\n");
+
+    const char* test_filename = "test_config_edge.conf";
+    char long_value[4096];
+    memset(long_value, 'x', sizeof(long_value) - 1);
+    long_value[sizeof(long_value) - 1] = '\0';
+
+    FILE* f = fopen(test_filename, "wb");
+    assert(f != NULL);
+    fprintf(f, "long.key=%s\n", long_value);
+    fprintf(f, "crlf.key = windows\r\n");
+    fprintf(f, "dup.key=first\n");
+    fprintf(f, "equals.key=a=b\n");
+    fprintf(f, " = no key\n");
+    fprintf(f, "dup.key=second\n");
+    fprintf(f, "last.key=no newline");
+    fclose(f);
+
+    assert(config_load(test_filename) == ph_SUCCESS);
+    size_t length = 0;
+    const char* value = config_get_view("long.key", &length);
+    assert(value != NULL && length == sizeof(long_value) - 1 && strcmp(value, long_value) == 0);
+    printf("  [PASS] Lines longer than 1024 bytes are not split\n");
+
+    assert(strcmp(config_get_view("crlf.key", NULL), "windows") == 0);
+    assert(strcmp(config_get_view("dup.key", NULL), "second") == 0);
+    assert(strcmp(config_get_view("equals.key", NULL), "a=b") == 0);
+    assert(strcmp(config_get_view("last.key", NULL), "no newline") == 0);
+    assert(config_get_view("", NULL) == NULL);
+    printf("  [PASS] CRLF, duplicates, '=' in values and a missing final newline\n");
+
+    f = fopen(test_filename, "wb");
+    assert(f != NULL);
+    fclose(f);
+    assert(config_load(test_filename) == ph_SUCCESS);
+    assert(config_get_view("long.key", NULL) == NULL);
+    printf("  [PASS] An empty file loads an empty configuration\n");
+
+    config_cleanup();
+    remove(test_filename);
+    remove("test_config_edge.conf.phc");
+    printf("Test finished.\n\n");
+}
+
+void test_config_compiled_image() {
+    printf("Running test: test_config_compiled_image...\n");
+
+    const char* test_filename = "test_config_image.conf";
+    const char* image_filename = "test_config_image.conf.phc";
+    remove(image_filename);
+    FILE* f = fopen(test_filename, "w");
+    assert(f != NULL);
+    for (int i = 0; i < 1000; i++) {
+        fprintf(f, "image.key%d = value%d\n", i, i);
+    }
+    fprintf(f, "log.level = DEBUG\n");
+    fclose(f);
+
+    assert(config_load(test_filename) == ph_SUCCESS);
+    f = fopen(image_filename, "rb");
+    assert(f != NULL);
+    fclose(f);
+    printf("  [PASS] The first load compiles an image next to the file\n");
+
+    config_cleanup();
+    logger_set_level(LOG_LEVEL_WARN);
+    assert(config_load(test_filename) == ph_SUCCESS);
+    char expected[32];
+    for (int i = 0; i < 1000; i++) {
+        snprintf(expected, sizeof(expected), "image.key%d", i);
+        const char* value = config_get_view(expected, NULL);
+        snprintf(expected, sizeof(expected), "value%d", i);
+        assert(value != NULL && strcmp(value, expected) == 0);
+    }
+    assert(config_get_view("image.key1000", NULL) == NULL);
+    assert(config_get_view("image.key", NULL) == NULL);
+    assert(logger_get_level() == LOG_LEVEL_DEBUG);
+    printf("  [PASS] A second load reads every value and log key from the image\n");
+
+    assert(config_set_value("image.key7", "changed") == ph_SUCCESS);
+    assert(strcmp(config_get_view("image.key7", NULL), "changed") == 0);
+    assert(strcmp(config_get_view("image.key8", NULL), "value8") == 0);
+    printf("  [PASS] Values can be changed after loading from the image\n");
+
+    f = fopen(test_filename, "a");
+    assert(f != NULL);
+    fprintf(f, "image.added = yes\n");
+    fclose(f);
+    assert(config_load(test_filename) == ph_SUCCESS);
+    assert(strcmp(config_get_view("image.added", NULL), "yes") == 0);
+    assert(strcmp(config_get_view("image.key8", NULL), "value8") == 0);
+    // The value set above is a command-line override: reloading keeps it.
+    assert(strcmp(config_get_view("image.key7", NULL), "changed") == 0);
+    printf("  [PASS] A stale image is ignored and rebuilt\n");
+
+    config_cleanup();
+
+    // Flip one byte of a slot: the checksum must reject the image.
+    ConfigCacheHeader header;
+    f = fopen(image_filename, "r+b");
+    assert(f != NULL);
+    assert(fread(&header, sizeof(header), 1, f) == 1);
+    assert(fseek(f, (long)header.slots_offset + 4, SEEK_SET) == 0);
+    int original = fgetc(f);
+    assert(fseek(f, (long)header.slots_offset + 4, SEEK_SET) == 0);
+    fputc(original ^ 0x40, f);
+    fclose(f);
+    assert(config_load(test_filename) == ph_SUCCESS);
+    for (int i = 0; i < 1000; i++) {
+        snprintf(expected, sizeof(expected), "image.key%d", i);
+        const char* value = config_get_view(expected, NULL);
+        snprintf(expected, sizeof(expected), "value%d", i);
+        assert(value != NULL && strcmp(value, expected) == 0);
+    }
+    assert(strcmp(config_get_view("image.added", NULL), "yes") == 0);
+    printf("  [PASS] An image with a corrupt index is ignored\n");
+
+    config_cleanup();
+
+    // The arena is not checksummed: overwrite the terminator of its last
+    // string. The image is used, and only the entry whose string lost its
+    // terminator is refused when read.
+    f = fopen(image_filename, "r+b");
+    assert(f != NULL);
+    assert(fseek(f, -1, SEEK_END) == 0);
+    fputc('#', f);
+    fclose(f);
+    assert(config_load(test_filename) == ph_SUCCESS);
+    int missing = 0;
+    for (int i = 0; i <= 1000; i++) {
+        snprintf(expected, sizeof(expected), i < 1000 ? "image.key%d" : "image.added", i);
+        const char* value = config_get_view(expected, NULL);
+        snprintf(expected, sizeof(expected), i < 1000 ? "value%d" : "yes", i);
+        if (value == NULL) {
+            missing++;
+        } else {
+            assert(strcmp(value, expected) == 0);
+        }
+    }
+    if (config_get_view("log.level", NULL) == NULL) {
+        missing++;
+    }
+    assert(missing == 1);
+    printf("  [PASS] A string without its terminator is refused, the rest read\n");
+
+    config_cleanup();
+    remove(test_filename);
+    remove(image_filename);
+    printf("Test finished.\n\n");
+}
+
+void test_log_level_keys() {
+    printf("Running test: test_log_level_keys...\n");
+
+    assert(config_set_value("log.level", "warn") == ph_SUCCESS);
+    assert(logger_get_level() == LOG_LEVEL_WARN);
+    assert(!logger_is_enabled(LOG_LEVEL_INFO, "ANY"));
+    printf("  [PASS] log.level filters INFO globally\n");
+
+    assert(config_set_value("log.level.SYNC_ENGINE", "DEBUG") == ph_SUCCESS);
+    assert(logger_is_enabled(LOG_LEVEL_DEBUG, "SYNC_ENGINE"));
+    assert(!logger_is_enabled(LOG_LEVEL_DEBUG, "GIT_OPS"));
+    printf("  [PASS] log.level.<MODULE> overrides the global level\n");
+
+    // An invalid level is ignored and leaves the previous one in place.
+    assert(config_set_value("log.level", "verbose") == ph_SUCCESS);
+    assert(logger_get_level() == LOG_LEVEL_WARN);
+    printf("  [PASS] Invalid level names are ignored\n");
+
+    config_set_value("log.level", "DEBUG");
+    config_cleanup();
+    printf("Test finished.\n\n");
+}
+
+void test_log_rotation_keys() {
+    printf("Running test: test_log_rotation_keys...\n");
+
+    phLoggerRotation rotation;
+    assert(config_set_value("log.rotate.max_size", "10M") == ph_SUCCESS);
+    assert(config_set_value("log.rotate.interval", "1h") == ph_SUCCESS);
+    assert(config_set_value("log.rotate.keep", "3") == ph_SUCCESS);
+    assert(config_set_value("log.rotate.compress", "gzip") == ph_SUCCESS);
+    assert(logger_get_rotation(&rotation) == 0);
+    assert(rotation.max_bytes == 10u * 1024u * 1024u);
+    assert(rotation.interval_seconds == 3600);
+    assert(rotation.keep == 3);
+    assert(rotation.compression == LOGGER_COMPRESS_GZIP);
+    printf("  [PASS] log.rotate.* keys update the rotation policy\n");
+
+    // Invalid values are ignored and leave the previous policy in place.
+    assert(config_set_value("log.rotate.max_size", "lots") == ph_SUCCESS);
+    assert(config_set_value("log.rotate.compress", "rar") == ph_SUCCESS);
+    assert(logger_get_rotation(&rotation) == 0);
+    assert(rotation.max_bytes == 10u * 1024u * 1024u);
+    assert(rotation.compression == LOGGER_COMPRESS_GZIP);
+    printf("  [PASS] Invalid rotation values are ignored\n");
+
+    config_set_value("log.rotate.max_size", "0");
+    config_set_value("log.rotate.interval", "0");
+    config_set_value("log.rotate.compress", "none");
+    config_cleanup();
+    printf("Test finished.\n\n");
+}
+
+void test_config_table_growth() {
+    printf("Running test: test_config_table_growth...\n");
+
+    // Enough keys to grow the table and the string arena several times.
+    char key[64];
+    char value[64];
+    for (int i = 0; i < 5000; i++) {
+        snprintf(key, sizeof(key), "section%d.key%d", i % 7, i);
+        snprintf(value, sizeof(value), "value-%d", i);
+        assert(config_set_value(key, value) == ph_SUCCESS);
+    }
+    // Replace every value with a longer one.
+    for (int i = 0; i < 5000; i++) {
+        snprintf(key, sizeof(key), "section%d.key%d", i % 7, i);
+        snprintf(value, sizeof(value), "replaced-value-%d", i);
+        assert(config_set_value(key, value) == ph_SUCCESS);
+    }
+    for (int i = 0; i < 5000; i++) {
+        snprintf(key, sizeof(key), "section%d.key%d", i % 7, i);
+        snprintf(value, sizeof(value), "replaced-value-%d", i);
+        char* stored = config_get_value(key);
+        assert(stored != NULL && strcmp(stored, value) == 0);
+        free(stored);
+    }
+    printf("  [PASS] 5000 keys survive growth and value replacement\n");
+
+    // Rewriting one key many times makes the arena compact itself.
+    for (int i = 0; i < 20000; i++) {
+        snprintf(value, sizeof(value), "rewritten-%d", i);
+        assert(config_set_value("section0.key0", value) == ph_SUCCESS);
+    }
+    char* rewritten = config_get_value("section0.key0");
+    assert(rewritten != NULL && strcmp(rewritten, "rewritten-19999") == 0);
+    free(rewritten);
+    char* untouched = config_get_value("section1.key4999");
+    assert(untouched != NULL && strcmp(untouched, "replaced-value-4999") == 0);
+    free(untouched);
+    printf("  [PASS] Values stay intact when replaced values are reclaimed\n");
+
+    assert(config_get_value("section0.key5000") == NULL);
+    printf("  [PASS] Missing keys are not found\n");
+
+    config_cleanup();
+    printf("Test finished.\n\n");
+}
+
+void test_config_views() {
+    printf("Running test: test_config_views...\n");
+
+    assert(config_set_value("view.key", "borrowed") == ph_SUCCESS);
+    uint64_t generation = config_generation();
+    size_t length = 0;
+    const char* view = config_get_view("view.key", &length);
+    assert(view != NULL && strcmp(view, "borrowed") == 0 && length == 8);
+    assert(config_get_view("view.key", NULL) == view);
+    assert(config_get_view("view.missing", &length) == NULL);
+    printf("  [PASS] config_get_view returns the stored value without copying\n");
+
+    assert(config_generation() == generation);
+    assert(config_set_value("view.other", "x") == ph_SUCCESS);
+    assert(config_generation() != generation);
+    generation = config_generation();
+    config_cleanup();
+    assert(config_generation() != generation);
+    printf("  [PASS] The generation changes whenever the configuration does\n");
+
+    printf("Test finished.\n\n");
+}
+
+void test_config_read_sections() {
+    printf("Running test: test_config_read_sections...\n");
+
+    assert(config_set_value("section.key", "old") == ph_SUCCESS);
+    config_read_begin();
+    const char* view = config_get_view("section.key", NULL);
+    config_read_begin(); // Sections nest.
+    assert(config_set_value("section.key", "new") == ph_SUCCESS);
+    config_read_end();
+    assert(strcmp(config_get_view("section.key", NULL), "new") == 0);
+    assert(strcmp(view, "old") == 0);
+    config_cleanup();
+    assert(strcmp(view, "old") == 0);
+    config_read_end();
+    printf("  [PASS] Views stay valid inside a read section across changes\n");
+
+    assert(config_set_value("section.key", "after") == ph_SUCCESS);
+    char* value = config_get_value("section.key");
+    assert(value != NULL && strcmp(value, "after") == 0);
+    free(value);
+    config_cleanup();
+    printf("  [PASS] Changes are visible once the section ends\n");
+
+    printf("Test finished.\n\n");
+}
+
+// What the change callback last received: the keys as ",k1,k2,...,".
+static char g_changed_keys[256];
+static size_t g_changed_count;
+static atomic_int g_notifications;
+
+static void record_changes(const char* const* keys, size_t count, void* user_data) {
+    assert(user_data == &g_notifications);
+    g_changed_keys[0] = '\0';
+    for (size_t i = 0; i < count; i++) {
+        snprintf(g_changed_keys + strlen(g_changed_keys), sizeof(g_changed_keys) - strlen(g_changed_keys),
+                 ",%s", keys[i]);
+    }
+    strncat(g_changed_keys, ",", sizeof(g_changed_keys) - strlen(g_changed_keys) - 1);
+    g_changed_count = count;
+    atomic_fetch_add(&g_notifications, 1);
+}
+
+static void write_file(const char* filename, const char* contents) {
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fputs(contents, f);
+    fclose(f);
+}
+
+// Waits up to 5 s for the notification count to exceed `seen`.
+static int wait_for_notification(int seen) {
+    for (int i = 0; i < 500 && atomic_load(&g_notifications) == seen; i++) {
+        sleep_ms(10);
+    }
+    return atomic_load(&g_notifications) > seen;
+}
+
+void test_config_change_notification() {
+    printf("Running test: test_config_change_notification...\n");
+
+    const char* test_filename = "test_config_watch.conf";
+    int subscription = config_subscribe(record_changes, &g_notifications);
+    assert(subscription >= 0);
+
+    assert(config_set_value("watch.key", "1") == ph_SUCCESS);
+    assert(atomic_load(&g_notifications) == 1 && strcmp(g_changed_keys, ",watch.key,") == 0);
+    assert(config_set_value("watch.key", "1") == ph_SUCCESS);
+    assert(atomic_load(&g_notifications) == 1);
+    printf("  [PASS] Setting a value reports its key, unless it is unchanged\n");
+
+    write_file(test_filename, "a=1\nb=2\nc=3\n");
+    assert(config_load(test_filename) == ph_SUCCESS);
+    // watch.key was set on the command-line layer, which the file leaves alone.
+    assert(atomic_load(&g_notifications) == 2 && g_changed_count == 3);
+    assert(strstr(g_changed_keys, ",a,") && strstr(g_changed_keys, ",b,") && strstr(g_changed_keys, ",c,"));
+    write_file(test_filename, "a=1\nb=20\nd=4\n");
+    assert(config_load(test_filename) == ph_SUCCESS);
+    assert(atomic_load(&g_notifications) == 3 && g_changed_count == 3);
+    assert(strstr(g_changed_keys, ",b,") && strstr(g_changed_keys, ",c,") && strstr(g_changed_keys, ",d,"));
+    printf("  [PASS] Loading a file reports the keys added, modified and removed\n");
+
+    // The watcher reloads the file by itself, edited in place...
+    assert(config_watch_start(test_filename) == ph_SUCCESS);
+    int seen = atomic_load(&g_notifications);
+    write_file(test_filename, "a=1\nb=20\nd=40\n");
+    assert(wait_for_notification(seen));
+    assert(g_changed_count == 1 && strcmp(g_changed_keys, ",d,") == 0);
+    assert(strcmp(config_get_view("d", NULL), "40") == 0);
+    printf("  [PASS] A watched file edited in place is reloaded\n");
+
+    // ...or replaced by a rename, as editors save.
+    seen = atomic_load(&g_notifications);
+    write_file("test_config_watch.conf.new", "a=100\nb=20\nd=40\n");
+    assert(rename("test_config_watch.conf.new", test_filename) == 0);
+    assert(wait_for_notification(seen));
+    assert(strcmp(g_changed_keys, ",a,") == 0);
+    assert(strcmp(config_get_view("a", NULL), "100") == 0);
+    printf("  [PASS] A watched file replaced by a rename is reloaded\n");
+
+    seen = atomic_load(&g_notifications);
+    remove(test_filename);
+    assert(wait_for_notification(seen));
+    assert(g_changed_count == 3 && config_get_view("a", NULL) == NULL);
+    assert(strcmp(config_get_view("watch.key", NULL), "1") == 0);
+    printf("  [PASS] Deleting a watched file clears its layer\n");
+
+    config_watch_stop();
+    config_unsubscribe(subscription);
+    seen = atomic_load(&g_notifications);
+    assert(config_set_value("watch.key", "2") == ph_SUCCESS);
+    assert(atomic_load(&g_notifications) == seen);
+    printf("  [PASS] Nothing is reported after unsubscribing\n");
+
+    config_cleanup();
+    remove("test_config_watch.conf" ".phc");
+    printf("Test finished.\n\n");
+}
+
+void test_config_layers() {
+    printf("Running test: test_config_layers...\n");
+
+    const char* system_file = "test_layer_system.conf";
+    const char* user_file = "test_layer_user.conf";
+    const char* repo_file = "test_layer_repo.conf";
+    FILE* f = fopen(system_file, "w");
+    assert(f != NULL);
+    fprintf(f, "shared = system\nsystem.only = 1\n");
+    for (int i = 0; i < 200; i++) {
+        fprintf(f, "system.filler%d = %d\n", i, i);
+    }
+    fclose(f);
+    write_file(user_file, "shared = user\nuser.only = 1\n");
+    write_file(repo_file, "shared = repo\n");
+
+    assert(config_load_layer(CONFIG_LAYER_SYSTEM, system_file) == ph_SUCCESS);
+    assert(config_load_layer(CONFIG_LAYER_USER, user_file) == ph_SUCCESS);
+    assert(config_load_layer(CONFIG_LAYER_REPO, repo_file) == ph_SUCCESS);
+    assert(strcmp(config_get_view("shared", NULL), "repo") == 0);
+    assert(config_get_origin("shared") == CONFIG_LAYER_REPO);
+    assert(strcmp(config_get_view("system.only", NULL), "1") == 0);
+    assert(config_get_origin("system.only") == CONFIG_LAYER_SYSTEM);
+    assert(config_get_origin("user.only") == CONFIG_LAYER_USER);
+    assert(config_get_origin("missing") == -1);
+    assert(config_load_layer(CONFIG_LAYER_ENV, repo_file) == ph_ERROR_INVALID_ARGS);
+    printf("  [PASS] Higher layers win, and each value knows its layer\n");
+
+    setenv("PH_SHARED", "env", 1);
+    setenv("PH_LAYER_TEST__NAME", "mapped", 1);
+    assert(config_load_environment() == ph_SUCCESS);
+    assert(strcmp(config_get_view("shared", NULL), "env") == 0);
+    assert(config_get_origin("shared") == CONFIG_LAYER_ENV);
+    assert(strcmp(config_get_view("layer.test_name", NULL), "mapped") == 0);
+    assert(config_set_value("shared", "cli") == ph_SUCCESS);
+    assert(config_get_origin("shared") == CONFIG_LAYER_CLI);
+    assert(strcmp(config_layer_name(CONFIG_LAYER_CLI), "cli") == 0);
+    printf("  [PASS] PH_* variables and overrides sit above the files\n");
+
+    // Small changes to one layer patch the merge.
+    write_file(repo_file, "shared = repo2\nrepo.added = 1\nsystem.only = repo\n");
+    assert(config_load_layer(CONFIG_LAYER_REPO, repo_file) == ph_SUCCESS);
+    assert(strcmp(config_get_view("shared", NULL), "cli") == 0);
+    assert(config_get_origin("repo.added") == CONFIG_LAYER_REPO);
+    assert(strcmp(config_get_view("system.only", NULL), "repo") == 0);
+    write_file(repo_file, "shared = repo2\nrepo.added = 1\n");
+    assert(config_load_layer(CONFIG_LAYER_REPO, repo_file) == ph_SUCCESS);
+    assert(strcmp(config_get_view("system.only", NULL), "1") == 0);
+    assert(config_get_origin("system.only") == CONFIG_LAYER_SYSTEM);
+    // A key gone from every layer makes the merge start over.
+    write_file(repo_file, "shared = repo2\n");
+    assert(config_load_layer(CONFIG_LAYER_REPO, repo_file) == ph_SUCCESS);
+    assert(config_get_view("repo.added", NULL) == NULL);
+    assert(strcmp(config_get_view("system.filler199", NULL), "199") == 0);
+    assert(strcmp(config_get_view("shared", NULL), "cli") == 0);
+    printf("  [PASS] Removing a key from a layer falls back to the layers below\n");
+
+    unsetenv("PH_SHARED");
+    unsetenv("PH_LAYER_TEST__NAME");
+    assert(config_load_environment() == ph_SUCCESS);
+    assert(config_get_view("layer.test_name", NULL) == NULL);
+    config_cleanup();
+    assert(config_get_view("system.only", NULL) == NULL && config_get_view("shared", NULL) == NULL);
+    printf("  [PASS] Every layer can be reloaded, and cleanup clears them all\n");
+
+    remove(system_file);
+    remove(user_file);
+    remove(repo_file);
+    remove("test_layer_system.conf.phc");
+    remove("test_layer_user.conf.phc");
+    remove("test_layer_repo.conf.phc");
+    printf("Test finished.\n\n");
+}
+
+// Checks the typed readings of the values written by test_config_typed_values.
+static void check_typed_values(void) {
+    int64_t number = 0;
+    bool flag = false;
+    assert(config_get_int("typed.int", &number) == ph_SUCCESS && number == 42);
+    assert(config_get_int("typed.negative", &number) == ph_SUCCESS && number == -17);
+    assert(config_get_int("typed.min", &number) == ph_SUCCESS && number == INT64_MIN);
+    assert(config_get_bool("typed.on", &flag) == ph_SUCCESS && flag);
+    assert(config_get_bool("typed.off", &flag) == ph_SUCCESS && !flag);
+    assert(config_get_bool("typed.one", &flag) == ph_SUCCESS && flag);
+    assert(config_get_duration_ms("typed.timeout", &number) == ph_SUCCESS && number == 90 * 60 * 1000);
+    assert(config_get_duration_ms("typed.delay", &number) == ph_SUCCESS && number == 250);
+    assert(config_get_duration_ms("typed.int", &number) == ph_SUCCESS && number == 42);
+
+    number = 7;
+    assert(config_get_int("typed.text", &number) == ph_ERROR_INVALID_ARGS && number == 7);
+    assert(config_get_int("typed.overflow", &number) == ph_ERROR_INVALID_ARGS);
+    assert(config_get_int("typed.timeout", &number) == ph_ERROR_INVALID_ARGS);
+    assert(config_get_bool("typed.int", &flag) == ph_ERROR_INVALID_ARGS);
+    assert(config_get_duration_ms("typed.negative", &number) == ph_ERROR_INVALID_ARGS);
+    assert(config_get_duration_ms("typed.bad_unit", &number) == ph_ERROR_INVALID_ARGS);
+    assert(config_get_int("typed.missing", &number) == ph_ERROR_NOT_FOUND && number == 7);
+    assert(config_get_int(NULL, &number) == ph_ERROR_INVALID_ARGS);
+    assert(config_get_bool("typed.on", NULL) == ph_ERROR_INVALID_ARGS);
+
+    ConfigListItem items[2];
+    assert(config_get_list("typed.list", items, 2) == 3);
+    assert(items[0].length == 5 && memcmp(items[0].data, "alpha", 5) == 0);
+    assert(items[1].length == 4 && memcmp(items[1].data, "beta", 4) == 0);
+    assert(config_get_list("typed.list", NULL, 0) == 3);
+    assert(config_get_list("typed.text", items, 2) == 1 && items[0].length == strlen("plain text"));
+    assert(config_get_list("typed.missing", items, 2) == 0);
+}
+
+void test_config_typed_values() {
+    printf("Running test: test_config_typed_values...\n");
+
+    const char* test_filename = "test_config_typed.conf";
+    const char* image_filename = "test_config_typed.conf.phc";
+    remove(image_filename);
+    FILE* f = fopen(test_filename, "w");
+    assert(f != NULL);
+    fprintf(f, "typed.int = 42\n");
+    fprintf(f, "typed.negative = -17\n");
+    fprintf(f, "typed.min = -9223372036854775808\n");
+    fprintf(f, "typed.overflow = 9223372036854775808\n");
+    fprintf(f, "typed.on = Yes\n");
+    fprintf(f, "typed.off = off\n");
+    fprintf(f, "typed.one = 1\n");
+    fprintf(f, "typed.timeout = 1h30m\n");
+    fprintf(f, "typed.delay = 250ms\n");
+    fprintf(f, "typed.bad_unit = 10w\n");
+    fprintf(f, "typed.text = plain text\n");
+    fprintf(f, "typed.list = alpha, beta ,, gamma,\n");
+    fclose(f);
+
+    assert(config_load(test_filename) == ph_SUCCESS);
+    check_typed_values();
+    printf("  [PASS] Parsed values read as integers, booleans, durations and lists\n");
+
+    config_cleanup();
+    assert(config_load(test_filename) == ph_SUCCESS);
+    check_typed_values();
+    printf("  [PASS] Values mapped from the compiled image read the same\n");
+
+    int64_t number = 0;
+    bool flag = true;
+    assert(config_set_value("typed.int", "off") == ph_SUCCESS);
+    assert(config_get_int("typed.int", &number) == ph_ERROR_INVALID_ARGS);
+    assert(config_get_bool("typed.int", &flag) == ph_SUCCESS && !flag);
+    setenv("PH_TYPED_ENV", "2d", 1);
+    assert(config_load_environment() == ph_SUCCESS);
+    assert(config_get_duration_ms("typed.env", &number) == ph_SUCCESS && number == 2 * 24 * 60 * 60 * 1000);
+    assert(config_get_duration_ms("typed.delay", &number) == ph_SUCCESS && number == 250);
+    unsetenv("PH_TYPED_ENV");
+    printf("  [PASS] Overrides and merged layers keep their typed readings\n");
+
+    config_cleanup();
+    remove(test_filename);
+    remove(image_filename);
+    printf("Test finished.\n\n");
+}
+
+// Counts the lines of a file that contain `needle`.
+static int count_lines_containing(const char* filename, const char* needle) {
+    FILE* f = fopen(filename, "r");
+    assert(f != NULL);
+    char line[1024];
+    int count = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strstr(line, needle)) count++;
+    }
+    fclose(f);
+    return count;
+}
+
+// Adds up the counts of the "N similar messages suppressed" summaries of a
+// call site, given its format string, and counts the summaries.
+static int sum_suppressed(const char* filename, const char* format, int* summaries) {
+    char needle[128];
+    snprintf(needle, sizeof(needle), " similar messages suppressed: \"%s\"", format);
+    FILE* f = fopen(filename, "r");
+    assert(f != NULL);
+    char line[1024];
+    int total = 0;
+    while (fgets(line, sizeof(line), f)) {
+        char* found = strstr(line, needle);
+        if (!found) continue;
+        while (found > line && found[-1] >= '0' && found[-1] <= '9') found--;
+        total += atoi(found);
+        if (summaries) (*summaries)++;
+    }
+    fclose(f);
+    return total;
+}
+
+void test_log_rate_limit_keys() {
+    printf("Running test: test_log_rate_limit_keys...\n");
+
+    phLoggerRateLimit limit;
+    assert(config_set_value("log.rate_limit", "1") == ph_SUCCESS);
+    assert(config_set_value("log.rate_limit.burst", "2") == ph_SUCCESS);
+    assert(logger_get_rate_limit(&limit) == 0);
+    assert(limit.per_second == 1);
+    assert(limit.burst == 2);
+    printf("  [PASS] log.rate_limit keys update the rate limit\n");
+
+    // One call site logging in a tight loop only gets its burst through.
+    logger_flush();
+    int before = count_lines_containing("test_log.txt", "[TEST] rate-limited iteration");
+    int reported_before = sum_suppressed("test_log.txt", "rate-limited iteration %d", NULL);
+    for (int i = 0; i < 50; i++) {
+        logger_log_fmt(LOG_LEVEL_INFO, "TEST", "rate-limited iteration %d", i);
+    }
+    logger_flush();
+    assert(count_lines_containing("test_log.txt", "[TEST] rate-limited iteration") - before == 2);
+    printf("  [PASS] A chatty call site is limited to its burst\n");
+
+    // The storm ended within the report interval and the call site went
+    // quiet, so the flush reports what it suppressed, exactly once.
+    assert(sum_suppressed("test_log.txt", "rate-limited iteration %d", NULL) - reported_before == 48);
+    logger_flush();
+    assert(sum_suppressed("test_log.txt", "rate-limited iteration %d", NULL) - reported_before == 48);
+    printf("  [PASS] The tail of a storm is reported on flush\n");
+
+    // A storm that outlasts the report interval is summarized when the call
+    // site logs after it, and the rest on flush; no record goes unaccounted.
+    int summaries_before = 0;
+    int logged_before = count_lines_containing("test_log.txt", "[TEST] storm record");
+    reported_before = sum_suppressed("test_log.txt", "storm record %d", &summaries_before);
+    for (int i = 0; i < 30; i++) {
+        logger_log_fmt(LOG_LEVEL_INFO, "TEST", "storm record %d", i);
+        if (i == 14) {
+            sleep_ms(1100); // Past the report interval; also refills one token.
+        }
+    }
+    logger_flush();
+    int summaries = 0;
+    int logged = count_lines_containing("test_log.txt", "[TEST] storm record") - logged_before;
+    int reported = sum_suppressed("test_log.txt", "storm record %d", &summaries) - reported_before;
+    assert(logged + reported == 30);
+    assert(summaries - summaries_before == 2);
+    printf("  [PASS] Storm of 30: %d logged, %d reported in 2 summaries\n", logged, reported);
+
+    assert(config_set_value("log.rate_limit", "fast") == ph_SUCCESS);
+    assert(logger_get_rate_limit(&limit) == 0);
+    assert(limit.per_second == 1);
+    printf("  [PASS] Invalid rate limit values are ignored\n");
+
+    config_set_value("log.rate_limit", "0");
+    config_cleanup();
+    printf("Test finished.\n\n");
+}
+
+void test_log_key_removal() {
+    printf("Running test: test_log_key_removal...\n");
+
+    const char* test_filename = "test_log_keys.conf";
+    const char* image_filename = "test_log_keys.conf.phc";
+    write_file(test_filename,
+               "log.level = ERROR\n"
+               "log.level.GIT_OPS = DEBUG\n"
+               "log.rate_limit = 5\n"
+               "log.rotate.max_size = 1M\n");
+    assert(config_load(test_filename) == ph_SUCCESS);
+    assert(logger_get_level() == LOG_LEVEL_ERROR);
+    assert(logger_is_enabled(LOG_LEVEL_DEBUG, "GIT_OPS"));
+    phLoggerRateLimit limit;
+    phLoggerRotation rotation;
+    assert(logger_get_rate_limit(&limit) == 0 && limit.per_second == 5);
+    assert(logger_get_rotation(&rotation) == 0 && rotation.max_bytes == 1024u * 1024u);
+
+    // Drop the module override and the rate limit from the file.
+    write_file(test_filename,
+               "log.level = ERROR\n"
+               "log.rotate.max_size = 1M\n");
+    assert(config_load(test_filename) == ph_SUCCESS);
+    assert(!logger_is_enabled(LOG_LEVEL_WARN, "GIT_OPS"));
+    assert(logger_is_enabled(LOG_LEVEL_ERROR, "GIT_OPS"));
+    assert(logger_get_rate_limit(&limit) == 0 && limit.per_second == 0);
+    assert(logger_get_rotation(&rotation) == 0 && rotation.max_bytes == 1024u * 1024u);
+    printf("  [PASS] A removed module override falls back to the global level\n");
+
+    write_file(test_filename, "unrelated = 1\n");
+    assert(config_load(test_filename) == ph_SUCCESS);
+    assert(logger_get_level() == LOG_LEVEL_DEBUG);
+    assert(logger_get_rotation(&rotation) == 0 && rotation.max_bytes == 0);
+    printf("  [PASS] Removed log keys return to their defaults\n");
+
+    // A cleared override can be set again.
+    assert(config_set_value("log.level.GIT_OPS", "FATAL") == ph_SUCCESS);
+    assert(!logger_is_enabled(LOG_LEVEL_ERROR, "GIT_OPS"));
+    assert(logger_is_enabled(LOG_LEVEL_ERROR, "SYNC_ENGINE"));
+    printf("  [PASS] A cleared override can be set again\n");
+
+    config_set_value("log.level.GIT_OPS", "DEBUG");
+    config_cleanup();
+    remove(test_filename);
+    remove(image_filename);
+    printf("Test finished.\n\n");
+}
+
+// Collects the rotated copies of the test log in the current directory.
+static int list_rotated_logs(char names[][256], int max) {
+    int count = 0;
+#ifdef _WIN32
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA("test_log.txt.*", &entry);
+    if (find == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    do {
+        if (count < max) {
+            snprintf(names[count++], 256, "%s", entry.cFileName);
+        }
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    DIR* dir = opendir(".");
+    assert(dir != NULL);
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "test_log.txt.", 13) == 0 && count < max) {
+            snprintf(names[count++], 256, "%s", entry->d_name);
+        }
+    }
+    closedir(dir);
+#endif
+    return count;
+}
+
+void test_log_size_rotation() {
+    printf("Running test: test_log_size_rotation...\n");
+
+    static char rotated[64][256];
+    int stale = list_rotated_logs(rotated, 64);
+    for (int i = 0; i < stale; i++) {
+        remove(rotated[i]);
+    }
+
+    phLoggerRotation rotation = {0};
+    rotation.max_bytes = 4096;
+    rotation.keep = 64;
+    rotation.compression = LOGGER_COMPRESS_NONE;
+    assert(logger_set_rotation(&rotation) == 0);
+    // The size is checked after each write, and a write may carry many
+    // lines, so flush in batches of about 5 KiB to cross the threshold often.
+    for (int i = 0; i < 400; i++) {
+        logger_log_fmt(LOG_LEVEL_INFO, "TEST", "size-rotation line %03d, padded to about a hundred bytes", i);
+        if (i % 50 == 49) {
+            logger_flush();
+        }
+    }
+
+    // Every segment was cut after it reached the threshold, on a line
+    // boundary, and together with the live file they hold every line once.
+    int count = list_rotated_logs(rotated, 64);
+    assert(count >= 5);
+    int lines = count_lines_containing("test_log.txt", "size-rotation line");
+    for (int i = 0; i < count; i++) {
+        FILE* f = fopen(rotated[i], "rb");
+        assert(f != NULL);
+        assert(fseek(f, 0, SEEK_END) == 0 && ftell(f) >= 4096);
+        assert(fseek(f, -1, SEEK_END) == 0 && fgetc(f) == '\n');
+        fclose(f);
+        lines += count_lines_containing(rotated[i], "size-rotation line");
+    }
+    assert(lines == 400);
+    printf("  [PASS] %d rotated segments of at least 4 KiB hold every line\n", count);
+
+#ifdef __linux__
+    // The descriptor swapped in by rotation stays close-on-exec, so it does
+    // not leak into the compression tools.
+    char live[PATH_MAX];
+    assert(realpath("test_log.txt", live) != NULL);
+    int found = 0;
+    for (int fd = 0; fd < 1024; fd++) {
+        char link[64];
+        char target[PATH_MAX];
+        snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+        ssize_t length = readlink(link, target, sizeof(target) - 1);
+        if (length < 0) {
+            continue;
+        }
+        target[length] = '\0';
+        if (strcmp(target, live) == 0) {
+            assert(fcntl(fd, F_GETFD) & FD_CLOEXEC);
+            found++;
+        }
+    }
+    assert(found > 0);
+    printf("  [PASS] The log descriptor stays close-on-exec after rotation\n");
+#endif
+
+    memset(&rotation, 0, sizeof(rotation));
+    assert(logger_set_rotation(&rotation) == 0);
+    for (int i = 0; i < count; i++) {
+        remove(rotated[i]);
+    }
     printf("Test finished.\n\n");
 }
 
@@ -59,6 +872,19 @@ int main() {
     logger_init("test_log.txt");
 
     test_config_loading_and_retrieval();
+    test_config_parsing_edge_cases();
+    test_config_compiled_image();
+    test_config_table_growth();
+    test_config_views();
+    test_config_read_sections();
+    test_config_change_notification();
+    test_config_layers();
+    test_config_typed_values();
+    test_log_level_keys();
+    test_log_rotation_keys();
+    test_log_rate_limit_keys();
+    test_log_key_removal();
+    test_log_size_rotation();
 
     logger_cleanup();
     printf("All C core tests passed!\n");
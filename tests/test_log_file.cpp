@@ -0,0 +1,66 @@
+// tests/test_log_file.cpp
+// The rotating text log file: rotated files queued for the background
+// compressor when the file is closed are still compressed and pruned.
+
+#include "libs/liblogger/LogFile.hpp"
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+static const char* kLogPath = "test_log_file.log";
+
+// Counts the rotated copies of kLogPath in the current directory.
+static int count_rotated() {
+    const std::string prefix = std::string(kLogPath) + ".";
+    int count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+        if (entry.path().filename().string().compare(0, prefix.size(), prefix) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void remove_logs() {
+    const std::string prefix = std::string(kLogPath) + ".";
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+        std::string name = entry.path().filename().string();
+        if (name == kLogPath || name.compare(0, prefix.size(), prefix) == 0) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+}
+
+void test_close_drains_compressor() {
+    printf("Running test: test_close_drains_compressor...\n");
+
+    remove_logs();
+    LogFile file;
+    assert(file.open(kLogPath));
+    phLoggerRotation rotation = {};
+    rotation.max_bytes = 64;
+    rotation.keep = 2;
+    rotation.compression = LOGGER_COMPRESS_NONE;
+    file.set_rotation(rotation);
+
+    // Every write crosses the threshold, so each one rotates and queues a
+    // pruning job; closing right away must not drop the queued ones.
+    const std::string line(100, 'x');
+    for (int i = 0; i < 50; ++i) {
+        file.write((line + "\n").data(), line.size() + 1);
+    }
+    file.close();
+    assert(count_rotated() == 2);
+    printf("  [PASS] Jobs queued before close still prune to the retention limit\n");
+
+    remove_logs();
+    printf("Test finished.\n\n");
+}
+
+int main() {
+    test_close_drains_compressor();
+
+    printf("All log file tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,163 @@
+// tests/test_module_manifest.c
+// The module manifest: a write/read round trip, lookups by stamp, and
+// manifests that are corrupt, truncated or missing.
+
+#include "module_loader/module_manifest.h"
+#include "platform/platform.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void write_bytes(const char* filename, const void* data, size_t size) {
+    FILE* f = fopen(filename, "wb");
+    assert(f != NULL);
+    assert(fwrite(data, 1, size, f) == size);
+    fclose(f);
+}
+
+static void write_file(const char* filename, const char* contents) {
+    write_bytes(filename, contents, strlen(contents));
+}
+
+// Returns the contents of a file, which the caller frees.
+static char* read_file(const char* filename, size_t* size) {
+    FILE* f = fopen(filename, "rb");
+    assert(f != NULL);
+    assert(fseek(f, 0, SEEK_END) == 0);
+    long length = ftell(f);
+    assert(length > 0 && fseek(f, 0, SEEK_SET) == 0);
+    char* data = (char*)malloc((size_t)length);
+    assert(data != NULL && fread(data, 1, (size_t)length, f) == (size_t)length);
+    fclose(f);
+    *size = (size_t)length;
+    return data;
+}
+
+// Checks that a manifest entry read back holds what was written.
+static void check_manifest_entry(const ModuleManifestEntry* read, const ModuleManifestEntry* written) {
+    assert(strcmp(read->file_path, written->file_path) == 0);
+    assert(read->file_size == written->file_size && read->file_mtime_ns == written->file_mtime_ns);
+    assert(strcmp(read->info.name, written->info.name) == 0);
+    assert(strcmp(read->info.version, written->info.version) == 0);
+    assert(written->info.description ? strcmp(read->info.description, written->info.description) == 0
+                                     : read->info.description == NULL);
+    for (int i = 0; written->info.commands && written->info.commands[i]; ++i) {
+        assert(strcmp(read->info.commands[i], written->info.commands[i]) == 0);
+        assert(written->info.commands[i + 1] || !read->info.commands[i + 1]);
+    }
+    if (!written->info.commands) {
+        assert(read->info.commands == NULL);
+    }
+    for (int i = 0; written->dependencies && written->dependencies[i]; ++i) {
+        assert(strcmp(read->dependencies[i], written->dependencies[i]) == 0);
+        assert(written->dependencies[i + 1] || !read->dependencies[i + 1]);
+    }
+    if (!written->dependencies) {
+        assert(read->dependencies == NULL);
+    }
+}
+
+void test_module_manifest() {
+    printf("Running test: test_module_manifest...\n");
+
+    const char* manifest_filename = "test_" MODULE_MANIFEST_FILE;
+    const char* module_filename = "test_module.so";
+    write_file(module_filename, "not really a library\n");
+    uint64_t module_size = 0;
+    int64_t module_mtime_ns = 0;
+    assert(platform_file_stamp(module_filename, &module_size, &module_mtime_ns));
+
+    const char* git_commands[] = {"status", "commit", "push", NULL};
+    const char* sync_commands[] = {"sync", NULL};
+    const char* sync_dependencies[] = {"git_ops", "config", NULL};
+    ModuleManifestEntry entries[3];
+    memset(entries, 0, sizeof(entries));
+    entries[0].file_path = "modules/libgit_ops.so";
+    entries[0].file_size = 12345;
+    entries[0].file_mtime_ns = 1750000000123456789LL;
+    entries[0].info.name = "git_ops";
+    entries[0].info.version = "1.2.0";
+    entries[0].info.description = "Git operations";
+    entries[0].info.commands = git_commands;
+    entries[1].file_path = "modules/libsync.so";
+    entries[1].file_size = 42;
+    entries[1].file_mtime_ns = -1;
+    entries[1].info.name = "sync";
+    entries[1].info.version = "0.1";
+    entries[1].info.commands = sync_commands;
+    entries[1].dependencies = sync_dependencies;
+    entries[2].file_path = module_filename;
+    entries[2].file_size = module_size;
+    entries[2].file_mtime_ns = module_mtime_ns;
+    entries[2].info.name = "test";
+    entries[2].info.version = "1";
+    entries[2].info.description = "";
+
+    assert(module_manifest_write(manifest_filename, entries, 3) == 0);
+    ModuleManifest manifest;
+    assert(module_manifest_read(&manifest, manifest_filename) == 0);
+    assert(manifest.count == 3);
+    for (int i = 0; i < 3; ++i) {
+        const ModuleManifestEntry* found = module_manifest_find(&manifest, entries[i].file_path,
+                                                                entries[i].file_size, entries[i].file_mtime_ns);
+        assert(found == &manifest.entries[i]);
+        check_manifest_entry(found, &entries[i]);
+    }
+    assert(module_manifest_find(&manifest, "modules/libmissing.so", 42, -1) == NULL);
+    printf("  [PASS] Every entry survives a write/read round trip\n");
+
+    // Changing the module file changes its stamp: it must be scanned again.
+    // The new contents differ in size, so this holds on coarse clocks too.
+    assert(module_manifest_find(&manifest, module_filename, module_size, module_mtime_ns) != NULL);
+    write_file(module_filename, "a rebuilt library, somewhat larger\n");
+    assert(platform_file_stamp(module_filename, &module_size, &module_mtime_ns));
+    assert(module_size != entries[2].file_size);
+    assert(module_manifest_find(&manifest, module_filename, module_size, module_mtime_ns) == NULL);
+    const ModuleManifestEntry* entry = &entries[0];
+    assert(module_manifest_find(&manifest, entry->file_path, entry->file_size, entry->file_mtime_ns + 1) == NULL);
+    assert(module_manifest_find(&manifest, entry->file_path, entry->file_size + 1, entry->file_mtime_ns) == NULL);
+    module_manifest_free(&manifest);
+    assert(manifest.count == 0 && manifest.entries == NULL);
+    printf("  [PASS] A changed stamp forces a rescan\n");
+
+    size_t manifest_size = 0;
+    char* written = read_file(manifest_filename, &manifest_size);
+
+    // Flip one byte of the last string: the checksum must reject the manifest.
+    written[manifest_size - 2] ^= 0x40;
+    write_bytes(manifest_filename, written, manifest_size);
+    written[manifest_size - 2] ^= 0x40;
+    assert(module_manifest_read(&manifest, manifest_filename) == -1);
+    assert(manifest.count == 0 && manifest.entries == NULL);
+    printf("  [PASS] A corrupt manifest is rejected\n");
+
+    // One byte short, shorter than the header, and empty.
+    const size_t truncated_sizes[] = {manifest_size - 1, 16, 0};
+    for (size_t i = 0; i < sizeof(truncated_sizes) / sizeof(truncated_sizes[0]); ++i) {
+        write_bytes(manifest_filename, written, truncated_sizes[i]);
+        assert(module_manifest_read(&manifest, manifest_filename) == -1);
+    }
+    free(written);
+    remove(manifest_filename);
+    assert(module_manifest_read(&manifest, manifest_filename) == -1);
+    printf("  [PASS] A truncated or missing manifest is rejected\n");
+
+    assert(module_manifest_write(manifest_filename, NULL, 0) == 0);
+    assert(module_manifest_read(&manifest, manifest_filename) == 0);
+    assert(manifest.count == 0);
+    assert(module_manifest_find(&manifest, module_filename, module_size, module_mtime_ns) == NULL);
+    module_manifest_free(&manifest);
+    printf("  [PASS] An empty manifest round-trips\n");
+
+    remove(manifest_filename);
+    remove(module_filename);
+    printf("Test finished.\n\n");
+}
+
+int main() {
+    test_module_manifest();
+
+    printf("All module manifest tests passed!\n");
+    return 0;
+}